@@ -18,6 +18,7 @@
     
 #include <project.h>
 #include <stdio.h>
+#include "deferred_log.h"
 
 
 /***************************************
@@ -28,6 +29,12 @@
 
 #define DEBUG_UART_ENABLED                  (ENABLED)
 
+/* (ENABLED) stores DBG_PRINTF() calls as binary records that are sent from the
+   main loop, see deferred_log.h for the frame format. The output is binary
+   and needs a host decoder, which is not part of this example.
+   (DISABLED) formats and prints the text at the call site. */
+#define DEBUG_UART_DEFERRED_LOG             (DISABLED)
+
 
 /***************************************
 *        API Constants
@@ -68,8 +75,18 @@ void App_ShowAuthError(cy_en_ble_gap_auth_failed_reason_t authErr);
 /***************************************
 *        Macros
 ***************************************/
-#if (DEBUG_UART_ENABLED == ENABLED)
+#if (DEBUG_UART_ENABLED == ENABLED) && (DEBUG_UART_DEFERRED_LOG == ENABLED)
+    #define DBG_PRINTF(...)                 LOG_PRINTF(__VA_ARGS__)
+    #define DBG_LOG_DRAIN(...)              (Log_Drain())
+    #define UART_DEB_PUT_CHAR(...)           while(1UL != UART_DEB_Put(__VA_ARGS__))
+    #define UART_DEB_GET_CHAR(...)          (UART_DEB_Get())
+    #define UART_DEB_IS_TX_COMPLETE(...)    (Log_IsEmpty() && (UART_DEB_IsTxComplete() != 0u))
+    #define UART_DEB_WAIT_TX_COMPLETE(...)  Log_Flush()
+    #define UART_DEB_SCB_CLEAR_RX_FIFO(...) (Cy_SCB_ClearRxFifo(UART_DEB_SCB__HW))
+    #define UART_START(...)                 (UART_DEB_Start(__VA_ARGS__))
+#elif (DEBUG_UART_ENABLED == ENABLED)
     #define DBG_PRINTF(...)                 (printf(__VA_ARGS__))
+    #define DBG_LOG_DRAIN(...)
     #define UART_DEB_PUT_CHAR(...)           while(1UL != UART_DEB_Put(__VA_ARGS__))
     #define UART_DEB_GET_CHAR(...)          (UART_DEB_Get())
     #define UART_DEB_IS_TX_COMPLETE(...)    (UART_DEB_IsTxComplete())
@@ -78,6 +95,7 @@ void App_ShowAuthError(cy_en_ble_gap_auth_failed_reason_t authErr);
     #define UART_START(...)                 (UART_DEB_Start(__VA_ARGS__))
 #else
     #define DBG_PRINTF(...)
+    #define DBG_LOG_DRAIN(...)
     #define UART_DEB_PUT_CHAR(...)
     #define UART_DEB_GET_CHAR(...)          (0u)
     #define UART_DEB_IS_TX_COMPLETE(...)    (1u)
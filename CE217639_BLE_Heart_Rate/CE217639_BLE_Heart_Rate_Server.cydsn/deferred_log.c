@@ -0,0 +1,275 @@
+/*******************************************************************************
+* File Name: deferred_log.c
+*
+* Version: 1.0
+*
+* Description:
+*  This file contains the deferred logging: a lock-free ring of binary log
+*  records that is sent to the debug UART from the main loop.
+*
+* Hardware Dependency:
+*  CY8CKIT-062 PSoC6 BLE Pioneer Kit
+* 
+********************************************************************************
+* Copyright 2017, Cypress Semiconductor Corporation.  All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+
+#include "common.h"
+#include <stdarg.h>
+
+#if (DEBUG_UART_ENABLED == ENABLED) && (DEBUG_UART_DEFERRED_LOG == ENABLED)
+
+#if ((LOG_RING_SIZE & (LOG_RING_SIZE - 1u)) != 0u)
+    #error "LOG_RING_SIZE must be a power of two"
+#endif
+
+/***************************************
+*           Constants
+***************************************/
+#define LOG_RING_MASK           (LOG_RING_SIZE - 1u)
+#define LOG_FRAME_HEADER_SIZE   (6u)
+#define LOG_FRAME_MAX_SIZE      (LOG_FRAME_HEADER_SIZE + (4u * LOG_MAX_ARGS))
+
+
+/***************************************
+*        Data Types
+***************************************/
+typedef struct
+{
+    /* Address of the format string, NULL until the record is complete */
+    const char * volatile format;
+    uint32_t              argCount;
+    uint32_t              args[LOG_MAX_ARGS];
+} log_record_t;
+
+
+/***************************************
+*        Global Variables
+***************************************/
+static log_record_t      logRing[LOG_RING_SIZE];
+
+/* Free-running indices: records reserved by Log_Write() and sent by 
+   Log_Drain() */
+static volatile uint32_t logHead    = 0u;
+static volatile uint32_t logTail    = 0u;
+
+/* Records lost because the ring was full */
+static volatile uint32_t logDropped = 0u;
+static const char        logDroppedFormat[] = "Log: %lu records dropped\r\n";
+
+/* Frame that is being sent to the UART */
+static uint8_t           logFrame[LOG_FRAME_MAX_SIZE];
+static uint32_t          logFrameSize = 0u;
+static uint32_t          logFramePos  = 0u;
+
+
+/*******************************************************************************
+* Function Name: AtomicAdd
+********************************************************************************
+*
+* Summary:
+*  Adds a value to a variable shared with interrupts, without disabling them.
+*
+*******************************************************************************/
+static void AtomicAdd(volatile uint32_t *value, uint32_t delta)
+{
+    do
+    {
+        /* Retried if an interrupt modified the value in between */
+    } while(__STREXW(__LDREXW(value) + delta, value) != 0u);
+}
+
+
+/*******************************************************************************
+* Function Name: BuildFrame
+********************************************************************************
+*
+* Summary:
+*  Encodes one record into logFrame.
+*
+*******************************************************************************/
+static void BuildFrame(const char *format, uint32_t argCount, const uint32_t args[])
+{
+    uint32_t i;
+    uint32_t pos;
+    
+    logFrame[0u] = LOG_FRAME_SYNC;
+    logFrame[1u] = (uint8_t)argCount;
+    Set32ByPtr(&logFrame[2u], (uint32_t)format);
+    
+    pos = LOG_FRAME_HEADER_SIZE;
+    for(i = 0u; i < argCount; i++)
+    {
+        Set32ByPtr(&logFrame[pos], args[i]);
+        pos += 4u;
+    }
+    
+    logFrameSize = pos;
+    logFramePos  = 0u;
+}
+
+
+/*******************************************************************************
+* Function Name: NextFrame
+********************************************************************************
+*
+* Summary:
+*  Takes the next complete record out of the ring and encodes it.
+*
+* Return:
+*  true if a frame is ready to be sent.
+*
+*******************************************************************************/
+static bool NextFrame(void)
+{
+    bool          frameReady = false;
+    uint32_t      dropped    = logDropped;
+    log_record_t *record;
+    
+    if(dropped != 0u)
+    {
+        /* Report the lost records first, they happened before the others */
+        BuildFrame(logDroppedFormat, 1u, &dropped);
+        AtomicAdd(&logDropped, 0u - dropped);
+        frameReady = true;
+    }
+    else if(logTail != logHead)
+    {
+        record = &logRing[logTail & LOG_RING_MASK];
+        
+        /* The oldest record may still be written by an interrupted writer */
+        if(record->format != NULL)
+        {
+            BuildFrame(record->format, record->argCount, record->args);
+            
+            /* Free the slot */
+            record->format = NULL;
+            __DMB();
+            logTail++;
+            frameReady = true;
+        }
+    }
+    
+    return frameReady;
+}
+
+
+/*******************************************************************************
+* Function Name: Log_Write
+********************************************************************************
+*
+* Summary:
+*  Stores a log record into the ring. Can be called from the main loop and
+*  from interrupts. Use the LOG_PRINTF() macro, which counts the arguments.
+*
+* Parameters:
+*  argCount: Number of arguments after the format string
+*  format:   printf() format string, must be a string literal
+*
+*******************************************************************************/
+void Log_Write(uint32_t argCount, const char *format, ...)
+{
+    va_list       argList;
+    log_record_t *record;
+    uint32_t      head;
+    uint32_t      i;
+    
+    /* Reserve a slot. The exclusive store fails if an interrupt reserved
+       one in between, in which case the reservation is retried */
+    do
+    {
+        head = __LDREXW(&logHead);
+        if((head - logTail) >= LOG_RING_SIZE)
+        {
+            __CLREX();
+            AtomicAdd(&logDropped, 1u);
+            return;
+        }
+    } while(__STREXW(head + 1u, &logHead) != 0u);
+    
+    record = &logRing[head & LOG_RING_MASK];
+    record->argCount = argCount;
+    
+    va_start(argList, format);
+    for(i = 0u; i < argCount; i++)
+    {
+        record->args[i] = va_arg(argList, uint32_t);
+    }
+    va_end(argList);
+    
+    /* The format marks the record as complete, so it is written last */
+    __DMB();
+    record->format = format;
+}
+
+
+/*******************************************************************************
+* Function Name: Log_Drain
+********************************************************************************
+*
+* Summary:
+*  Sends the log records to the UART until the ring is empty or the TX FIFO is
+*  full. Called from the main loop; it never waits for the UART.
+*
+*******************************************************************************/
+void Log_Drain(void)
+{
+    do
+    {
+        while(logFramePos < logFrameSize)
+        {
+            if(UART_DEB_Put(logFrame[logFramePos]) == 0u)
+            {
+                /* TX FIFO is full, continue on the next call */
+                return;
+            }
+            logFramePos++;
+        }
+    } while(NextFrame());
+}
+
+
+/*******************************************************************************
+* Function Name: Log_IsEmpty
+********************************************************************************
+*
+* Summary:
+*  Returns true if all the log records have been handed to the UART.
+*
+*******************************************************************************/
+bool Log_IsEmpty(void)
+{
+    return ((logTail == logHead) && (logDropped == 0u) && 
+            (logFramePos == logFrameSize));
+}
+
+
+/*******************************************************************************
+* Function Name: Log_Flush
+********************************************************************************
+*
+* Summary:
+*  Sends all the log records and waits until the UART has sent them, for
+*  example before entering Hibernate.
+*
+*******************************************************************************/
+void Log_Flush(void)
+{
+    while(Log_IsEmpty() == false)
+    {
+        Log_Drain();
+    }
+    
+    while(UART_DEB_IsTxComplete() == 0u)
+    {
+    }
+}
+
+#endif /* (DEBUG_UART_ENABLED == ENABLED) && (DEBUG_UART_DEFERRED_LOG == ENABLED) */
+
+
+/* [] END OF FILE */
@@ -0,0 +1,106 @@
+/*******************************************************************************
+* File Name: deferred_log.h
+*
+* Version: 1.0
+*
+* Description:
+*  Contains the function prototypes and constants of the deferred logging.
+*
+* Hardware Dependency:
+*  CY8CKIT-062 PSoC6 BLE Pioneer Kit
+*
+********************************************************************************
+* Copyright 2017, Cypress Semiconductor Corporation.  All rights reserved.
+* You may use this file only in accordance with the license, terms, conditions,
+* disclaimers, and limitations in the end user license agreement accompanying
+* the software package with which this file was provided.
+*******************************************************************************/
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/***************************************
+*           API Constants
+***************************************/
+
+/* Number of records the log ring can hold, must be a power of two */
+#define LOG_RING_SIZE                   (64u)
+
+/* Maximum number of arguments of one record */
+#define LOG_MAX_ARGS                    (6u)
+
+/* First byte of every frame sent to the UART */
+#define LOG_FRAME_SYNC                  (0xA5u)
+
+
+/***************************************
+*    Function Prototypes
+***************************************/
+
+/*
+* The deferred logging does not format the text at the call site. A call only
+* stores the address of the format string and the raw arguments into a RAM
+* ring, which takes a few dozen cycles and is safe from interrupts. Log_Drain() 
+* sends the records from the main loop without waiting for the UART. Every 
+* record is sent as one frame:
+*
+*   LOG_FRAME_SYNC, argument count N, format string address (4 bytes),
+*   N arguments (4 bytes each)
+*
+* All the multi-byte fields are little-endian. A host tool rebuilds the text
+* by looking up the format string at its address in the .elf file of the
+* project (the NUL-terminated string in the section that holds the address)
+* and formatting it with the arguments. No such tool ships with this example.
+* Frames have no checksum; a reader that loses sync skips bytes until it finds
+* LOG_FRAME_SYNC followed by a count of at most LOG_MAX_ARGS. The arguments must be integers
+* or pointers of up to 32 bits; strings (%s) and floating point values are not
+* supported. Records that do not fit into the ring are counted and reported
+* with a record of their own.
+*/
+void Log_Write(uint32_t argCount, const char *format, ...);
+void Log_Drain(void);
+bool Log_IsEmpty(void);
+void Log_Flush(void);
+
+
+/***************************************
+*        Macros
+***************************************/
+
+/*
+* Number of arguments after the format string, up to LOG_MAX_ARGS. The count
+* is picked by its position in the list and pasted onto LOG_ARG_CHECK_, so 
+* only the LOG_ARGS_n markers expand to a number. With more arguments, either
+* a LOG_TOO_MANY_ARGUMENTS marker or one of the caller's own arguments lands 
+* in the count position, and the pasted name does not exist: the call fails
+* to compile instead of recording a wrong count.
+*/
+#define LOG_ARG_COUNT(...)                                                      \
+    LOG_ARG_COUNT_(__VA_ARGS__, LOG_TOO_MANY_ARGUMENTS, LOG_TOO_MANY_ARGUMENTS, \
+                   LOG_ARGS_6, LOG_ARGS_5, LOG_ARGS_4, LOG_ARGS_3, LOG_ARGS_2,  \
+                   LOG_ARGS_1, LOG_ARGS_0, LOG_ARGS_0)
+#define LOG_ARG_COUNT_(format, a1, a2, a3, a4, a5, a6, a7, a8, count, ...)     \
+    (LOG_ARG_CHECK_##count)
+
+#define LOG_ARG_CHECK_LOG_ARGS_0        (0u)
+#define LOG_ARG_CHECK_LOG_ARGS_1        (1u)
+#define LOG_ARG_CHECK_LOG_ARGS_2        (2u)
+#define LOG_ARG_CHECK_LOG_ARGS_3        (3u)
+#define LOG_ARG_CHECK_LOG_ARGS_4        (4u)
+#define LOG_ARG_CHECK_LOG_ARGS_5        (5u)
+#define LOG_ARG_CHECK_LOG_ARGS_6        (6u)
+
+#if (LOG_MAX_ARGS != 6u)
+    #error "LOG_ARG_COUNT() has to be extended to match LOG_MAX_ARGS"
+#endif
+
+/* Records a formatted message, takes the same arguments as printf() */
+#define LOG_PRINTF(...)     (Log_Write(LOG_ARG_COUNT(__VA_ARGS__), __VA_ARGS__))
+
+#endif /* DEFERRED_LOG_H */
+
+/* [] END OF FILE */
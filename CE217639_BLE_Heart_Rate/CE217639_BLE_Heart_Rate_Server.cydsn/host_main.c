@@ -483,6 +483,9 @@ int HostMain()
         /* Cy_BLE_ProcessEvents() allows BLE stack to process pending events */
         Cy_BLE_ProcessEvents();
         
+        /* Send the deferred log records to the debug UART */
+        DBG_LOG_DRAIN();
+        
         /* To achieve low power in the device */
         LowPowerImplementation();
         
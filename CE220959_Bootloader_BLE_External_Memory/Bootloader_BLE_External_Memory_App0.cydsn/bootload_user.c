@@ -40,12 +40,42 @@ static const uint32_t cy_bootload_metadata[CY_FLASH_SIZEOF_ROW / sizeof(uint32_t
     CY_BOOTLOAD_APP0_VERIFY_START, CY_BOOTLOAD_APP0_VERIFY_LENGTH, /* The App0 base address and length       */
     CY_BOOTLOAD_APP1_VERIFY_START, CY_BOOTLOAD_APP1_VERIFY_LENGTH, /* The App1 base address and length       */
     CY_BOOTLOAD_APP1_VERIFY_START, CY_BOOTLOAD_APP1_VERIFY_LENGTH, /* Temporary App1 base address and length */
+    0xFFFFFFFF, 0x00000000,                                        /* vApp3 marks an unfinished App1 copy    */
     0u                                                             /* The rest does not matter               */
 };
 
 
+/* Bootloader packet command byte, see Cy_Bootload_TransportRead() */
+#define PACKET_CMD_IDX            (1u)
+#define CMD_ENTER                 (0x38u)
+#define CMD_PROGRAM_DATA          (0x49u)
+
+/* The flash row being programmed in the background, see DeferNextFlashWrite() */
+CY_ALIGN(4) static uint8_t flashRowBuffer[CY_FLASH_SIZEOF_ROW];
+static uint32_t flashRowAddress;
+static bool flashRowBusy = false;
+static bool flashRowDeferNext = false;
+/* A row of the session failed in the background, see ClearFlashWriteError() */
+static bool flashRowFailed = false;
+
+/* 
+* Sectors of the external memory erased for the application being received,
+* one bit per sector: 256 sectors of 256 KB cover the 64 MB of the S25FL512S.
+*/
+#define EXT_SECTOR_MAP_WORDS      (8u)
+#define EXT_SECTOR_MAX            (EXT_SECTOR_MAP_WORDS * 32u)
+static uint32_t extSectorErased[EXT_SECTOR_MAP_WORDS];
+
+/* The first row of a sector, written once the erase of the sector has finished */
+CY_ALIGN(4) static uint8_t extRowBuffer[CY_FLASH_SIZEOF_ROW];
+static uint32_t extRowAddress;
+static uint32_t extRowLength;
+static bool extRowPending = false;
+
 static uint32_t IsMultipleOf(uint32_t value, uint32_t multiple);
 static void GetStartEndAddress(uint32_t appId, uint32_t *startAddress, uint32_t *endAddress);
+static cy_en_bootload_status_t WriteFlashRow(uint32_t address, const uint8_t *data);
+static cy_en_bootload_status_t WriteExternalRow(uint32_t address, const uint8_t *data, uint32_t length);
 
 
 /*******************************************************************************
@@ -97,42 +127,194 @@ static void GetStartEndAddress(uint32_t appId, uint32_t *startAddress, uint32_t
 }
 
 /*******************************************************************************
-* Function Name: EraseExternalApp
+* Function Name: DeferNextFlashWrite
 ****************************************************************************//**
 *
-* Erases the sectors of the external memory, where the application is stored.
-* 
-* /params
-* None
+* Lets the next internal flash row written by Cy_Bootload_WriteData() be 
+* programmed in the background. Cy_Bootload_WriteData() then returns as soon as
+* the row has been copied and programming has started, so the caller can fetch 
+* the next row meanwhile. Rows of the metadata are always programmed before 
+* Cy_Bootload_WriteData() returns, as the Bootloader SDK reads them directly.
+*
+* A background write that fails is reported by WaitForFlashWrite(), and by 
+* the next background write, which fails the command so the session ends.
 *
 *******************************************************************************/
-cy_en_bootload_status_t EraseExternalApp(void)
+void DeferNextFlashWrite(void)
 {
-    /* Get Sector Size from External Memory Configuration */
-    uint32_t SectorSize = deviceCfg_S25FL512S_0.eraseSize;
-    uint32_t appSize;
+    flashRowDeferNext = true;
+}
+
+
+/*******************************************************************************
+* Function Name: ClearFlashWriteError
+****************************************************************************//**
+*
+* Finishes the row programmed in the background and forgets a failed background
+* write, so that a new session or a new copy of an application can start.
+*
+*******************************************************************************/
+void ClearFlashWriteError(void)
+{
+    (void) WaitForFlashWrite();
+    flashRowFailed = false;
+}
+
+
+/*******************************************************************************
+* Function Name: WaitForFlashWrite
+****************************************************************************//**
+*
+* Waits until the row programmed in the background is written and checks it.
+* A row of the external memory waiting for the erase of its sector is written.
+*
+* \return
+* - true if the rows programmed in the background are written.
+* - false if one of them has failed since ClearFlashWriteError() was called.
+*
+*******************************************************************************/
+bool WaitForFlashWrite(void)
+{
+    cy_en_flashdrv_status_t fstatus;
     
-    /* Start address is assumed to be start of external memory */
-    cy_en_bootload_status_t status = Cy_Bootload_GetAppMetadata(2u, NULL, &appSize);
+    if (extRowPending)
+    {
+        /* WriteMemory() waits until the sector is erased */
+        extRowPending = false;
+        WriteMemory(extRowBuffer, extRowLength, extRowAddress);
+    }
     
-    if(status == CY_BOOTLOAD_SUCCESS)
+    if (flashRowBusy)
     {
-        if(appSize > 0)
+        do
         {
-            appSize += CY_BOOTLOAD_SIGNATURE_SIZE;
-            /* Convert appSize into sectors */
-            appSize = (appSize - 1) / SectorSize;
-            for(uint16_t i = 0; i <= appSize; i++)
-            {
-                EraseSMIFSector(SectorSize * i);
-            }
+            fstatus = Cy_Flash_IsOperationComplete();
+        } while (fstatus == CY_FLASH_DRV_OPCODE_BUSY);
+        
+        flashRowBusy = false;
+        Cy_SysLib_ClearFlashCacheAndBuffer();
+        
+        if ( (fstatus != CY_FLASH_DRV_SUCCESS) ||
+             (memcmp(flashRowBuffer, (const void *)flashRowAddress, CY_FLASH_SIZEOF_ROW) != 0) )
+        {
+            flashRowFailed = true;
+        }
+    }
+    return (!flashRowFailed);
+}
+
+
+/*******************************************************************************
+* Function Name: WriteFlashRow
+****************************************************************************//**
+*
+* This internal function writes a row of the internal flash. The row is 
+* programmed in the background if DeferNextFlashWrite() has been called before,
+* so the buffer with the data can be reused right away.
+*
+* \param address  The address of the row.
+* \param data     The data to write, CY_FLASH_SIZEOF_ROW bytes.
+*
+* \return CY_BOOTLOAD_SUCCESS if the row is written or its programming has
+*         started. CY_BOOTLOAD_ERROR_DATA if the write fails, or if this
+*         is a background write and a background write before it has failed.
+*
+*******************************************************************************/
+static cy_en_bootload_status_t WriteFlashRow(uint32_t address, const uint8_t *data)
+{
+    cy_en_flashdrv_status_t fstatus;
+    cy_en_bootload_status_t status = CY_BOOTLOAD_SUCCESS;
+    bool deferred = flashRowDeferNext;
+    
+    flashRowDeferNext = false;
+    
+    /* The buffer of the previous row is reused, so it must be written first */
+    if (!WaitForFlashWrite())
+    {
+        if (deferred)
+        {
+            /* The failed command ends the session, the host starts it again */
+            status = CY_BOOTLOAD_ERROR_DATA;
         }
         else
         {
-            status = CY_BOOTLOAD_ERROR_ADDRESS;
+            /* A write outside a Program Data command does not depend on it */
+            flashRowFailed = false;
+        }
+    }
+    
+    if ( ((uint32_t)&__cy_boot_metadata_addr <= address) && 
+         (((uint32_t)&__cy_boot_metadata_addr + (uint32_t)&__cy_boot_metadata_length) > address) )
+    {
+        deferred = false;
+    }
+    
+    if (status == CY_BOOTLOAD_SUCCESS)
+    {
+        if (deferred)
+        {
+            (void) memcpy(flashRowBuffer, data, CY_FLASH_SIZEOF_ROW);
+            fstatus = Cy_Flash_StartWrite(address, (const uint32_t *)flashRowBuffer);
+            flashRowAddress = address;
+            flashRowBusy = (fstatus == CY_FLASH_DRV_SUCCESS);
+        }
+        else
+        {
+            fstatus = Cy_Flash_WriteRow(address, (const uint32_t *)data);
         }
+        status = (fstatus == CY_FLASH_DRV_SUCCESS) ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_DATA;
     }
-    return status;
+    return (status);
+}
+
+
+/*******************************************************************************
+* Function Name: WriteExternalRow
+****************************************************************************//**
+*
+* This internal function writes a row of the application in the external 
+* memory. A sector is erased just before the first write into it, so sectors
+* the application does not use are left alone. The erase is only started 
+* here; the row is kept in a buffer and written by Cy_Bootload_TransportRead()
+* once the erase has finished, so the erase runs while the next command is 
+* received. WaitForFlashWrite() writes it first if a command needs it sooner.
+*
+* \param address  The offset of the row in the external memory.
+* \param data     The data to write.
+* \param length   The length of the data, at most CY_FLASH_SIZEOF_ROW bytes.
+*
+* \return CY_BOOTLOAD_SUCCESS, or CY_BOOTLOAD_ERROR_ADDRESS if the row is 
+*         outside the external memory.
+*
+*******************************************************************************/
+static cy_en_bootload_status_t WriteExternalRow(uint32_t address, const uint8_t *data, uint32_t length)
+{
+    /* Get Sector Size from External Memory Configuration */
+    uint32_t sector = address / deviceCfg_S25FL512S_0.eraseSize;
+    cy_en_bootload_status_t status = CY_BOOTLOAD_SUCCESS;
+    
+    /* A row is written only after the row before it */
+    (void) WaitForFlashWrite();
+    
+    if ( (sector >= EXT_SECTOR_MAX) || (length > CY_FLASH_SIZEOF_ROW) )
+    {
+        status = CY_BOOTLOAD_ERROR_ADDRESS;
+    }
+    else if ( (extSectorErased[sector / 32u] & (1ul << (sector % 32u))) == 0u )
+    {
+        extSectorErased[sector / 32u] |= (1ul << (sector % 32u));
+        StartEraseSMIFSector(sector * deviceCfg_S25FL512S_0.eraseSize);
+        
+        (void) memcpy(extRowBuffer, data, length);
+        extRowAddress = address;
+        extRowLength  = length;
+        extRowPending = true;
+    }
+    else
+    {
+        WriteMemory((uint8_t *)data, length, address);
+    }
+    return (status);
 }
 
 
@@ -235,23 +417,22 @@ cy_en_bootload_status_t Cy_Bootload_WriteData (uint32_t address, uint32_t length
             {
                 (void) memset(params->dataBuffer, 0, CY_FLASH_SIZEOF_ROW);
             }
-            cy_en_flashdrv_status_t fstatus =  Cy_Flash_WriteRow(address, (uint32_t*)params->dataBuffer);
-            status = (fstatus == CY_FLASH_DRV_SUCCESS) ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_DATA;
+            status = WriteFlashRow(address, params->dataBuffer);
         }
         else if ( (minXIPAddress <= address) && (address < maxXIPAddress) )
         {
             /*
             * Check if address to write is the beginning of a new App
-            * If it is, then delete the application before writing.
+            * If it is, then its sectors are erased again as it is written.
             */
             if(address == minXIPAddress)
             {
-                status = EraseExternalApp();
-            }
-            if(status == CY_BOOTLOAD_SUCCESS)
-            {
-                WriteMemory(params->dataBuffer, length, address - minXIPAddress);
+                (void) WaitForFlashWrite();
+                (void) memset(extSectorErased, 0, sizeof(extSectorErased));
             }
+            /* Only rows of the internal flash are programmed in the background */
+            flashRowDeferNext = false;
+            status = WriteExternalRow(address - minXIPAddress, params->dataBuffer, length);
         }
         else
         {
@@ -330,11 +511,19 @@ cy_en_bootload_status_t Cy_Bootload_ReadData (uint32_t address, uint32_t length,
             /* Read or Compare */
     	    if ((ctl & CY_BOOTLOAD_IOCTL_COMPARE) == 0u)
     	    {
+    	        (void) WaitForFlashWrite();
     	        (void) memcpy(params->dataBuffer, (const void *)address, length);
     	        status = CY_BOOTLOAD_SUCCESS;
       	    }
+    	    else if (flashRowBusy && (address == flashRowAddress) && (length == CY_FLASH_SIZEOF_ROW))
+    	    {
+    	        /* The row is still being programmed; WaitForFlashWrite() checks the flash */
+    	        status = ( memcmp(params->dataBuffer, flashRowBuffer, length) == 0 )
+    		         ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_VERIFY;
+    	    }
     	    else
     	    {
+    	        (void) WaitForFlashWrite();
     	        status = ( memcmp(params->dataBuffer, (const void *)address, length) == 0 )
     		         ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_VERIFY;
     	    }
@@ -344,11 +533,14 @@ cy_en_bootload_status_t Cy_Bootload_ReadData (uint32_t address, uint32_t length,
     	{
     		if ((ctl & CY_BOOTLOAD_IOCTL_COMPARE) == 0u)
     		{
+    		    (void) WaitForFlashWrite();
     		    ReadMemory(params->dataBuffer, length, address - minXIPAddress);
     		}
     		else
     		{
     		    uint8_t buffer[CY_BOOTLOAD_SIZEOF_DATA_BUFFER];
+    		    /* A row waiting for the erase of its sector is written and read back */
+    		    (void) WaitForFlashWrite();
     		    ReadMemory(&buffer[0], length, address - minXIPAddress);
     		    status = ( memcmp(params->dataBuffer, &buffer[0], length) == 0 )
     			     ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_VERIFY;
@@ -398,6 +590,8 @@ cy_en_bootload_status_t Cy_Bootload_ValidateApp(uint32_t appId, cy_stc_bootload_
     if(appId == 2u)
     {
         appStartAddress = minXIPAddress;
+        /* A row may still wait for the erase of its sector */
+        (void) WaitForFlashWrite();
         /* 
         * Switch to XIP mode to enable direct access and avoid reimplementing the crc algorithm.
         * If memory mode is unavailable, the crc algorithm must be implemented to work in chunks.
@@ -433,7 +627,42 @@ cy_en_bootload_status_t Cy_Bootload_ValidateApp(uint32_t appId, cy_stc_bootload_
 *******************************************************************************/
 cy_en_bootload_status_t Cy_Bootload_TransportRead (uint8_t *buffer, uint32_t size, uint32_t *count, uint32_t timeout)
 {
-    return (CyBLE_CyBtldrCommRead(buffer, size, count, timeout));
+    cy_en_bootload_status_t status;
+    
+    /* 
+    * Write a row waiting for the erase of its sector as soon as the erase is
+    * done. Checking first keeps the BLE loop running while the memory is busy.
+    */
+    if (extRowPending && IsSMIFMemoryReady())
+    {
+        extRowPending = false;
+        WriteMemory(extRowBuffer, extRowLength, extRowAddress);
+    }
+    
+    status = CyBLE_CyBtldrCommRead(buffer, size, count, timeout);
+    
+    /* 
+    * The row of a Program Data command is programmed while the next command is
+    * received. Any other command may read the flash, so the row is finished first.
+    */
+    if ( (status == CY_BOOTLOAD_SUCCESS) && (*count > PACKET_CMD_IDX) )
+    {
+        if (buffer[PACKET_CMD_IDX] == CMD_PROGRAM_DATA)
+        {
+            DeferNextFlashWrite();
+        }
+        else
+        {
+            (void) WaitForFlashWrite();
+            
+            /* A new session writes the application again from the start */
+            if (buffer[PACKET_CMD_IDX] == CMD_ENTER)
+            {
+                ClearFlashWriteError();
+            }
+        }
+    }
+    return (status);
 }
 
 /*******************************************************************************
@@ -446,6 +675,9 @@ cy_en_bootload_status_t Cy_Bootload_TransportRead (uint8_t *buffer, uint32_t siz
 *******************************************************************************/
 cy_en_bootload_status_t Cy_Bootload_TransportWrite(uint8_t *buffer, uint32_t size, uint32_t *count, uint32_t timeout)
 {
+    /* The command is done, a row it has not written is not written in the background */
+    flashRowDeferNext = false;
+    
     return (CyBLE_CyBtldrCommWrite(buffer, size, count, timeout));
 }
 
@@ -459,6 +691,8 @@ cy_en_bootload_status_t Cy_Bootload_TransportWrite(uint8_t *buffer, uint32_t siz
 *******************************************************************************/
 void Cy_Bootload_TransportReset(void)
 {
+    /* The session has ended, the next one writes the application again */
+    ClearFlashWriteError();
     CyBLE_CyBtldrCommReset();
 }
 
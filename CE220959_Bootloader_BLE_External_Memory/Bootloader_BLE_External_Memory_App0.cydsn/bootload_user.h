@@ -17,6 +17,7 @@
 #define BOOTLOAD_USER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "flash/cy_flash.h"
     
 
@@ -77,8 +78,11 @@
 * because 4 bytes are reserved for the entire metadata CRC.
 * 
 * The smallest metadata size if CY_BOOTLOAD_MAX_APPS * 8 (bytes per one app) + 4 (bytes for CRC-32C)
+*
+* Virtual App3 is not an application: a non-zero length marks a copy of App2
+* into App1 that has not finished yet.
 */
-#define CY_BOOTLOAD_MAX_APPS            (3u)
+#define CY_BOOTLOAD_MAX_APPS            (4u)
 
 
 /** A non-zero value enables the Verify Data bootloader command  */
@@ -165,6 +169,12 @@
 #endif /* !defined(CY_DOXYGEN) */
 
 
+/* Background flash writes, implemented in bootload_user.c */
+void DeferNextFlashWrite(void);
+bool WaitForFlashWrite(void);
+void ClearFlashWriteError(void);
+
+
 #endif /* !defined(BOOTLOAD_USER_H) */
 
 
@@ -60,6 +60,12 @@
 #define VERIFY_INT_APP (1u)
 #define VERIFY_EXT_APP (2u)
 
+/* 
+* Virtual App3 holds the App2 metadata while App2 is copied into App1, so
+* a copy interrupted by a reset is finished at the next start.
+*/
+#define COPY_MARKER_APP (3u)
+
 /* Enables/Disables warning sequence at boot up */
 #define SHOW_WARNING (1u)
 
@@ -81,6 +87,7 @@ void AppCallBack(uint32 event, void* eventParam);
 static bool IsButtonPressed(uint16_t timeoutInMilis);
 static uint32_t counterTimeoutSeconds(uint32_t seconds, uint32_t timeout);
 static cy_en_bootload_status_t CopyApp(cy_stc_bootload_params_t * params);
+static bool IsCopyPending(void);
 
 static cy_en_bootload_status_t CopyRow(uint32_t dest, uint32_t src, uint32_t rowSize, cy_stc_bootload_params_t * params);
 static cy_en_bootload_status_t HandleMetadata(cy_stc_bootload_params_t *params);
@@ -92,6 +99,8 @@ static cy_en_bootload_status_t HandleMetadata(cy_stc_bootload_params_t *params);
 * Summary:
 *  Main function of the bootloader application (App0).
 *  1. Shows the warning LED sequence if enabled
+*  1.1. If a reset interrupted the copy of a valid external app into the internal flash,
+*       finish the copy.
 *  2. If application started from Non-Software reset, it validates App1 in the internal flash.
 *  2.1. If the app is valid it switches to it, else goto #3.
 *  3. Start SMIF communication.
@@ -201,6 +210,12 @@ int main(void)
     }
     #endif /* SHOW_WARNING != 0 */
     
+    /* Finish copying App2 into App1 if a reset interrupted it */
+    if (IsCopyPending() && (Cy_Bootload_ValidateApp(VERIFY_EXT_APP, &bootParams) == CY_BOOTLOAD_SUCCESS))
+    {
+        (void) CopyApp(&bootParams);
+    }
+    
     /*
     * In the case of non-software reset and user does not
     * want to stay in bootloader check if there is a valid app image
@@ -424,6 +439,13 @@ static bool IsButtonPressed(uint16_t timeoutInMilis)
 ********************************************************************************
 *  Copies the application located in the external memory into the internal flash.
 *
+*  The image is read through the XIP region, so the SMIF cache prefetches the
+*  next rows, and each row is programmed while the next one is read. Rows that 
+*  the internal flash already holds are skipped, which keeps small updates 
+*  short. The App2 metadata is kept in virtual App3 until the App1 metadata has
+*  been written; if a reset interrupts the copy, main() calls CopyApp() again 
+*  and it goes on from the first row that differs.
+*
 * Parameters:
 *  Bootloader parameters structure to use as buffer.
 *
@@ -437,40 +459,85 @@ static cy_en_bootload_status_t CopyApp(cy_stc_bootload_params_t * params)
     uint32_t SourceAppAddress = CY_XIP_BASE;
     uint32_t SourceAppSize;
     uint32_t DestAddress;
+    uint32_t AppLength;
     uint8_t BlinkDivider = 0;
+    #if CY_BOOTLOAD_METADATA_WRITABLE != 0
+    uint32_t MarkerAddress;
+    uint32_t MarkerLength;
+    #endif /* CY_BOOTLOAD_METADA_WRITABLE != 0 */
         
     /* Get Source address and size to copy into destination address */
-    status = Cy_Bootload_GetAppMetadata(2u, &DestAddress, &SourceAppSize);
+    status = Cy_Bootload_GetAppMetadata(2u, &DestAddress, &AppLength);
+    
+    #if CY_BOOTLOAD_METADATA_WRITABLE != 0
+    /* Mark the copy as started */
+    if(status == CY_BOOTLOAD_SUCCESS)
+    {
+        status = Cy_Bootload_GetAppMetadata(COPY_MARKER_APP, &MarkerAddress, &MarkerLength);
+        if((status != CY_BOOTLOAD_SUCCESS) || (MarkerAddress != DestAddress) || (MarkerLength != AppLength))
+        {
+            status = Cy_Bootload_SetAppMetadata(COPY_MARKER_APP, DestAddress, AppLength, params);
+        }
+    }
+    #endif /* CY_BOOTLOAD_METADA_WRITABLE != 0 */
     
     if(status == CY_BOOTLOAD_SUCCESS)
     {
         /* Calculate Source end address */
-        SourceAppSize = SourceAppAddress + SourceAppSize + CY_BOOTLOAD_SIGNATURE_SIZE;
+        SourceAppSize = SourceAppAddress + AppLength + CY_BOOTLOAD_SIGNATURE_SIZE;
         
         /* Set appId to 1u in order to write to internal flash */
         params->appId = 1u;
+        
+        /* 
+        * Nothing may be left to write to the external memory in XIP mode. A row 
+        * that failed in a copy before is written again by this one.
+        */
+        ClearFlashWriteError();
+        SwitchSMIFMemory();
 
         while (SourceAppAddress < SourceAppSize)
         {
-            /* Read a row from the memory */
-            status = Cy_Bootload_ReadData(SourceAppAddress, CY_FLASH_SIZEOF_ROW, CY_BOOTLOAD_IOCTL_READ, params);
-            if(status != CY_BOOTLOAD_SUCCESS)
+            /* Read a row from the memory, while the previous row is programmed */
+            (void) memcpy(params->dataBuffer, (const void *)SourceAppAddress, CY_FLASH_SIZEOF_ROW);
+            
+            /* The internal flash cannot be read while it is programmed */
+            if(!WaitForFlashWrite())
             {
                 status = CY_BOOTLOAD_ERROR_DATA;
                 break;
             }
-            /* Write the row into the internal application */
-            status = Cy_Bootload_WriteData(DestAddress, CY_FLASH_SIZEOF_ROW, CY_BOOTLOAD_IOCTL_WRITE, params);
-            if(status != CY_BOOTLOAD_SUCCESS)
+            
+            /* Skip the rows that are already in the internal application */
+            if(memcmp(params->dataBuffer, (const void *)DestAddress, CY_FLASH_SIZEOF_ROW) != 0)
             {
-                status = CY_BOOTLOAD_ERROR_DATA;
-                break;
+                /* 
+                * Write the row into the internal application. The row is programmed 
+                * while the next one is read from the external memory.
+                */
+                DeferNextFlashWrite();
+                status = Cy_Bootload_WriteData(DestAddress, CY_FLASH_SIZEOF_ROW, CY_BOOTLOAD_IOCTL_WRITE, params);
+                if(status != CY_BOOTLOAD_SUCCESS)
+                {
+                    status = CY_BOOTLOAD_ERROR_DATA;
+                    break;
+                }
+                /* Blink LED to indicate an app being copied */
+                if((BlinkDivider++ % 3) == 0) BlinkLED();
             }
             SourceAppAddress += CY_FLASH_SIZEOF_ROW;
             DestAddress += CY_FLASH_SIZEOF_ROW;
-            /* Blink LED to indicate an app being copied */
-            if((BlinkDivider++ % 3) == 0) BlinkLED();
         }
+        
+        /* Finish the last row */
+        if(!WaitForFlashWrite())
+        {
+            status = CY_BOOTLOAD_ERROR_DATA;
+        }
+        
+        /* Return to normal SMIF mode, to use regular read/write functions */
+        SwitchSMIFNormal();
+        
         #if CY_BOOTLOAD_METADATA_WRITABLE != 0
         /* Update metadata of App1 (internal) with received metadata of App2 (external) */
         if(status == CY_BOOTLOAD_SUCCESS)
@@ -478,11 +545,45 @@ static cy_en_bootload_status_t CopyApp(cy_stc_bootload_params_t * params)
             Cy_Bootload_GetAppMetadata(2u, &SourceAppAddress, &SourceAppSize);
             status = Cy_Bootload_SetAppMetadata(1u, SourceAppAddress, SourceAppSize, params);
         }
+        /* The copy is complete */
+        if(status == CY_BOOTLOAD_SUCCESS)
+        {
+            status = Cy_Bootload_SetAppMetadata(COPY_MARKER_APP, 0xFFFFFFFF, 0x00000000, params);
+        }
         #endif /* CY_BOOTLOAD_METADA_WRITABLE != 0 */
     }
     return status;
 }
 
+/*******************************************************************************
+* Function Name: IsCopyPending
+********************************************************************************
+*  Checks if a copy of App2 into App1 has been started by CopyApp() and has 
+*  not finished.
+*
+* Parameters:
+*  None
+*
+* Returns:
+*  true if the copy has to be finished.
+*******************************************************************************/
+static bool IsCopyPending(void)
+{
+    uint32_t MarkerAddress;
+    uint32_t MarkerLength;
+    uint32_t AppAddress;
+    uint32_t AppLength;
+    bool pending = false;
+    
+    if((Cy_Bootload_GetAppMetadata(COPY_MARKER_APP, &MarkerAddress, &MarkerLength) == CY_BOOTLOAD_SUCCESS)
+        && (Cy_Bootload_GetAppMetadata(2u, &AppAddress, &AppLength) == CY_BOOTLOAD_SUCCESS))
+    {
+        /* The marker only counts for the App2 image it was written for */
+        pending = (MarkerLength != 0u) && (MarkerAddress == AppAddress) && (MarkerLength == AppLength);
+    }
+    return pending;
+}
+
 /*******************************************************************************
 * Function Name: counterTimeoutSeconds
 ********************************************************************************
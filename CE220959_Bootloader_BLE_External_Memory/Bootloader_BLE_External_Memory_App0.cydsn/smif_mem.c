@@ -38,19 +38,37 @@
 * Cypress software license agreement.
 *****************************************************************************/
 
+#include <string.h>
 #include "smif_mem.h"
 #include "project.h"
 
-/* Macro to wait until a next operation can be issued */
-#define WaitMemBusy(Hardware, Context)  while(Cy_SMIF_Memslot_IsBusy(Hardware, (cy_stc_smif_mem_config_t*)smifMemConfigs[0], Context)){}
+/* 
+* Macro to wait until a next operation can be issued. A page still being sent
+* by the SMIF interrupt must be out before the memory status can be read.
+*/
+#define WaitMemBusy(Hardware, Context)  do { \
+            while(pageTxBusy){} \
+            while(Cy_SMIF_Memslot_IsBusy(Hardware, (cy_stc_smif_mem_config_t*)smifMemConfigs[0], Context)){} \
+        } while(0)
+
+/* Largest program page supported, the S25FL512S has 512 byte pages */
+#define PAGE_BUFFER_SIZE    (512u)
 
 /* Local functions */
 void SetSMIFPointers(SMIF_Type *base, cy_stc_smif_context_t *context); /* Sets local pointers */
+void TxCmpltCallback(uint32_t event);                                  /* Page sent */
 
 /* Pointers must be initialized before using component, otherwise a fault will occur */
 static SMIF_Type* SMIFHardware;
 static cy_stc_smif_context_t* SMIFcontext;
 
+/* 
+* The page being programmed. WriteMemory() returns while the SMIF interrupt
+* still sends it, so the data is copied here and the caller's buffer is free.
+*/
+CY_ALIGN(4) static uint8_t pageBuffer[PAGE_BUFFER_SIZE];
+static volatile bool pageTxBusy = false;
+
 /*******************************************************************************
 * Function Name: handle_error
 ********************************************************************************
@@ -97,6 +115,28 @@ void RxCmpltCallback (uint32_t event)
     }
 }
 
+/*******************************************************************************
+* Function Name: TxCmpltCallback
+********************************************************************************
+*
+*   Callback function for the SMIF interrupt, called when the last byte of a
+*   page has been sent to the memory. The memory then programs the page.
+*
+* \param
+*  uint32_t event: Event received from SMIF interrupt
+*
+* \return
+*  None
+*
+*******************************************************************************/
+void TxCmpltCallback (uint32_t event)
+{
+    if(CY_SMIF_SEND_CMPLT == event)
+    {
+        pageTxBusy = false;
+    }
+}
+
 /*******************************************************************************
 * Function Name: configureSMIF
 ********************************************************************************
@@ -160,7 +200,11 @@ void configureSMIF(SMIF_Type *base, cy_stc_smif_context_t *context)
 ********************************************************************************
 *
 * This function writes data to the external memory in the quad mode. 
-* The function uses the Quad Page Program. 
+* The function uses the Quad Page Program, one command per page; the data is
+* split at the page boundaries. It returns as soon as the last page is being
+* sent: the SMIF interrupt sends it from a copy, and the memory programs it
+* while the CPU goes on. The next access waits for it, or IsSMIFMemoryReady()
+* tells whether it is done.
 *
 * \param txBuffer
 * Holds the address of the data to be sent.
@@ -177,28 +221,77 @@ void configureSMIF(SMIF_Type *base, cy_stc_smif_context_t *context)
 void WriteMemory(uint8_t txBuffer[],uint32_t txSize,uint32_t Address)
 {
     cy_en_smif_status_t smif_status;
+    uint32_t pageSize = smifMemConfigs[0]->deviceCfg->programSize;
+    uint32_t pageAddress;
+    uint32_t chunk;
     
-    /* Reverse address byte order */
-    Address = __REV(Address);
-    
-    /* Wait until memory is available */
-    WaitMemBusy(SMIFHardware, SMIFcontext);
-    
-    /* Send Write Enable to external memory */	
-    smif_status = Cy_SMIF_Memslot_CmdWriteEnable(SMIFHardware, smifMemConfigs[0], SMIFcontext);
-    if(smif_status!=CY_SMIF_SUCCESS)
+    if(pageSize > PAGE_BUFFER_SIZE)
     {
-        handle_error();
+        pageSize = PAGE_BUFFER_SIZE;
     }
     
-    WaitMemBusy(SMIFHardware, SMIFcontext);
+    while(txSize > 0u)
+    {
+        /* A page program wraps around within the page, so stop at its end */
+        chunk = pageSize - (Address % pageSize);
+        if(chunk > txSize)
+        {
+            chunk = txSize;
+        }
+        
+        /* Wait until memory is available */
+        WaitMemBusy(SMIFHardware, SMIFcontext);
+        
+        (void) memcpy(pageBuffer, txBuffer, chunk);
+        
+        /* Send Write Enable to external memory */	
+        smif_status = Cy_SMIF_Memslot_CmdWriteEnable(SMIFHardware, smifMemConfigs[0], SMIFcontext);
+        if(smif_status!=CY_SMIF_SUCCESS)
+        {
+            handle_error();
+        }
+        
+        /* Reverse address byte order */
+        pageAddress = __REV(Address);
+        
+    	/* Quad Page Program command, the interrupt sends the page */       
+        pageTxBusy = true;
+        smif_status = Cy_SMIF_Memslot_CmdProgram(SMIFHardware, smifMemConfigs[0], (uint8_t*)&pageAddress, pageBuffer, chunk, &TxCmpltCallback, SMIFcontext);
+        if(smif_status!=CY_SMIF_SUCCESS)
+        {
+            handle_error();
+        }
+        
+        txBuffer = &txBuffer[chunk];
+        txSize  -= chunk;
+        Address += chunk;
+    }
+}
+
+/*******************************************************************************
+* Function Name: IsSMIFMemoryReady
+********************************************************************************
+*
+* This function tells whether the external memory can take the next command,
+* without waiting: the last page has been sent and the memory has finished 
+* programming or erasing. 
+*
+* \param
+*  None
+*
+* \return
+*  true if the memory is ready.
+*******************************************************************************/
+bool IsSMIFMemoryReady(void)
+{
+    bool ready = false;
     
-	/* Quad Page Program command */       
-    smif_status = Cy_SMIF_Memslot_CmdProgram(SMIFHardware, smifMemConfigs[0], (uint8_t*)&Address, txBuffer, txSize, &RxCmpltCallback, SMIFcontext);
-    if(smif_status!=CY_SMIF_SUCCESS)
+    /* The status can only be read once the page has been sent */
+    if(!pageTxBusy)
     {
-        handle_error();
+        ready = !Cy_SMIF_Memslot_IsBusy(SMIFHardware, (cy_stc_smif_mem_config_t*)smifMemConfigs[0], SMIFcontext);
     }
+    return ready;
 }
 
 /*******************************************************************************
@@ -257,6 +350,9 @@ void ReadMemory(uint8_t rxBuffer[], uint32_t rxSize, uint32_t Address)
 *******************************************************************************/
 void SwitchSMIFMemory(void)
 {
+    /* The memory cannot be read while it programs a page */
+    WaitMemBusy(SMIFHardware, SMIFcontext);
+    
     /* SMIF must be already running */
     Cy_SMIF_SetMode(SMIFHardware, CY_SMIF_MEMORY);
     
@@ -299,6 +395,9 @@ void EraseSMIFChip(void)
 {
     cy_en_smif_status_t smif_status;
     
+    /* Wait until memory is available */
+    WaitMemBusy(SMIFHardware, SMIFcontext);
+    
     smif_status = Cy_SMIF_Memslot_CmdWriteEnable(SMIFHardware, smifMemConfigs[0], SMIFcontext);
     if(smif_status!=CY_SMIF_SUCCESS)
     {
@@ -327,12 +426,36 @@ void EraseSMIFChip(void)
 *  None
 *******************************************************************************/
 void EraseSMIFSector(uint32_t Address)
+{
+    StartEraseSMIFSector(Address);
+    
+    WaitMemBusy(SMIFHardware, SMIFcontext);
+}
+
+/*******************************************************************************
+* Function Name: StartEraseSMIFSector
+********************************************************************************
+*
+* This function starts erasing the sector where the passed address is located
+* and returns while the memory is still busy. The next call of WriteMemory(), 
+* ReadMemory() or any erase function waits until the erase has finished.
+*
+* \param Address
+* Address to be deleted (Including sector where address is located).
+* 
+* \return
+*  None
+*******************************************************************************/
+void StartEraseSMIFSector(uint32_t Address)
 {
     cy_en_smif_status_t smif_status;
     
     /* Reverse address byte order */
     Address = __REV(Address);
     
+    /* Wait until memory is available */
+    WaitMemBusy(SMIFHardware, SMIFcontext);
+    
     smif_status = Cy_SMIF_Memslot_CmdWriteEnable(SMIFHardware, smifMemConfigs[0], SMIFcontext);
     if(smif_status!=CY_SMIF_SUCCESS)
     {
@@ -344,8 +467,6 @@ void EraseSMIFSector(uint32_t Address)
     {
         handle_error();
     }
-    
-    WaitMemBusy(SMIFHardware, SMIFcontext);
 }
 
 /*******************************************************************************
@@ -59,6 +59,8 @@ void ReadMemory(
                     uint32_t rxSize, 	
                     uint32_t address);  	/* Read data from memory in the quad mode */
 
+bool IsSMIFMemoryReady(void);               /* Check if the last write or erase has finished */
+
 void SwitchSMIFMemory(void);                /* Switch to XIP mode */
 
 void SwitchSMIFNormal(void);                /* Switch to Normal mode */
@@ -67,6 +69,8 @@ void EraseSMIFChip(void);                   /* Bulk erase the chip */
 
 void EraseSMIFSector(uint32_t Address);     /* Erase a sector */
 
+void StartEraseSMIFSector(uint32_t Address);/* Start erasing a sector, without waiting for it */
+
 /*******************************************************************************
 *            Constants
 *******************************************************************************/
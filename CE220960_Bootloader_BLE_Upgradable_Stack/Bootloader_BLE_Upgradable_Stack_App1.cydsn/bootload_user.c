@@ -28,8 +28,22 @@
 #include "bootloader/cy_bootload.h"
 
 
+/* Bootloader packet command byte, see Cy_Bootload_TransportRead() */
+#define PACKET_CMD_IDX            (1u)
+#define CMD_ENTER                 (0x38u)
+#define CMD_PROGRAM_DATA          (0x49u)
+
+/* The flash row being programmed in the background, see DeferNextFlashWrite() */
+CY_ALIGN(4) static uint8_t flashRowBuffer[CY_FLASH_SIZEOF_ROW];
+static uint32_t flashRowAddress;
+static bool flashRowBusy = false;
+static bool flashRowDeferNext = false;
+/* A row of the session failed in the background, see ClearFlashWriteError() */
+static bool flashRowFailed = false;
+
 static uint32_t IsMultipleOf(uint32_t value, uint32_t multiple);
 static void GetStartEndAddress(uint32_t appId, uint32_t *startAddress, uint32_t *endAddress);
+static cy_en_bootload_status_t WriteFlashRow(uint32_t address, const uint8_t *data);
 
 
 /*******************************************************************************
@@ -81,6 +95,140 @@ static void GetStartEndAddress(uint32_t appId, uint32_t *startAddress, uint32_t
 }
 
 
+/*******************************************************************************
+* Function Name: DeferNextFlashWrite
+****************************************************************************//**
+*
+* Lets the next internal flash row written by Cy_Bootload_WriteData() be 
+* programmed in the background. Cy_Bootload_WriteData() then returns as soon as
+* the row has been copied and programming has started, so the caller can fetch 
+* the next row meanwhile. Rows of the metadata are always programmed before 
+* Cy_Bootload_WriteData() returns, as the Bootloader SDK reads them directly.
+*
+* A background write that fails is reported by WaitForFlashWrite(), and by 
+* the next background write, which fails the command so the session ends.
+*
+*******************************************************************************/
+void DeferNextFlashWrite(void)
+{
+    flashRowDeferNext = true;
+}
+
+
+/*******************************************************************************
+* Function Name: ClearFlashWriteError
+****************************************************************************//**
+*
+* Finishes the row programmed in the background and forgets a failed background
+* write, so that a new session or a new copy of an application can start.
+*
+*******************************************************************************/
+void ClearFlashWriteError(void)
+{
+    (void) WaitForFlashWrite();
+    flashRowFailed = false;
+}
+
+
+/*******************************************************************************
+* Function Name: WaitForFlashWrite
+****************************************************************************//**
+*
+* Waits until the row programmed in the background is written and checks it.
+*
+* \return
+* - true if the rows programmed in the background are written.
+* - false if one of them has failed since ClearFlashWriteError() was called.
+*
+*******************************************************************************/
+bool WaitForFlashWrite(void)
+{
+    cy_en_flashdrv_status_t fstatus;
+    
+    if (flashRowBusy)
+    {
+        do
+        {
+            fstatus = Cy_Flash_IsOperationComplete();
+        } while (fstatus == CY_FLASH_DRV_OPCODE_BUSY);
+        
+        flashRowBusy = false;
+        Cy_SysLib_ClearFlashCacheAndBuffer();
+        
+        if ( (fstatus != CY_FLASH_DRV_SUCCESS) ||
+             (memcmp(flashRowBuffer, (const void *)flashRowAddress, CY_FLASH_SIZEOF_ROW) != 0) )
+        {
+            flashRowFailed = true;
+        }
+    }
+    return (!flashRowFailed);
+}
+
+
+/*******************************************************************************
+* Function Name: WriteFlashRow
+****************************************************************************//**
+*
+* This internal function writes a row of the internal flash. The row is 
+* programmed in the background if DeferNextFlashWrite() has been called before,
+* so the buffer with the data can be reused right away.
+*
+* \param address  The address of the row.
+* \param data     The data to write, CY_FLASH_SIZEOF_ROW bytes.
+*
+* \return CY_BOOTLOAD_SUCCESS if the row is written or its programming has
+*         started. CY_BOOTLOAD_ERROR_DATA if the write fails, or if this
+*         is a background write and a background write before it has failed.
+*
+*******************************************************************************/
+static cy_en_bootload_status_t WriteFlashRow(uint32_t address, const uint8_t *data)
+{
+    cy_en_flashdrv_status_t fstatus;
+    cy_en_bootload_status_t status = CY_BOOTLOAD_SUCCESS;
+    bool deferred = flashRowDeferNext;
+    
+    flashRowDeferNext = false;
+    
+    /* The buffer of the previous row is reused, so it must be written first */
+    if (!WaitForFlashWrite())
+    {
+        if (deferred)
+        {
+            /* The failed command ends the session, the host starts it again */
+            status = CY_BOOTLOAD_ERROR_DATA;
+        }
+        else
+        {
+            /* A write outside a Program Data command does not depend on it */
+            flashRowFailed = false;
+        }
+    }
+    
+    if ( ((uint32_t)&__cy_boot_metadata_addr <= address) && 
+         (((uint32_t)&__cy_boot_metadata_addr + (uint32_t)&__cy_boot_metadata_length) > address) )
+    {
+        deferred = false;
+    }
+    
+    if (status == CY_BOOTLOAD_SUCCESS)
+    {
+        if (deferred)
+        {
+            (void) memcpy(flashRowBuffer, data, CY_FLASH_SIZEOF_ROW);
+            fstatus = Cy_Flash_StartWrite(address, (const uint32_t *)flashRowBuffer);
+            flashRowAddress = address;
+            flashRowBusy = (fstatus == CY_FLASH_DRV_SUCCESS);
+        }
+        else
+        {
+            fstatus = Cy_Flash_WriteRow(address, (const uint32_t *)data);
+        }
+        status = (fstatus == CY_FLASH_DRV_SUCCESS) ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_DATA;
+    }
+    return (status);
+}
+
+
 /*******************************************************************************
 * Function Name: Cy_Bootload_WriteData
 ****************************************************************************//**
@@ -237,8 +385,7 @@ cy_en_bootload_status_t Cy_Bootload_WriteData (uint32_t address, uint32_t length
         {
             (void) memset(params->dataBuffer, 0, CY_FLASH_SIZEOF_ROW);
         }
-        cy_en_flashdrv_status_t fstatus =  Cy_Flash_WriteRow(address, (uint32_t*)params->dataBuffer);
-        status = (fstatus == CY_FLASH_DRV_SUCCESS) ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_DATA;
+        status = WriteFlashRow(address, params->dataBuffer);
     }
     return (status);
 }
@@ -308,11 +455,19 @@ cy_en_bootload_status_t Cy_Bootload_ReadData (uint32_t address, uint32_t length,
     {
         if ((ctl & CY_BOOTLOAD_IOCTL_COMPARE) == 0u)
         {
+            (void) WaitForFlashWrite();
             (void) memcpy(params->dataBuffer, (const void *)address, length);
             status = CY_BOOTLOAD_SUCCESS;
         }
+        else if (flashRowBusy && (address == flashRowAddress) && (length == CY_FLASH_SIZEOF_ROW))
+        {
+            /* The row is still being programmed; WaitForFlashWrite() checks the flash */
+            status = ( memcmp(params->dataBuffer, flashRowBuffer, length) == 0 )
+                     ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_VERIFY;
+        }
         else
         {
+            (void) WaitForFlashWrite();
             status = ( memcmp(params->dataBuffer, (const void *)address, length) == 0 )
                      ? CY_BOOTLOAD_SUCCESS : CY_BOOTLOAD_ERROR_VERIFY;
         }
@@ -331,7 +486,30 @@ cy_en_bootload_status_t Cy_Bootload_ReadData (uint32_t address, uint32_t length,
 *******************************************************************************/
 cy_en_bootload_status_t Cy_Bootload_TransportRead (uint8_t *buffer, uint32_t size, uint32_t *count, uint32_t timeout)
 {
-    return (CyBLE_CyBtldrCommRead(buffer, size, count, timeout));
+    cy_en_bootload_status_t status = CyBLE_CyBtldrCommRead(buffer, size, count, timeout);
+    
+    /* 
+    * The row of a Program Data command is programmed while the next command is
+    * received. Any other command may read the flash, so the row is finished first.
+    */
+    if ( (status == CY_BOOTLOAD_SUCCESS) && (*count > PACKET_CMD_IDX) )
+    {
+        if (buffer[PACKET_CMD_IDX] == CMD_PROGRAM_DATA)
+        {
+            DeferNextFlashWrite();
+        }
+        else
+        {
+            (void) WaitForFlashWrite();
+            
+            /* A new session writes the application again from the start */
+            if (buffer[PACKET_CMD_IDX] == CMD_ENTER)
+            {
+                ClearFlashWriteError();
+            }
+        }
+    }
+    return (status);
 }
 
 /*******************************************************************************
@@ -344,6 +522,9 @@ cy_en_bootload_status_t Cy_Bootload_TransportRead (uint8_t *buffer, uint32_t siz
 *******************************************************************************/
 cy_en_bootload_status_t Cy_Bootload_TransportWrite(uint8_t *buffer, uint32_t size, uint32_t *count, uint32_t timeout)
 {
+    /* The command is done, a row it has not written is not written in the background */
+    flashRowDeferNext = false;
+    
     return (CyBLE_CyBtldrCommWrite(buffer, size, count, timeout));
 }
 
@@ -357,6 +538,8 @@ cy_en_bootload_status_t Cy_Bootload_TransportWrite(uint8_t *buffer, uint32_t siz
 *******************************************************************************/
 void Cy_Bootload_TransportReset(void)
 {
+    /* The session has ended, the next one writes the application again */
+    ClearFlashWriteError();
     CyBLE_CyBtldrCommReset();
 }
 
@@ -17,6 +17,7 @@
 #define BOOTLOAD_USER_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "flash/cy_flash.h"
     
 
@@ -168,6 +169,12 @@
 #endif /* !defined(CY_DOXYGEN) */
 
 
+/* Background flash writes, implemented in bootload_user.c */
+void DeferNextFlashWrite(void);
+bool WaitForFlashWrite(void);
+void ClearFlashWriteError(void);
+
+
 #endif /* !defined(BOOTLOAD_USER_H) */
 
 
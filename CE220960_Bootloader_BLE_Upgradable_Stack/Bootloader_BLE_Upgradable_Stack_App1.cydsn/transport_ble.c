@@ -37,6 +37,30 @@ static uint8_t  *cyBle_btsBuffPtr;
 static uint16_t cyBle_btsDataPacketSize = 0u;
 static uint8_t  cyBle_btsDataBuffer[CY_FLASH_SIZEOF_ROW + CYBLE_BTS_COMMAND_CONTROL_BYTES_NUM];
 
+/* Streaming mode: reassembly slot of one command */
+typedef struct
+{
+    uint8_t  data[CY_FLASH_SIZEOF_ROW + CYBLE_BTS_COMMAND_CONTROL_BYTES_NUM];
+    uint16_t length;        /* Command length, 0 until the length field has been received */
+    uint16_t received;      /* Number of bytes received */
+    uint8_t  seq;           /* Sequence number of the command in the slot */
+    bool     inUse;
+    bool     complete;
+} cy_stc_bts_stream_slot_t;
+
+/* Streaming mode: reassembly window, the slot of a command is its sequence 
+*  number modulo CYBLE_BTS_STREAM_WINDOW */
+static cy_stc_bts_stream_slot_t cyBle_streamSlot[CYBLE_BTS_STREAM_WINDOW];
+static uint8_t  cyBle_streamExpectedSeq = 0u;
+static uint8_t  cyBle_streamUnacked = 0u;
+static bool     cyBle_streamAckPending = false;
+static bool     cyBle_streamResponsePending = false;
+
+static void CyBLE_StreamReset(void);
+static void CyBLE_StreamReceive(const uint8_t fragment[], uint32_t length);
+static bool CyBLE_StreamRead(uint8_t pData[], uint32_t size, uint32_t *count);
+static void CyBLE_StreamSendAck(void);
+
 /* Connection Handle */
 cy_stc_ble_conn_handle_t appConnHandle;
 
@@ -56,6 +80,7 @@ void CyBLE_CyBtldrCommStart(void)
     (void)Cy_BLE_BTS_RegisterAttrCallback(&BootloaderCallBack);
 #endif /* defined(CY_PSOC_CREATOR_USED) */
     cyBle_btsDataPacketIndex  = 0u;
+    CyBLE_StreamReset();
 }
 
 
@@ -99,6 +124,7 @@ void CyBLE_CyBtldrCommStop(void)
 void CyBLE_CyBtldrCommReset(void)
 {
     cyBle_btsDataPacketIndex  = 0u;
+    CyBLE_StreamReset();
 }
 
 /*******************************************************************************
@@ -110,6 +136,10 @@ void CyBLE_CyBtldrCommReset(void)
 * CyBle_GattsNotification() API to sent the data. If a notification is
 * accepted, the function returns CYRET_SUCCESS. The timeOut parameter is ignored
 * in this case.
+*
+* A successful response without data to a streamed command is not sent. It is
+* covered by the next acknowledgement, which is sent every 
+* CYBLE_BTS_STREAM_ACK_INTERVAL commands and ahead of any other response.
 * 
 * \param data  The pointer to the buffer containing data to be written.
 * \param size  The number of bytes from the data buffer to write.
@@ -132,6 +162,27 @@ cy_en_bootload_status_t CyBLE_CyBtldrCommWrite(const uint8_t pData[], uint32_t s
         /* empty */
     }
     
+    if(cyBle_streamResponsePending)
+    {
+        cyBle_streamResponsePending = false;
+        
+        if((size > (CYBLE_BTS_COMMAND_DATA_LEN_OFFSET + 1u)) &&
+           (pData[CYBLE_BTS_RESPONSE_STATUS_OFFSET] == (uint8_t)CY_BOOTLOAD_SUCCESS) &&
+           (pData[CYBLE_BTS_COMMAND_DATA_LEN_OFFSET] == 0u) &&
+           (pData[CYBLE_BTS_COMMAND_DATA_LEN_OFFSET + 1u] == 0u))
+        {
+            if(cyBle_streamUnacked >= CYBLE_BTS_STREAM_ACK_INTERVAL)
+            {
+                CyBLE_StreamSendAck();
+            }
+            *count = size;
+            return (CY_BOOTLOAD_SUCCESS);
+        }
+        
+        /* Tell the host which commands the response follows */
+        CyBLE_StreamSendAck();
+    }
+    
     if(Cy_BLE_BTSS_SendNotification(appConnHandle, CY_BLE_BTS_BT_SERVICE, size, (const uint8 *)pData) == CY_BLE_SUCCESS)
     {   
         *count = size;
@@ -187,6 +238,18 @@ cy_en_bootload_status_t CyBLE_CyBtldrCommRead(uint8_t pData[], uint32_t size, ui
             /* Process BLE events */
             Cy_BLE_ProcessEvents();
             
+            /* Acknowledge streamed commands if the host needs to resend one */
+            if(cyBle_streamAckPending)
+            {
+                CyBLE_StreamSendAck();
+            }
+            
+            if(CyBLE_StreamRead(pData, size, count))
+            {
+                status = CY_BOOTLOAD_SUCCESS;
+                break;
+            }
+            
             if(cyBle_cmdReceivedFlag == 1u)
             {
                 /* Clear command receive flag */
@@ -214,6 +277,12 @@ cy_en_bootload_status_t CyBLE_CyBtldrCommRead(uint8_t pData[], uint32_t size, ui
             --timeout;
         }
         
+        /* The host has stopped sending; acknowledge the last commands */
+        if((status == CY_BOOTLOAD_ERROR_TIMEOUT) && (cyBle_streamUnacked != 0u))
+        {
+            CyBLE_StreamSendAck();
+        }
+        
         /* Process BLE events */
         Cy_BLE_ProcessEvents();
     }
@@ -280,6 +349,15 @@ void BootloaderCallBack(uint32 event, void* eventParam)
     {
         uint8 *localDataBuffer = ((cy_stc_ble_bts_char_value_t *)eventParam)->value->val;
     
+        /* A streamed fragment, which never continues a packet */
+        if((cyBle_btsDataPacketIndex == 0u) && 
+           (localDataBuffer[0u] == CYBLE_BTS_STREAM_MARKER))
+        {
+            CyBLE_StreamReceive(localDataBuffer, 
+                                ((cy_stc_ble_bts_char_value_t *)eventParam)->value->len);
+            break;
+        }
+    
         /* This is the beginning of the packet, let's read the size now */
         if(cyBle_btsDataPacketIndex == 0u)
         {
@@ -323,6 +401,221 @@ void BootloaderCallBack(uint32 event, void* eventParam)
     }
 }
 
+
+/*******************************************************************************
+* Function Name: CyBLE_StreamReset
+****************************************************************************//**
+* 
+* Empties the streaming mode reassembly window. The next streamed command is 
+* expected with sequence number 0.
+* 
+*******************************************************************************/
+static void CyBLE_StreamReset(void)
+{
+    uint32_t i;
+    
+    for(i = 0u; i < CYBLE_BTS_STREAM_WINDOW; i++)
+    {
+        cyBle_streamSlot[i].inUse = false;
+        cyBle_streamSlot[i].complete = false;
+    }
+    cyBle_streamExpectedSeq     = 0u;
+    cyBle_streamUnacked         = 0u;
+    cyBle_streamAckPending      = false;
+    cyBle_streamResponsePending = false;
+}
+
+
+/*******************************************************************************
+* Function Name: CyBLE_StreamReceive
+****************************************************************************//**
+* 
+* Stores a streamed fragment in the slot of its command. A fragment that 
+* cannot be stored makes the next acknowledgement go out right away, so the 
+* host resends the commands that are missing.
+*
+* The link delivers the fragments in the order they were written, so a
+* fragment that does not continue its command, or a command that starts 
+* while the one before it is incomplete, means that data was lost.
+* 
+* \param fragment The fragment, starting with the streaming header.
+* \param length   The length of the fragment in bytes.
+* 
+*******************************************************************************/
+static void CyBLE_StreamReceive(const uint8_t fragment[], uint32_t length)
+{
+    cy_stc_bts_stream_slot_t *slot;
+    cy_stc_bts_stream_slot_t *previousSlot;
+    uint8_t  seq;
+    uint32_t offset;
+    uint32_t dataLength;
+    
+    if(length <= CYBLE_BTS_STREAM_HEADER_SIZE)
+    {
+        return;
+    }
+    
+    seq        = fragment[1u];
+    offset     = ((uint32_t)fragment[3u] << 8u) | (uint32_t)fragment[2u];
+    dataLength = length - CYBLE_BTS_STREAM_HEADER_SIZE;
+    
+    /* A command outside the window was already processed, or the host sent
+    *  too far ahead; in both cases the host needs the current state */
+    if((uint8_t)(seq - cyBle_streamExpectedSeq) >= CYBLE_BTS_STREAM_WINDOW)
+    {
+        cyBle_streamAckPending = true;
+        return;
+    }
+    
+    slot = &cyBle_streamSlot[seq % CYBLE_BTS_STREAM_WINDOW];
+    
+    if(offset == 0u)
+    {
+        /* A command that follows an incomplete one: that one was lost */
+        previousSlot = &cyBle_streamSlot[(uint8_t)(seq - 1u) % CYBLE_BTS_STREAM_WINDOW];
+        if((seq != cyBle_streamExpectedSeq) && 
+           !(previousSlot->inUse && previousSlot->complete && 
+             (previousSlot->seq == (uint8_t)(seq - 1u))))
+        {
+            cyBle_streamAckPending = true;
+        }
+        
+        /* The host resends whole commands, so a resent command starts over */
+        if(!(slot->inUse && slot->complete && (slot->seq == seq)))
+        {
+            slot->inUse    = true;
+            slot->complete = false;
+            slot->seq      = seq;
+            slot->length   = 0u;
+            slot->received = 0u;
+        }
+    }
+    
+    if(!slot->inUse || (slot->seq != seq) || slot->complete)
+    {
+        /* Fragment of a command whose start was lost, or of a command that is
+        *  already complete */
+        cyBle_streamAckPending = cyBle_streamAckPending || !slot->complete;
+        return;
+    }
+    
+    if((offset != slot->received) || ((offset + dataLength) > sizeof(slot->data)))
+    {
+        /* A fragment of the command was lost; drop the command */
+        slot->inUse = false;
+        cyBle_streamAckPending = true;
+        return;
+    }
+    
+    (void) memcpy(&slot->data[offset], &fragment[CYBLE_BTS_STREAM_HEADER_SIZE], dataLength);
+    slot->received += (uint16_t)dataLength;
+    
+    /* Read the command length from the packet */
+    if((slot->length == 0u) && (slot->received > (CYBLE_BTS_COMMAND_DATA_LEN_OFFSET + 1u)))
+    {
+        slot->length = (((uint16)(((uint16) slot->data[CYBLE_BTS_COMMAND_DATA_LEN_OFFSET + 1u]) << 8u)) | 
+                         (uint16) slot->data[CYBLE_BTS_COMMAND_DATA_LEN_OFFSET]) +
+                         CYBLE_BTS_COMMAND_CONTROL_BYTES_NUM;
+    }
+    
+    if((slot->length != 0u) && (slot->received >= slot->length))
+    {
+        slot->complete = (slot->received == slot->length);
+        if(!slot->complete)
+        {
+            slot->inUse = false;
+            cyBle_streamAckPending = true;
+        }
+    }
+}
+
+
+/*******************************************************************************
+* Function Name: CyBLE_StreamRead
+****************************************************************************//**
+* 
+* Returns the next streamed command, if it is complete, and moves the window 
+* on by one command.
+* 
+* \param pData The pointer to the buffer to store the command.
+* \param size  The size of the buffer in bytes.
+* \param count The pointer to where the command length is written.
+*
+* \return
+* True if a command has been returned.
+* 
+*******************************************************************************/
+static bool CyBLE_StreamRead(uint8_t pData[], uint32_t size, uint32_t *count)
+{
+    cy_stc_bts_stream_slot_t *slot = 
+        &cyBle_streamSlot[cyBle_streamExpectedSeq % CYBLE_BTS_STREAM_WINDOW];
+    bool commandRead = false;
+    
+    if(slot->inUse && slot->complete && (slot->seq == cyBle_streamExpectedSeq))
+    {
+        if(slot->length < size)
+        {
+            (void) memcpy((void *) pData, (const void *) slot->data, (uint32_t)slot->length);
+            *count = slot->length;
+            
+            slot->inUse = false;
+            cyBle_streamExpectedSeq++;
+            cyBle_streamUnacked++;
+            cyBle_streamResponsePending = true;
+            commandRead = true;
+        }
+        else
+        {
+            /* The command does not fit; it is resent after the acknowledgement */
+            slot->inUse = false;
+            cyBle_streamAckPending = true;
+        }
+    }
+    
+    return (commandRead);
+}
+
+
+/*******************************************************************************
+* Function Name: CyBLE_StreamSendAck
+****************************************************************************//**
+* 
+* Sends the streaming mode acknowledgement. It carries the sequence number of 
+* the next command expected and a bit map of the commands from it on that 
+* are complete, bit 0 for the expected command. An acknowledgement that the 
+* stack cannot take yet is sent on the next call of CyBLE_CyBtldrCommRead().
+* 
+*******************************************************************************/
+static void CyBLE_StreamSendAck(void)
+{
+    uint8_t  ack[CYBLE_BTS_STREAM_ACK_SIZE] = {CYBLE_BTS_STREAM_MARKER, 0u, 0u, 0u};
+    uint8_t  seq;
+    uint32_t i;
+    
+    ack[1u] = cyBle_streamExpectedSeq;
+    for(i = 0u; i < CYBLE_BTS_STREAM_WINDOW; i++)
+    {
+        seq = (uint8_t)(cyBle_streamExpectedSeq + i);
+        if(cyBle_streamSlot[seq % CYBLE_BTS_STREAM_WINDOW].inUse &&
+           cyBle_streamSlot[seq % CYBLE_BTS_STREAM_WINDOW].complete &&
+           (cyBle_streamSlot[seq % CYBLE_BTS_STREAM_WINDOW].seq == seq))
+        {
+            ack[2u] |= (uint8_t)(1u << i);
+        }
+    }
+    
+    if(Cy_BLE_BTSS_SendNotification(appConnHandle, CY_BLE_BTS_BT_SERVICE, 
+                                    CYBLE_BTS_STREAM_ACK_SIZE, ack) == CY_BLE_SUCCESS)
+    {
+        cyBle_streamUnacked    = 0u;
+        cyBle_streamAckPending = false;
+    }
+    else
+    {
+        cyBle_streamAckPending = true;
+    }
+}
+
 #endif /* CY_BLE_HOST_CORE */
 
 /* [] END OF FILE */
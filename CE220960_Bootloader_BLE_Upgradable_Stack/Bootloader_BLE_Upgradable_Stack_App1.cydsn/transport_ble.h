@@ -41,6 +41,25 @@ extern void AppCallBack(uint32 event, void* eventParam);
 #define CYBLE_BTS_COMMAND_DATA_LEN_OFFSET                 (2u)
 #define CYBLE_BTS_COMMAND_CONTROL_BYTES_NUM               (7u)
 #define CYBLE_BTS_COMMAND_MAX_LENGTH                      (265u)
+#define CYBLE_BTS_RESPONSE_STATUS_OFFSET                  (1u)
+
+/* Streaming mode. The host writes the commands with Write Without Response
+*  fragments, each starting with a header:
+*  [CYBLE_BTS_STREAM_MARKER] [sequence number] [offset in the command, 2 bytes LE]
+*  A successful response without data is not sent; instead an acknowledgement
+*  notification [CYBLE_BTS_STREAM_MARKER] [next expected sequence number]
+*  [bit map of the received commands from the expected one on] [0] is sent
+*  every CYBLE_BTS_STREAM_ACK_INTERVAL commands, before any other response,
+*  when a command is missing, and when the host stops sending.
+*  Every command of the window has its own reassembly slot of one flash row
+*  plus the control bytes, so the window of 8 takes about 4.1 KB of RAM 
+*  (8 x 528 bytes) on top of the regular command buffer.
+*/
+#define CYBLE_BTS_STREAM_MARKER                           (0xA5u)
+#define CYBLE_BTS_STREAM_HEADER_SIZE                      (4u)
+#define CYBLE_BTS_STREAM_ACK_SIZE                         (4u)
+#define CYBLE_BTS_STREAM_WINDOW                           (8u)
+#define CYBLE_BTS_STREAM_ACK_INTERVAL                     (4u)
 
 
 /***************************************
@@ -6,7 +6,10 @@
 * Description: This is the source code for BLE GATT Client. The client receives
 *              the notification data sent by the GATT server. The BLE throughput 
 *              is calculated every 10 seconds and displayed on a UART terminal
-*              emulator.
+*              emulator. The client can connect to up to four GATT servers at
+*              once and report per-link and aggregate throughput. It can also
+*              stream Write Without Response data to the server, alone or 
+*              together with the notifications.
 *
 * Related Document: CE222046_Throughput_Measurement.pdf
 *
@@ -46,7 +49,14 @@
 
 #include <project.h>
 #include "stdio_user.h"
+#include "throughput_stats.h"
+#include "latency_stats.h"
+#include "integrity_stats.h"
+#include "timebase.h"
+#include "payload.h"
+#include "sweep.h"
 #include <stdio.h>
+#include <string.h>
 
 #if CY_BLE_HOST_CORE
 
@@ -72,10 +82,77 @@
     
 #define GATT_MTU                    (MAX_MTU_SIZE)
               
+/* Direction of the data transfer. Must match TRAFFIC_MODE of the GATT Out
+   project.
+   TRAFFIC_MODE_DOWNLINK : the server sends notifications to the client
+   TRAFFIC_MODE_UPLINK   : the client sends Write Without Response commands 
+                           to the server
+   TRAFFIC_MODE_DUPLEX   : both at the same time */
+#define TRAFFIC_MODE_DOWNLINK       (0u)
+#define TRAFFIC_MODE_UPLINK         (1u)
+#define TRAFFIC_MODE_DUPLEX         (2u)
+#define TRAFFIC_MODE                TRAFFIC_MODE_DOWNLINK
 
+/* Maximum number of Write Without Response commands queued to the stack per
+   link by one pass of the main loop */
+#define UPLINK_MAX_IN_FLIGHT        (8u)
+
+/* Size of the ATT header of a Write Without Response command */
+#define ATT_WRITE_CMD_HEADER_SIZE   (3u)
+
+/* Number of GATT Out peripherals the client connects to at the same time.
+   Set to 1 for the single link measurement. Must not exceed the maximum number
+   of connections configured in the BLE component. */
+#define PEER_COUNT                  (1u)
+
+/* Period of the Timer component, in seconds */
+#define TIMER_PERIOD_SEC            (10u)
+
+/* Number of timer periods in one throughput report window */
+#define REPORT_WINDOW_PERIODS       (1u)
+
+/* Set to ENABLE to measure the latency of every notification from the 
+   timestamp in its payload, and to send one binary latency record per link 
+   after each throughput report (see latency_stats.h for the format) */
+#define LATENCY_REPORT_ENABLE       DISABLE
+
+/* Set to ENABLE to check the sequence number and CRC-32 of every notification
+   and to report the goodput and the lost, duplicated and corrupted packets of
+   every link after each throughput report. Must match INTEGRITY_CHECK_ENABLE
+   of the GATT Out project. */
+#define INTEGRITY_CHECK_ENABLE      DISABLE
+
+/* Set to ENABLE to run the link parameter sweep instead of the continuous
+   measurement. The sweep walks the MTU/PHY/data length/connection interval
+   matrix in sweep.c and prints one "SWEEP," CSV row per cell. */
+#define SWEEP_ENABLE                DISABLE
+
+/* Connection parameters requested during the sweep */
+#define SWEEP_CONN_LATENCY          (0u)
+#define SWEEP_SUPERVISION_TO        (400u)     /* 4 s, in 10 ms units */
+#define SWEEP_MAX_TX_TIME           (17040u)   /* enough for 251 octets on Coded PHY */
+
+#if (SWEEP_ENABLE == ENABLE) && (PEER_COUNT != 1u)
+#error "The link parameter sweep runs on a single link"
+#endif
+
+#if (SWEEP_ENABLE == ENABLE) && (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+#error "The link parameter sweep measures the notification throughput only"
+#endif
+
+#if (PEER_COUNT > THROUGHPUT_MAX_LINKS) || (PEER_COUNT > CY_BLE_CONN_COUNT)
+#error "PEER_COUNT exceeds the number of supported connections"
+#endif
     
-/* The configurable GAP parameters */
-#define TARGET_BDADDR   {{0xFF, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0}
+/* The configurable GAP parameters. Entry n is the address of the GATT Out
+   peripheral built with DEVICE_INDEX n. */
+#define TARGET_BDADDR_LIST                                  \
+{                                                           \
+    {{0xFF, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0},              \
+    {{0xFE, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0},              \
+    {{0xFD, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0},              \
+    {{0xFC, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0},              \
+}
     
 /* The configurable GATT parameters */
 #define GATT_CCD_HANDLE             (28u) 
@@ -87,13 +164,15 @@
 *******************************************************************************/
 cy_en_ble_api_result_t              apiResult = CY_BLE_SUCCESS;
 cy_stc_ble_gap_bd_addr_t            local_addr;
-cy_stc_ble_gap_bd_addr_t            remote_addr = TARGET_BDADDR;
+cy_stc_ble_gap_bd_addr_t            remote_addr[THROUGHPUT_MAX_LINKS] = TARGET_BDADDR_LIST;
 
 /* GAP Related Information */
-bool    isConnected = false;
-uint8   bdHandle;
+bool    isConnected[PEER_COUNT];
 bool    targetAddrFound = false;
 
+/* Index of the peer found in the last scan, connection pending */
+uint8   targetPeer = THROUGHPUT_INVALID_LINK;
+
 /* GATT Related Information */
 /* Char handle for which notification will be received. */
 const uint16  char_handle = GATT_CHAR_HANDLE; 
@@ -104,23 +183,44 @@ const uint16  desc_handle = GATT_CCD_HANDLE;
 /* CCD value to enable notification*/
 uint8   desc_val[CY_BLE_CCCD_LEN] = {0x01, 0x00}; 
 
-cy_stc_ble_conn_handle_t     conn_handle;
+/* Connection handle of every peer */
+cy_stc_ble_conn_handle_t     conn_handle[PEER_COUNT];
+
+/* Negotiated MTU of every peer */
+uint16  peerMtu[PEER_COUNT];
+
+/* Set when the client may stream Write Without Response data to the peer */
+bool    uplinkEnabled[PEER_COUNT];
+
+/* Dummy data written to the server */
+uint8   uplinkBuffer[MAX_MTU_SIZE - ATT_WRITE_CMD_HEADER_SIZE];
+
+/* BD handle of the last PHY update request */
+uint8   phyBdHandle;
 
-/* Number of notification received */
-uint32 notify_count; 
+/* Set while the link parameter sweep needs a connection */
+bool    sweepActive = false;
 
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
 void Ble_Init(void);
 void StartScan(void);
-void InitiateConnection(void);
-void EnableNotification(void);
+void InitiateConnection(uint8 peer);
+void EnableNotification(cy_stc_ble_conn_handle_t connHandle);
 void StackEventHandler(uint32 event, void* eventParam);
 void BleAssert(void);
 void Disconnect(cy_stc_ble_conn_handle_t connHandle);
 void MyTimerIsr(void);
-void StartScan(void);
+uint8 FindPeerByAddr(const uint8 *bdAddr);
+uint8 FindPeerByBdHandle(uint8 bdHandle);
+uint8 GetConnectedPeerCount(void);
+void PrintThroughputReport(const throughput_report_t *report);
+void SendLatencyRecords(const throughput_report_t *report);
+void PrintIntegrityReport(const throughput_report_t *report);
+void RunSweep(sweep_event_t event);
+bool StartSweepAction(sweep_action_t action);
+void SendUplinkData(void);
 
 /*******************************************************************************
 * Function Name: HostMain()
@@ -136,11 +236,15 @@ void StartScan(void);
 *
 * Theory:
 *  The function starts BLE and UART components.
-*  This function processes all BLE events
+*  This function processes all BLE events and prints the throughput report
+*  latched by the timer ISR.
 *
 *******************************************************************************/
 int HostMain(void)
 {
+    throughput_report_t report;
+    uint8 peer;
+    
     __enable_irq(); /* Enable global interrupts. */
        
 	UART_Start();
@@ -150,6 +254,26 @@ int HostMain(void)
     printf("*****************CE222046: PSoC 6 MCU BLE Throughput Measurement *******"\
                "**********\r\n");
     printf("Role : Client (GATT IN)\r\n");
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        isConnected[peer] = false;
+        uplinkEnabled[peer] = false;
+        peerMtu[peer] = DEFAULT_MTU_SIZE;
+        conn_handle[peer].bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+        conn_handle[peer].attId    = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+    }
+    Throughput_Init(TIMER_PERIOD_SEC, REPORT_WINDOW_PERIODS);
+    LatencyStats_Init();
+    Sweep_Init();
+    Timebase_Start();
+    Integrity_Init();
+    
+    for(uint16 i = 0u; i < sizeof(uplinkBuffer); i++)
+    {
+        uplinkBuffer[i] = (uint8)i;
+    }
+    
     /* Configure the Timer to generate an interrupt every 10 seconds */
     Timer_Start();
     Cy_SysInt_Init(&TimerInterrupt_cfg, MyTimerIsr);
@@ -163,6 +287,32 @@ int HostMain(void)
     {   
         /* Cy_BLE_ProcessEvents() allows BLE stack to process pending events */
         Cy_BLE_ProcessEvents();
+        
+        /* Keep the timebase running between notifications */
+        (void)Timebase_GetUs();
+        
+    #if (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+        /* Top up the stack buffers with data for the GATT Servers */
+        SendUplinkData();
+    #endif
+        
+    #if (SWEEP_ENABLE == ENABLE)
+        /* Let the sweep time its updates and transfers */
+        RunSweep(SWEEP_EVT_TICK);
+        (void)report;
+    #else
+        /* Print the report latched by the timer ISR, if any */
+        if(Throughput_GetReport(&report))
+        {
+            PrintThroughputReport(&report);
+        #if (LATENCY_REPORT_ENABLE == ENABLE)
+            SendLatencyRecords(&report);
+        #endif
+        #if (INTEGRITY_CHECK_ENABLE == ENABLE)
+            PrintIntegrityReport(&report);
+        #endif
+        }
+    #endif
 	}   
 }  
 
@@ -233,7 +383,7 @@ void StackEventHandler(uint32 event, void *eventParam)
 {
     cy_en_ble_api_result_t      apiResult;
 
-    uint8 bdAddrIndex;
+    uint8 peer;
     
     cy_stc_ble_gapc_adv_report_param_t * advReport;
     
@@ -253,9 +403,14 @@ void StackEventHandler(uint32 event, void *eventParam)
             
             /* Stack initialized; ready for scan */
             
+        #if (SWEEP_ENABLE == ENABLE)
+            /* The sweep starts the scan for its first cell */
+            RunSweep(SWEEP_EVT_START);
+        #else
             /* Start scanning for the target device.
              * Triggers events: CY_BLE_EVT_GAPC_SCAN_START_STOP */
             StartScan();
+        #endif
             
             break;
         }
@@ -331,22 +486,16 @@ void StackEventHandler(uint32 event, void *eventParam)
             advReport = (cy_stc_ble_gapc_adv_report_param_t *)eventParam;
             
             /* Process only for Advertisement packets, not on scan response packets */
-            if(advReport->eventType != CY_BLE_GAPC_SCAN_RSP)
+            if((advReport->eventType != CY_BLE_GAPC_SCAN_RSP) && (targetAddrFound == false))
             {
-                /* Set address 'found' status temporarily */
-                targetAddrFound = true;
+                /* Look for a target peer that is not connected yet */
+                peer = FindPeerByAddr(advReport->peerBdAddr);
                 
-                for(bdAddrIndex = 0; bdAddrIndex < CY_BLE_BD_ADDR_SIZE; bdAddrIndex++)
-                {
-                    /* Set targetAddrFound status to false if BD address bytes don't match */
-                    if (advReport->peerBdAddr[bdAddrIndex] != remote_addr.bdAddr[bdAddrIndex]) 
-                    {
-                        targetAddrFound = false;
-                    }
-                }
-
-                if (targetAddrFound)
+                if((peer != THROUGHPUT_INVALID_LINK) && (isConnected[peer] == false))
                 {
+                    targetAddrFound = true;
+                    targetPeer = peer;
+                    
                     printf("Found target device with address: ");
                     printf("%02X:%02X:%02X:%02X:%02X:%02X\r\n\n",advReport->peerBdAddr[5],\
                     advReport->peerBdAddr[4], advReport->peerBdAddr[3], advReport->peerBdAddr[2],\
@@ -388,9 +537,10 @@ void StackEventHandler(uint32 event, void *eventParam)
                     /* Scan stopped manually; do not restart scan */
                     targetAddrFound = false;
                     printf("Scan stopped as device was found. Initiating Connection...\r\n\n");
-                    InitiateConnection();
+                    InitiateConnection(targetPeer);
                 }
-                else
+                else if((GetConnectedPeerCount() < PEER_COUNT) && 
+                        ((SWEEP_ENABLE == DISABLE) || sweepActive))
                 {
                     /* Scanning timed out; Restart scan */
                     printf("Timed Out. Restarting scan...\r\n\n");
@@ -405,9 +555,15 @@ void StackEventHandler(uint32 event, void *eventParam)
         {
             DEBUG_BLE("CY_BLE_EVT_DATA_LENGTH_CHANGE\r\n");
             
+        #if (SWEEP_ENABLE == ENABLE)
+            /* The sweep selects the PHY itself */
+            break;
+        #endif
+            
             cy_stc_ble_set_phy_info_t phyParam;
 
-            phyParam.bdHandle = conn_handle.bdHandle;
+            phyParam.bdHandle = ((cy_stc_ble_data_length_change_info_t *)eventParam)->bdHandle;
+            phyBdHandle = phyParam.bdHandle;
             phyParam.allPhyMask = CY_BLE_PHY_NO_PREF_MASK_NONE;
             phyParam.phyOption = 0;
             phyParam.rxPhyMask = CY_BLE_PHY_MASK_LE_2M;
@@ -436,12 +592,15 @@ void StackEventHandler(uint32 event, void *eventParam)
             if(param->status ==SUCCESS)
             {
                 DEBUG_BLE("SET PHY updated to 2 Mbps\r\n");
-                Cy_BLE_GetPhy(conn_handle.bdHandle);
+                Cy_BLE_GetPhy(phyBdHandle);
             }
             else
             {
                 DEBUG_BLE("SET PHY Could not update to 2 Mbps\r\n");
-                Cy_BLE_GetPhy(conn_handle.bdHandle);
+                Cy_BLE_GetPhy(phyBdHandle);
+            #if (SWEEP_ENABLE == ENABLE)
+                RunSweep(SWEEP_EVT_API_ERROR);
+            #endif
             }
             
             break;
@@ -478,8 +637,34 @@ void StackEventHandler(uint32 event, void *eventParam)
                 DEBUG_BLE("RxPhy Mask : 0x%02X\r\nTxPhy Mask : 0x%02X\r\n", phyparam->rxPhyMask, phyparam->txPhyMask);            
             }
             #endif
+            
+        #if (SWEEP_ENABLE == ENABLE)
+            RunSweep((((cy_stc_ble_events_param_generic_t *)eventParam)->status == SUCCESS) ? 
+                     SWEEP_EVT_PHY_DONE : SWEEP_EVT_API_ERROR);
+        #endif
+            break;
+        }
+        
+    #if (SWEEP_ENABLE == ENABLE)
+        /* This event indicates completion of the Cy_BLE_SetDataLength API */
+        case CY_BLE_EVT_SET_DATA_LENGTH_COMPLETE:
+        {
+            DEBUG_BLE("CY_BLE_EVT_SET_DATA_LENGTH_COMPLETE\r\n");
+            RunSweep((((cy_stc_ble_events_param_generic_t *)eventParam)->status == SUCCESS) ? 
+                     SWEEP_EVT_DATA_LENGTH_DONE : SWEEP_EVT_API_ERROR);
+            break;
+        }
+        
+        /* This event indicates that the connection parameters have been 
+           updated by the controller */
+        case CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE:
+        {
+            DEBUG_BLE("CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE\r\n");
+            RunSweep((((cy_stc_ble_gap_conn_param_updated_in_controller_t *)eventParam)->status 
+                     == SUCCESS) ? SWEEP_EVT_CONN_PARAM_DONE : SWEEP_EVT_API_ERROR);
             break;
         }
+    #endif
         
         /**********************************************************
         *                       GATT Events
@@ -490,39 +675,78 @@ void StackEventHandler(uint32 event, void *eventParam)
         case CY_BLE_EVT_GATT_CONNECT_IND:
         {
             /* Connected as Central (master role) */  
-            conn_handle = *(cy_stc_ble_conn_handle_t *)eventParam;
+            cy_stc_ble_conn_handle_t connHandle = *(cy_stc_ble_conn_handle_t *)eventParam;
             
             DEBUG_BLE("CY_BLE_EVT_GATT_CONNECT_IND: attId=%X, bdHandle=%X \r\n", 
-                        conn_handle.attId, 
-                        conn_handle.bdHandle);
-            printf("Connected to Device\r\n\n");
+                        connHandle.attId, 
+                        connHandle.bdHandle);
+            
+            peer = targetPeer;
+            targetPeer = THROUGHPUT_INVALID_LINK;
+            if(peer == THROUGHPUT_INVALID_LINK)
+            {
+                DEBUG_BLE("Connection to unknown peer\r\n");
+                break;
+            }
+            
+            conn_handle[peer] = connHandle;
+            isConnected[peer] = true;
+            Throughput_LinkOpen(peer);
+            LatencyStats_LinkReset(peer);
+            Integrity_LinkReset(peer);
+            printf("Connected to Device %u\r\n\n", (unsigned int)peer);
             
-            PWM_Disable();
             Cy_GPIO_Write(LED_ConnectStatus_0_PORT, LED_ConnectStatus_0_NUM, 0); 
                   
             /* Initiate an MTU exchange request */
-            cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {conn_handle, 512};
+        #if (SWEEP_ENABLE == ENABLE)
+            cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {connHandle, Sweep_GetCell()->mtu};
+        #else
+            cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {connHandle, GATT_MTU};
+        #endif
             apiResult = Cy_BLE_GATTC_ExchangeMtuReq(&mtuParam);
             
             if(apiResult != CY_BLE_SUCCESS)
             {
                 DEBUG_BLE("Cy_BLE_GATTC_ExchangeMtuReq API Error: %xd \r\n", apiResult);
             }
+            
+            /* Keep scanning until all the peers are connected */
+            if(GetConnectedPeerCount() < PEER_COUNT)
+            {
+                StartScan();
+            }
+            else
+            {
+                PWM_Disable();
+            }
                 
             break;
         }
         /* This event indicates GATT MTU Exchange response from the server device. */
         case CY_BLE_EVT_GATTC_XCHNG_MTU_RSP:
         {
-            /* To remove unused parameter warning when UART debug is disabled */
-            #if (DEBUG_BLE == ENABLE)
             cy_stc_ble_gatt_xchg_mtu_param_t *resp = (cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam;
             DEBUG_BLE("CY_BLE_EVT_GATTC_XCHNG_MTU_RSP [bdHandle 0x%02X MTU %hu]\r\n", 
                    resp->connHandle.bdHandle, resp->mtu);
-            #endif
             
+            peer = FindPeerByBdHandle(resp->connHandle.bdHandle);
+            if(peer != THROUGHPUT_INVALID_LINK)
+            {
+                peerMtu[peer] = (resp->mtu < GATT_MTU) ? resp->mtu : GATT_MTU;
+            }
+            
+        #if (TRAFFIC_MODE == TRAFFIC_MODE_UPLINK)
+            /* Notifications are not used; start writing to the Server */
+            if(peer != THROUGHPUT_INVALID_LINK)
+            {
+                uplinkEnabled[peer] = true;
+                printf("Uplink started to Device %u\r\n\n", (unsigned int)peer);
+            }
+        #else
             /* Enable notifications on the characteristic to get data from the Server. */
-            EnableNotification();
+            EnableNotification(resp->connHandle);
+        #endif
 
             break;
         }
@@ -532,14 +756,30 @@ void StackEventHandler(uint32 event, void *eventParam)
         case CY_BLE_EVT_GATT_DISCONNECT_IND:
         {
             DEBUG_BLE("CY_BLE_EVT_GATT_DISCONNECT_IND \r\n");
-            if(conn_handle.bdHandle == (*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle)
+            peer = FindPeerByBdHandle((*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle);
+            if(peer != THROUGHPUT_INVALID_LINK)
             {
-                printf("Disconnected.\r\n\n");
-                conn_handle.bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;
-                conn_handle.attId    = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+                printf("Disconnected from Device %u.\r\n\n", (unsigned int)peer);
+                Throughput_LinkClose(peer);
+                isConnected[peer] = false;
+                uplinkEnabled[peer] = false;
+                peerMtu[peer] = DEFAULT_MTU_SIZE;
+                conn_handle[peer].bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;
+                conn_handle[peer].attId    = CY_BLE_INVALID_CONN_HANDLE_VALUE;
             }
-            Cy_GPIO_Write(LED_ConnectStatus_0_PORT, LED_ConnectStatus_0_NUM, 1); 
-            StartScan();
+            if(GetConnectedPeerCount() == 0u)
+            {
+                Cy_GPIO_Write(LED_ConnectStatus_0_PORT, LED_ConnectStatus_0_NUM, 1); 
+            }
+        #if (SWEEP_ENABLE == ENABLE)
+            /* The sweep decides whether to reconnect */
+            RunSweep(SWEEP_EVT_DISCONNECTED);
+        #else
+            if(Cy_BLE_GetScanState() == CY_BLE_SCAN_STATE_STOPPED)
+            {
+                StartScan();
+            }
+        #endif
             break;
         }
          
@@ -559,6 +799,18 @@ void StackEventHandler(uint32 event, void *eventParam)
             DEBUG_BLE("CY_BLE_EVT_GATTC_WRITE_RSP, bdHandle = %X\r\n",\
                      (*(cy_stc_ble_conn_handle_t *) eventParam).bdHandle);
             DEBUG_BLE("Notifications are enabled\r\n");
+        #if (TRAFFIC_MODE == TRAFFIC_MODE_DUPLEX)
+            /* Start writing to the Server alongside the notifications */
+            peer = FindPeerByBdHandle((*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle);
+            if(peer != THROUGHPUT_INVALID_LINK)
+            {
+                uplinkEnabled[peer] = true;
+                printf("Uplink started to Device %u\r\n\n", (unsigned int)peer);
+            }
+        #endif
+        #if (SWEEP_ENABLE == ENABLE)
+            RunSweep(SWEEP_EVT_LINK_READY);
+        #endif
             break;
         }
         /* This event is triggered when notification data is received from the 
@@ -567,7 +819,28 @@ void StackEventHandler(uint32 event, void *eventParam)
         {
             cy_stc_ble_gattc_handle_value_ntf_param_t *param \
              = (cy_stc_ble_gattc_handle_value_ntf_param_t *)eventParam;
-            notify_count += param->handleValPair.value.len;
+            peer = FindPeerByBdHandle(param->connHandle.bdHandle);
+            Throughput_AddBytes(peer, param->handleValPair.value.len);
+            
+        #if (LATENCY_REPORT_ENABLE == ENABLE)
+            /* The payload header carries the sequence number and the time
+               the server queued the notification */
+            if((param->handleValPair.attrHandle == char_handle) &&
+               (param->handleValPair.value.len >= PAYLOAD_HEADER_SIZE))
+            {
+                LatencyStats_AddSample(peer,
+                    PAYLOAD_GET_U32(param->handleValPair.value.val, PAYLOAD_SEQ_OFFSET),
+                    PAYLOAD_GET_U32(param->handleValPair.value.val, PAYLOAD_TIME_OFFSET),
+                    Timebase_GetUs());
+            }
+        #endif
+        #if (INTEGRITY_CHECK_ENABLE == ENABLE)
+            if(param->handleValPair.attrHandle == char_handle)
+            {
+                (void)Integrity_CheckPacket(peer, param->handleValPair.value.val,
+                                            param->handleValPair.value.len);
+            }
+        #endif
             break;
         }
         /* The event is received by the Client when the Server cannot perform 
@@ -611,9 +884,18 @@ void StackEventHandler(uint32 event, void *eventParam)
 *******************************************************************************/
 void StartScan(void)
 {
-    printf("Scanning for GAP Peripheral with address: %02X:%02X:%02X:%02X:%02X:%02X\r\n\n",
-            remote_addr.bdAddr[5], remote_addr.bdAddr[4], remote_addr.bdAddr[3],
-            remote_addr.bdAddr[2], remote_addr.bdAddr[1], remote_addr.bdAddr[0]);
+    uint8 peer;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(isConnected[peer] == false)
+        {
+            printf("Scanning for GAP Peripheral with address: %02X:%02X:%02X:%02X:%02X:%02X\r\n\n",
+                    remote_addr[peer].bdAddr[5], remote_addr[peer].bdAddr[4], 
+                    remote_addr[peer].bdAddr[3], remote_addr[peer].bdAddr[2], 
+                    remote_addr[peer].bdAddr[1], remote_addr[peer].bdAddr[0]);
+        }
+    }
     Cy_BLE_GAPC_StartScan(CY_BLE_SCANNING_FAST,\
                           CY_BLE_CENTRAL_CONFIGURATION_0_INDEX);
     PWM_Start();
@@ -626,17 +908,17 @@ void StartScan(void)
 * Initiates a connection with a GAP peripheral.
 *
 * Parameters:
-* None
+* peer: index of the peer in the target address list
 *
 * Return:
 * None
 *
 *******************************************************************************/
-void InitiateConnection(void)
+void InitiateConnection(uint8 peer)
 {
     
     /* Initiate Connection */
-    apiResult = Cy_BLE_GAPC_ConnectDevice(&remote_addr, \
+    apiResult = Cy_BLE_GAPC_ConnectDevice(&remote_addr[peer], \
                                          CY_BLE_CENTRAL_CONFIGURATION_0_INDEX);
     
     if(apiResult != CY_BLE_SUCCESS)
@@ -657,19 +939,19 @@ void InitiateConnection(void)
 * Enables notification on the GATT Server
 *
 * Parameters:
-* None
+* connHandle: connection handle of the GATT Server
 *
 * Return:
 * None
 *
 *******************************************************************************/
-void EnableNotification(void)
+void EnableNotification(cy_stc_ble_conn_handle_t connHandle)
 {
     cy_stc_ble_gattc_write_req_t req;
                 
     desc_val[0] = 1;
     
-    req.connHandle = conn_handle;
+    req.connHandle = connHandle;
     req.handleValPair.attrHandle = desc_handle;
     req.handleValPair.value.val = desc_val;
     req.handleValPair.value.len = CY_BLE_CCCD_LEN;
@@ -718,12 +1000,10 @@ void BleAssert(void)
 * None
 *
 * Theory:
-* The ISR is fired when the timer reaches terminal count. In the ISR, the total
-* number of bytes received until now is cached locally (to avoid any potential 
-* race conditions) and then the throughput is calculated from it.
-* Since the ISR fires 10 seconds after the timer is started, the total number
-* of bytes is divided by 10. The bytes are converted to kilobytes by dividing 
-* by 1024. It is then converted to kilo bits by multiplying the result by 8.
+* The ISR is fired when the timer reaches terminal count. At the end of every
+* report window the number of bytes received on each link is latched; the
+* throughput is calculated and printed from the main loop (see 
+* Throughput_GetReport()).
 *
 * Side Effects:
 * None
@@ -731,16 +1011,437 @@ void BleAssert(void)
 *******************************************************************************/
 void MyTimerIsr(void)
 {
-    uint32_t throughput;
+    Throughput_TimerTick();
+    Timer_ClearInterrupt(CY_TCPWM_INT_ON_TC);
+    NVIC_ClearPendingIRQ(TimerInterrupt_cfg.intrSrc);
+}
 
-    throughput = (notify_count>>7) /10 ;
-    if (Cy_BLE_GetConnectionState(conn_handle)== CY_BLE_CONN_STATE_CONNECTED)
+/*******************************************************************************
+* Function Name: FindPeerByAddr()
+********************************************************************************
+* Summary:
+* Looks up a BD address in the target address list.
+*
+* Parameters:
+* bdAddr: BD address from the advertisement report
+*
+* Return:
+* uint8: index of the peer, or THROUGHPUT_INVALID_LINK if not a target
+*
+*******************************************************************************/
+uint8 FindPeerByAddr(const uint8 *bdAddr)
+{
+    uint8 peer;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
     {
-        printf("Throughput is: %lu kbps. \r\n", (unsigned long)throughput);
+        if(memcmp(bdAddr, remote_addr[peer].bdAddr, CY_BLE_BD_ADDR_SIZE) == 0)
+        {
+            return peer;
+        }
     }
-    notify_count = 0;
-    Timer_ClearInterrupt(CY_TCPWM_INT_ON_TC);
-    NVIC_ClearPendingIRQ(TimerInterrupt_cfg.intrSrc);
+    return THROUGHPUT_INVALID_LINK;
+}
+
+/*******************************************************************************
+* Function Name: FindPeerByBdHandle()
+********************************************************************************
+* Summary:
+* Looks up the peer that owns a connection.
+*
+* Parameters:
+* bdHandle: BD handle of the connection
+*
+* Return:
+* uint8: index of the peer, or THROUGHPUT_INVALID_LINK if not connected
+*
+*******************************************************************************/
+uint8 FindPeerByBdHandle(uint8 bdHandle)
+{
+    uint8 peer;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(isConnected[peer] && (conn_handle[peer].bdHandle == bdHandle))
+        {
+            return peer;
+        }
+    }
+    return THROUGHPUT_INVALID_LINK;
+}
+
+/*******************************************************************************
+* Function Name: GetConnectedPeerCount()
+********************************************************************************
+* Summary:
+* Returns the number of connected peers.
+*
+* Parameters:
+* None
+*
+* Return:
+* uint8: number of connected peers
+*
+*******************************************************************************/
+uint8 GetConnectedPeerCount(void)
+{
+    uint8 peer;
+    uint8 count = 0u;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(isConnected[peer])
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: PrintThroughputReport()
+********************************************************************************
+* Summary:
+* Prints the throughput report of the last window on the UART.
+*
+* Parameters:
+* report: report built by Throughput_GetReport()
+*
+* Return:
+* None
+*
+* Theory:
+* With a single peer only the link throughput is printed, as in the original
+* example. With several peers the per-link throughput is followed by the 
+* aggregate and the min/max/mean over the links that were connected for the
+* whole window.
+*
+*******************************************************************************/
+void PrintThroughputReport(const throughput_report_t *report)
+{
+#if (PEER_COUNT == 1u)
+    if(report->linkActive[0u])
+    {
+    #if (TRAFFIC_MODE == TRAFFIC_MODE_DOWNLINK)
+        printf("Throughput is: %lu kbps. \r\n", (unsigned long)report->linkKbps[0u]);
+    #elif (TRAFFIC_MODE == TRAFFIC_MODE_UPLINK)
+        printf("Uplink throughput (sent) is: %lu kbps. \r\n", 
+               (unsigned long)report->linkTxKbps[0u]);
+    #else
+        printf("Throughput is: %lu kbps down, %lu kbps up (sent). \r\n", 
+               (unsigned long)report->linkKbps[0u], (unsigned long)report->linkTxKbps[0u]);
+    #endif
+    }
+#else
+    uint8 peer;
+    
+    if(GetConnectedPeerCount() == 0u)
+    {
+        return;
+    }
+    
+    printf("Throughput over %lu s:\r\n", (unsigned long)report->windowSec);
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(report->linkActive[peer])
+        {
+            printf("  Device %u : %lu kbps%s\r\n", (unsigned int)peer,
+                   (unsigned long)report->linkKbps[peer],
+                   report->linkPartial[peer] ? " (partial)" : "");
+        #if (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+            printf("  Device %u : %lu kbps up (sent)\r\n", (unsigned int)peer,
+                   (unsigned long)report->linkTxKbps[peer]);
+        #endif
+        }
+    }
+    printf("  Aggregate: %lu kbps, min/max/mean: %lu/%lu/%lu kbps over %u links\r\n\n",
+           (unsigned long)report->aggregateKbps, (unsigned long)report->minKbps,
+           (unsigned long)report->maxKbps, (unsigned long)report->meanKbps,
+           (unsigned int)report->linkCount);
+#if (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+    printf("  Aggregate uplink (sent): %lu kbps\r\n\n", 
+           (unsigned long)report->aggregateTxKbps);
+#endif
+#endif
+}
+
+/*******************************************************************************
+* Function Name: SendLatencyRecords()
+********************************************************************************
+* Summary:
+* Sends the binary latency record of every connected link on the UART and
+* starts a new latency window.
+*
+* Parameters:
+* report: report of the window that just ended
+*
+* Return:
+* None
+*
+* Theory:
+* The records are written from the main loop right after the throughput 
+* report, so nothing is formatted or sent from the timer ISR.
+*
+*******************************************************************************/
+void SendLatencyRecords(const throughput_report_t *report)
+{
+    uint8 record[LATENCY_RECORD_SIZE];
+    uint8 peer;
+    uint8 i;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(report->linkActive[peer])
+        {
+            LatencyStats_BuildRecord(peer, record);
+            for(i = 0u; i < LATENCY_RECORD_SIZE; i++)
+            {
+                STDIO_PutChar(record[i]);
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: PrintIntegrityReport()
+********************************************************************************
+* Summary:
+* Prints the goodput and the packet integrity counters of every connected 
+* link and restarts the counters.
+*
+* Parameters:
+* report: throughput report of the window that just ended
+*
+* Return:
+* None
+*
+*******************************************************************************/
+void PrintIntegrityReport(const throughput_report_t *report)
+{
+    integrity_report_t integrity;
+    uint8 peer;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(report->linkActive[peer])
+        {
+            Integrity_GetReport(peer, &integrity);
+            printf("  Device %u : goodput %lu kbps, good %lu, lost %lu, duplicated %lu, "
+                   "corrupted %lu, CRC %lu cycles/packet\r\n", (unsigned int)peer,
+                   (unsigned long)integrity.goodputKbps, (unsigned long)integrity.good,
+                   (unsigned long)integrity.lost, (unsigned long)integrity.duplicated,
+                   (unsigned long)integrity.corrupted, 
+                   (unsigned long)integrity.crcCyclesPerPacket);
+        }
+    }
+    printf("\r\n");
+}
+
+/*******************************************************************************
+* Function Name: SendUplinkData()
+********************************************************************************
+* Summary:
+* Queues Write Without Response commands to every peer with uplink enabled
+* until the stack reports busy or UPLINK_MAX_IN_FLIGHT commands were queued.
+*
+* Parameters:
+* None
+*
+* Return:
+* None
+*
+* Theory:
+* Each command carries a full ATT payload for the negotiated MTU. Only the
+* commands accepted by the stack are counted as sent; the goodput received by
+* the server is reported by the GATT Out project.
+*
+*******************************************************************************/
+void SendUplinkData(void)
+{
+    cy_stc_ble_gattc_write_cmd_req_t writeCmd;
+    uint8 peer;
+    uint8 queued;
+    
+    for(peer = 0u; peer < PEER_COUNT; peer++)
+    {
+        if(!uplinkEnabled[peer])
+        {
+            continue;
+        }
+        
+        writeCmd.connHandle = conn_handle[peer];
+        writeCmd.handleValPair.attrHandle = char_handle;
+        writeCmd.handleValPair.value.val  = uplinkBuffer;
+        writeCmd.handleValPair.value.len  = peerMtu[peer] - ATT_WRITE_CMD_HEADER_SIZE;
+        
+        for(queued = 0u; queued < UPLINK_MAX_IN_FLIGHT; queued++)
+        {
+            if(Cy_BLE_GATT_GetBusyStatus(conn_handle[peer].attId) != CY_BLE_STACK_STATE_FREE)
+            {
+                break;
+            }
+            if(Cy_BLE_GATTC_WriteWithoutResponse(&writeCmd) != CY_BLE_SUCCESS)
+            {
+                break;
+            }
+            Throughput_AddTxBytes(peer, writeCmd.handleValPair.value.len);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: RunSweep()
+********************************************************************************
+* Summary:
+* Feeds an event into the link parameter sweep and starts the BLE operations
+* it requests.
+*
+* Parameters:
+* event: sweep event
+*
+* Return:
+* None
+*
+*******************************************************************************/
+void RunSweep(sweep_event_t event)
+{
+    sweep_action_t action;
+    
+    action = Sweep_HandleEvent(event, Timebase_GetUs(), Throughput_GetTotalBytes(0u));
+    
+    /* An operation that cannot be started is reported back to the sweep, 
+       which moves on to its next action */
+    while((action != SWEEP_ACTION_NONE) && !StartSweepAction(action))
+    {
+        action = Sweep_HandleEvent(SWEEP_EVT_API_ERROR, Timebase_GetUs(), 
+                                   Throughput_GetTotalBytes(0u));
+    }
+}
+
+/*******************************************************************************
+* Function Name: StartSweepAction()
+********************************************************************************
+* Summary:
+* Starts the BLE operation requested by the link parameter sweep.
+*
+* Parameters:
+* action: requested operation
+*
+* Return:
+* bool: false if the BLE stack rejected the operation
+*
+*******************************************************************************/
+bool StartSweepAction(sweep_action_t action)
+{
+    static const char * const phyName[] = {"1M", "2M", "CODED"};
+    static const uint8 phyMask[] = 
+    {
+        CY_BLE_PHY_MASK_LE_1M, CY_BLE_PHY_MASK_LE_2M, CY_BLE_PHY_MASK_LE_CODED
+    };
+    const sweep_cell_t *cell = Sweep_GetCell();
+    const sweep_result_t *result;
+    cy_en_ble_api_result_t result_api = CY_BLE_SUCCESS;
+    
+    switch(action)
+    {
+        case SWEEP_ACTION_CONNECT:
+        {
+            if(!sweepActive)
+            {
+                sweepActive = true;
+                printf("SWEEP,cell,mtu,phy,tx_octets,conn_intv_us,bytes,duration_us,kbps,status\r\n");
+            }
+            if(Cy_BLE_GetScanState() == CY_BLE_SCAN_STATE_STOPPED)
+            {
+                StartScan();
+            }
+            break;
+        }
+        
+        case SWEEP_ACTION_SET_PHY:
+        {
+            cy_stc_ble_set_phy_info_t phyParam =
+            {
+                .bdHandle   = conn_handle[0u].bdHandle,
+                .allPhyMask = CY_BLE_PHY_NO_PREF_MASK_NONE,
+                .phyOption  = 0u,
+                .txPhyMask  = phyMask[cell->phy],
+                .rxPhyMask  = phyMask[cell->phy]
+            };
+            phyBdHandle = phyParam.bdHandle;
+            Cy_BLE_EnablePhyUpdateFeature();
+            result_api = Cy_BLE_SetPhy(&phyParam);
+            break;
+        }
+        
+        case SWEEP_ACTION_SET_DATA_LENGTH:
+        {
+            cy_stc_ble_set_data_length_info_t dataLengthParam =
+            {
+                .bdHandle        = conn_handle[0u].bdHandle,
+                .connMaxTxOctets = cell->txOctets,
+                .connMaxTxTime   = SWEEP_MAX_TX_TIME
+            };
+            result_api = Cy_BLE_SetDataLength(&dataLengthParam);
+            break;
+        }
+        
+        case SWEEP_ACTION_SET_CONN_PARAM:
+        {
+            cy_stc_ble_gap_conn_update_param_info_t connUpdateParam =
+            {
+                .connIntvMin   = cell->connIntv,
+                .connIntvMax   = cell->connIntv,
+                .connLatency   = SWEEP_CONN_LATENCY,
+                .supervisionTO = SWEEP_SUPERVISION_TO,
+                .bdHandle      = conn_handle[0u].bdHandle
+            };
+            result_api = Cy_BLE_GAPC_ConnectionParamUpdateRequest(&connUpdateParam);
+            break;
+        }
+        
+        case SWEEP_ACTION_DISCONNECT:
+        {
+            cy_stc_ble_gap_disconnect_info_t disconnectParam =
+            {
+                .bdHandle = conn_handle[0u].bdHandle,
+                .reason   = CY_BLE_HCI_ERROR_OTHER_END_TERMINATED_USER
+            };
+            result_api = Cy_BLE_GAP_Disconnect(&disconnectParam);
+            break;
+        }
+        
+        case SWEEP_ACTION_REPORT:
+        {
+            result = Sweep_GetResult();
+            printf("SWEEP,%u,%u,%s,%u,%lu,%lu,%lu,%lu,%s\r\n", 
+                   (unsigned int)result->cellIndex, (unsigned int)result->cell.mtu,
+                   phyName[result->cell.phy], (unsigned int)result->cell.txOctets,
+                   (unsigned long)result->cell.connIntv * 1250u,
+                   (unsigned long)result->bytes, (unsigned long)result->durationUs,
+                   (unsigned long)result->kbps,
+                   (result->status == SWEEP_STATUS_OK) ? "OK" :
+                   ((result->status == SWEEP_STATUS_TIMEOUT) ? "TIMEOUT" : "ERROR"));
+            break;
+        }
+        
+        case SWEEP_ACTION_DONE:
+        {
+            sweepActive = false;
+            printf("Sweep complete: %u cells\r\n\n", (unsigned int)Sweep_GetCellCount());
+            break;
+        }
+        
+        default:
+            break;
+    }
+    
+    if(result_api != CY_BLE_SUCCESS)
+    {
+        DEBUG_BLE("Sweep action %d failed: 0x%x\r\n", action, result_api);
+        return false;
+    }
+    return true;
 }
 
 #endif /* CY_BLE_HOST_CORE */
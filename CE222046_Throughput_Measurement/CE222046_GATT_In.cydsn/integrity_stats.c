@@ -0,0 +1,261 @@
+/*******************************************************************************
+* File Name: integrity_stats.c
+*
+* Version: 1.10
+*
+* Description: This file implements the payload integrity check and the goodput
+*              accounting of the GATT client.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "project.h"
+#include "integrity_stats.h"
+#include "timebase.h"
+#include "crc32.h"
+#include "payload.h"
+#include <string.h>
+
+#if CY_BLE_HOST_CORE
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+typedef struct
+{
+    /* Sequence number expected next */
+    uint32_t nextSeq;
+    
+    /* Counters of the current report */
+    uint32_t startUs;
+    uint32_t good;
+    uint32_t lost;
+    uint32_t duplicated;
+    uint32_t corrupted;
+    uint32_t goodBytes;
+    uint32_t crcCycles;
+    uint32_t crcCount;
+} integrity_link_t;
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+static integrity_link_t integrityLink[THROUGHPUT_MAX_LINKS];
+
+/*******************************************************************************
+* Function Name: Integrity_Init()
+********************************************************************************
+* Summary:
+*  Resets the counters of all links.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Integrity_Init(void)
+{
+    uint8_t link;
+    
+    for(link = 0u; link < THROUGHPUT_MAX_LINKS; link++)
+    {
+        Integrity_LinkReset(link);
+    }
+}
+
+/*******************************************************************************
+* Function Name: Integrity_LinkReset()
+********************************************************************************
+* Summary:
+*  Resets the counters of one link. Called when the link connects, as the
+*  server restarts its sequence numbers from zero.
+*
+* Parameters:
+*  link : index of the link
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Integrity_LinkReset(uint8_t link)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        memset(&integrityLink[link], 0, sizeof(integrity_link_t));
+        integrityLink[link].startUs = Timebase_GetUs();
+    }
+}
+
+/*******************************************************************************
+* Function Name: Integrity_CheckPacket()
+********************************************************************************
+* Summary:
+*  Checks the CRC and the sequence number of one received notification and
+*  updates the link counters. Must be called from the BLE event context only.
+*
+* Parameters:
+*  link : index of the link
+*  data : notification payload
+*  len  : payload length
+*
+* Return:
+*  bool : true if the packet passed the CRC check
+*
+* Theory:
+*  The CRC covers the body first and then the sequence number and timestamp,
+*  the same order as the server computes it (see payload.h). A packet with a
+*  wrong CRC is counted as corrupted and its sequence number is not trusted.
+*  A sequence number ahead of the expected one counts the skipped numbers as
+*  lost; one behind it counts as a duplicate.
+*
+*******************************************************************************/
+bool Integrity_CheckPacket(uint8_t link, const uint8_t *data, uint32_t len)
+{
+    integrity_link_t *state;
+    uint32_t startCycles;
+    uint32_t crc;
+    uint32_t seq;
+    int32_t  seqDiff;
+    
+    if(link >= THROUGHPUT_MAX_LINKS)
+    {
+        return false;
+    }
+    state = &integrityLink[link];
+    
+    if(len < PAYLOAD_INTEGRITY_HEADER_SIZE)
+    {
+        state->corrupted++;
+        return false;
+    }
+    
+    startCycles = Timebase_GetCycles();
+    crc = Crc32_Update(CRC32_INIT, &data[PAYLOAD_INTEGRITY_HEADER_SIZE], 
+                       len - PAYLOAD_INTEGRITY_HEADER_SIZE);
+    crc = Crc32_Update(crc, data, PAYLOAD_CRC_OFFSET) ^ CRC32_FINAL_XOR;
+    state->crcCycles += Timebase_GetCycles() - startCycles;
+    state->crcCount++;
+    
+    if(crc != PAYLOAD_GET_U32(data, PAYLOAD_CRC_OFFSET))
+    {
+        state->corrupted++;
+        return false;
+    }
+    
+    /* Signed difference handles wrap-around of the sequence number */
+    seq = PAYLOAD_GET_U32(data, PAYLOAD_SEQ_OFFSET);
+    seqDiff = (int32_t)(seq - state->nextSeq);
+    if(seqDiff < 0)
+    {
+        state->duplicated++;
+    }
+    else
+    {
+        state->lost      += (uint32_t)seqDiff;
+        state->good++;
+        state->goodBytes += len - PAYLOAD_INTEGRITY_HEADER_SIZE;
+        state->nextSeq    = seq + 1u;
+    }
+    
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: Integrity_GetReport()
+********************************************************************************
+* Summary:
+*  Returns the counters of one link since the previous call and restarts them.
+*  Must be called from the main loop or the BLE event context only.
+*
+* Parameters:
+*  link   : index of the link
+*  report : report to be filled
+*
+* Return:
+*  None
+*
+* Theory:
+*  The goodput is measured over the time between two calls with the
+*  timebase, so it does not depend on the period of the throughput timer.
+*  Like the throughput, it is converted to kilobits with 1 kB = 1024 bytes.
+*
+*******************************************************************************/
+void Integrity_GetReport(uint8_t link, integrity_report_t *report)
+{
+    integrity_link_t *state;
+    uint32_t nowUs;
+    
+    memset(report, 0, sizeof(integrity_report_t));
+    if(link >= THROUGHPUT_MAX_LINKS)
+    {
+        return;
+    }
+    state = &integrityLink[link];
+    nowUs = Timebase_GetUs();
+    
+    report->durationUs = nowUs - state->startUs;
+    report->good       = state->good;
+    report->lost       = state->lost;
+    report->duplicated = state->duplicated;
+    report->corrupted  = state->corrupted;
+    report->goodBytes  = state->goodBytes;
+    
+    if(report->durationUs != 0u)
+    {
+        report->goodputKbps = (uint32_t)(((uint64_t)state->goodBytes * 1000000u) / 
+                                         ((uint64_t)report->durationUs * 128u));
+    }
+    if(state->crcCount != 0u)
+    {
+        report->crcCyclesPerPacket = state->crcCycles / state->crcCount;
+    }
+    
+    /* The expected sequence number carries over to the next report */
+    state->startUs    = nowUs;
+    state->good       = 0u;
+    state->lost       = 0u;
+    state->duplicated = 0u;
+    state->corrupted  = 0u;
+    state->goodBytes  = 0u;
+    state->crcCycles  = 0u;
+    state->crcCount   = 0u;
+}
+
+#endif /* CY_BLE_HOST_CORE */
+
+/* [] END OF FILE */
@@ -0,0 +1,94 @@
+/*******************************************************************************
+* File Name: integrity_stats.h
+*
+* Version: 1.10
+*
+* Description: This file contains the interface of the payload integrity check.
+*              The GATT client checks the sequence number and CRC-32 of every
+*              notification and accounts lost, duplicated and corrupted packets
+*              and the goodput per link.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifndef INTEGRITY_STATS_H
+#define INTEGRITY_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "throughput_stats.h"
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+/* Integrity counters of one link since the previous Integrity_GetReport() */
+typedef struct
+{
+    /* Time covered by the counters, in microseconds */
+    uint32_t durationUs;
+    
+    /* Packets that passed the CRC check and were new */
+    uint32_t good;
+    
+    /* Sequence numbers skipped */
+    uint32_t lost;
+    
+    /* Packets that passed the CRC check but were already received */
+    uint32_t duplicated;
+    
+    /* Packets with a CRC mismatch or too short to carry the header */
+    uint32_t corrupted;
+    
+    /* Payload bytes after the integrity header of the good packets, and the
+       resulting goodput */
+    uint32_t goodBytes;
+    uint32_t goodputKbps;
+    
+    /* Average CPU cycles spent on the CRC of one packet */
+    uint32_t crcCyclesPerPacket;
+} integrity_report_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void Integrity_Init(void);
+void Integrity_LinkReset(uint8_t link);
+bool Integrity_CheckPacket(uint8_t link, const uint8_t *data, uint32_t len);
+void Integrity_GetReport(uint8_t link, integrity_report_t *report);
+
+#endif /* INTEGRITY_STATS_H */
+
+/* [] END OF FILE */
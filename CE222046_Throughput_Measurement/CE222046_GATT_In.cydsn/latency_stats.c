@@ -0,0 +1,330 @@
+/*******************************************************************************
+* File Name: latency_stats.c
+*
+* Version: 1.10
+*
+* Description: This file implements the per-link latency histograms and
+*              sequence gap counters of the GATT client. It has no dependency
+*              on the BLE component.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "project.h"
+#include "latency_stats.h"
+#include "payload.h"
+#include <string.h>
+
+#if CY_BLE_HOST_CORE
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+typedef struct
+{
+    /* Latency histogram of the current window */
+    uint32_t bins[LATENCY_BIN_COUNT];
+    uint32_t count;
+    uint32_t maxUs;
+    
+    /* Clock offset (rx - tx) removed from every sample, and the smallest
+       offset seen in the current window */
+    int32_t  offset;
+    int32_t  minDelta;
+    bool     offsetValid;
+    
+    /* Sequence tracking */
+    uint32_t nextSeq;
+    bool     seqValid;
+    uint32_t lost;
+    uint32_t gaps;
+} latency_link_t;
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+static latency_link_t latencyLink[THROUGHPUT_MAX_LINKS];
+
+/*******************************************************************************
+* Function Name: LatencyStats_Init()
+********************************************************************************
+* Summary:
+*  Resets the statistics of all links.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void LatencyStats_Init(void)
+{
+    uint8_t link;
+    
+    for(link = 0u; link < THROUGHPUT_MAX_LINKS; link++)
+    {
+        LatencyStats_LinkReset(link);
+    }
+}
+
+/*******************************************************************************
+* Function Name: LatencyStats_LinkReset()
+********************************************************************************
+* Summary:
+*  Resets the statistics of one link. Called when the link connects, as the
+*  server restarts its sequence numbers and may have a new clock offset.
+*
+* Parameters:
+*  link : index of the link
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void LatencyStats_LinkReset(uint8_t link)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        memset(&latencyLink[link], 0, sizeof(latency_link_t));
+    }
+}
+
+/*******************************************************************************
+* Function Name: LatencyStats_AddSample()
+********************************************************************************
+* Summary:
+*  Adds one received notification to the link statistics.
+*
+* Parameters:
+*  link : index of the link
+*  seq  : sequence number stamped by the server
+*  txUs : server timebase stamped in the payload
+*  rxUs : client timebase when the notification was received
+*
+* Return:
+*  None
+*
+* Theory:
+*  The two timebases are not synchronized, so rx - tx contains an unknown
+*  constant offset. The smallest rx - tx of the previous window is used as
+*  the offset; the reported latency is therefore the one-way delay above the
+*  fastest notification, i.e. queuing delay plus jitter. Offsets are
+*  re-estimated every window so that the drift between the two clocks does 
+*  not accumulate.
+*
+*******************************************************************************/
+void LatencyStats_AddSample(uint8_t link, uint32_t seq, uint32_t txUs, uint32_t rxUs)
+{
+    latency_link_t *stats;
+    int32_t  delta;
+    uint32_t latencyUs;
+    uint32_t bin;
+    
+    if(link >= THROUGHPUT_MAX_LINKS)
+    {
+        return;
+    }
+    stats = &latencyLink[link];
+    
+    /* Sequence gaps */
+    if(stats->seqValid && (seq != stats->nextSeq))
+    {
+        stats->gaps++;
+        
+        /* Sequence numbers behind the expected one are late duplicates */
+        if((int32_t)(seq - stats->nextSeq) > 0)
+        {
+            stats->lost += seq - stats->nextSeq;
+        }
+    }
+    
+    /* A late duplicate must not move the expected sequence number back */
+    if(!stats->seqValid || ((int32_t)(seq - stats->nextSeq) >= 0))
+    {
+        stats->nextSeq  = seq + 1u;
+        stats->seqValid = true;
+    }
+    
+    /* Latency */
+    delta = (int32_t)(rxUs - txUs);
+    if(!stats->offsetValid)
+    {
+        stats->offset      = delta;
+        stats->minDelta    = delta;
+        stats->offsetValid = true;
+    }
+    if(delta < stats->minDelta)
+    {
+        stats->minDelta = delta;
+    }
+    
+    latencyUs = (delta > stats->offset) ? (uint32_t)(delta - stats->offset) : 0u;
+    
+    bin = latencyUs / LATENCY_BIN_US;
+    if(bin >= LATENCY_BIN_COUNT)
+    {
+        bin = LATENCY_BIN_COUNT - 1u;
+    }
+    stats->bins[bin]++;
+    stats->count++;
+    
+    if(latencyUs > stats->maxUs)
+    {
+        stats->maxUs = latencyUs;
+    }
+}
+
+/*******************************************************************************
+* Function Name: GetPercentile()
+********************************************************************************
+* Summary:
+*  Returns the latency below which the given percentage of samples fall.
+*
+* Parameters:
+*  stats   : link statistics
+*  percent : percentile, 1 to 100
+*
+* Return:
+*  uint32_t : upper edge of the histogram bin holding the percentile, in
+*             microseconds, capped at the maximum latency seen
+*
+*******************************************************************************/
+static uint32_t GetPercentile(const latency_link_t *stats, uint32_t percent)
+{
+    uint32_t bin;
+    uint32_t target;
+    uint32_t sum = 0u;
+    uint32_t edge;
+    
+    if(stats->count == 0u)
+    {
+        return 0u;
+    }
+    
+    if(percent > 100u)
+    {
+        percent = 100u;
+    }
+    
+    /* Rank of the percentile sample, rounded up; with percent <= 100 it is at
+    *  most count, so it fits in 32 bits */
+    target = (uint32_t)(((uint64_t)stats->count * percent + 99u) / 100u);
+    
+    for(bin = 0u; bin < LATENCY_BIN_COUNT; bin++)
+    {
+        sum += stats->bins[bin];
+        if(sum >= target)
+        {
+            break;
+        }
+    }
+    
+    edge = (bin + 1u) * LATENCY_BIN_US;
+    return (edge < stats->maxUs) ? edge : stats->maxUs;
+}
+
+/*******************************************************************************
+* Function Name: LatencyStats_BuildRecord()
+********************************************************************************
+* Summary:
+*  Builds the binary latency record of the current window and starts a new 
+*  window.
+*
+* Parameters:
+*  link   : index of the link
+*  record : buffer of LATENCY_RECORD_SIZE bytes
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void LatencyStats_BuildRecord(uint8_t link, uint8_t *record)
+{
+    latency_link_t *stats;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint8_t checksum = 0u;
+    uint8_t i;
+    
+    if(link >= THROUGHPUT_MAX_LINKS)
+    {
+        return;
+    }
+    stats = &latencyLink[link];
+    
+    /* Each percentile walks the histogram */
+    p50 = GetPercentile(stats, 50u);
+    p90 = GetPercentile(stats, 90u);
+    p99 = GetPercentile(stats, 99u);
+    
+    record[0u] = LATENCY_RECORD_SYNC0;
+    record[1u] = LATENCY_RECORD_SYNC1;
+    record[2u] = LATENCY_RECORD_TYPE;
+    record[3u] = link;
+    Payload_PutU32(record, 4u,  stats->count);
+    Payload_PutU32(record, 8u,  p50);
+    Payload_PutU32(record, 12u, p90);
+    Payload_PutU32(record, 16u, p99);
+    Payload_PutU32(record, 20u, stats->maxUs);
+    Payload_PutU32(record, 24u, stats->lost);
+    Payload_PutU32(record, 28u, stats->gaps);
+    
+    for(i = 2u; i < (LATENCY_RECORD_SIZE - 1u); i++)
+    {
+        checksum ^= record[i];
+    }
+    record[LATENCY_RECORD_SIZE - 1u] = checksum;
+    
+    /* Start a new window with the offset of this one; the sequence tracking
+       carries over */
+    if(stats->count != 0u)
+    {
+        stats->offset = stats->minDelta;
+    }
+    stats->minDelta = INT32_MAX;
+    
+    memset(stats->bins, 0, sizeof(stats->bins));
+    stats->count  = 0u;
+    stats->maxUs  = 0u;
+    stats->lost   = 0u;
+    stats->gaps   = 0u;
+}
+
+#endif /* CY_BLE_HOST_CORE */
+
+/* [] END OF FILE */
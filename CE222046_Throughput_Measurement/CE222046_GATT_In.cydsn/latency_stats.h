@@ -0,0 +1,88 @@
+/*******************************************************************************
+* File Name: latency_stats.h
+*
+* Version: 1.10
+*
+* Description: This file is the public interface of latency_stats.c. It
+*              declares the per-link latency histograms, sequence gap counters
+*              and the binary latency record.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef LATENCY_STATS_H
+#define LATENCY_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "throughput_stats.h"
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Histogram resolution. The last bin collects all larger latencies. */
+#define LATENCY_BIN_US              (250u)
+#define LATENCY_BIN_COUNT           (128u)
+
+/**
+ * Binary latency record, one per link and report window. All multi-byte 
+ * fields are little endian.
+ *  - byte  0    : LATENCY_RECORD_SYNC0
+ *  - byte  1    : LATENCY_RECORD_SYNC1
+ *  - byte  2    : LATENCY_RECORD_TYPE
+ *  - byte  3    : link index
+ *  - bytes 4..7 : number of samples in the window
+ *  - bytes 8..11, 12..15, 16..19 : p50, p90, p99 latency in microseconds
+ *  - bytes 20..23 : maximum latency in microseconds
+ *  - bytes 24..27 : number of lost notifications (sequence numbers skipped)
+ *  - bytes 28..31 : number of gaps (sequence discontinuities)
+ *  - byte  32   : XOR of bytes 2..31
+ */
+#define LATENCY_RECORD_SYNC0        (0xA5u)
+#define LATENCY_RECORD_SYNC1        (0x5Au)
+#define LATENCY_RECORD_TYPE         (0x01u)
+#define LATENCY_RECORD_SIZE         (33u)
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void LatencyStats_Init(void);
+void LatencyStats_LinkReset(uint8_t link);
+void LatencyStats_AddSample(uint8_t link, uint32_t seq, uint32_t txUs, uint32_t rxUs);
+void LatencyStats_BuildRecord(uint8_t link, uint8_t *record);
+
+#endif /* LATENCY_STATS_H */
+
+/* [] END OF FILE */
@@ -0,0 +1,545 @@
+/*******************************************************************************
+* File Name: sweep.c
+*
+* Version: 1.10
+*
+* Description: This file implements the link parameter sweep of the GATT
+*              client. The state machine walks a matrix of MTU sizes, PHYs,
+*              data lengths and connection intervals, and for every cell
+*              requests the link updates and runs a timed transfer. It has no
+*              dependency on the BLE component: events are fed in by the caller
+*              and the requested BLE operations are returned as actions.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "project.h"
+#include "sweep.h"
+
+#if CY_BLE_HOST_CORE
+
+/*******************************************************************************
+* Sweep matrix. The MTU can only be exchanged once per connection, so it is 
+* the outermost dimension: the link is re-established whenever it changes. 
+* The other parameters are renegotiated on the live connection.
+*******************************************************************************/
+static const uint16_t    sweepMtu[]      = {23u, 185u, 247u, 512u};
+static const sweep_phy_t sweepPhy[]      = {SWEEP_PHY_1M, SWEEP_PHY_2M, SWEEP_PHY_CODED};
+static const uint16_t    sweepTxOctets[] = {27u, 251u};
+static const uint16_t    sweepConnIntv[] = {6u, 24u, 80u};
+
+#define ARRAY_SIZE(a)               (sizeof(a) / sizeof((a)[0]))
+
+#define SWEEP_MTU_COUNT             ((uint16_t)ARRAY_SIZE(sweepMtu))
+#define SWEEP_PHY_COUNT             ((uint16_t)ARRAY_SIZE(sweepPhy))
+#define SWEEP_TX_OCTETS_COUNT       ((uint16_t)ARRAY_SIZE(sweepTxOctets))
+#define SWEEP_CONN_INTV_COUNT       ((uint16_t)ARRAY_SIZE(sweepConnIntv))
+#define SWEEP_CELL_COUNT            (SWEEP_MTU_COUNT * SWEEP_PHY_COUNT * \
+                                     SWEEP_TX_OCTETS_COUNT * SWEEP_CONN_INTV_COUNT)
+
+/* Parameter update flags */
+#define SWEEP_UPDATE_PHY            (0x01u)
+#define SWEEP_UPDATE_TX_OCTETS      (0x02u)
+#define SWEEP_UPDATE_CONN_INTV      (0x04u)
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+typedef enum
+{
+    SWEEP_STATE_IDLE,
+    SWEEP_STATE_WAIT_LINK,
+    SWEEP_STATE_WAIT_PHY,
+    SWEEP_STATE_WAIT_DATA_LENGTH,
+    SWEEP_STATE_WAIT_CONN_PARAM,
+    SWEEP_STATE_SETTLE,
+    SWEEP_STATE_MEASURE,
+    SWEEP_STATE_REPORT,
+    SWEEP_STATE_WAIT_DISCONNECT,
+    SWEEP_STATE_DONE
+} sweep_state_t;
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+static sweep_state_t  sweepState;
+static uint32_t       stateEnteredUs;
+static uint16_t       cellIndex;
+static sweep_cell_t   cell;
+static sweep_result_t result;
+
+/* Parameters in effect on the current link */
+static bool           linkUp;
+static bool           phyApplied;
+static bool           txOctetsApplied;
+static bool           connIntvApplied;
+static sweep_cell_t   applied;
+
+/* Updates that failed or timed out in the current cell */
+static uint8_t        failedUpdates;
+
+/* Transfer measurement */
+static uint32_t       measureStartBytes;
+
+/*******************************************************************************
+* Function Name: LoadCell()
+********************************************************************************
+* Summary:
+*  Decodes a cell index into its link parameters. The connection interval is
+*  the innermost dimension and the MTU the outermost.
+*
+* Parameters:
+*  index : cell index
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void LoadCell(uint16_t index)
+{
+    cell.connIntv = sweepConnIntv[index % SWEEP_CONN_INTV_COUNT];
+    index /= SWEEP_CONN_INTV_COUNT;
+    cell.txOctets = sweepTxOctets[index % SWEEP_TX_OCTETS_COUNT];
+    index /= SWEEP_TX_OCTETS_COUNT;
+    cell.phy      = sweepPhy[index % SWEEP_PHY_COUNT];
+    index /= SWEEP_PHY_COUNT;
+    cell.mtu      = sweepMtu[index];
+}
+
+/*******************************************************************************
+* Function Name: EnterState()
+********************************************************************************
+* Summary:
+*  Changes the state and records when it was entered.
+*
+* Parameters:
+*  state : new state
+*  nowUs : current time
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void EnterState(sweep_state_t state, uint32_t nowUs)
+{
+    sweepState     = state;
+    stateEnteredUs = nowUs;
+}
+
+/*******************************************************************************
+* Function Name: NextUpdate()
+********************************************************************************
+* Summary:
+*  Returns the next parameter update needed by the current cell, skipping the
+*  parameters that already have the requested value on the link.
+*
+* Parameters:
+*  nowUs : current time
+*
+* Return:
+*  sweep_action_t : update to request, or SWEEP_ACTION_NONE when the link is
+*                   ready to be measured
+*
+*******************************************************************************/
+static sweep_action_t NextUpdate(uint32_t nowUs)
+{
+    if(!phyApplied || (applied.phy != cell.phy))
+    {
+        EnterState(SWEEP_STATE_WAIT_PHY, nowUs);
+        return SWEEP_ACTION_SET_PHY;
+    }
+    if(!txOctetsApplied || (applied.txOctets != cell.txOctets))
+    {
+        EnterState(SWEEP_STATE_WAIT_DATA_LENGTH, nowUs);
+        return SWEEP_ACTION_SET_DATA_LENGTH;
+    }
+    if(!connIntvApplied || (applied.connIntv != cell.connIntv))
+    {
+        EnterState(SWEEP_STATE_WAIT_CONN_PARAM, nowUs);
+        return SWEEP_ACTION_SET_CONN_PARAM;
+    }
+    
+    EnterState(SWEEP_STATE_SETTLE, nowUs);
+    return SWEEP_ACTION_NONE;
+}
+
+/*******************************************************************************
+* Function Name: UpdateFinished()
+********************************************************************************
+* Summary:
+*  Marks the pending parameter update as finished and moves on to the next 
+*  one. A failed or timed out update is not retried within the cell; it is 
+*  recorded in the cell status and requested again by the next cell.
+*
+* Parameters:
+*  status : outcome of the update
+*  nowUs  : current time
+*
+* Return:
+*  sweep_action_t : next action
+*
+*******************************************************************************/
+static sweep_action_t UpdateFinished(sweep_status_t status, uint32_t nowUs)
+{
+    uint8_t update = 0u;
+    
+    switch(sweepState)
+    {
+        case SWEEP_STATE_WAIT_PHY:
+            phyApplied  = true;
+            applied.phy = cell.phy;
+            update      = SWEEP_UPDATE_PHY;
+            break;
+        
+        case SWEEP_STATE_WAIT_DATA_LENGTH:
+            txOctetsApplied  = true;
+            applied.txOctets = cell.txOctets;
+            update           = SWEEP_UPDATE_TX_OCTETS;
+            break;
+        
+        case SWEEP_STATE_WAIT_CONN_PARAM:
+            connIntvApplied  = true;
+            applied.connIntv = cell.connIntv;
+            update           = SWEEP_UPDATE_CONN_INTV;
+            break;
+        
+        default:
+            break;
+    }
+    
+    if(status != SWEEP_STATUS_OK)
+    {
+        failedUpdates |= update;
+        
+        /* Keep the first problem of the cell */
+        if(result.status == SWEEP_STATUS_OK)
+        {
+            result.status = status;
+        }
+    }
+    
+    return NextUpdate(nowUs);
+}
+
+/*******************************************************************************
+* Function Name: StartCell()
+********************************************************************************
+* Summary:
+*  Starts the cell selected by cellIndex.
+*
+* Parameters:
+*  nowUs : current time
+*
+* Return:
+*  sweep_action_t : first action of the cell
+*
+*******************************************************************************/
+static sweep_action_t StartCell(uint32_t nowUs)
+{
+    if(cellIndex >= SWEEP_CELL_COUNT)
+    {
+        EnterState(SWEEP_STATE_DONE, nowUs);
+        return (linkUp) ? SWEEP_ACTION_DISCONNECT : SWEEP_ACTION_DONE;
+    }
+    
+    LoadCell(cellIndex);
+    result.cellIndex  = cellIndex;
+    result.cell       = cell;
+    result.bytes      = 0u;
+    result.durationUs = 0u;
+    result.kbps       = 0u;
+    result.status     = SWEEP_STATUS_OK;
+    
+    /* The value of a parameter whose update failed is unknown */
+    if((failedUpdates & SWEEP_UPDATE_PHY) != 0u)
+    {
+        phyApplied = false;
+    }
+    if((failedUpdates & SWEEP_UPDATE_TX_OCTETS) != 0u)
+    {
+        txOctetsApplied = false;
+    }
+    if((failedUpdates & SWEEP_UPDATE_CONN_INTV) != 0u)
+    {
+        connIntvApplied = false;
+    }
+    failedUpdates = 0u;
+    
+    if(linkUp && (applied.mtu == cell.mtu))
+    {
+        return NextUpdate(nowUs);
+    }
+    
+    if(linkUp)
+    {
+        /* A new MTU needs a new connection */
+        EnterState(SWEEP_STATE_WAIT_DISCONNECT, nowUs);
+        return SWEEP_ACTION_DISCONNECT;
+    }
+    
+    EnterState(SWEEP_STATE_WAIT_LINK, nowUs);
+    return SWEEP_ACTION_CONNECT;
+}
+
+/*******************************************************************************
+* Function Name: Sweep_Init()
+********************************************************************************
+* Summary:
+*  Resets the sweep to its first cell.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Sweep_Init(void)
+{
+    sweepState      = SWEEP_STATE_IDLE;
+    stateEnteredUs  = 0u;
+    cellIndex       = 0u;
+    linkUp          = false;
+    phyApplied      = false;
+    txOctetsApplied = false;
+    connIntvApplied = false;
+    failedUpdates   = 0u;
+    LoadCell(0u);
+}
+
+/*******************************************************************************
+* Function Name: Sweep_HandleEvent()
+********************************************************************************
+* Summary:
+*  Runs the sweep state machine.
+*
+* Parameters:
+*  event      : event that occurred
+*  nowUs      : current time in microseconds
+*  totalBytes : running count of notification bytes received on the link
+*
+* Return:
+*  sweep_action_t : BLE operation the caller must start. When the operation
+*                   cannot be started, the caller feeds SWEEP_EVT_API_ERROR.
+*
+*******************************************************************************/
+sweep_action_t Sweep_HandleEvent(sweep_event_t event, uint32_t nowUs, uint32_t totalBytes)
+{
+    sweep_action_t action = SWEEP_ACTION_NONE;
+    
+    if(event == SWEEP_EVT_DISCONNECTED)
+    {
+        linkUp          = false;
+        phyApplied      = false;
+        txOctetsApplied = false;
+        connIntvApplied = false;
+        
+        switch(sweepState)
+        {
+            case SWEEP_STATE_WAIT_DISCONNECT:
+                EnterState(SWEEP_STATE_WAIT_LINK, nowUs);
+                return SWEEP_ACTION_CONNECT;
+            
+            case SWEEP_STATE_WAIT_LINK:
+                /* Connection attempt failed; try again */
+                return SWEEP_ACTION_CONNECT;
+            
+            case SWEEP_STATE_DONE:
+                return SWEEP_ACTION_DONE;
+            
+            case SWEEP_STATE_IDLE:
+            case SWEEP_STATE_REPORT:
+                return SWEEP_ACTION_NONE;
+            
+            default:
+                /* Link lost in the middle of the cell */
+                result.status = SWEEP_STATUS_ERROR;
+                EnterState(SWEEP_STATE_REPORT, nowUs);
+                return SWEEP_ACTION_REPORT;
+        }
+    }
+    
+    switch(sweepState)
+    {
+        case SWEEP_STATE_IDLE:
+            if(event == SWEEP_EVT_START)
+            {
+                action = StartCell(nowUs);
+            }
+            break;
+        
+        case SWEEP_STATE_WAIT_LINK:
+            if(event == SWEEP_EVT_LINK_READY)
+            {
+                linkUp      = true;
+                applied.mtu = cell.mtu;
+                action = NextUpdate(nowUs);
+            }
+            break;
+        
+        case SWEEP_STATE_WAIT_PHY:
+        case SWEEP_STATE_WAIT_DATA_LENGTH:
+        case SWEEP_STATE_WAIT_CONN_PARAM:
+            if(((sweepState == SWEEP_STATE_WAIT_PHY)         && (event == SWEEP_EVT_PHY_DONE))         ||
+               ((sweepState == SWEEP_STATE_WAIT_DATA_LENGTH) && (event == SWEEP_EVT_DATA_LENGTH_DONE)) ||
+               ((sweepState == SWEEP_STATE_WAIT_CONN_PARAM)  && (event == SWEEP_EVT_CONN_PARAM_DONE)))
+            {
+                action = UpdateFinished(SWEEP_STATUS_OK, nowUs);
+            }
+            else if(event == SWEEP_EVT_API_ERROR)
+            {
+                action = UpdateFinished(SWEEP_STATUS_ERROR, nowUs);
+            }
+            else if((event == SWEEP_EVT_TICK) && 
+                    ((nowUs - stateEnteredUs) >= SWEEP_APPLY_TIMEOUT_US))
+            {
+                action = UpdateFinished(SWEEP_STATUS_TIMEOUT, nowUs);
+            }
+            else
+            {
+                /* Keep waiting */
+            }
+            break;
+        
+        case SWEEP_STATE_SETTLE:
+            if((event == SWEEP_EVT_TICK) && ((nowUs - stateEnteredUs) >= SWEEP_SETTLE_US))
+            {
+                measureStartBytes = totalBytes;
+                EnterState(SWEEP_STATE_MEASURE, nowUs);
+            }
+            break;
+        
+        case SWEEP_STATE_MEASURE:
+            if((event == SWEEP_EVT_TICK) && ((nowUs - stateEnteredUs) >= SWEEP_MEASURE_US))
+            {
+                result.bytes      = totalBytes - measureStartBytes;
+                result.durationUs = nowUs - stateEnteredUs;
+                
+                /* Bytes per second >> 7, the 1024 bit kbps the throughput 
+                *  report uses */
+                result.kbps = (uint32_t)((((uint64_t)result.bytes * 1000000u) >> 7u) / 
+                                          result.durationUs);
+                
+                EnterState(SWEEP_STATE_REPORT, nowUs);
+                action = SWEEP_ACTION_REPORT;
+            }
+            break;
+        
+        case SWEEP_STATE_REPORT:
+            /* The result has been reported; move on to the next cell */
+            if(event == SWEEP_EVT_TICK)
+            {
+                cellIndex++;
+                action = StartCell(nowUs);
+            }
+            break;
+        
+        case SWEEP_STATE_WAIT_DISCONNECT:
+            if(event == SWEEP_EVT_API_ERROR)
+            {
+                /* Could not close the link; skip the cell */
+                result.status = SWEEP_STATUS_ERROR;
+                EnterState(SWEEP_STATE_REPORT, nowUs);
+                action = SWEEP_ACTION_REPORT;
+            }
+            break;
+        
+        case SWEEP_STATE_DONE:
+        default:
+            break;
+    }
+    
+    return action;
+}
+
+/*******************************************************************************
+* Function Name: Sweep_GetCell()
+********************************************************************************
+* Summary:
+*  Returns the link parameters of the current cell.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  const sweep_cell_t * : current cell
+*
+*******************************************************************************/
+const sweep_cell_t *Sweep_GetCell(void)
+{
+    return &cell;
+}
+
+/*******************************************************************************
+* Function Name: Sweep_GetResult()
+********************************************************************************
+* Summary:
+*  Returns the result of the last measured cell. Valid after 
+*  SWEEP_ACTION_REPORT.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  const sweep_result_t * : last result
+*
+*******************************************************************************/
+const sweep_result_t *Sweep_GetResult(void)
+{
+    return &result;
+}
+
+/*******************************************************************************
+* Function Name: Sweep_GetCellCount()
+********************************************************************************
+* Summary:
+*  Returns the number of cells in the sweep matrix.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint16_t : number of cells
+*
+*******************************************************************************/
+uint16_t Sweep_GetCellCount(void)
+{
+    return SWEEP_CELL_COUNT;
+}
+
+#endif /* CY_BLE_HOST_CORE */
+
+/* [] END OF FILE */
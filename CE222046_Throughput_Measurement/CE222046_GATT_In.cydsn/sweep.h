@@ -0,0 +1,141 @@
+/*******************************************************************************
+* File Name: sweep.h
+*
+* Version: 1.10
+*
+* Description: This file is the public interface of sweep.c. It declares the
+*              link parameter sweep state machine of the GATT client.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Time allowed for a parameter update to complete before the cell is 
+   measured anyway and reported with SWEEP_STATUS_TIMEOUT */
+#define SWEEP_APPLY_TIMEOUT_US      (3000000u)
+
+/* Time between the last parameter update and the start of the measurement */
+#define SWEEP_SETTLE_US             (1000000u)
+
+/* Length of the timed transfer of every cell */
+#define SWEEP_MEASURE_US            (5000000u)
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+/* PHY of a sweep cell */
+typedef enum
+{
+    SWEEP_PHY_1M,
+    SWEEP_PHY_2M,
+    SWEEP_PHY_CODED
+} sweep_phy_t;
+
+/* Link parameters of a sweep cell */
+typedef struct
+{
+    uint16_t    mtu;
+    sweep_phy_t phy;
+    uint16_t    txOctets;       /* LL data length, in bytes */
+    uint16_t    connIntv;       /* connection interval, in 1.25 ms units */
+} sweep_cell_t;
+
+/* Events fed into the sweep state machine */
+typedef enum
+{
+    SWEEP_EVT_START,            /* BLE stack is on */
+    SWEEP_EVT_LINK_READY,       /* connected, MTU exchanged, notifications on */
+    SWEEP_EVT_PHY_DONE,         /* PHY update completed */
+    SWEEP_EVT_DATA_LENGTH_DONE, /* data length update completed */
+    SWEEP_EVT_CONN_PARAM_DONE,  /* connection parameter update completed */
+    SWEEP_EVT_API_ERROR,        /* the last requested action failed */
+    SWEEP_EVT_DISCONNECTED,     /* link lost or closed */
+    SWEEP_EVT_TICK              /* main loop pass */
+} sweep_event_t;
+
+/* Actions requested by the sweep state machine */
+typedef enum
+{
+    SWEEP_ACTION_NONE,
+    SWEEP_ACTION_CONNECT,       /* connect and exchange Sweep_GetCell()->mtu */
+    SWEEP_ACTION_SET_PHY,
+    SWEEP_ACTION_SET_DATA_LENGTH,
+    SWEEP_ACTION_SET_CONN_PARAM,
+    SWEEP_ACTION_DISCONNECT,
+    SWEEP_ACTION_REPORT,        /* Sweep_GetResult() holds a new result */
+    SWEEP_ACTION_DONE           /* all cells have been measured */
+} sweep_action_t;
+
+/* Outcome of a sweep cell */
+typedef enum
+{
+    SWEEP_STATUS_OK,
+    SWEEP_STATUS_TIMEOUT,       /* a parameter update did not complete */
+    SWEEP_STATUS_ERROR,         /* a parameter update was rejected or the 
+                                   link was lost */
+} sweep_status_t;
+
+/* Result of a sweep cell */
+typedef struct
+{
+    uint16_t       cellIndex;
+    sweep_cell_t   cell;
+    uint32_t       bytes;
+    uint32_t       durationUs;
+    uint32_t       kbps;
+    sweep_status_t status;
+} sweep_result_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void                  Sweep_Init(void);
+sweep_action_t        Sweep_HandleEvent(sweep_event_t event, uint32_t nowUs, 
+                                        uint32_t totalBytes);
+const sweep_cell_t   *Sweep_GetCell(void);
+const sweep_result_t *Sweep_GetResult(void);
+uint16_t              Sweep_GetCellCount(void);
+
+#endif /* SWEEP_H */
+
+/* [] END OF FILE */
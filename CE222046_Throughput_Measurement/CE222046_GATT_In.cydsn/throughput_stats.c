@@ -0,0 +1,356 @@
+/*******************************************************************************
+* File Name: throughput_stats.c
+*
+* Version: 1.10
+*
+* Description: This file implements the per-link and aggregate throughput
+*              accounting used by the GATT client. Byte counters are written
+*              only from the BLE event context and sampled from the timer ISR,
+*              so no critical sections are needed. It has no dependency on the
+*              BLE component.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "project.h"
+#include "throughput_stats.h"
+
+#if CY_BLE_HOST_CORE
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+/* Running byte count per link. Written only from the BLE event context. */
+static volatile uint32_t linkTotalBytes[THROUGHPUT_MAX_LINKS];
+static volatile uint32_t linkTotalTxBytes[THROUGHPUT_MAX_LINKS];
+
+/* Link state. Written from the BLE event context, read by the timer ISR. */
+static volatile bool     linkActive[THROUGHPUT_MAX_LINKS];
+static volatile bool     linkPartial[THROUGHPUT_MAX_LINKS];
+
+/* Byte count at the start of the current window. Owned by the timer ISR. */
+static uint32_t          linkWindowBase[THROUGHPUT_MAX_LINKS];
+static uint32_t          linkTxWindowBase[THROUGHPUT_MAX_LINKS];
+
+/* Values latched by the timer ISR at the end of each window */
+static volatile uint32_t latchedBytes[THROUGHPUT_MAX_LINKS];
+static volatile uint32_t latchedTxBytes[THROUGHPUT_MAX_LINKS];
+static volatile bool     latchedActive[THROUGHPUT_MAX_LINKS];
+static volatile bool     latchedPartial[THROUGHPUT_MAX_LINKS];
+static volatile bool     reportReady;
+
+/* Window configuration */
+static uint32_t          windowSeconds;
+static uint32_t          windowTicks;
+static volatile uint32_t tickCount;
+
+/*******************************************************************************
+* Function Name: Throughput_Init()
+********************************************************************************
+* Summary:
+*  Resets all counters and configures the measurement window.
+*
+* Parameters:
+*  timerPeriodSec : period of the timer that calls Throughput_TimerTick()
+*  windowPeriods  : number of timer periods in one measurement window
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_Init(uint32_t timerPeriodSec, uint32_t windowPeriods)
+{
+    uint8_t link;
+    
+    for(link = 0u; link < THROUGHPUT_MAX_LINKS; link++)
+    {
+        linkTotalBytes[link] = 0u;
+        linkTotalTxBytes[link] = 0u;
+        linkActive[link]     = false;
+        linkPartial[link]    = false;
+        linkWindowBase[link] = 0u;
+        linkTxWindowBase[link] = 0u;
+        latchedBytes[link]   = 0u;
+        latchedTxBytes[link] = 0u;
+        latchedActive[link]  = false;
+        latchedPartial[link] = false;
+    }
+    
+    windowTicks   = (windowPeriods != 0u) ? windowPeriods : 1u;
+    windowSeconds = timerPeriodSec * windowTicks;
+    tickCount     = 0u;
+    reportReady   = false;
+}
+
+/*******************************************************************************
+* Function Name: Throughput_LinkOpen()
+********************************************************************************
+* Summary:
+*  Starts accounting for a link. The link is reported as partial until the
+*  first full window after it was opened.
+*
+* Parameters:
+*  link : index of the link
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_LinkOpen(uint8_t link)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        linkPartial[link] = true;
+        linkActive[link]  = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: Throughput_LinkClose()
+********************************************************************************
+* Summary:
+*  Stops accounting for a link. The link is still reported, as partial, for
+*  the window in which it was closed, since its bytes count in that window.
+*
+* Parameters:
+*  link : index of the link
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_LinkClose(uint8_t link)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        linkPartial[link] = true;
+        linkActive[link]  = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: Throughput_AddBytes()
+********************************************************************************
+* Summary:
+*  Adds the received bytes to the link counter. Must be called from the BLE
+*  event context only.
+*
+* Parameters:
+*  link : index of the link
+*  len  : number of bytes received
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_AddBytes(uint8_t link, uint32_t len)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        linkTotalBytes[link] += len;
+    }
+}
+
+/*******************************************************************************
+* Function Name: Throughput_GetTotalBytes()
+********************************************************************************
+* Summary:
+*  Returns the running count of bytes received on a link. Must be called from
+*  the BLE event context only. The count wraps around at 2^32.
+*
+* Parameters:
+*  link : index of the link
+*
+* Return:
+*  uint32_t : number of bytes received since Throughput_Init()
+*
+*******************************************************************************/
+uint32_t Throughput_GetTotalBytes(uint8_t link)
+{
+    return (link < THROUGHPUT_MAX_LINKS) ? linkTotalBytes[link] : 0u;
+}
+
+/*******************************************************************************
+* Function Name: Throughput_AddTxBytes()
+********************************************************************************
+* Summary:
+*  Adds the bytes accepted by the stack for transmission to the link uplink 
+*  counter. Must be called from the main loop or the BLE event context only.
+*
+* Parameters:
+*  link : index of the link
+*  len  : number of bytes sent
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_AddTxBytes(uint8_t link, uint32_t len)
+{
+    if(link < THROUGHPUT_MAX_LINKS)
+    {
+        linkTotalTxBytes[link] += len;
+    }
+}
+
+/*******************************************************************************
+* Function Name: Throughput_TimerTick()
+********************************************************************************
+* Summary:
+*  Called from the timer ISR once per timer period. At the end of each window
+*  the number of bytes received and sent on every link is latched for the
+*  main loop.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Throughput_TimerTick(void)
+{
+    uint8_t link;
+    uint32_t total;
+    
+    tickCount++;
+    if(tickCount >= windowTicks)
+    {
+        tickCount = 0u;
+        
+        for(link = 0u; link < THROUGHPUT_MAX_LINKS; link++)
+        {
+            /* Unsigned subtraction handles wrap-around of the running count */
+            total = linkTotalBytes[link];
+            latchedBytes[link]   = total - linkWindowBase[link];
+            linkWindowBase[link] = total;
+            
+            total = linkTotalTxBytes[link];
+            latchedTxBytes[link]   = total - linkTxWindowBase[link];
+            linkTxWindowBase[link] = total;
+            
+            latchedActive[link]  = linkActive[link] || linkPartial[link];
+            latchedPartial[link] = linkPartial[link];
+            linkPartial[link]    = false;
+        }
+        
+        reportReady = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: Throughput_GetReport()
+********************************************************************************
+* Summary:
+*  Builds the report for the last completed window. Called from the main loop
+*  so that the divisions and the UART output stay out of the ISR.
+*
+* Parameters:
+*  report : report to be filled
+*
+* Return:
+*  bool : true if a new report was available
+*
+* Theory:
+*  The throughput in kbps is the number of bytes divided by the window length,
+*  converted to kilobytes by dividing by 1024 and to kilobits by multiplying
+*  by 8.
+*
+*******************************************************************************/
+bool Throughput_GetReport(throughput_report_t *report)
+{
+    uint8_t link;
+    uint32_t kbps;
+    uint32_t sumKbps = 0u;
+    
+    if(!reportReady)
+    {
+        return false;
+    }
+    reportReady = false;
+    
+    report->windowSec     = windowSeconds;
+    report->linkCount     = 0u;
+    report->aggregateKbps = 0u;
+    report->aggregateTxKbps = 0u;
+    report->minKbps       = UINT32_MAX;
+    report->maxKbps       = 0u;
+    report->meanKbps      = 0u;
+    
+    for(link = 0u; link < THROUGHPUT_MAX_LINKS; link++)
+    {
+        kbps = (latchedBytes[link] >> 7u) / windowSeconds;
+        
+        report->linkActive[link]  = latchedActive[link];
+        report->linkPartial[link] = latchedPartial[link];
+        report->linkKbps[link]    = kbps;
+        report->aggregateKbps    += kbps;
+        
+        report->linkTxKbps[link]  = (latchedTxBytes[link] >> 7u) / windowSeconds;
+        report->aggregateTxKbps  += report->linkTxKbps[link];
+        
+        /* Links that connected or dropped during the window do not count
+           towards min/max/mean */
+        if(latchedActive[link] && !latchedPartial[link])
+        {
+            report->linkCount++;
+            sumKbps += kbps;
+            if(kbps < report->minKbps)
+            {
+                report->minKbps = kbps;
+            }
+            if(kbps > report->maxKbps)
+            {
+                report->maxKbps = kbps;
+            }
+        }
+    }
+    
+    if(report->linkCount != 0u)
+    {
+        report->meanKbps = sumKbps / report->linkCount;
+    }
+    else
+    {
+        report->minKbps = 0u;
+    }
+    
+    return true;
+}
+
+#endif /* CY_BLE_HOST_CORE */
+
+/* [] END OF FILE */
@@ -0,0 +1,107 @@
+/*******************************************************************************
+* File Name: throughput_stats.h
+*
+* Version: 1.10
+*
+* Description: This file is the public interface of throughput_stats.c. It
+*              declares the per-link and aggregate throughput accounting used
+*              by the GATT client.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef THROUGHPUT_STATS_H
+#define THROUGHPUT_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Maximum number of GATT Out peripherals that can be accounted at once */
+#define THROUGHPUT_MAX_LINKS        (4u)
+
+/* Link index returned when a connection is not tracked */
+#define THROUGHPUT_INVALID_LINK     (0xFFu)
+
+/*******************************************************************************
+* Data types
+*******************************************************************************/
+/* Throughput report for one measurement window */
+typedef struct
+{
+    /* Length of the measurement window in seconds */
+    uint32_t windowSec;
+    
+    /* Number of links that were connected for the whole window */
+    uint8_t  linkCount;
+    
+    /* Per-link state and throughput in kbps. A link is active if it was
+       connected during the window, and partial if it connected or dropped
+       during the window; the aggregate is the sum over the active links. */
+    bool     linkActive[THROUGHPUT_MAX_LINKS];
+    bool     linkPartial[THROUGHPUT_MAX_LINKS];
+    uint32_t linkKbps[THROUGHPUT_MAX_LINKS];
+    
+    /* Per-link uplink throughput in kbps: data accepted by the stack for 
+       transmission to the peer */
+    uint32_t linkTxKbps[THROUGHPUT_MAX_LINKS];
+    
+    /* Aggregate throughput of all links, including partial ones */
+    uint32_t aggregateKbps;
+    uint32_t aggregateTxKbps;
+    
+    /* Statistics over the links that were connected for the whole window */
+    uint32_t minKbps;
+    uint32_t maxKbps;
+    uint32_t meanKbps;
+} throughput_report_t;
+
+/*******************************************************************************
+*        Function Prototypes
+*******************************************************************************/
+void Throughput_Init(uint32_t timerPeriodSec, uint32_t windowPeriods);
+void Throughput_LinkOpen(uint8_t link);
+void Throughput_LinkClose(uint8_t link);
+void Throughput_AddBytes(uint8_t link, uint32_t len);
+uint32_t Throughput_GetTotalBytes(uint8_t link);
+void Throughput_AddTxBytes(uint8_t link, uint32_t len);
+void Throughput_TimerTick(void);
+bool Throughput_GetReport(throughput_report_t *report);
+
+#endif /* THROUGHPUT_STATS_H */
+
+/* [] END OF FILE */
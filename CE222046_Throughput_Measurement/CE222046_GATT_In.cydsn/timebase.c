@@ -0,0 +1,141 @@
+/*******************************************************************************
+* File Name: timebase.c
+*
+* Version: 1.10
+*
+* Description: This file implements a free-running 32-bit microsecond timebase
+*              on top of the Cortex-M4 DWT cycle counter. No hardware component
+*              is needed.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+#include "project.h"
+#include "timebase.h"
+
+#if CY_BLE_HOST_CORE
+
+#if !(CY_CPU_CORTEX_M4)
+#error "The timebase uses the DWT cycle counter, which is only available on CM4"
+#endif
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+static uint32_t cyclesPerUs;
+static uint32_t lastCycles;
+static uint32_t cycleRemainder;
+static uint32_t usCount;
+
+/*******************************************************************************
+* Function Name: Timebase_Start()
+********************************************************************************
+* Summary:
+*  Enables the DWT cycle counter and resets the timebase.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Timebase_Start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    
+    cyclesPerUs    = SystemCoreClock / 1000000u;
+    lastCycles     = 0u;
+    cycleRemainder = 0u;
+    usCount        = 0u;
+}
+
+/*******************************************************************************
+* Function Name: Timebase_GetUs()
+********************************************************************************
+* Summary:
+*  Returns the time in microseconds since Timebase_Start() was called.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : time in microseconds, wraps around after about 71 minutes
+*
+* Theory:
+*  The cycle counter wraps around in less than a minute, so the elapsed cycles
+*  are accumulated into a microsecond count on every call. The function must
+*  be called at least once per cycle counter period, which the main loop of 
+*  this example always does. It must not be called from an interrupt.
+*
+*******************************************************************************/
+uint32_t Timebase_GetUs(void)
+{
+    uint32_t now = DWT->CYCCNT;
+    
+    cycleRemainder += now - lastCycles;
+    lastCycles = now;
+    
+    usCount        += cycleRemainder / cyclesPerUs;
+    cycleRemainder %= cyclesPerUs;
+    
+    return usCount;
+}
+
+/*******************************************************************************
+* Function Name: Timebase_GetCycles()
+********************************************************************************
+* Summary:
+*  Returns the raw CPU cycle counter, for timing short code sections. Unlike
+*  Timebase_GetUs() it may be called from anywhere.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : CPU cycle count; differences are valid across one wrap-around
+*
+*******************************************************************************/
+uint32_t Timebase_GetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+#endif /* CY_BLE_HOST_CORE */
+
+/* [] END OF FILE */
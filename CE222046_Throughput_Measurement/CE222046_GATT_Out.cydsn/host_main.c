@@ -6,7 +6,9 @@
 * Description: This is the source code for BLE GATT Server with custom 
 *              throughput service. The BLE sends notification data to the BLE
 *              GATT client device which is used by the client for BLE 
-*              throughput measurement. 
+*              throughput measurement. In the uplink and duplex modes it also
+*              counts the Write Without Response data sent by the client and
+*              reports the uplink throughput. 
 *
 * Related Document: CE222046_Throughput_Measurement.pdf
 *
@@ -46,7 +48,11 @@
 
 #include "project.h"
 #include "stdio_user.h"
+#include "timebase.h"
+#include "payload.h"
+#include "crc32.h"
 #include <stdio.h>
+#include <string.h>
 
 
 #if CY_BLE_HOST_CORE   
@@ -68,12 +74,48 @@
 #define DEFAULT_MTU_SIZE            (23) 
 #define NOTIFICATION_PKT_SIZE       (495)
 #define SUCCESS                     (0u)
-#define TARGET_BDADDR       {{0xFF, 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0}
+/* Index of this device when the GATT In client connects to several GATT Out
+   devices at once. Each device must be built with a different index; index n
+   matches entry n of TARGET_BDADDR_LIST in the GATT In project. */
+#define DEVICE_INDEX                (0u)
+#define TARGET_BDADDR       {{(0xFF - DEVICE_INDEX), 0xBB, 0xAA, 0x50, 0xA0, 0x00}, 0}
 #define CUSTOM_SERV0_CHAR0_DESC0_HANDLE     cy_ble_customConfig.customs[0]\
                                         .customServInfo[0].customServCharDesc[0] 
 #define CUSTOM_SERV0_CHAR0_HANDLE           cy_ble_customConfig.customs[0]\
                                         .customServInfo[0].customServCharHandle 
 
+/* Maximum number of notifications queued to the stack by one pass of the
+   notification pump. The pump stops earlier when the stack reports busy. */
+#define PUMP_MAX_IN_FLIGHT          (8u)
+
+/* Set to ENABLE to print the notification pump counters periodically */
+#define PUMP_REPORT_ENABLE          DISABLE
+#define PUMP_REPORT_PERIOD_US       (10000000u)
+
+/* Direction of the data transfer. Must match TRAFFIC_MODE of the GATT In
+   project.
+   TRAFFIC_MODE_DOWNLINK : the server sends notifications to the client
+   TRAFFIC_MODE_UPLINK   : the client sends Write Without Response commands 
+                           to the server
+   TRAFFIC_MODE_DUPLEX   : both at the same time 
+   The Write Without Response property must be enabled for the custom 
+   characteristic in the BLE component customizer for the uplink modes. */
+#define TRAFFIC_MODE_DOWNLINK       (0u)
+#define TRAFFIC_MODE_UPLINK         (1u)
+#define TRAFFIC_MODE_DUPLEX         (2u)
+#define TRAFFIC_MODE                TRAFFIC_MODE_DOWNLINK
+
+/* Set to ENABLE to add a CRC-32 to every notification (see payload.h). Must 
+   match INTEGRITY_CHECK_ENABLE of the GATT In project. */
+#define INTEGRITY_CHECK_ENABLE      DISABLE
+
+/* Period of the uplink throughput report, in seconds */
+#define UPLINK_REPORT_PERIOD_SEC    (10u)
+#define US_PER_SEC                  (1000000u)
+
+/* Connection interval unit, in microseconds */
+#define CONN_INTERVAL_UNIT_US       (1250u)
+
 /*******************************************************************************
 * Variables
 *******************************************************************************/
@@ -84,12 +126,54 @@ cy_stc_ble_gap_bd_addr_t    local_addr = TARGET_BDADDR;
 cy_stc_ble_conn_handle_t appConnHandle;
 cy_stc_ble_gatts_handle_value_ntf_t notificationPacket;
 
+/* Sequence number stamped in the next notification */
+uint32 notificationSeq;
+
+/* Running CRC of the constant notification body */
+uint32 bodyCrc;
+
+/* Notification pump state */
+typedef struct
+{
+    /* Notifications accepted by the stack */
+    uint32 sent;
+    
+    /* Notifications rejected by the stack, e.g. because no buffer was free */
+    uint32 rejected;
+    
+    /* Number of times the stack reported busy */
+    uint32 busyEvents;
+    
+    /* Estimated connection events without notification data: the time from 
+       the stack reporting free to the next notification, in connection 
+       intervals */
+    uint32 idleConnEvents;
+    
+    /* Longest time from the stack reporting free to the next notification */
+    uint32 maxRefillUs;
+} pump_counters_t;
+
+pump_counters_t pumpCounters;
+bool   stackBusy = false;
+bool   refillPending = false;
+uint32 stackFreeTimeUs;
+uint32 connIntervalUs = CONN_INTERVAL_UNIT_US;
+
+/* Write Without Response data received from the client. Written from the BLE
+   event context, read from the main loop. */
+uint32 uplinkBytes;
+bool   uplinkActive = false;
+
 /*******************************************************************************
 *        Function Prototypes
 *******************************************************************************/
 void Ble_Init(void);
 void StackEventHandler(uint32 event, void* eventParam);
-void SendNotification(void);
+cy_en_ble_api_result_t SendNotification(void);
+void PumpNotifications(void);
+void ResetPumpCounters(void);
+void PrintPumpCounters(void);
+void PrintUplinkThroughput(void);
 
 /*******************************************************************************
 * Function Name: HostMain()
@@ -110,6 +194,13 @@ void SendNotification(void);
 *******************************************************************************/
 int HostMain(void)
 {
+#if (PUMP_REPORT_ENABLE == ENABLE)
+    uint32 lastReportUs = 0u;
+#endif
+#if (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+    uint32 lastUplinkReportUs = 0u;
+#endif
+    
     __enable_irq(); /* Enable global interrupts. */
     
     UART_Start();
@@ -131,20 +222,49 @@ int HostMain(void)
     {
         buffer[i]=i; 
     }
+    
+#if (INTEGRITY_CHECK_ENABLE == ENABLE)
+    /* Only the header changes between notifications, so the CRC of the body
+       is computed once */
+    bodyCrc = Crc32_Update(CRC32_INIT, &buffer[PAYLOAD_INTEGRITY_HEADER_SIZE], 
+                           NOTIFICATION_PKT_SIZE - PAYLOAD_INTEGRITY_HEADER_SIZE);
+#endif
+    
+    /* Timebase used to stamp the notifications */
+    Timebase_Start();
+    
     for(;;)
     {
         /* Cy_Ble_ProcessEvents() allows BLE stack to process pending events */
         Cy_BLE_ProcessEvents();
         
+        /* Keep the timebase running between notifications */
+        (void)Timebase_GetUs();
+        
+    #if (TRAFFIC_MODE != TRAFFIC_MODE_DOWNLINK)
+        if((Timebase_GetUs() - lastUplinkReportUs) >= (UPLINK_REPORT_PERIOD_SEC * US_PER_SEC))
+        {
+            lastUplinkReportUs = Timebase_GetUs();
+            PrintUplinkThroughput();
+        }
+    #endif
+        
+    #if (TRAFFIC_MODE != TRAFFIC_MODE_UPLINK)
         if(charNotificationEnabled == true)
         {
-            if(Cy_BLE_GATT_GetBusyStatus(appConnHandle.attId) ==\
-               CY_BLE_STACK_STATE_FREE)
+            /* Top up the stack buffers with notification data for the 
+               GATT Client */
+            PumpNotifications();
+            
+        #if (PUMP_REPORT_ENABLE == ENABLE)
+            if((Timebase_GetUs() - lastReportUs) >= PUMP_REPORT_PERIOD_US)
             {
-                /* Send notification data to the GATT Client*/
-                SendNotification();
+                lastReportUs = Timebase_GetUs();
+                PrintPumpCounters();
             }
+        #endif
         }
+    #endif
     }
 }
 
@@ -265,6 +385,20 @@ void StackEventHandler(uint32 event, void* eventParam)
         {
 			DEBUG_BLE("CY_BLE_EVT_STACK_BUSY_STATUS: %x\r\n", *(uint8 *)eventParam);
             
+            if(*(uint8 *)eventParam == CY_BLE_STACK_STATE_BUSY)
+            {
+                stackBusy = true;
+                pumpCounters.busyEvents++;
+            }
+            else
+            {
+                /* Buffers have been freed; the pump refills them on its next
+                   pass and measures how long that took */
+                stackBusy = false;
+                refillPending = true;
+                stackFreeTimeUs = Timebase_GetUs();
+            }
+            
 			break;
 		}
         /* This event indicates completion of Set LE event mask. */
@@ -370,6 +504,8 @@ void StackEventHandler(uint32 event, void* eventParam)
             PWM_Disable();
             Cy_GPIO_Write(LED_ConnectStatus_0_PORT, LED_ConnectStatus_0_NUM, 0);
             DEBUG_BLE("\r\nBDhandle : 0x%02X\r\n", param->bdHandle);
+            
+            connIntervalUs = (uint32)param->connIntv * CONN_INTERVAL_UNIT_US;
                 
             break;
         }
@@ -409,6 +545,9 @@ void StackEventHandler(uint32 event, void* eventParam)
 		{
 			DEBUG_BLE("CY_BLE_EVT_GAP_DEVICE_CONNECTED \r\n");
             charNotificationEnabled = false;
+            notificationSeq = 0u;
+            uplinkBytes = 0u;
+            uplinkActive = false;
                       
             break;
 		}            
@@ -436,6 +575,13 @@ void StackEventHandler(uint32 event, void* eventParam)
 		{
 			DEBUG_BLE("CY_BLE_EVT_GAP_CONNECTION_UPDATE_COMPLETE \r\n");
             
+            cy_stc_ble_gap_conn_param_updated_in_controller_t *param = \
+            (cy_stc_ble_gap_conn_param_updated_in_controller_t *)eventParam;
+            if(param->status == SUCCESS)
+            {
+                connIntervalUs = (uint32)param->connIntv * CONN_INTERVAL_UNIT_US;
+            }
+            
             break;
 		}
         /* This event indicates completion of the Cy_BLE_SetPhy API*/
@@ -527,6 +673,9 @@ void StackEventHandler(uint32 event, void* eventParam)
             DEBUG_BLE("CY_BLE_EVT_GATT_DISCONNECT_IND \r\n");
             if(appConnHandle.bdHandle == (*(cy_stc_ble_conn_handle_t *)eventParam).bdHandle)
             {
+            #if (PUMP_REPORT_ENABLE == ENABLE)
+                PrintPumpCounters();
+            #endif
                 printf("Disconnected. \r\n\n");
                 appConnHandle.bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;
                 appConnHandle.attId    = CY_BLE_INVALID_CONN_HANDLE_VALUE;
@@ -581,6 +730,7 @@ void StackEventHandler(uint32 event, void* eventParam)
                     charNotificationEnabled = attr_param.handleValuePair.value.val[0];
                     DEBUG_BLE("charNotificationEnabled = %d\r\n", charNotificationEnabled);
                     printf("Notification Enabled.\r\n\n");
+                    ResetPumpCounters();
                     notificationPacket.connHandle = appConnHandle;
                     notificationPacket.handleValPair.attrHandle = CUSTOM_SERV0_CHAR0_HANDLE;
                     notificationPacket.handleValPair.value.val = buffer;
@@ -589,6 +739,20 @@ void StackEventHandler(uint32 event, void* eventParam)
             }
             break;
         }
+        /* This event is triggered when a Write Without Response command is 
+           received from the Client device */
+        case CY_BLE_EVT_GATTS_WRITE_CMD_REQ:
+        {
+            cy_stc_ble_gatts_write_cmd_req_param_t *write_cmd_param = \
+            (cy_stc_ble_gatts_write_cmd_req_param_t *)eventParam;
+            
+            if(write_cmd_param->handleValPair.attrHandle == CUSTOM_SERV0_CHAR0_HANDLE)
+            {
+                uplinkBytes += write_cmd_param->handleValPair.value.len;
+                uplinkActive = true;
+            }
+            break;
+        }
         case CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ:
         {
             DEBUG_BLE("CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ \r\n");  
@@ -614,14 +778,36 @@ void StackEventHandler(uint32 event, void* eventParam)
 * None
 *
 * Return:
-* None
+* cy_en_ble_api_result_t: result of Cy_BLE_GATTS_Notification()
+*
+* Theory:
+* The payload header is stamped with the sequence number and the current
+* timebase (see payload.h) so that the client can measure latency and lost
+* notifications. With the integrity check enabled the CRC is completed over 
+* the header. The BLE stack copies the payload, so the buffer can be 
+* stamped again for the next notification.
 *
 *******************************************************************************/
-void SendNotification(void)
+cy_en_ble_api_result_t SendNotification(void)
 {
     cy_en_ble_api_result_t apiResult;
+#if (INTEGRITY_CHECK_ENABLE == ENABLE)
+    uint32_t crc;
+#endif
+    
+    Payload_PutU32(buffer, PAYLOAD_SEQ_OFFSET, notificationSeq);
+    Payload_PutU32(buffer, PAYLOAD_TIME_OFFSET, Timebase_GetUs());
+#if (INTEGRITY_CHECK_ENABLE == ENABLE)
+    crc = Crc32_Update(bodyCrc, buffer, PAYLOAD_CRC_OFFSET) ^ CRC32_FINAL_XOR;
+    Payload_PutU32(buffer, PAYLOAD_CRC_OFFSET, crc);
+#endif
+    
     apiResult = Cy_BLE_GATTS_Notification(&notificationPacket);
-    if(apiResult == CY_BLE_ERROR_INVALID_PARAMETER)
+    if(apiResult == CY_BLE_SUCCESS)
+    {
+        notificationSeq++;
+    }
+    else if(apiResult == CY_BLE_ERROR_INVALID_PARAMETER)
     {
         DEBUG_BLE("Couldn't send notification. [CY_BLE_ERROR_INVALID_PARAMETER]\r\n");
     }
@@ -631,6 +817,138 @@ void SendNotification(void)
             "0x%2.2x \r\n", notificationPacket.handleValPair.attrHandle, apiResult);
     }
     
+    return apiResult;
+}
+
+/*******************************************************************************
+* Function Name: PumpNotifications()
+********************************************************************************
+* Summary:
+* Queues notifications to the stack until the stack is busy or 
+* PUMP_MAX_IN_FLIGHT notifications have been queued in this pass.
+*
+* Parameters:
+* None
+*
+* Return:
+* None
+*
+* Theory:
+* The stack reports CY_BLE_EVT_STACK_BUSY_STATUS when its buffers fill up and
+* again when they drain. Between two events the busy state is polled after 
+* every notification, so the controller queue is kept full instead of being
+* filled in bursts. The time from the stack reporting free to the next 
+* notification is the window in which the controller may run out of data; it
+* is converted into an estimate of idle connection events.
+*
+*******************************************************************************/
+void PumpNotifications(void)
+{
+    uint32 queued;
+    uint32 refillUs;
+    
+    for(queued = 0u; (queued < PUMP_MAX_IN_FLIGHT) && (stackBusy == false); queued++)
+    {
+        if(Cy_BLE_GATT_GetBusyStatus(appConnHandle.attId) != CY_BLE_STACK_STATE_FREE)
+        {
+            stackBusy = true;
+            break;
+        }
+        
+        if(SendNotification() != CY_BLE_SUCCESS)
+        {
+            pumpCounters.rejected++;
+            break;
+        }
+        pumpCounters.sent++;
+        
+        if(refillPending)
+        {
+            refillPending = false;
+            refillUs = Timebase_GetUs() - stackFreeTimeUs;
+            if(refillUs > pumpCounters.maxRefillUs)
+            {
+                pumpCounters.maxRefillUs = refillUs;
+            }
+            pumpCounters.idleConnEvents += refillUs / connIntervalUs;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: ResetPumpCounters()
+********************************************************************************
+* Summary:
+* Clears the notification pump counters.
+*
+* Parameters:
+* None
+*
+* Return:
+* None
+*
+*******************************************************************************/
+void ResetPumpCounters(void)
+{
+    memset(&pumpCounters, 0, sizeof(pumpCounters));
+    stackBusy = false;
+    refillPending = false;
+}
+
+/*******************************************************************************
+* Function Name: PrintPumpCounters()
+********************************************************************************
+* Summary:
+* Prints the notification pump counters on the UART.
+*
+* Parameters:
+* None
+*
+* Return:
+* None
+*
+*******************************************************************************/
+void PrintPumpCounters(void)
+{
+    printf("Pump: sent %lu, rejected %lu, busy %lu, idle conn events %lu, "
+           "max refill %lu us\r\n", (unsigned long)pumpCounters.sent, 
+           (unsigned long)pumpCounters.rejected, (unsigned long)pumpCounters.busyEvents,
+           (unsigned long)pumpCounters.idleConnEvents, 
+           (unsigned long)pumpCounters.maxRefillUs);
+}
+
+/*******************************************************************************
+* Function Name: PrintUplinkThroughput()
+********************************************************************************
+* Summary:
+*  Prints the throughput of the Write Without Response data received since
+*  the last report and restarts the count.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The throughput in kbps is the number of bytes divided by the report period,
+*  converted to kilobytes by dividing by 1024 and to kilobits by multiplying
+*  by 8, the same as in the GATT In project.
+*
+*******************************************************************************/
+void PrintUplinkThroughput(void)
+{
+    uint32 bytes;
+    
+    /* The count is updated from Cy_BLE_ProcessEvents() in this same loop */
+    bytes = uplinkBytes;
+    uplinkBytes = 0u;
+    
+    if(uplinkActive)
+    {
+        printf("Uplink throughput is: %lu kbps. \r\n", 
+               (unsigned long)((bytes >> 7u) / UPLINK_REPORT_PERIOD_SEC));
+    }
 }
 
 #endif /* CY_BLE_HOST_CORE */
@@ -0,0 +1,91 @@
+/*******************************************************************************
+* File Name: payload.h
+*
+* Version: 1.10
+*
+* Description: This file defines the layout of the notification payload
+*              exchanged between the GATT Out server and the GATT In client.
+*
+* Related Document: CE222046_Throughput_Measurement.pdf
+*
+* Hardware Dependency: See CE222046_Throughput_Measurement.pdf
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+#ifndef PAYLOAD_H
+#define PAYLOAD_H
+
+#include <stdint.h>
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/**
+ * Every notification starts with a header stamped by the GATT Out server:
+ *  - bytes 0..3 : sequence number, incremented for every notification sent
+ *  - bytes 4..7 : server timebase in microseconds when the notification was
+ *                 queued to the BLE stack
+ * When the integrity check is enabled (INTEGRITY_CHECK_ENABLE in both 
+ * projects) the header is followed by:
+ *  - bytes 8..11 : CRC-32 (see crc32.h) of the body (bytes 12 to the end)
+ *                  followed by bytes 0..7. The body comes first so that the
+ *                  server can reuse the CRC of its constant body.
+ * All fields are little endian. The remaining bytes are dummy data.
+ */
+#define PAYLOAD_SEQ_OFFSET          (0u)
+#define PAYLOAD_TIME_OFFSET         (4u)
+#define PAYLOAD_HEADER_SIZE         (8u)
+#define PAYLOAD_CRC_OFFSET          (8u)
+#define PAYLOAD_INTEGRITY_HEADER_SIZE   (12u)
+
+/* Little endian access to the payload fields */
+#define PAYLOAD_GET_U32(buf, offset)                                \
+    ((uint32_t)(buf)[(offset)]                 |                    \
+    ((uint32_t)(buf)[(offset) + 1u] << 8u)     |                    \
+    ((uint32_t)(buf)[(offset) + 2u] << 16u)    |                    \
+    ((uint32_t)(buf)[(offset) + 3u] << 24u))
+
+/*******************************************************************************
+* Inline Functions
+*******************************************************************************/
+/* A function rather than a macro, so that value is evaluated only once */
+static inline void Payload_PutU32(uint8_t *buf, uint32_t offset, uint32_t value)
+{
+    buf[offset]      = (uint8_t)value;
+    buf[offset + 1u] = (uint8_t)(value >> 8u);
+    buf[offset + 2u] = (uint8_t)(value >> 16u);
+    buf[offset + 3u] = (uint8_t)(value >> 24u);
+}
+
+#endif /* PAYLOAD_H */
+
+/* [] END OF FILE */
@@ -49,7 +49,8 @@
 #include "rgb_led_task.h"
 #include "status_led_task.h"
 #include "temperature_task.h"
-#include "math.h"
+#include "rtos_trace.h"
+#include "tx_scheduler.h"
 
 /* BLE application timeout */
 #define TIMEOUT_INTERVAL    pdMS_TO_TICKS(30000u) /* 30 sec */
@@ -57,9 +58,27 @@
 /* Queue Handle for BLE command and data */
 QueueHandle_t bleCommandDataQ;
 
+/**
+ * Task notification bits of Task_Ble. The controller interrupt only sets a 
+ * bit, so any number of interrupts that arrive before Task_Ble runs are
+ * handled by one Cy_BLE_ProcessEvents() pass and never fill bleCommandDataQ.
+ */
+#define BLE_EVENT_PROCESS_EVENTS    (0x01u)   /* Controller has pending events */
+#define BLE_EVENT_COMMAND           (0x02u)   /* Command sent over bleCommandDataQ */
+#define BLE_EVENT_ALL               (BLE_EVENT_PROCESS_EVENTS | BLE_EVENT_COMMAND)
+
+/* Handle of Task_Ble, the target of the task notifications */
+static TaskHandle_t bleTaskHandle = NULL;
+
+/* Counters of the Task_Ble wake-ups */
+static ble_wakeup_stats_t bleWakeupStats;
+
 /* Timer handles */
 TimerHandle_t xBleTimer;
 
+/* Control block of the BLE timer */
+static StaticTimer_t bleTimerBuffer;
+
 /* Variable for storing custom service data */
 uint8_t customServiceData[CUSTOM_SERVICE_128BIT_RW_SERVICE_LEN];
 uint8_t customNotificationData[CUSTOM_NOTIFICATIN_SERVICE_LEN];
@@ -67,19 +86,31 @@ uint8_t customNotificationData[CUSTOM_NOTIFICATIN_SERVICE_LEN];
 /* Variable used to maintain connection information */
 static cy_stc_ble_conn_handle_t appConnHandle[CY_BLE_CONN_COUNT];
 
+/* The connections are the links of the TX scheduler */
+#if (CY_BLE_CONN_COUNT > TX_SCHED_MAX_LINKS)
+    #error "TX_SCHED_MAX_LINKS in tx_scheduler.h is less than CY_BLE_CONN_COUNT"
+#endif
+
+/* Latest Health Thermometer Characteristic value, sent by the TX scheduler */
+static uint8_t htsCharacteristicValue[HTS_CHARACTERISTIC_SIZE];
+
+/* Connections that have not yet confirmed the last temperature indication */
+static bool htsIndicationPending[CY_BLE_CONN_COUNT];
+
 /** 
  * These static functions are used by the BLE Task. These are not available 
  * outside this file. See the respective function definitions for more 
  * details. 
  */
 static void BleControllerInterruptEventHandler(void);
+static BaseType_t ReceiveBleCommand(ble_commandAndData_t *bleCommand);
 static void StackEventHandler(uint32_t eventType, void *eventParam);
 static void CallbackHts(uint32_t eventType, void* eventParam);
 static void BleTimerCallback(TimerHandle_t xTimer);
 static void StartAdvertisement(void);
-static void SendCustomNotificatioon(void);
+static tx_sched_result_t SendToConnection(uint32_t link, tx_sched_item_t item);
 static void UpdateStatusLed(status_led_command_t redLed, status_led_command_t orangeLed);
-static void SendTemperatureIndication(float temperature);
+static void SendTemperatureIndication(int32_t temperature);
 static void HandleWriteReq_CustomService(cy_stc_ble_gatts_write_cmd_req_param_t writeReqParameter);
 static void HandleWriteReq_RgbLed(cy_stc_ble_gatts_write_cmd_req_param_t writeReqParameter);
 static void UpdateGattDB(cy_stc_ble_gatts_write_cmd_req_param_t writeReqParam);
@@ -109,19 +140,32 @@ void Task_Ble(void* pvParameters)
     /* Variable that stores BLE commands that need to be processed */
     ble_commandAndData_t bleCommandData;
     
+    /* Variable that stores the time spent in Tickless Idle */
+    tickless_idle_stats_t ticklessIdleStats;
+    
+    /* Variable that stores the counters of the TX scheduler */
+    tx_sched_stats_t txSchedStats;
+    
     /* Remove warning for unused parameter */
     (void)pvParameters;
     
+    /* Store the task handle for the task notifications */
+    bleTaskHandle = xTaskGetCurrentTaskHandle();
+    
+    /* Initialize the scheduler of the notifications and indications */
+    TxSched_Init(SendToConnection);
+    
     /** 
      * Create an RTOS timer. 
 	 * This timer is used to monitor, if no device is connected for 30 sec then
 	 * goto hibernate mode.
      */
-    xBleTimer =  xTimerCreate ("BLE Timer",         /* Timer name */
+    xBleTimer =  xTimerCreateStatic ("BLE Timer",   /* Timer name */
                                 TIMEOUT_INTERVAL,   /* Timer period = 30 sec */
                                 pdFALSE,            /* Auto reload enable */
                                 NULL,               /* Timer ID */
-                                BleTimerCallback);  /* Timer callback function */
+                                BleTimerCallback,   /* Timer callback function */
+                                &bleTimerBuffer);   /* Timer control block */
         
     /* Start the BLE component and register the stack event handler */
     bleApiResult = Cy_BLE_Start(StackEventHandler);
@@ -149,8 +193,11 @@ void Task_Ble(void* pvParameters)
     /* Repeatedly running part of the task */
     for(;;)
     {
-        /* Block until a BLE command has been received over bleCommandDataQ */
-        rtosApiResult = xQueueReceive(bleCommandDataQ, &bleCommandData, portMAX_DELAY);
+        /**
+         * Block until a BLE command has been received over bleCommandDataQ.
+         * Pending controller events are processed while waiting.
+         */
+        rtosApiResult = ReceiveBleCommand(&bleCommandData);
         
         /* Command has been received from bleCommandQ */
         if(rtosApiResult == pdTRUE)
@@ -172,15 +219,28 @@ void Task_Ble(void* pvParameters)
                 /*~~~~~~~~~~~~~~ Command to send temperature indication ~~~~~~*/
                 case SEND_TEMP_INDICATION:
                 {      
-                    /* Send temperature data over BLE HTS notification */
-                    SendTemperatureIndication(*(float*)bleCommandData.data);
+                    /* Task_Ble owns the block with the temperature now */
+                    int32_t* temperature = (int32_t*)MsgPool_Get(bleCommandData.data);
+                    
+                    if(temperature != NULL)
+                    {
+                        /* Send temperature data over BLE HTS notification */
+                        SendTemperatureIndication(*temperature);
+                        MsgPool_Free(bleCommandData.data);
+                    }
+                    else
+                    {
+                        Task_DebugPrintf("Failure! : BLE - Invalid message handle", 
+                                         bleCommandData.data);
+                    }
                     break;
                 }
                 
                 case SEND_NOTIFICATION:
                 {
-                    /* Send notification to all the connected devices */
-                    SendCustomNotificatioon();
+                    /* Send the pending notifications and indications to the
+                       connected devices */
+                    TxSched_Run();
                     break;
                 }
                 
@@ -196,6 +256,30 @@ void Task_Ble(void* pvParameters)
                     }
                     UpdateStatusLed(LED_TURN_ON, LED_TURN_OFF);
                     Cy_BLE_ProcessEvents();
+                    
+                    /* Show how well the controller interrupts were merged */
+                    Task_DebugPrintf("Info     : BLE - Controller interrupts (hex):", 
+                                     bleWakeupStats.controllerInterrupts);
+                    Task_DebugPrintf("Info     : BLE - Merged wake-ups (hex):", 
+                                     bleWakeupStats.mergedWakeups);
+                    Task_DebugPrintf("Info     : BLE - Max command queue depth (hex):", 
+                                     bleWakeupStats.maxQueueDepth);
+                    
+                    /* Show how the notifications were scheduled */
+                    TxSched_GetStats(&txSchedStats);
+                    Task_DebugPrintf("Info     : BLE - Values sent (hex):", 
+                                     txSchedStats.sent);
+                    Task_DebugPrintf("Info     : BLE - Values coalesced (hex):", 
+                                     txSchedStats.coalesced);
+                    Task_DebugPrintf("Info     : BLE - Links parked (hex):", 
+                                     txSchedStats.parked);
+                    
+                    /* Show the time spent in each Tickless Idle mode */
+                    TicklessIdleGetStats(&ticklessIdleStats);
+                    Task_DebugPrintf("Info     : RTOS - Ticks in Sleep (hex):", 
+                                     ticklessIdleStats.sleepTicks);
+                    Task_DebugPrintf("Info     : RTOS - Ticks in Deep Sleep (hex):", 
+                                     ticklessIdleStats.deepSleepTicks);
                     break;
                 }
                 
@@ -219,21 +303,27 @@ void Task_Ble(void* pvParameters)
 }
 
 /*******************************************************************************
-* Function Name: bool Task_Ble_Tickless_Idle_Readiness (void) 
+* Function Name: tickless_idle_mode_t Task_Ble_Tickless_Idle_Readiness 
+*                                     (TickType_t *ticksToDeadline) 
 ********************************************************************************
 * Summary:
 *  This function returns the Tickless Idle readiness of Task_Ble
 * 
 * Parameters: 
-*  None
+*  ticksToDeadline : Ticks until the earliest deadline of the wake sources,
+*                    not changed since the BLE controller wakes up the CPU
 *
 * Return:
-*  bool: returns the Tickless Idle readiness of Task_Ble
+*  tickless_idle_mode_t : Deepest mode allowed by Task_Ble
 *******************************************************************************/
-bool Task_Ble_Tickless_Idle_Readiness (void) 
+tickless_idle_mode_t Task_Ble_Tickless_Idle_Readiness 
+                     (TickType_t *ticksToDeadline) 
 {
-    /* Return "true" if the BLE is on, "false" otherwise */
-    return (Cy_BLE_GetState() == CY_BLE_STATE_ON) ? true : false;
+    (void) ticksToDeadline;
+    
+    /* Allow Deep Sleep if the BLE is on, Sleep otherwise */
+    return (Cy_BLE_GetState() == CY_BLE_STATE_ON) ? 
+            TICKLESS_IDLE_DEEP_SLEEP : TICKLESS_IDLE_SLEEP;
 }
 
 /*******************************************************************************
@@ -260,6 +350,9 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
     /* Local variable for storing connection handle */ 
     static cy_stc_ble_conn_handle_t connHandle; 
     
+    /* Record the event in the trace. See FreeRTOSConfig.h to enable the trace */
+    RtosTrace_BleEvent(eventType);
+    
     /* Take an action based on the current event */
     switch ((cy_en_ble_event_t)eventType)
     {
@@ -320,6 +413,10 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
             /* Update connection handle array */
             appConnHandle[connHandle.attId].attId    = connHandle.attId;
             appConnHandle[connHandle.attId].bdHandle = CY_BLE_INVALID_CONN_HANDLE_VALUE;                        
+            
+            /* Drop the values still pending for the connection */
+            TxSched_ResetLink(connHandle.attId);
+            htsIndicationPending[connHandle.attId] = false;
             break;
         }
         
@@ -350,11 +447,26 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
             }
                        
             /* Queue BLE command to send notification to all the connected devices */
+            TxSched_PostAll(TX_SCHED_CUSTOM_NOTIFICATION);
             ble_commandAndData_t bleCommand = {.command = SEND_NOTIFICATION};
-            xQueueSend(bleCommandDataQ, &bleCommand, 0u);
+            Task_Ble_SendCommand(&bleCommand, 0u);
             
             break;
         }
+        
+        /* This event is received when the stack buffers become full or free
+           again */
+        case CY_BLE_EVT_STACK_BUSY_STATUS:
+        {
+            if(*(uint8_t *)eventParam == CY_BLE_STACK_STATE_FREE)
+            {
+                /* Resume the connections that were waiting for buffers */
+                TxSched_Unpark();
+                ble_commandAndData_t bleCommand = {.command = SEND_NOTIFICATION};
+                Task_Ble_SendCommand(&bleCommand, 0u);
+            }
+            break;
+        }
         /* This event is received when Central device sends a read command
            on an Attribute */
         case CY_BLE_EVT_GATTS_READ_CHAR_VAL_ACCESS_REQ:
@@ -497,6 +609,19 @@ void CallbackHts(uint32_t event, void *eventParam)
             }
             break;
         }
+        
+        /* This event is received when the central confirms an indication */
+        case CY_BLE_EVT_HTSS_INDICATION_CONFIRMED:
+        {
+            cy_stc_ble_conn_handle_t connHandle = 
+                ((cy_stc_ble_hts_char_value_t *)eventParam)->connHandle;
+            
+            /* The next temperature can be sent to this central */
+            htsIndicationPending[connHandle.attId] = false;
+            ble_commandAndData_t bleCommand = {.command = SEND_NOTIFICATION};
+            Task_Ble_SendCommand(&bleCommand, 0u);
+            break;
+        }
         default:
         {
         	/* Error handling */
@@ -523,15 +648,140 @@ void CallbackHts(uint32_t event, void *eventParam)
 *******************************************************************************/
 static void BleControllerInterruptEventHandler(void)
 {
-    BaseType_t xHigherPriorityTaskWoken;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    
+    /* Notification value before this interrupt set its bit */
+    uint32_t previousEvents = 0u;
+    
+    bleWakeupStats.controllerInterrupts++;
     
-    /* Send command to process BLE events  */
-    ble_commandAndData_t bleCommand = {.command = PROCESS_BLE_EVENTS};
-    xQueueSendFromISR(bleCommandDataQ, &bleCommand,&xHigherPriorityTaskWoken);
+    /* Tell Task_Ble to process BLE events */
+    xTaskNotifyAndQueryFromISR(bleTaskHandle, BLE_EVENT_PROCESS_EVENTS, eSetBits,
+                               &previousEvents, &xHigherPriorityTaskWoken);
+    
+    /* A pass was already pending; this interrupt is handled by it */
+    if((previousEvents & BLE_EVENT_PROCESS_EVENTS) != 0u)
+    {
+        bleWakeupStats.mergedWakeups++;
+    }
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken );
 }
 
+/*******************************************************************************
+* Function Name: static BaseType_t ReceiveBleCommand(
+*                   ble_commandAndData_t *bleCommand)
+********************************************************************************
+* Summary:
+*  Waits for the next BLE command. Pending controller events are processed
+*  before every command, so they are never delayed by queued commands.
+*
+* Parameters:
+*  ble_commandAndData_t *bleCommand : received command
+*
+* Return:
+*  BaseType_t : pdTRUE when a command has been received
+*
+*******************************************************************************/
+static BaseType_t ReceiveBleCommand(ble_commandAndData_t *bleCommand)
+{
+    /* Task notification bits; every wait clears the bits it returns */
+    uint32_t pendingEvents = 0u;
+    
+    /* Collect the bits set since the last call without blocking */
+    if(xTaskNotifyWait(0u, BLE_EVENT_ALL, &pendingEvents, 0u) != pdTRUE)
+    {
+        pendingEvents = 0u;
+    }
+    
+    for(;;)
+    {
+        /* One pass handles all the controller interrupts received so far */
+        if((pendingEvents & BLE_EVENT_PROCESS_EVENTS) != 0u)
+        {
+            bleWakeupStats.processEventPasses++;
+            Cy_BLE_ProcessEvents();
+        }
+        
+        if(xQueueReceive(bleCommandDataQ, bleCommand, 0u) == pdTRUE)
+        {
+            return pdTRUE;
+        }
+        
+        /**
+         * Nothing to do; block until the next notification. A notification
+         * that arrived during the pass above makes this call return 
+         * immediately.
+         */
+        if(xTaskNotifyWait(0u, BLE_EVENT_ALL, &pendingEvents, portMAX_DELAY) != pdTRUE)
+        {
+            pendingEvents = 0u;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: BaseType_t Task_Ble_SendCommand(
+*                   const ble_commandAndData_t *bleCommand, TickType_t ticksToWait)
+********************************************************************************
+* Summary:
+*  Sends a command to Task_Ble over bleCommandDataQ and wakes up the task. Must 
+*  not be called from an interrupt.
+*
+* Parameters:
+*  const ble_commandAndData_t *bleCommand : command to be sent
+*  TickType_t ticksToWait          : time to wait for space in the queue
+*
+* Return:
+*  BaseType_t : pdTRUE if the command has been queued
+*
+*******************************************************************************/
+BaseType_t Task_Ble_SendCommand(const ble_commandAndData_t *bleCommand, 
+                                TickType_t ticksToWait)
+{
+    BaseType_t rtosApiResult;
+    uint32_t queueDepth;
+    
+    rtosApiResult = xQueueSend(bleCommandDataQ, bleCommand, ticksToWait);
+    if(rtosApiResult == pdTRUE)
+    {
+        queueDepth = (uint32_t)uxQueueMessagesWaiting(bleCommandDataQ);
+        if(queueDepth > bleWakeupStats.maxQueueDepth)
+        {
+            bleWakeupStats.maxQueueDepth = queueDepth;
+        }
+        
+        /* Task_Ble drains the queue on start-up, so commands sent before it
+           runs need no notification */
+        if(bleTaskHandle != NULL)
+        {
+            (void)xTaskNotify(bleTaskHandle, BLE_EVENT_COMMAND, eSetBits);
+        }
+    }
+    
+    return rtosApiResult;
+}
+
+/*******************************************************************************
+* Function Name: void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats)
+********************************************************************************
+* Summary:
+*  Returns the counters of the Task_Ble wake-ups
+*
+* Parameters:
+*  ble_wakeup_stats_t *stats : counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = bleWakeupStats;
+    taskEXIT_CRITICAL();
+}
+
 /*******************************************************************************
 * Function Name: static void BleTimerCallback(TimerHandle_t xTimer)           
 ********************************************************************************
@@ -555,7 +805,7 @@ static void BleTimerCallback(TimerHandle_t xTimer)
     
     /* Send command to stop BLE */
     ble_commandAndData_t bleCommand = {.command = STOP_BLE};
-    rtosApiResult = xQueueSend(bleCommandDataQ, &bleCommand, 0);
+    rtosApiResult = Task_Ble_SendCommand(&bleCommand, 0u);
     
     /* Check if the operation has been successful */
     if(rtosApiResult != pdTRUE)
@@ -609,44 +859,85 @@ static void StartAdvertisement(void)
 }
 
 /*******************************************************************************
-* Function Name: static void SendCustomNotificatioon(void)
+* Function Name: static tx_sched_result_t SendToConnection(uint32_t link, 
+*                                                     tx_sched_item_t item)
 ********************************************************************************
 * Summary:
-*  This function sends modification to all the connected devices.
+*  This function is called by the TX scheduler to send the latest value of a 
+*  notification or indication to one connected device.
 *
 * Parameters:
-*  cy_ble_gatt_db_attr_handle_t attrHandle: GATT DB attribute handle 
-*  uint8_t* val : Attribute value
-*  uint16_t length: Attribute length
-*  cy_stc_ble_conn_handle_t connHandle: Connection handle 
+*  uint32_t link        : Index of the connection in appConnHandle
+*  tx_sched_item_t item : Value to send
 *
 * Return:
-*  None
+*  tx_sched_result_t : Result of the transmission
 *******************************************************************************/
-static void SendCustomNotificatioon(void)
+static tx_sched_result_t SendToConnection(uint32_t link, tx_sched_item_t item)
 {
-    uint8_t i;
-    /* Send notification top all the connected device */
-    for(i = 0; i < CY_BLE_CONN_COUNT; i++)
+    /* Variable used to store the return values of BLE APIs */
+    cy_en_ble_api_result_t bleApiResult = CY_BLE_ERROR_INVALID_STATE;
+    
+    tx_sched_result_t result = TX_SCHED_DROPPED;
+    
+    if(Cy_BLE_GetConnectionState(appConnHandle[link]) != 
+        CY_BLE_CONN_STATE_CONNECTED)
     {
-        
-        if((Cy_BLE_GetConnectionState(appConnHandle[i]) ==  CY_BLE_CONN_STATE_CONNECTED )&&
-            Cy_BLE_GATTS_IsNotificationEnabled(&appConnHandle[i], 
-                CUSTOM_NOTIFICATION_CCC_HANDLE))
+        /* The value is not sent to a device that is not connected */
+    }
+    else if(Cy_BLE_GATT_GetBusyStatus(appConnHandle[link].attId) == 
+            CY_BLE_STACK_STATE_BUSY)
+    {
+        /* Wait for CY_BLE_EVT_STACK_BUSY_STATUS before trying again */
+        result = TX_SCHED_BUSY;
+    }
+    else if(item == TX_SCHED_CUSTOM_NOTIFICATION)
+    {
+        if(Cy_BLE_GATTS_IsNotificationEnabled(&appConnHandle[link], 
+            CUSTOM_NOTIFICATION_CCC_HANDLE))
         {
             /*  Local variable used for storing notification parameter */
             cy_stc_ble_gatts_handle_value_ntf_t customNotificationHandle = 
             {
-                .connHandle = appConnHandle[i],
+                .connHandle = appConnHandle[link],
                 .handleValPair.attrHandle   = CUSTOM_NOTIFICATION_CCC_HANDLE,
                 .handleValPair.value.val    = customNotificationData,
                 .handleValPair.value.len    = CUSTOM_NOTIFICATIN_SERVICE_LEN
             };
             
             /* Send the updated handle as part of attribute for notifications */
-            Cy_BLE_GATTS_Notification(&customNotificationHandle);
+            bleApiResult = Cy_BLE_GATTS_Notification(&customNotificationHandle);
         }
     }
+    else if(htsIndicationPending[link])
+    {
+        /* Only one indication can be waiting for confirmation */
+        result = TX_SCHED_WAIT;
+    }
+    else
+    {
+        /* Send indication to the central */
+        bleApiResult = Cy_BLE_HTSS_SendIndication(appConnHandle[link], 
+            CY_BLE_HTS_TEMP_MEASURE, HTS_CHARACTERISTIC_SIZE, 
+            htsCharacteristicValue);
+        
+        if(bleApiResult == CY_BLE_SUCCESS)
+        {
+            htsIndicationPending[link] = true;
+        }
+    }
+    
+    if(bleApiResult == CY_BLE_SUCCESS)
+    {
+        result = TX_SCHED_SENT;
+    }
+    else if(bleApiResult == CY_BLE_ERROR_MEMORY_ALLOCATION_FAILED)
+    {
+        /* The stack has no buffer left for this connection */
+        result = TX_SCHED_BUSY;
+    }
+    
+    return result;
 }
 
 /*******************************************************************************
@@ -683,56 +974,46 @@ static void UpdateStatusLed(status_led_command_t redLed, status_led_command_t or
 }
 
 /*******************************************************************************
-* Function Name: static void SendTemperatureIndication(float temperature)
+* Function Name: static void SendTemperatureIndication(int32_t temperature)
 ********************************************************************************
 * Summary:
-*  This function send temperature data over BLE HTS notification
+*  This function send temperature data over BLE HTS indication. The value is
+*  handed to the TX scheduler, which sends it to every connected central as 
+*  soon as that central has confirmed the previous one.
 *
 * Parameters:
-*  float temperature: temperature value 
+*  int32_t temperature: temperature in hundredths of a degree C
 *
 * Return:
 *  None
 *******************************************************************************/
-static void SendTemperatureIndication(float temperature)
+static void SendTemperatureIndication(int32_t temperature)
 {
     /* Variable used to store the return values of BLE APIs */
     cy_en_ble_api_result_t bleApiResult;
     
-    /* Temporary array to hold Health Thermometer Characteristic information */
-    uint8 valueArray[HTS_CHARACTERISTIC_SIZE];
     temperature_data_t tempData;
-    
-    uint8_t i;
                         
-    /* Convert from IEEE-754 single precision floating point format to
-       IEEE-11073 FLOAT, which is mandated by the health thermometer
-       characteristic */
-    tempData.temeratureValue = (int32_t)(roundf(temperature*
-                                        IEEE_11073_MANTISSA_SCALER));
+    /* Convert to IEEE-11073 FLOAT, which is mandated by the health 
+       thermometer characteristic. The temperature is already scaled by 
+       IEEE_11073_MANTISSA_SCALER, so it is the mantissa as is. */
+    tempData.temeratureValue = temperature;
     tempData.temperatureArray[IEEE_11073_EXPONENT_INDEX] = 
                                         IEEE_11073_EXPONENT_VALUE;         
 
     /* Read Health Thermometer Characteristic from GATT DB */
     bleApiResult = Cy_BLE_HTSS_GetCharacteristicValue(CY_BLE_HTS_TEMP_MEASURE, 
-                    HTS_CHARACTERISTIC_SIZE, valueArray);
+                    HTS_CHARACTERISTIC_SIZE, htsCharacteristicValue);
     
     if(bleApiResult == CY_BLE_SUCCESS)
     { 
         /* Update temperature value in the characteristic */
-        memcpy(&valueArray[HTS_TEMPERATURE_DATA_INDEX],
+        memcpy(&htsCharacteristicValue[HTS_TEMPERATURE_DATA_INDEX],
                tempData.temperatureArray, HTS_TEMPERATURE_DATA_SIZE);
         
-        for(i = 0; i < CY_BLE_CONN_COUNT ; i++ )
-        {
-            if(Cy_BLE_GetConnectionState(appConnHandle[i]) == 
-                CY_BLE_CONN_STATE_CONNECTED)
-            {
-                /* Send indication to the central */
-                Cy_BLE_HTSS_SendIndication(appConnHandle[i], 
-                    CY_BLE_HTS_TEMP_MEASURE, HTS_CHARACTERISTIC_SIZE, valueArray);
-            }
-        }  
+        /* Send indication to the centrals */
+        TxSched_PostAll(TX_SCHED_TEMP_INDICATION);
+        TxSched_Run();
     }
 }
 
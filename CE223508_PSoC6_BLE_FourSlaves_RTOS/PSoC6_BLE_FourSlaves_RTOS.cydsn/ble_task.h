@@ -53,6 +53,9 @@
 #include "project.h"
 #include "FreeRTOS.h"
 #include "queue.h"
+#include "task.h"
+#include "msg_pool.h"
+#include "tickless_idle.h"
 
 /* List of BLE commands */
 typedef enum
@@ -63,21 +66,47 @@ typedef enum
     STOP_BLE                        /* Stop BLE */
 }   ble_commands_list_t;
 
-/* Data-type of BLE commands and data */
+/**
+ * Data-type of BLE commands and data. The whole item is one 32-bit word. 
+ * Command data is passed in a message pool block; the sender gives up the 
+ * block when the item has been queued and Task_Ble frees it after use.
+ * Commands without data use MSG_POOL_NULL_HANDLE.
+ */
 typedef struct
 {   
-    ble_commands_list_t command;
-    void* data;
+    uint16_t command;       /* One of ble_commands_list_t */
+    msg_handle_t data;
 }   ble_commandAndData_t;
 
+/* Counters of the Task_Ble wake-ups */
+typedef struct
+{
+    /* Interrupts received from the BLE controller */
+    uint32_t controllerInterrupts;
+    /* Cy_BLE_ProcessEvents() passes run for the controller interrupts */
+    uint32_t processEventPasses;
+    /* Controller interrupts merged into a pass that was already pending */
+    uint32_t mergedWakeups;
+    /* Largest number of commands seen waiting in bleCommandDataQ */
+    uint32_t maxQueueDepth;
+}   ble_wakeup_stats_t;
+
 /* Handle for the Queue that contains BLE commands and data */
 extern QueueHandle_t bleCommandDataQ;
 
 /* Task_Ble takes care of the BLE module in this code example */    
 void Task_Ble(void *pvParameters);
 
+/* Sends a command to Task_Ble over bleCommandDataQ and wakes up the task */
+BaseType_t Task_Ble_SendCommand(const ble_commandAndData_t *bleCommand, 
+                                TickType_t ticksToWait);
+
+/* Returns the counters of the Task_Ble wake-ups */
+void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats);
+
 /* Function that returns the Tickless Idle readiness of Task_Ble */
-bool Task_Ble_Tickless_Idle_Readiness (void);
+tickless_idle_mode_t Task_Ble_Tickless_Idle_Readiness 
+                     (TickType_t *ticksToDeadline);
 
 #endif /* BLE_TASK_H */
 
@@ -0,0 +1,266 @@
+/******************************************************************************
+* File Name: led_pattern.c
+*
+* Version: 1.0
+*
+* Description: This file contains the LED pattern engine
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the LED pattern engine. It turns the blink patterns of
+* several LEDs into one sequence of edge times, so the CPU only needs to wake
+* up when an LED changes state and the edges of different LEDs share a wakeup.
+* The engine uses no RTOS or hardware API.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stddef.h>
+#include "led_pattern.h"
+
+/* Checks if a time has been reached; correct across a wrap-around of the 
+   millisecond count */
+#define IS_TIME_REACHED(timeMs, nowMs)  ((int32_t)((nowMs) - (timeMs)) >= 0)
+
+/** 
+ * These static functions are used by the pattern engine. These are not 
+ * available outside this file. See the respective function definitions for 
+ * more details. 
+ */
+static void StartStep(led_pattern_channel_t *channel, uint32_t startMs);
+
+/*******************************************************************************
+* Function Name: void LedPattern_Init(led_pattern_engine_t *engine)
+********************************************************************************
+* Summary:
+*  Initializes the engine with all LEDs off and no pattern playing
+*
+* Parameters:
+*  led_pattern_engine_t *engine : engine to initialize
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void LedPattern_Init(led_pattern_engine_t *engine)
+{
+    uint32_t index;
+    
+    for(index = 0u; index < LED_PATTERN_MAX_CHANNELS; index++)
+    {
+        engine->channel[index].pattern     = NULL;
+        engine->channel[index].step        = 0u;
+        engine->channel[index].ledOn       = false;
+        engine->channel[index].edgePending = false;
+        engine->channel[index].edgeMs      = 0u;
+    }
+}
+
+/*******************************************************************************
+* Function Name: void LedPattern_Set(led_pattern_engine_t *engine, 
+*                   uint32_t channel, const led_pattern_t *pattern, 
+*                   uint32_t nowMs)
+********************************************************************************
+* Summary:
+*  Starts a pattern on one LED. The LED takes the state of the first step 
+*  right away.
+*
+* Parameters:
+*  led_pattern_engine_t *engine   : engine
+*  uint32_t channel               : LED, below LED_PATTERN_MAX_CHANNELS
+*  const led_pattern_t *pattern   : pattern to play, with at least one step
+*  uint32_t nowMs                 : current time in milliseconds
+*
+* Return:
+*  None
+*
+* Theory:
+*  The first step is counted from the slot boundary nearest to the current
+*  time, so it is up to half a slot shorter or longer than the others. All 
+*  later edges then fall on slot boundaries. The boundaries are counted from 
+*  a pending edge of any LED rather than from 0 ms, since the millisecond 
+*  count is not a whole number of slots when it wraps around.
+*
+*******************************************************************************/
+void LedPattern_Set(led_pattern_engine_t *engine, uint32_t channel,
+                    const led_pattern_t *pattern, uint32_t nowMs)
+{
+    led_pattern_channel_t *ledChannel;
+    uint32_t startMs = nowMs + (LED_PATTERN_SLOT_MS / 2u);
+    uint32_t gridMs = 0u;
+    uint32_t index;
+    int32_t  offsetMs;
+    
+    if((channel < LED_PATTERN_MAX_CHANNELS) && (pattern != NULL) &&
+       (pattern->stepCount > 0u))
+    {
+        /* Any pending edge lies on a slot boundary */
+        for(index = 0u; index < LED_PATTERN_MAX_CHANNELS; index++)
+        {
+            if(engine->channel[index].edgePending)
+            {
+                gridMs = engine->channel[index].edgeMs;
+            }
+        }
+        
+        offsetMs = (int32_t)(startMs - gridMs) % (int32_t)LED_PATTERN_SLOT_MS;
+        if(offsetMs < 0)
+        {
+            offsetMs += (int32_t)LED_PATTERN_SLOT_MS;
+        }
+        
+        ledChannel = &engine->channel[channel];
+        ledChannel->pattern = pattern;
+        ledChannel->step    = 0u;
+        StartStep(ledChannel, startMs - (uint32_t)offsetMs);
+    }
+}
+
+/*******************************************************************************
+* Function Name: uint32_t LedPattern_Advance(led_pattern_engine_t *engine, 
+*                                            uint32_t nowMs)
+********************************************************************************
+* Summary:
+*  Moves every LED to the step of its pattern that is due at the current 
+*  time
+*
+* Parameters:
+*  led_pattern_engine_t *engine : engine
+*  uint32_t nowMs               : current time in milliseconds
+*
+* Return:
+*  uint32_t : milliseconds until the next LED edge, LED_PATTERN_NO_EDGE if no
+*             LED changes until a new pattern is set
+*
+*******************************************************************************/
+uint32_t LedPattern_Advance(led_pattern_engine_t *engine, uint32_t nowMs)
+{
+    led_pattern_channel_t *ledChannel;
+    uint32_t index;
+    uint32_t msToEdge;
+    uint32_t msToNextEdge = LED_PATTERN_NO_EDGE;
+    
+    for(index = 0u; index < LED_PATTERN_MAX_CHANNELS; index++)
+    {
+        ledChannel = &engine->channel[index];
+        
+        /* Play all the steps that have ended, the next one starting where 
+           the previous one ended */
+        while(ledChannel->edgePending && 
+              IS_TIME_REACHED(ledChannel->edgeMs, nowMs))
+        {
+            ledChannel->step++;
+            if(ledChannel->step >= ledChannel->pattern->stepCount)
+            {
+                if(!ledChannel->pattern->repeat)
+                {
+                    /* Hold the state of the last step */
+                    ledChannel->step = ledChannel->pattern->stepCount - 1u;
+                    ledChannel->edgePending = false;
+                    break;
+                }
+                ledChannel->step = 0u;
+            }
+            StartStep(ledChannel, ledChannel->edgeMs);
+        }
+        
+        if(ledChannel->edgePending)
+        {
+            msToEdge = ledChannel->edgeMs - nowMs;
+            if(msToEdge < msToNextEdge)
+            {
+                msToNextEdge = msToEdge;
+            }
+        }
+    }
+    
+    return msToNextEdge;
+}
+
+/*******************************************************************************
+* Function Name: bool LedPattern_IsLedOn(const led_pattern_engine_t *engine, 
+*                                        uint32_t channel)
+********************************************************************************
+* Summary:
+*  Returns the state of one LED after the last LedPattern_Set() or 
+*  LedPattern_Advance() call
+*
+* Parameters:
+*  const led_pattern_engine_t *engine : engine
+*  uint32_t channel                   : LED, below LED_PATTERN_MAX_CHANNELS
+*
+* Return:
+*  bool : true if the LED is on
+*
+*******************************************************************************/
+bool LedPattern_IsLedOn(const led_pattern_engine_t *engine, uint32_t channel)
+{
+    return (channel < LED_PATTERN_MAX_CHANNELS) && 
+           engine->channel[channel].ledOn;
+}
+
+/*******************************************************************************
+* Function Name: static void StartStep(led_pattern_channel_t *channel, 
+*                                      uint32_t startMs)
+********************************************************************************
+* Summary:
+*  Sets the LED state of the current step and the time at which it ends
+*
+* Parameters:
+*  led_pattern_channel_t *channel : LED
+*  uint32_t startMs               : time at which the step starts
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void StartStep(led_pattern_channel_t *channel, uint32_t startMs)
+{
+    const led_pattern_step_t *step = &channel->pattern->steps[channel->step];
+    
+    channel->ledOn = step->ledOn;
+    if(step->slots == 0u)
+    {
+        channel->edgePending = false;
+    }
+    else
+    {
+        channel->edgePending = true;
+        channel->edgeMs = startMs + ((uint32_t)step->slots * LED_PATTERN_SLOT_MS);
+    }
+}
+
+/* [] END OF FILE */
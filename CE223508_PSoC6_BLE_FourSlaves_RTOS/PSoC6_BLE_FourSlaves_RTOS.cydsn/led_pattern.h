@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name: led_pattern.h
+*
+* Version: 1.0
+*
+* Description: This file is the public interface of led_pattern.c source file
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the LED pattern engine, which plays
+* blink patterns of several LEDs from one timer
+*******************************************************************************/
+
+/* Include guard */
+#ifndef LED_PATTERN_H
+#define LED_PATTERN_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Number of LEDs driven by one engine */
+#define LED_PATTERN_MAX_CHANNELS    (2u)
+
+/**
+ * Length of a pattern slot in milliseconds. Pattern steps last a whole number
+ * of slots and every LED edge falls on a slot boundary, so the edges of all 
+ * LEDs that change at about the same time share one wakeup.
+ */
+#define LED_PATTERN_SLOT_MS         (500u)
+
+/* Time until the next edge when no LED has a pending edge */
+#define LED_PATTERN_NO_EDGE         (0xFFFFFFFFu)
+
+/* One step of a pattern: the LED state and how many slots it is held for */
+typedef struct
+{
+    bool     ledOn;
+    /* Number of slots, 0 to hold the state until the next pattern is set */
+    uint8_t  slots;
+}   led_pattern_step_t;
+
+/* Pattern of one LED */
+typedef struct
+{
+    const led_pattern_step_t *steps;
+    uint8_t                   stepCount;
+    /* Restart from the first step after the last one, else hold the last */
+    bool                      repeat;
+}   led_pattern_t;
+
+/* Playing state of one LED */
+typedef struct
+{
+    const led_pattern_t *pattern;
+    uint8_t              step;
+    bool                 ledOn;
+    bool                 edgePending;
+    /* Time in milliseconds at which the current step ends */
+    uint32_t             edgeMs;
+}   led_pattern_channel_t;
+
+/* Pattern engine; it only keeps time and state and drives no hardware */
+typedef struct
+{
+    led_pattern_channel_t channel[LED_PATTERN_MAX_CHANNELS];
+}   led_pattern_engine_t;
+
+/* Initializes the engine with all LEDs off */
+void LedPattern_Init(led_pattern_engine_t *engine);
+
+/* Starts a pattern on one LED */
+void LedPattern_Set(led_pattern_engine_t *engine, uint32_t channel,
+                    const led_pattern_t *pattern, uint32_t nowMs);
+
+/* Plays the edges that are due; returns the time until the next edge */
+uint32_t LedPattern_Advance(led_pattern_engine_t *engine, uint32_t nowMs);
+
+/* Returns the state of one LED */
+bool LedPattern_IsLedOn(const led_pattern_engine_t *engine, uint32_t channel);
+
+#endif /* LED_PATTERN_H */
+
+/* [] END OF FILE */
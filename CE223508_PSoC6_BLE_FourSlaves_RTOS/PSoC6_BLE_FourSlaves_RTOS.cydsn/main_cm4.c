@@ -53,6 +53,8 @@
 #include "temperature_task.h"
 #include "uart_debug.h"
 #include "tickless_idle.h"
+#include "msg_pool.h"
+#include "rtos_trace.h"
 
 /** 
  * Priorities of user tasks in this project - spaced at intervals of 5 for 
@@ -76,8 +78,31 @@
 #define STATUS_LED_QUEUE_LEN            (5u)
 #define TEMPERATURE_COMMAND_QUEUE_LEN   (5u)
 
-/* Function that returns the Tickless Idle readiness of the system */
-bool IsSystemReadyForTicklessIdle(void);
+/** 
+ * Stacks and control blocks of the user tasks and storage of the queues. All 
+ * kernel objects are allocated at compile time, so the RAM they take shows up
+ * in the map file and nothing is allocated from the FreeRTOS heap. 
+ */
+static StackType_t   bleTaskStack[TASK_BLE_STACK_SIZE];
+static StaticTask_t  bleTaskBuffer;
+static StackType_t   rgbLedTaskStack[TASK_RGB_LED_STACK_SIZE];
+static StaticTask_t  rgbLedTaskBuffer;
+static StackType_t   statusLedTaskStack[TASK_STATUS_LED_STACK_SIZE];
+static StaticTask_t  statusLedTaskBuffer;
+static StackType_t   temperatureTaskStack[TASK_TEMPERATURE_STACK_SIZE];
+static StaticTask_t  temperatureTaskBuffer;
+
+static uint8_t       bleCommandDataQStorage[BLE_COMMAND_QUEUE_LEN *
+                                            sizeof(ble_commandAndData_t)];
+static StaticQueue_t bleCommandDataQBuffer;
+static uint8_t       statusLedDataQStorage[STATUS_LED_QUEUE_LEN *
+                                           sizeof(status_led_data_t)];
+static StaticQueue_t statusLedDataQBuffer;
+static uint8_t       rgbLedDataQStorage[RGB_LED_QUEUE_LEN * sizeof(uint32_t)];
+static StaticQueue_t rgbLedDataQBuffer;
+static uint8_t       temperatureCommandQStorage[TEMPERATURE_COMMAND_QUEUE_LEN *
+                                                sizeof(temperature_command_t)];
+static StaticQueue_t temperatureCommandQBuffer;
 
 /*******************************************************************************
 * Function Name: main
@@ -98,31 +123,53 @@ int main()
     /* Configure switch SW2 as hibernate wake up source */
     Cy_SysPm_SetHibWakeupSource(CY_SYSPM_HIBPIN1_LOW);
     
+    /* Initialize the message pool used to pass data between the tasks */
+    MsgPool_Init();
+    
     /** 
      * Create the queues. 
      * See the respective data-types for details of queue contents. 
      */
-    bleCommandDataQ = xQueueCreate(BLE_COMMAND_QUEUE_LEN,
-                                        sizeof(ble_commandAndData_t));
-    statusLedDataQ  = xQueueCreate(STATUS_LED_QUEUE_LEN,
-                                        sizeof(status_led_data_t));
-    rgbLedDataQ     = xQueueCreate(RGB_LED_QUEUE_LEN,
-                                        sizeof(uint32_t));
-    temperatureCommandQ = xQueueCreate(TEMPERATURE_COMMAND_QUEUE_LEN,
-                                        sizeof(temperature_command_t));  
+    bleCommandDataQ = xQueueCreateStatic(BLE_COMMAND_QUEUE_LEN,
+                                        sizeof(ble_commandAndData_t),
+                                        bleCommandDataQStorage,
+                                        &bleCommandDataQBuffer);
+    statusLedDataQ  = xQueueCreateStatic(STATUS_LED_QUEUE_LEN,
+                                        sizeof(status_led_data_t),
+                                        statusLedDataQStorage,
+                                        &statusLedDataQBuffer);
+    rgbLedDataQ     = xQueueCreateStatic(RGB_LED_QUEUE_LEN,
+                                        sizeof(uint32_t),
+                                        rgbLedDataQStorage,
+                                        &rgbLedDataQBuffer);
+    temperatureCommandQ = xQueueCreateStatic(TEMPERATURE_COMMAND_QUEUE_LEN,
+                                        sizeof(temperature_command_t),
+                                        temperatureCommandQStorage,
+                                        &temperatureCommandQBuffer);  
+    
+    /* Name the queues in the trace. See FreeRTOSConfig.h to enable the trace */
+    RtosTrace_RegisterQueue(bleCommandDataQ, "BLE command");
+    RtosTrace_RegisterQueue(statusLedDataQ, "Status LED");
+    RtosTrace_RegisterQueue(rgbLedDataQ, "RGB LED");
+    RtosTrace_RegisterQueue(temperatureCommandQ, "Temperature");
          
     /** 
      * Create the user Tasks. 
      * See the respective Task definition for more details of these tasks 
      */       
-    xTaskCreate(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
-                NULL, TASK_BLE_PRIORITY, NULL);
-    xTaskCreate(Task_RgbLed, "RGB LED Task", TASK_RGB_LED_STACK_SIZE,
-                NULL, TASK_RGB_LED_PRIORITY, NULL);
-    xTaskCreate(Task_StatusLed, "Status LED Task", TASK_STATUS_LED_STACK_SIZE,
-                NULL, TASK_STATUS_LED_PRIORITY, NULL);
-    xTaskCreate(Task_Temperature, "Temperature Task", TASK_TEMPERATURE_STACK_SIZE,
-                NULL, TASK_TEMPERATURE_PRIORITY, NULL);
+    xTaskCreateStatic(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
+                      NULL, TASK_BLE_PRIORITY, bleTaskStack, &bleTaskBuffer);
+    xTaskCreateStatic(Task_RgbLed, "RGB LED Task", TASK_RGB_LED_STACK_SIZE,
+                      NULL, TASK_RGB_LED_PRIORITY, rgbLedTaskStack,
+                      &rgbLedTaskBuffer);
+    xTaskCreateStatic(Task_StatusLed, "Status LED Task", 
+                      TASK_STATUS_LED_STACK_SIZE, NULL, 
+                      TASK_STATUS_LED_PRIORITY, statusLedTaskStack,
+                      &statusLedTaskBuffer);
+    xTaskCreateStatic(Task_Temperature, "Temperature Task", 
+                      TASK_TEMPERATURE_STACK_SIZE, NULL, 
+                      TASK_TEMPERATURE_PRIORITY, temperatureTaskStack,
+                      &temperatureTaskBuffer);
     
     /** 
      * Initialize thread-safe debug message printing. 
@@ -130,8 +177,18 @@ int main()
      */
     Task_DebugInit();
     
-    /* Initialize Tickless Idle mode */                    
-    TicklessIdleInit(IsSystemReadyForTicklessIdle);
+    /* Initialize the run time statistics and trace reporting */
+    RtosTrace_Init();
+    
+    /* Initialize Tickless Idle mode and register the wake sources that 
+       limit the low power mode the system can enter when idle */                    
+    TicklessIdleInit();
+    TicklessIdleAddSource(Task_Ble_Tickless_Idle_Readiness);
+    TicklessIdleAddSource(Task_RgbLed_Tickless_Idle_Readiness);
+    TicklessIdleAddSource(Task_Temp_Tickless_Idle_Readiness);
+#if (UART_DEBUG_ENABLE)
+    TicklessIdleAddSource(Task_Debug_Tickless_Idle_Readiness);
+#endif
     
     /* Start the RTOS scheduler. This function should never return */
     vTaskStartScheduler();
@@ -148,28 +205,6 @@ int main()
 }
 
 
-/*******************************************************************************
-* Function Name: bool IsSystemReadyForTicklessIdle(void)
-********************************************************************************
-*
-* Summary:
-*  This function returns the Tickless Idle readiness of the system.
-*    
-* Parameters:
-*  None
-*
-* Return:
-*  bool: Tickless Idle readiness of the system.
-*
-*******************************************************************************/
-bool IsSystemReadyForTicklessIdle(void)
-{
-    return  ((Task_Ble_Tickless_Idle_Readiness())      &&
-             (Task_RgbLed_Tickless_Idle_Readiness())   &&
-             (Task_Temp_Tickless_Idle_Readiness())     &&
-             (Task_Debug_Tickless_Idle_Readiness()));
-}
-
 /*******************************************************************************
 * Function Name: void vApplicationIdleHook(void)
 ********************************************************************************
@@ -246,4 +281,66 @@ void vApplicationMallocFailedHook(void)
     CY_ASSERT(0);
 }
 
+/*******************************************************************************
+* Function Name: void vApplicationGetIdleTaskMemory(
+*                               StaticTask_t **ppxIdleTaskTCBBuffer,
+*                               StackType_t **ppxIdleTaskStackBuffer,
+*                               uint32_t *pulIdleTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the idle task
+*    
+* Parameters:
+*  StaticTask_t **ppxIdleTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxIdleTaskStackBuffer : returns the stack
+*  uint32_t *pulIdleTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t idleTaskBuffer;
+    static StackType_t  idleTaskStack[configMINIMAL_STACK_SIZE];
+    
+    *ppxIdleTaskTCBBuffer   = &idleTaskBuffer;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: void vApplicationGetTimerTaskMemory(
+*                               StaticTask_t **ppxTimerTaskTCBBuffer,
+*                               StackType_t **ppxTimerTaskStackBuffer,
+*                               uint32_t *pulTimerTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the timer service task
+*    
+* Parameters:
+*  StaticTask_t **ppxTimerTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxTimerTaskStackBuffer : returns the stack
+*  uint32_t *pulTimerTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t timerTaskBuffer;
+    static StackType_t  timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+    
+    *ppxTimerTaskTCBBuffer   = &timerTaskBuffer;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
 /* [] END OF FILE */
@@ -0,0 +1,285 @@
+/******************************************************************************
+* File Name: msg_pool.c
+*
+* Version: 1.0
+*
+* Description: This file contains the fixed-block message pool
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the fixed-block message pool. A task that has data for
+* another task allocates a block, fills it and sends the block handle over a
+* queue; the receiving task owns the block from then on and frees it after use.
+*******************************************************************************/
+
+/* Header file includes */
+#include "msg_pool.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Parts of a block handle */
+#define HANDLE_INDEX_MASK       (0x00FFu)
+#define HANDLE_GEN_SHIFT        (8u)
+#define MAKE_HANDLE(index, gen) ((msg_handle_t)((((uint32_t)(gen)) << HANDLE_GEN_SHIFT) | \
+                                                ((uint32_t)(index) + 1u)))
+
+/* The index must fit into the low byte of a handle */
+#if (MSG_POOL_BLOCK_COUNT > 255u)
+    #error "MSG_POOL_BLOCK_COUNT must not exceed 255"
+#endif
+
+/* Pool block; the union keeps the data word aligned */
+typedef union
+{
+    uint8_t  bytes[MSG_POOL_BLOCK_SIZE];
+    uint32_t words[(MSG_POOL_BLOCK_SIZE + 3u) / 4u];
+}   msg_block_t;
+
+/* Block storage */
+static msg_block_t poolBlocks[MSG_POOL_BLOCK_COUNT];
+
+/* Generation of every block, and whether it is allocated */
+static uint8_t poolGeneration[MSG_POOL_BLOCK_COUNT];
+static bool    poolAllocated[MSG_POOL_BLOCK_COUNT];
+
+/* Stack of free block indexes */
+static uint8_t  poolFreeList[MSG_POOL_BLOCK_COUNT];
+static uint32_t poolFreeCount;
+
+/** 
+ * These static functions are used by the message pool. These are not 
+ * available outside this file. See the respective function definitions for 
+ * more details. 
+ */
+static msg_handle_t AllocBlock(void);
+static bool HandleToIndex(msg_handle_t handle, uint32_t *index);
+
+/*******************************************************************************
+* Function Name: void MsgPool_Init(void)
+********************************************************************************
+* Summary:
+*  Initializes the pool with all blocks free
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void MsgPool_Init(void)
+{
+    uint32_t index;
+    
+    for(index = 0u; index < MSG_POOL_BLOCK_COUNT; index++)
+    {
+        poolGeneration[index] = 0u;
+        poolAllocated[index]  = false;
+        poolFreeList[index]   = (uint8_t)index;
+    }
+    poolFreeCount = MSG_POOL_BLOCK_COUNT;
+}
+
+/*******************************************************************************
+* Function Name: msg_handle_t MsgPool_Alloc(void)
+********************************************************************************
+* Summary:
+*  Allocates a block from a task. The calling task owns the block until it 
+*  sends the handle to another task or frees it.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  msg_handle_t : handle of the block, MSG_POOL_NULL_HANDLE if the pool is 
+*                 empty
+*
+*******************************************************************************/
+msg_handle_t MsgPool_Alloc(void)
+{
+    msg_handle_t handle;
+    
+    taskENTER_CRITICAL();
+    handle = AllocBlock();
+    taskEXIT_CRITICAL();
+    
+    return handle;
+}
+
+/*******************************************************************************
+* Function Name: void* MsgPool_Get(msg_handle_t handle)
+********************************************************************************
+* Summary:
+*  Returns the data of a block. Only the current owner of the block may use 
+*  the data.
+*
+* Parameters:
+*  msg_handle_t handle : handle of the block
+*
+* Return:
+*  void* : data of the block, NULL if the handle is not valid or the block 
+*          has been freed
+*
+*******************************************************************************/
+void* MsgPool_Get(msg_handle_t handle)
+{
+    uint32_t index;
+    
+    if(!HandleToIndex(handle, &index))
+    {
+        return NULL;
+    }
+    return (void*)poolBlocks[index].bytes;
+}
+
+/*******************************************************************************
+* Function Name: bool MsgPool_Free(msg_handle_t handle)
+********************************************************************************
+* Summary:
+*  Returns a block to the pool. All copies of the handle become invalid.
+*
+* Parameters:
+*  msg_handle_t handle : handle of the block
+*
+* Return:
+*  bool : false if the handle was not valid, e.g. because the block was 
+*         already freed
+*
+*******************************************************************************/
+bool MsgPool_Free(msg_handle_t handle)
+{
+    uint32_t index;
+    bool result = false;
+    
+    taskENTER_CRITICAL();
+    if(HandleToIndex(handle, &index))
+    {
+        poolAllocated[index] = false;
+        poolGeneration[index]++;
+        poolFreeList[poolFreeCount] = (uint8_t)index;
+        poolFreeCount++;
+        result = true;
+    }
+    taskEXIT_CRITICAL();
+    
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t MsgPool_GetFreeCount(void)
+********************************************************************************
+* Summary:
+*  Returns the number of free blocks in the pool
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : number of free blocks
+*
+*******************************************************************************/
+uint32_t MsgPool_GetFreeCount(void)
+{
+    return poolFreeCount;
+}
+
+/*******************************************************************************
+* Function Name: static msg_handle_t AllocBlock(void)
+********************************************************************************
+* Summary:
+*  Takes a block from the free list. Must be called inside a critical section.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  msg_handle_t : handle of the block, MSG_POOL_NULL_HANDLE if the pool is 
+*                 empty
+*
+*******************************************************************************/
+static msg_handle_t AllocBlock(void)
+{
+    uint32_t index;
+    
+    if(poolFreeCount == 0u)
+    {
+        return MSG_POOL_NULL_HANDLE;
+    }
+    
+    poolFreeCount--;
+    index = poolFreeList[poolFreeCount];
+    poolAllocated[index] = true;
+    
+    return MAKE_HANDLE(index, poolGeneration[index]);
+}
+
+/*******************************************************************************
+* Function Name: static bool HandleToIndex(msg_handle_t handle, uint32_t *index)
+********************************************************************************
+* Summary:
+*  Checks a handle against the current state of its block
+*
+* Parameters:
+*  msg_handle_t handle : handle of the block
+*  uint32_t *index     : block index of a valid handle
+*
+* Return:
+*  bool : true if the handle refers to an allocated block of the current 
+*         generation
+*
+*******************************************************************************/
+static bool HandleToIndex(msg_handle_t handle, uint32_t *index)
+{
+    uint32_t blockIndex = (uint32_t)(handle & HANDLE_INDEX_MASK);
+    
+    if((blockIndex == 0u) || (blockIndex > MSG_POOL_BLOCK_COUNT))
+    {
+        return false;
+    }
+    blockIndex--;
+    
+    if(!poolAllocated[blockIndex] || 
+       (poolGeneration[blockIndex] != (uint8_t)(handle >> HANDLE_GEN_SHIFT)))
+    {
+        return false;
+    }
+    
+    *index = blockIndex;
+    return true;
+}
+
+/* [] END OF FILE */
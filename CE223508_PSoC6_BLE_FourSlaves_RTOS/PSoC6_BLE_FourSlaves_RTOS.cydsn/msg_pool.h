@@ -0,0 +1,88 @@
+/******************************************************************************
+* File Name: msg_pool.h
+*
+* Version: 1.0
+*
+* Description: This file is the public interface of msg_pool.c source file
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the fixed-block message pool used to
+* pass data between RTOS tasks by handle
+*******************************************************************************/
+
+/* Include guard */
+#ifndef MSG_POOL_H
+#define MSG_POOL_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Number of blocks in the pool and size of one block in bytes */
+#define MSG_POOL_BLOCK_COUNT    (8u)
+#define MSG_POOL_BLOCK_SIZE     (16u)
+
+/* Handle value that refers to no block */
+#define MSG_POOL_NULL_HANDLE    (0u)
+
+/**
+ * Handle of a pool block. The low byte is the block index plus one, the high
+ * byte is the generation of the block, which changes every time the block is
+ * freed. A handle that is used after its block was freed no longer matches 
+ * the generation and MsgPool_Get() returns NULL instead of the block.
+ */
+typedef uint16_t msg_handle_t;
+
+/* Initializes the pool; must be called before the scheduler is started */
+void MsgPool_Init(void);
+
+/* Allocates a block; returns MSG_POOL_NULL_HANDLE if the pool is empty */
+msg_handle_t MsgPool_Alloc(void);
+
+/* Returns the data of a block, or NULL if the handle is not valid */
+void* MsgPool_Get(msg_handle_t handle);
+
+/* Returns a block to the pool; the handle must not be used afterwards */
+bool MsgPool_Free(msg_handle_t handle);
+
+/* Returns the number of free blocks */
+uint32_t MsgPool_GetFreeCount(void);
+
+#endif /* MSG_POOL_H */
+
+/* [] END OF FILE */
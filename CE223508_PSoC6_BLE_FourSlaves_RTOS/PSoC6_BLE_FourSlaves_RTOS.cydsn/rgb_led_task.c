@@ -182,23 +182,28 @@ void Task_RgbLed (void *pvParameters)
 }
 
 /*******************************************************************************
-* Function Name: Task_RgbLed_Tickless_Idle_Readiness(void)
+* Function Name: Task_RgbLed_Tickless_Idle_Readiness(TickType_t *ticksToDeadline)
 ********************************************************************************
 * Summary:
 *  This function returns the Tickless Idle readiness of Task_RgbLed  
 *
 * Parameters:
-*  None                          
+*  ticksToDeadline : Ticks until the earliest deadline of the wake sources, 
+*                    not changed since the PWMs run until they are stopped
 *
 * Return:
-*  bool: Tickless Idle readiness of Task_RgbLed
+*  tickless_idle_mode_t: Deepest mode allowed by Task_RgbLed
 *
 *******************************************************************************/
-bool Task_RgbLed_Tickless_Idle_Readiness(void)  
+tickless_idle_mode_t Task_RgbLed_Tickless_Idle_Readiness
+                     (TickType_t *ticksToDeadline)  
 {
-    /* Return "false" if one of TCPWMs are running, "true" otherwise */
+    (void) ticksToDeadline;
+    
+    /* Allow Sleep only if one of TCPWMs are running, Deep Sleep otherwise */
     return ((Cy_TCPWM_PWM_GetStatus(PWMPR_Red_TCPWM__HW, PWMPR_Red_TCPWM__CNT_IDX)
-             &TCPWM_CNT_STATUS_RUNNING_Msk) == 0u) ? true : false;
+             &TCPWM_CNT_STATUS_RUNNING_Msk) == 0u) ? 
+            TICKLESS_IDLE_DEEP_SLEEP : TICKLESS_IDLE_SLEEP;
 };
 
 /* [] END OF FILE */
@@ -53,6 +53,7 @@
 #include "project.h"
 #include "FreeRTOS.h"
 #include "queue.h"    
+#include "tickless_idle.h"
 
 /* Handle for the Queue that contains RGB LED data */    
 extern QueueHandle_t rgbLedDataQ;
@@ -61,7 +62,8 @@ extern QueueHandle_t rgbLedDataQ;
 void Task_RgbLed(void *pvParameters);
 
 /* Function that returns the Tickless Idle readiness of Task_RgbLed */
-bool Task_RgbLed_Tickless_Idle_Readiness(void);
+tickless_idle_mode_t Task_RgbLed_Tickless_Idle_Readiness
+                     (TickType_t *ticksToDeadline);
 
 #endif /* RGB_LED_TASK_H */
 /* [] END OF FILE */
@@ -46,36 +46,52 @@
 
 /* Header file includes */
 #include "status_led_task.h"
-#include "uart_debug.h"
+#include "led_pattern.h"
 #include "uart_debug.h"
 #include "task.h"  
 #include "timers.h" 
 
+/* Pattern engine channels of the status LEDs */
+#define STATUS_LED_RED      (0u)
+#define STATUS_LED_ORANGE   (1u)
+
 /**
- * LED refresh interval of 500ms is used when continuously toggling a 
- * status LED 
+ * Patterns of the status LED commands. Toggling changes the LED every 500 ms
+ * (one slot) and a single blink lasts 4 s (eight slots). See led_pattern.h
+ * for the slot length.
  */
-#define STATUS_LED_TOGGLE_INTERVAL (pdMS_TO_TICKS(500u))
-/* LED refresh interval of 4s is used for blinking a status LED once */
-#define STATUS_LED_BLINK_INTERVAL  (pdMS_TO_TICKS(4000u))
-/* Idle interval is used for static LED states or when no LEDs are ON */
-#define STATUS_LED_IDLE_INTERVAL   (portMAX_DELAY)
+static const led_pattern_step_t ledOnSteps[]     = {{true, 0u}};
+static const led_pattern_step_t ledOffSteps[]    = {{false, 0u}};
+static const led_pattern_step_t ledToggleSteps[] = {{true, 1u}, {false, 1u}};
+static const led_pattern_step_t ledBlinkSteps[]  = {{true, 8u}, {false, 0u}};
+
+static const led_pattern_t ledPatternOn     = {ledOnSteps, 1u, false};
+static const led_pattern_t ledPatternOff    = {ledOffSteps, 1u, false};
+static const led_pattern_t ledPatternToggle = {ledToggleSteps, 2u, true};
+static const led_pattern_t ledPatternBlink  = {ledBlinkSteps, 2u, false};
 
 /* Queue handle used for commands to Task_StatusLed */
 QueueHandle_t statusLedDataQ;
 
-/* Timer handles used to control LED blink / toggle intervals */
-TimerHandle_t xTimer_StatusLedRed;
-TimerHandle_t xTimer_StatusLedOrange;
+/**
+ * Timer handle used for the LED edges. The timer is set to expire at the 
+ * next edge of either LED and is stopped while no LED has an edge pending
+ */
+TimerHandle_t xTimer_StatusLed;
+
+/* Control block of the LED timer */
+static StaticTimer_t statusLedTimerBuffer;
+
+/* Pattern engine of the status LEDs, used with the scheduler suspended */
+static led_pattern_engine_t statusLedEngine;
 
 /**
- * Functions that start and control the timers used for LED blink / toggle
- * intervals. 
+ * Functions that select the LED patterns and play them from the LED timer
  */
-static void StatusLedRedTimerStart(void);
-static void StatusLedOrangeTimerStart(void);
-static void StatusLedRedTimerUpdate(TickType_t period);
-static void StatusLedOrangeTimerUpdate(TickType_t period);
+static const led_pattern_t* StatusLedGetPattern(status_led_command_t command);
+static void StatusLedUpdate(const led_pattern_t *redPattern, 
+                            const led_pattern_t *orangePattern);
+static void StatusLedTimerStart(void);
 
 /*******************************************************************************
 * Function Name: void Task_StatusLed(void *pvParameters)
@@ -89,15 +105,17 @@ static void StatusLedOrangeTimerUpdate(TickType_t period);
 * Return:
 *  None
 *
+* Theory:
+*  Task_StatusLed only runs when an LED command is received. It starts the
+*  pattern of the command, and the LED timer then plays the edges of both 
+*  LEDs directly from its callback. The edges fall on the slot boundaries of
+*  the pattern engine, so the two LEDs share their wakeups.
+*
 *******************************************************************************/
 void Task_StatusLed(void *pvParameters)
 { 
     /* Variable that stores the data recieved received over queue */
     status_led_data_t statusLedData;
-
-    /* Variables used to detect changes to the LED states */
-    status_led_command_t static redLedState    = LED_TURN_OFF;
-    status_led_command_t static orangeLedState = LED_TURN_OFF;
     
     /* Variable used to store the return values of RTOS APIs */
     BaseType_t rtosApiResult;
@@ -105,9 +123,10 @@ void Task_StatusLed(void *pvParameters)
     /* Remove warning for unused parameter */
     (void)pvParameters ;
     
-    /* Start the timers that control LED blink / toggle intervals */
-    StatusLedRedTimerStart();
-    StatusLedOrangeTimerStart();
+    /* Start with both LEDs off and the timer that plays the LED edges */
+    LedPattern_Init(&statusLedEngine);
+    StatusLedTimerStart();
+    StatusLedUpdate(&ledPatternOff, &ledPatternOff);
     
     /* Repeatedly running part of the task */
     for(;;)
@@ -118,135 +137,9 @@ void Task_StatusLed(void *pvParameters)
         /* Command has been received from statusLedDataQ */
         if(rtosApiResult == pdTRUE)
         {
-            /* Take an action based on the command received for Orange LED */
-            switch(statusLedData.orangeLed)
-            {
-                /* No change to the LED state */
-                case LED_NO_CHANGE:
-                    break;
-                /* Turn ON the LED */
-                case LED_TURN_ON:
-                    Cy_GPIO_Clr(Pin_LED_Orange_PORT, Pin_LED_Orange_NUM);
-                    /* Set the timer to idle mode */
-                    StatusLedOrangeTimerUpdate(STATUS_LED_IDLE_INTERVAL);
-                    orangeLedState = LED_TURN_ON;
-                    break;
-                /* Turn OFF the LED */    
-                case LED_TURN_OFF:
-                    Cy_GPIO_Set(Pin_LED_Orange_PORT, Pin_LED_Orange_NUM);
-                    /* Set the timer to idle mode */
-                    StatusLedOrangeTimerUpdate(STATUS_LED_IDLE_INTERVAL);
-                    orangeLedState = LED_TURN_OFF;
-                    break;
-                /* Continuously toggle the LED */
-                case LED_TOGGLE_EN:
-                    /* Update the timer period to toggle interval */
-                    StatusLedOrangeTimerUpdate(STATUS_LED_TOGGLE_INTERVAL);
-                    orangeLedState = LED_TOGGLE_EN;
-                    break;
-                /* Blink the LED once */    
-                case LED_BLINK_ONCE:
-                    Cy_GPIO_Clr(Pin_LED_Orange_PORT, Pin_LED_Orange_NUM);
-                    /* Update the timer period to blink interval */
-                    StatusLedOrangeTimerUpdate(STATUS_LED_BLINK_INTERVAL);
-                    orangeLedState = LED_BLINK_ONCE;
-                    break;
-                /* Refresh the LED based on the current state */     
-                case LED_TIMER_EXPIRED:
-                    if(orangeLedState == LED_TOGGLE_EN)
-                    {
-                        /* Toggle the LED */
-                        Cy_GPIO_Inv(Pin_LED_Orange_PORT,
-                                    Pin_LED_Orange_NUM);
-                    }
-                    else if (orangeLedState == LED_BLINK_ONCE)
-                    {
-                        /* Turn off the LED */
-                        Cy_GPIO_Set(Pin_LED_Orange_PORT,
-                                    Pin_LED_Orange_NUM);
-                        /* Set the timer to idle mode */
-                        StatusLedOrangeTimerUpdate(STATUS_LED_IDLE_INTERVAL);
-                        orangeLedState = LED_TURN_OFF;
-                    }
-                    else
-                    {
-                        Task_DebugPrintf("Error!   : Status LED - refresh "\
-                                         "command for Orange LED during invalid"\
-                                         "state", 0u);   
-                    }
-                    break;
-                /* Invalid command received */    
-                default:
-                    Task_DebugPrintf("Error!   : Status LED - Invalid  command"\
-                                     " for Red LED received. Error Code:",
-                                      statusLedData.orangeLed);
-                    break;
-            }
-            
-            /* Take an action based on the command received for Red LED */
-            switch(statusLedData.redLed)
-            {
-                /* No change to the LED state */
-                case LED_NO_CHANGE:
-                    break;
-                /* Turn ON the LED */
-                case LED_TURN_ON:
-                    Cy_GPIO_Clr(Pin_LED_Red_PORT,Pin_LED_Red_NUM);
-                    /* Set the timer to idle mode */
-                    StatusLedRedTimerUpdate(STATUS_LED_IDLE_INTERVAL);
-                    redLedState = LED_TURN_ON;
-                    break;
-                /* Turn OFF the LED */        
-                case LED_TURN_OFF:
-                    Cy_GPIO_Set(Pin_LED_Red_PORT,Pin_LED_Red_NUM);
-                    /* Set the timer to idle mode */
-                    StatusLedRedTimerUpdate(STATUS_LED_IDLE_INTERVAL);
-                    redLedState = LED_TURN_OFF;
-                    break;
-                /* Continuously toggle the LED */
-                case LED_TOGGLE_EN:
-                    /* Update the timer period to toggle interval */
-                    StatusLedRedTimerUpdate(STATUS_LED_TOGGLE_INTERVAL);
-                    redLedState = LED_TOGGLE_EN;
-                    break;
-                /* Blink the LED once */        
-                case LED_BLINK_ONCE:
-                    Cy_GPIO_Clr(Pin_LED_Red_PORT,Pin_LED_Red_NUM);
-                    /* Update the timer period to blink interval */
-                    StatusLedRedTimerUpdate(STATUS_LED_BLINK_INTERVAL);
-                    redLedState = LED_BLINK_ONCE;
-                    break;
-                /* Refresh the LED based on the current state */         
-                case LED_TIMER_EXPIRED:
-                    if(redLedState == LED_TOGGLE_EN)
-                    {
-                        /* Toggle the LED */
-                        Cy_GPIO_Inv(Pin_LED_Red_PORT,
-                                    Pin_LED_Red_NUM);
-                    }
-                    else if (redLedState == LED_BLINK_ONCE)
-                    {
-                        /* Turn off the LED */
-                        Cy_GPIO_Set(Pin_LED_Red_PORT,
-                                    Pin_LED_Red_NUM);
-                        /* Set the timer to idle mode */
-                        StatusLedRedTimerUpdate(STATUS_LED_IDLE_INTERVAL);                        
-                        redLedState = LED_TURN_OFF;
-                    }
-                    else
-                    {
-                         Task_DebugPrintf("Error!   : Status LED - refresh "\
-                                          "command for Red LED during"\
-                                          "invalid state",0u);   
-                    }
-                    break;
-                /* Invalid command received */      
-                default:
-                    Task_DebugPrintf("Error!   : Status LED - Invalid command"
-                                     "for Red LED received. Error Code:",
-                                      statusLedData.orangeLed);
-                    break;
-            }            
+            /* Start the patterns of the commands received */
+            StatusLedUpdate(StatusLedGetPattern(statusLedData.redLed),
+                            StatusLedGetPattern(statusLedData.orangeLed));
         }
         /* Task has timed out and received no commands during an interval of 
            portMAXDELAY ticks */
@@ -258,119 +151,136 @@ void Task_StatusLed(void *pvParameters)
 }
 
 /*******************************************************************************
-* Function Name: static void StatusLedOrangeTimerCallback(TimerHandle_t xTimer)                          
+* Function Name: static const led_pattern_t* StatusLedGetPattern(
+*                                       status_led_command_t command)
 ********************************************************************************
 * Summary:
-*  This function is called when the Orange LED Timer expires
+*  This function returns the LED pattern of a status LED command
 *
 * Parameters:
-*  TimerHandle_t xTimer :  Current timer value (unused)
+*  status_led_command_t command : command received for the LED
 *
 * Return:
-*  None
+*  const led_pattern_t* : pattern of the command, NULL to keep the current 
+*                         pattern
 *
 *******************************************************************************/
-static void StatusLedOrangeTimerCallback(TimerHandle_t xTimer)
+static const led_pattern_t* StatusLedGetPattern(status_led_command_t command)
 {
-    /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
-    
-    /* Remove warning for unused parameter */
-    (void)xTimer;
-    
-    /* Send command to refresh the LED state */
-    status_led_data_t ledRefreshData = 
-    {   .redLed     = LED_NO_CHANGE,
-        .orangeLed  = LED_TIMER_EXPIRED 
-    };
-    rtosApiResult = xQueueSend(statusLedDataQ, &ledRefreshData,0u);
+    const led_pattern_t *pattern = NULL;
     
-    /* Check if the operation has been successful */
-    if(rtosApiResult != pdTRUE)
+    /* Take an action based on the command received */
+    switch(command)
     {
-        Task_DebugPrintf("Failure! : Status LED - Sending data to Status LED "\
-                         "queue",0u);      
+        /* No change to the LED state */
+        case LED_NO_CHANGE:
+            break;
+        /* Turn ON the LED */
+        case LED_TURN_ON:
+            pattern = &ledPatternOn;
+            break;
+        /* Turn OFF the LED */
+        case LED_TURN_OFF:
+            pattern = &ledPatternOff;
+            break;
+        /* Continuously toggle the LED */
+        case LED_TOGGLE_EN:
+            pattern = &ledPatternToggle;
+            break;
+        /* Blink the LED once */
+        case LED_BLINK_ONCE:
+            pattern = &ledPatternBlink;
+            break;
+        /* Invalid command received */    
+        default:
+            Task_DebugPrintf("Error!   : Status LED - Invalid command "\
+                             "received. Error Code:", command);
+            break;
     }
+    
+    return pattern;
 }
 
 /*******************************************************************************
-* Function Name: static void StatusLedOrangeTimerStart(void)                 
+* Function Name: static void StatusLedUpdate(const led_pattern_t *redPattern,
+*                                     const led_pattern_t *orangePattern)
 ********************************************************************************
 * Summary:
-*  This function starts the timer that provides timing to Orange LED 
-*  toggle / blink
+*  This function starts new LED patterns, plays the LED edges that are due and
+*  sets the LED timer to expire at the next edge
 *
 * Parameters:
-*  None
+*  const led_pattern_t *redPattern    : new pattern of the Red LED, NULL to 
+*                                       keep the current one
+*  const led_pattern_t *orangePattern : new pattern of the Orange LED, NULL 
+*                                       to keep the current one
 *
 * Return:
 *  None
 *
+* Theory:
+*  Task_StatusLed and the timer service task both call this function. The 
+*  scheduler is suspended so that the engine, the LED pins and the timer are
+*  updated in one step, and the last timer command sent is always based on
+*  the current engine state.
+*
 *******************************************************************************/
-static void StatusLedOrangeTimerStart(void)
+static void StatusLedUpdate(const led_pattern_t *redPattern, 
+                            const led_pattern_t *orangePattern)
 {
     /* Variable used to store the return values of RTOS APIs */
     BaseType_t rtosApiResult;
     
-    /* Create an RTOS timer */
-    xTimer_StatusLedOrange =  xTimerCreate ("Orange Status LED Timer",
-                                            STATUS_LED_IDLE_INTERVAL, pdTRUE, 
-                                            NULL, StatusLedOrangeTimerCallback); 
+    uint32_t nowMs;
+    uint32_t msToEdge;
+    TickType_t ticksToEdge;
     
-    /* Make sure that timer handle is valid */
-    if (xTimer_StatusLedOrange != NULL)
+    vTaskSuspendAll();
+    
+    nowMs = (uint32_t)(xTaskGetTickCount() * portTICK_PERIOD_MS);
+    if(redPattern != NULL)
     {
-        /* Start the timer */
-        rtosApiResult = xTimerStart(xTimer_StatusLedOrange, 0u);
-        
-        /* Check if the operation has been successful */
-        if(rtosApiResult  != pdPASS)
-        {
-            Task_DebugPrintf("Failure! : Status LED  - Orange LED Timer "\
-                             "initialization", 0u);    
-        }
+        LedPattern_Set(&statusLedEngine, STATUS_LED_RED, redPattern, nowMs);
+    }
+    if(orangePattern != NULL)
+    {
+        LedPattern_Set(&statusLedEngine, STATUS_LED_ORANGE, orangePattern, 
+                       nowMs);
+    }
+    msToEdge = LedPattern_Advance(&statusLedEngine, nowMs);
+    
+    /* The status LEDs are active low */
+    Cy_GPIO_Write(Pin_LED_Red_PORT, Pin_LED_Red_NUM, 
+        LedPattern_IsLedOn(&statusLedEngine, STATUS_LED_RED) ? 0u : 1u);
+    Cy_GPIO_Write(Pin_LED_Orange_PORT, Pin_LED_Orange_NUM, 
+        LedPattern_IsLedOn(&statusLedEngine, STATUS_LED_ORANGE) ? 0u : 1u);
+    
+    /* Wake up at the next edge, or not at all while the LEDs are static */
+    if(msToEdge == LED_PATTERN_NO_EDGE)
+    {
+        rtosApiResult = xTimerStop(xTimer_StatusLed, 0u);
     }
     else
     {
-        Task_DebugPrintf("Failure! : Status LED  - Orange LED Timer creation",
-                          0u); 
-    }  
-}
-
-/*******************************************************************************
-* Function Name: static void StatusLedOrangeTimerUpdate(TickType_t period)                
-********************************************************************************
-* Summary:
-*  This function updates the timer period per the parameter
-*
-* Parameters:
-*  TickType_t period :  Period of the timer in ticks
-*
-* Return:
-*  None
-*
-*******************************************************************************/
-static void StatusLedOrangeTimerUpdate(TickType_t period)
-{
-    /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
+        ticksToEdge = pdMS_TO_TICKS(msToEdge);
+        rtosApiResult = xTimerChangePeriod(xTimer_StatusLed, 
+            (ticksToEdge > 0u) ? ticksToEdge : 1u, 0u);
+    }
     
-    /* Change the timer period */
-    rtosApiResult = xTimerChangePeriod(xTimer_StatusLedOrange, period, 0u);
+    (void)xTaskResumeAll();
     
     /* Check if the operation has been successful */
     if(rtosApiResult != pdPASS)
     {
-        Task_DebugPrintf("Failure! : Status LED - Orange LED Timer update ",
-                          0u);   
+        Task_DebugPrintf("Failure! : Status LED - LED Timer update ", 0u);   
     }
 }
 
 /*******************************************************************************
-* Function Name: static void StatusLedRedTimerCallback(TimerHandle_t xTimer)                          
+* Function Name: static void StatusLedTimerCallback(TimerHandle_t xTimer)                          
 ********************************************************************************
 * Summary:
-*  This function is called when the Red LED Timer expires
+*  This function is called when the LED Timer expires at an LED edge
 *
 * Parameters:
 *  TimerHandle_t xTimer :  Current timer value (unused)
@@ -379,97 +289,43 @@ static void StatusLedOrangeTimerUpdate(TickType_t period)
 *  None
 *
 *******************************************************************************/
-static void StatusLedRedTimerCallback(TimerHandle_t xTimer)
+static void StatusLedTimerCallback(TimerHandle_t xTimer)
 {
-    /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
-    
     /* Remove warning for unused parameter */
     (void)xTimer;
     
-    /* Send command to refresh the LED state */
-    status_led_data_t ledRefreshData = 
-    {   .redLed     = LED_TIMER_EXPIRED,
-        .orangeLed  = LED_NO_CHANGE 
-    };
-    rtosApiResult = xQueueSend(statusLedDataQ, &ledRefreshData,0u);
-    
-    /* Check if the operation has been successful */
-    if(rtosApiResult != pdTRUE)
-    {
-        Task_DebugPrintf("Failure! : Status LED - Sending data to Status LED "\
-                         "queue",0u);    
-    }
+    /* Play the edges that are due, keeping the current patterns */
+    StatusLedUpdate(NULL, NULL);
 }
 
 /*******************************************************************************
-* Function Name: static void StatusLedRedTimerStart(void)                   
+* Function Name: static void StatusLedTimerStart(void)                 
 ********************************************************************************
 * Summary:
-*  This function starts the timer that provides timing to Red LED toggle / blink
+*  This function creates the one-shot timer that provides timing to the LED 
+*  edges. The timer is started by StatusLedUpdate().
 *
 * Parameters:
-*  void
-*
-* Return:
 *  None
 *
-*******************************************************************************/
-static void StatusLedRedTimerStart(void)
-{   
-    /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
-    
-    /* Create an RTOS timer */
-    xTimer_StatusLedRed    =  xTimerCreate ("Red Status LED Timer",
-                                            STATUS_LED_IDLE_INTERVAL, pdTRUE,
-                                            NULL, StatusLedRedTimerCallback);
-    
-    /* Make sure that timer handle is valid */
-    if (xTimer_StatusLedRed != NULL)
-    {
-        /* Start the timer */
-        rtosApiResult = xTimerStart(xTimer_StatusLedRed, 0u);
-        
-        /* Check if the operation has been successful */
-        if(rtosApiResult != pdPASS)
-        {
-            Task_DebugPrintf("Failure! : Status LED  - Red LED Timer "\
-                             "initialization", 0u);    
-        }
-    }
-    else
-    {
-        Task_DebugPrintf("Failure! : Status LED  - Red LED Timer creation", 0u); 
-    }
-}
-
-/*******************************************************************************
-* Function Name: static void StatusLedRedTimerUpdate(TickType_t period)                 
-********************************************************************************
-* Summary:
-*  This function updates the timer period per the parameter
-*
-* Parameters:
-*  TickType_t period :  Period of the timer in ticks
-*
 * Return:
 *  None
 *
 *******************************************************************************/
-static void StatusLedRedTimerUpdate(TickType_t period)
+static void StatusLedTimerStart(void)
 {
-    /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
-    
-    /* Change the timer period */
-    rtosApiResult = xTimerChangePeriod(xTimer_StatusLedRed, period, 0u);
+    /* Create an RTOS timer */
+    xTimer_StatusLed =  xTimerCreateStatic ("Status LED Timer",
+                                            pdMS_TO_TICKS(LED_PATTERN_SLOT_MS),
+                                            pdFALSE, NULL, 
+                                            StatusLedTimerCallback,
+                                            &statusLedTimerBuffer); 
     
-    /* Check if the operation has been successful */
-    if(rtosApiResult != pdPASS)
+    /* Make sure that timer handle is valid */
+    if (xTimer_StatusLed == NULL)
     {
-        Task_DebugPrintf("Failure! : Status LED - Red LED Timer update ", 0u);   
-    }
+        Task_DebugPrintf("Failure! : Status LED  - LED Timer creation", 0u); 
+    }  
 }
 
 /* [] END OF FILE */
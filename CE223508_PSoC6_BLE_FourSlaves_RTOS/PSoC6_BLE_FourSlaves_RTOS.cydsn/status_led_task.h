@@ -61,8 +61,7 @@ typedef enum
     LED_TURN_ON,
     LED_TURN_OFF,
     LED_TOGGLE_EN,
-    LED_BLINK_ONCE,
-    LED_TIMER_EXPIRED
+    LED_BLINK_ONCE
 }   status_led_command_t;
 
 /* Data-type used for the control of Red and Orange status LEDs  */
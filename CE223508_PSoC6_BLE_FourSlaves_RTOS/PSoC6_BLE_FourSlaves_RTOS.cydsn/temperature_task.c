@@ -44,31 +44,15 @@
 * This file contains the task that handles temperature sensing
 *******************************************************************************/
 #include "temperature_task.h"
-#include <math.h>
 #include "ble_task.h"
 #include "uart_debug.h"
 #include "timers.h"
+#include "thermistor.h"
 
 /* ADC channels used to measure reference and thermistor voltages */
 #define REFERENCE_CHANNEL   (uint32_t)(0x00u)
 #define THERMISTOR_CHANNEL  (uint32_t)(0x01u)
 
-/* Reference resistor in series with the thermistor is of 10 KOhm */
-#define R_REFERENCE         (float)(10000)
-
-/* See the thermistor (NCP18XH103F03RB) data sheet for more details. */
-/* Beta constant of this thermistor is 3380 Kelvin. */
-#define B_CONSTANT          (float)(3380) 
-/**
- * Resistance of the thermistor is 10K at 25 degrees C (from data sheet)
- * Therefore R0 = 10000 Ohm, and T0 = 298.15 Kelvin, which gives
- * R_INFINITY = R0 e^(-B_CONSTANT / T0) = 0.1192855 
- */
-#define R_INFINITY          (float)(0.1192855)
-
-/* Zero Kelvin in degree C */
-#define ABSOLUTE_ZERO       (float)(-273.15)
-
 /* Temperature scan interval */
 #define SCAN_INTERVAL               pdMS_TO_TICKS(500u)
 /* Idle interval used when no temperature scan required */
@@ -80,6 +64,9 @@ QueueHandle_t temperatureCommandQ;
 /* Timer handle for scan interval timer */
 TimerHandle_t xScanTimer;
 
+/* Control block of the scan interval timer */
+static StaticTimer_t scanTimerBuffer;
+
 bool tempTicklessIdleReadiness = false;
 
 /**
@@ -114,17 +101,14 @@ void Task_Temperature(void* pvParameters)
     /* Variables that stores ADC count values */
     int16_t countThermistor, countReference;
     
-    /* Variable that stores temperature */
-    float temperature;
-    
-    /* Variable that stores thermistor resistance */
-    float rThermistor;
+    /* Variable that stores temperature in hundredths of a degree C */
+    int32_t temperature;
     
     /* Remove warning for unused parameter */
     (void)pvParameters;
     
-    xScanTimer = xTimerCreate("Temperature Scan Timer", STATUS_IDLE_INTERVAL, \
-                 pdTRUE, NULL, ScanTimerCallback);
+    xScanTimer = xTimerCreateStatic("Temperature Scan Timer", STATUS_IDLE_INTERVAL, \
+                 pdTRUE, NULL, ScanTimerCallback, &scanTimerBuffer);
     xTimerStart(xScanTimer, 0u);
     
     /* Initialize the ADC  */
@@ -164,7 +148,11 @@ void Task_Temperature(void* pvParameters)
                     /* Set the GPIO that drives the thermistor circuit */
                     Cy_GPIO_Set(THER_VDD_0_PORT,THER_VDD_0_NUM);
                     
-                    /* Wake up the ADC and start conversion */
+                    /**
+                     * Wake up the ADC and start conversion. The ADC averages
+                     * 256 samples of each channel in hardware before it 
+                     * interrupts, so one scan gives one filtered reading.
+                     */
                     ADC_Wakeup();
                     ADC_StartConvert();
                     break;
@@ -189,26 +177,38 @@ void Task_Temperature(void* pvParameters)
                      */
                     Cy_GPIO_Clr(THER_VDD_0_PORT, THER_VDD_0_NUM);
                     
+                    /* Calculate the corresponding temperature */
+                    temperature = Thermistor_ConvertToTemperature(countThermistor, 
+                                                       countReference);
+                    
                     /**
-                     * Calculate the thermistor resistance and the corresponding
-                     * temperature 
+                     * Send updated temperature value to all connected devices. 
+                     * The value is passed in a pool block that Task_Ble owns
+                     * once the command has been queued.
                      */
-                    rThermistor = (R_REFERENCE*countThermistor)/countReference;    
-                    temperature = (B_CONSTANT/(logf(rThermistor/R_INFINITY)))+
-                                                                ABSOLUTE_ZERO;
-                    
-                    /* Send updated temperature value to all connected devices */
                     ble_commandAndData_t commandAndData =
                     {
                         .command = SEND_TEMP_INDICATION,
-                        .data    = (void*)&temperature
+                        .data    = MsgPool_Alloc()
                     };
-                    rtosApiResult = xQueueSend(bleCommandDataQ, &commandAndData, 0);
-                    /* Check if the operation has been successful */
-                    if(!rtosApiResult)
+                    
+                    if(commandAndData.data == MSG_POOL_NULL_HANDLE)
                     {
-                        Task_DebugPrintf("Failure! : Temperature - Failed to send BLE command",
-                            rtosApiResult); 
+                        Task_DebugPrintf("Failure! : Temperature - Message pool empty", 0u);
+                    }
+                    else
+                    {
+                        *(int32_t*)MsgPool_Get(commandAndData.data) = temperature;
+                        
+                        rtosApiResult = Task_Ble_SendCommand(&commandAndData, 0u);
+                        /* Check if the operation has been successful */
+                        if(!rtosApiResult)
+                        {
+                            /* The block was not handed over; return it */
+                            MsgPool_Free(commandAndData.data);
+                            Task_DebugPrintf("Failure! : Temperature - Failed to send BLE command",
+                                rtosApiResult); 
+                        }
                     }
                     
                     tempTicklessIdleReadiness = true;
@@ -297,21 +297,28 @@ static void ScanTimerCallback(TimerHandle_t xTimer)
 }
 
 /*******************************************************************************
-* Function Name: bool Task_Temp_Tickless_Idle_Readiness(void)
+* Function Name: tickless_idle_mode_t Task_Temp_Tickless_Idle_Readiness
+*                                     (TickType_t *ticksToDeadline)
 ********************************************************************************
 * Summary:
-*  Function that returns the Tickless Idle readiness of Task_Temperature
+*  Function that returns the Tickless Idle readiness of Task_Temperature. Only
+*  Sleep is allowed while an ADC conversion is in progress.
 *
 * Parameters:
-*  None                            
+*  ticksToDeadline : Ticks until the earliest deadline of the wake sources, 
+*                    not changed since the end of conversion wakes up the CPU
 *
 * Return:
-*  bool : Tickless Idle readiness 
+*  tickless_idle_mode_t : Deepest mode allowed by Task_Temperature 
 *
 *******************************************************************************/
-bool Task_Temp_Tickless_Idle_Readiness(void)
+tickless_idle_mode_t Task_Temp_Tickless_Idle_Readiness
+                     (TickType_t *ticksToDeadline)
 {
-    return tempTicklessIdleReadiness;
+    (void) ticksToDeadline;
+    
+    return tempTicklessIdleReadiness ? TICKLESS_IDLE_DEEP_SLEEP : 
+                                       TICKLESS_IDLE_SLEEP;
 }
 
 /* [] END OF FILE */
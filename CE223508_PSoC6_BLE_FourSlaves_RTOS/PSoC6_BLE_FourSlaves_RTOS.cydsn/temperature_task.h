@@ -51,6 +51,7 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "queue.h"
+#include "tickless_idle.h"
     
 /**
  * Declaration of Health Thermometer Service (HTS) specific macros.GATT
@@ -65,8 +66,8 @@
 #define HTS_TEMPERATURE_DATA_INDEX  (uint8_t) (1u)
 
 /**
- * Macros used to convert from IEEE-754 single precision floating 
- * point format to IEEE-11073 FLOAT with two decimal digits of precision 
+ * Macros used to convert from a temperature in hundredths of a degree C
+ * to IEEE-11073 FLOAT with two decimal digits of precision 
  */
 #define IEEE_11073_MANTISSA_SCALER  (uint8_t) (100u)
 #define IEEE_11073_EXPONENT_VALUE   (int8_t)  (-2)
@@ -98,7 +99,8 @@ extern QueueHandle_t temperatureCommandQ;
 void Task_Temperature(void* pvParameters);
 
 /* Function that returns the Tickless Idle readiness of Task_Temperature */
-bool Task_Temp_Tickless_Idle_Readiness(void);
+tickless_idle_mode_t Task_Temp_Tickless_Idle_Readiness
+                     (TickType_t *ticksToDeadline);
 
 #endif /* TEMPERATURE_TASK_H */
 
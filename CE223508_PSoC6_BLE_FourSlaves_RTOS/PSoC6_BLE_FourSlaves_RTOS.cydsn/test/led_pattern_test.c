@@ -0,0 +1,261 @@
+/******************************************************************************
+* File Name: led_pattern_test.c
+*
+* Version: 1.0
+*
+* Description: This file contains the host test of the LED pattern engine
+*              in led_pattern.c
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* The engine uses no RTOS or hardware API, so it is tested on the build host.
+* This file is not part of the PSoC Creator project. From this directory:
+*     gcc -std=c99 -Wall -I.. led_pattern_test.c ../led_pattern.c
+*     ./a.out
+* The program prints every failed check and returns non-zero if any failed.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stdio.h>
+#include "led_pattern.h"
+
+/* Checks if a time comes before another one across a wrap-around */
+#define IS_BEFORE(timeMs, otherMs)  ((int32_t)((timeMs) - (otherMs)) < 0)
+
+/* Length of the run of two blinking LEDs */
+#define TEST_RUN_MS             (60000u)
+
+/* Prints a failed check and counts it */
+#define CHECK(condition)        do                                          \
+                                {                                           \
+                                    if(!(condition))                        \
+                                    {                                       \
+                                        printf("%s:%d: %s\n", __FILE__,     \
+                                               __LINE__, #condition);       \
+                                        failures++;                         \
+                                    }                                       \
+                                } while(0)
+
+static uint32_t failures;
+
+/* One slot on, one slot off, repeated */
+static const led_pattern_step_t blinkSteps[] = {{true, 1u}, {false, 1u}};
+static const led_pattern_t blink = {blinkSteps, 2u, true};
+
+/* Off for one slot, then on until the next pattern */
+static const led_pattern_step_t holdOnSteps[] = {{false, 1u}, {true, 1u}};
+static const led_pattern_t holdOn = {holdOnSteps, 2u, false};
+
+/* On until the next pattern */
+static const led_pattern_step_t steadySteps[] = {{true, 0u}};
+static const led_pattern_t steady = {steadySteps, 1u, false};
+
+/*******************************************************************************
+* Function Name: static void TestSlotAlignment(void)
+********************************************************************************
+* Summary:
+*  Checks that a pattern starts from the nearest slot boundary, so its edges
+*  fall on slot boundaries
+*
+*******************************************************************************/
+static void TestSlotAlignment(void)
+{
+    led_pattern_engine_t engine;
+    
+    LedPattern_Init(&engine);
+    CHECK(!LedPattern_IsLedOn(&engine, 0u));
+    CHECK(LedPattern_Advance(&engine, 0u) == LED_PATTERN_NO_EDGE);
+    
+    /* 740 ms rounds down to 500 ms, the first edge is at 1000 ms */
+    LedPattern_Set(&engine, 0u, &blink, 740u);
+    CHECK(LedPattern_IsLedOn(&engine, 0u));
+    CHECK(LedPattern_Advance(&engine, 740u) == 260u);
+    
+    /* 760 ms rounds up to 1000 ms, the first edge is at 1500 ms */
+    LedPattern_Set(&engine, 0u, &blink, 760u);
+    CHECK(LedPattern_Advance(&engine, 760u) == 740u);
+    
+    /* An Advance() call that is late plays the missed steps on the grid */
+    CHECK(LedPattern_Advance(&engine, 2600u) == 400u);
+    CHECK(!LedPattern_IsLedOn(&engine, 0u));
+}
+
+/*******************************************************************************
+* Function Name: static void TestEdgeCoalescing(void)
+********************************************************************************
+* Summary:
+*  Runs two blinking LEDs started at unrelated times, waking up only when 
+*  LedPattern_Advance() asks for it. Checks that every wakeup is on a slot
+*  boundary and toggles both LEDs, so their edges share the wakeups.
+*
+*******************************************************************************/
+static void TestEdgeCoalescing(void)
+{
+    led_pattern_engine_t engine;
+    uint32_t nowMs;
+    uint32_t wakeups = 0u;
+    uint32_t edges = 0u;
+    uint32_t edgesNow;
+    uint32_t index;
+    bool     ledOn[LED_PATTERN_MAX_CHANNELS];
+    
+    LedPattern_Init(&engine);
+    LedPattern_Set(&engine, 0u, &blink, 137u);
+    LedPattern_Set(&engine, 1u, &blink, 612u);
+    nowMs = 612u + LedPattern_Advance(&engine, 612u);
+    for(index = 0u; index < LED_PATTERN_MAX_CHANNELS; index++)
+    {
+        ledOn[index] = LedPattern_IsLedOn(&engine, index);
+    }
+    
+    while(nowMs < TEST_RUN_MS)
+    {
+        (void)LedPattern_Advance(&engine, nowMs);
+        wakeups++;
+        
+        edgesNow = 0u;
+        for(index = 0u; index < LED_PATTERN_MAX_CHANNELS; index++)
+        {
+            if(LedPattern_IsLedOn(&engine, index) != ledOn[index])
+            {
+                ledOn[index] = !ledOn[index];
+                edgesNow++;
+            }
+        }
+        CHECK((nowMs % LED_PATTERN_SLOT_MS) == 0u);
+        CHECK(edgesNow == LED_PATTERN_MAX_CHANNELS);
+        edges += edgesNow;
+        
+        nowMs += LedPattern_Advance(&engine, nowMs);
+    }
+    
+    CHECK(wakeups == ((TEST_RUN_MS / LED_PATTERN_SLOT_MS) - 2u));
+    CHECK(edges == (wakeups * LED_PATTERN_MAX_CHANNELS));
+}
+
+/*******************************************************************************
+* Function Name: static void TestHoldLast(void)
+********************************************************************************
+* Summary:
+*  Checks that a pattern that does not repeat holds the state of its last 
+*  step, and that a step of 0 slots is held, with no edge pending
+*
+*******************************************************************************/
+static void TestHoldLast(void)
+{
+    led_pattern_engine_t engine;
+    
+    LedPattern_Init(&engine);
+    LedPattern_Set(&engine, 0u, &holdOn, 0u);
+    CHECK(!LedPattern_IsLedOn(&engine, 0u));
+    CHECK(LedPattern_Advance(&engine, 0u) == LED_PATTERN_SLOT_MS);
+    
+    CHECK(LedPattern_Advance(&engine, 500u) == LED_PATTERN_SLOT_MS);
+    CHECK(LedPattern_IsLedOn(&engine, 0u));
+    
+    /* The last step ends and its state is kept */
+    CHECK(LedPattern_Advance(&engine, 1000u) == LED_PATTERN_NO_EDGE);
+    CHECK(LedPattern_IsLedOn(&engine, 0u));
+    CHECK(LedPattern_Advance(&engine, 100000u) == LED_PATTERN_NO_EDGE);
+    CHECK(LedPattern_IsLedOn(&engine, 0u));
+    
+    /* A held LED does not hide the edges of the other one */
+    LedPattern_Set(&engine, 1u, &blink, 100000u);
+    CHECK(LedPattern_Advance(&engine, 100000u) == LED_PATTERN_SLOT_MS);
+    
+    LedPattern_Init(&engine);
+    LedPattern_Set(&engine, 1u, &steady, 0u);
+    CHECK(LedPattern_IsLedOn(&engine, 1u));
+    CHECK(LedPattern_Advance(&engine, 0u) == LED_PATTERN_NO_EDGE);
+}
+
+/*******************************************************************************
+* Function Name: static void TestWrapAround(void)
+********************************************************************************
+* Summary:
+*  Checks that a pattern set after a wrap-around of the millisecond count 
+*  shares the edges of a pattern set before it
+*
+*******************************************************************************/
+static void TestWrapAround(void)
+{
+    led_pattern_engine_t engine;
+    uint32_t nowMs = 0u - (3u * LED_PATTERN_SLOT_MS);
+    
+    LedPattern_Init(&engine);
+    LedPattern_Set(&engine, 0u, &blink, nowMs);
+    while(IS_BEFORE(nowMs, 300u))
+    {
+        nowMs += LedPattern_Advance(&engine, nowMs);
+    }
+    
+    /* The next edge of LED 0 is at 300 ms + 200 ms */
+    CHECK(LedPattern_Advance(&engine, 300u) == 200u);
+    LedPattern_Set(&engine, 1u, &blink, 300u);
+    CHECK(LedPattern_Advance(&engine, 300u) == 200u);
+    CHECK(LedPattern_IsLedOn(&engine, 1u));
+    
+    /* The first step of LED 1 counts from 500 ms, both LEDs change at 1 s */
+    CHECK(LedPattern_Advance(&engine, 500u) == LED_PATTERN_SLOT_MS);
+    CHECK(LedPattern_IsLedOn(&engine, 1u));
+    CHECK(LedPattern_Advance(&engine, 1000u) == LED_PATTERN_SLOT_MS);
+    CHECK(!LedPattern_IsLedOn(&engine, 1u));
+}
+
+/*******************************************************************************
+* Function Name: int main(void)
+********************************************************************************
+* Summary:
+*  Runs the tests
+*
+* Return:
+*  int : 0 if all checks passed
+*
+*******************************************************************************/
+int main(void)
+{
+    TestSlotAlignment();
+    TestEdgeCoalescing();
+    TestHoldLast();
+    TestWrapAround();
+    
+    printf("led_pattern_test: %u failed\n", (unsigned int)failures);
+    
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
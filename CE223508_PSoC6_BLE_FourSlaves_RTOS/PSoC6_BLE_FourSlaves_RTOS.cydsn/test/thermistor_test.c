@@ -0,0 +1,220 @@
+/******************************************************************************
+* File Name: thermistor_test.c
+*
+* Version: 1.0
+*
+* Description: This file contains the host test of the thermistor 
+*              temperature conversion in thermistor.c
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* The conversion only depends on the C library, so it is tested on the build
+* host. This file is not part of the PSoC Creator project. From this 
+* directory:
+*     gcc -std=c99 -Wall -I.. thermistor_test.c ../thermistor.c -lm
+*     ./a.out
+* The program prints every failed check and returns non-zero if any failed.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stdio.h>
+#include <math.h>
+#include "thermistor.h"
+
+/* Largest count of the 12-bit ADC */
+#define TEST_COUNT_MAX          (2047)
+
+/* Largest error versus the floating point equation, in hundredths of a 
+   degree C */
+#define TEST_MAX_ERROR          (6.0)
+
+/* Thermistor constants from the data sheet, see thermistor.c */
+#define TEST_R_REFERENCE        (10000.0)
+#define TEST_BETA               (3380.0)
+#define TEST_R_INFINITY         (0.1192855)
+#define TEST_KELVIN_OFFSET      (273.15)
+
+/* Prints a failed check and counts it */
+#define CHECK(condition)        do                                          \
+                                {                                           \
+                                    if(!(condition))                        \
+                                    {                                       \
+                                        printf("%s:%d: %s\n", __FILE__,     \
+                                               __LINE__, #condition);       \
+                                        failures++;                         \
+                                    }                                       \
+                                } while(0)
+
+static uint32_t failures;
+
+/*******************************************************************************
+* Function Name: static double ExactTemperature(int32_t countThermistor, 
+*                                               int32_t countReference)
+********************************************************************************
+* Summary:
+*  Evaluates the thermistor equation with floating point math
+*
+* Return:
+*  double : temperature in hundredths of a degree C, limited to the operating
+*           range
+*
+*******************************************************************************/
+static double ExactTemperature(int32_t countThermistor, int32_t countReference)
+{
+    double resistance;
+    double temperature;
+    
+    if(countReference == 0)
+    {
+        temperature = THERMISTOR_TEMP_MIN;
+    }
+    else if(countThermistor == 0)
+    {
+        temperature = THERMISTOR_TEMP_MAX;
+    }
+    else
+    {
+        resistance = (TEST_R_REFERENCE * countThermistor) / countReference;
+        temperature = 100.0 * ((TEST_BETA / log(resistance / TEST_R_INFINITY)) 
+                               - TEST_KELVIN_OFFSET);
+    }
+    
+    if(temperature < THERMISTOR_TEMP_MIN)
+    {
+        temperature = THERMISTOR_TEMP_MIN;
+    }
+    else if(temperature > THERMISTOR_TEMP_MAX)
+    {
+        temperature = THERMISTOR_TEMP_MAX;
+    }
+    
+    return temperature;
+}
+
+/*******************************************************************************
+* Function Name: static void TestEndpoints(void)
+********************************************************************************
+* Summary:
+*  Checks the ends of the table, the readings without voltage across the 
+*  thermistor or the reference resistor, and a ratio on a table entry
+*
+*******************************************************************************/
+static void TestEndpoints(void)
+{
+    /* Shorted thermistor: ratio 0, first table entry */
+    CHECK(Thermistor_ConvertToTemperature(0, 2000) == THERMISTOR_TEMP_MAX);
+    CHECK(Thermistor_ConvertToTemperature(-3, 2000) == THERMISTOR_TEMP_MAX);
+    
+    /* Open thermistor: the ratio is limited to the last table segment */
+    CHECK(Thermistor_ConvertToTemperature(2000, 0) == THERMISTOR_TEMP_MIN);
+    CHECK(Thermistor_ConvertToTemperature(2000, -3) == THERMISTOR_TEMP_MIN);
+    CHECK(Thermistor_ConvertToTemperature(TEST_COUNT_MAX, 1) == 
+          THERMISTOR_TEMP_MIN);
+    
+    /* No voltage across the circuit */
+    CHECK(Thermistor_ConvertToTemperature(0, 0) == THERMISTOR_TEMP_MAX);
+    
+    /* Equal counts: 10 KOhm, the table entry at ratio 0.5 is 25 degrees C */
+    CHECK(Thermistor_ConvertToTemperature(1000, 1000) == 2500);
+    
+    /* Just inside both ends of the operating range */
+    CHECK(Thermistor_ConvertToTemperature(70, 1000) < THERMISTOR_TEMP_MAX);
+    CHECK(Thermistor_ConvertToTemperature(1000, 50) > THERMISTOR_TEMP_MIN);
+}
+
+/*******************************************************************************
+* Function Name: static void TestAccuracy(void)
+********************************************************************************
+* Summary:
+*  Checks all pairs of ADC counts against the floating point equation, and 
+*  that the temperature falls as the thermistor count rises
+*
+*******************************************************************************/
+static void TestAccuracy(void)
+{
+    int32_t countThermistor;
+    int32_t countReference;
+    int32_t temperature;
+    int32_t previous;
+    double  error;
+    double  maxError = 0.0;
+    
+    for(countReference = 1; countReference <= TEST_COUNT_MAX; countReference++)
+    {
+        previous = THERMISTOR_TEMP_MAX;
+        for(countThermistor = 0; countThermistor <= TEST_COUNT_MAX; 
+            countThermistor++)
+        {
+            temperature = Thermistor_ConvertToTemperature(
+                (int16_t)countThermistor, (int16_t)countReference);
+            error = fabs(temperature - 
+                         ExactTemperature(countThermistor, countReference));
+            if(error > maxError)
+            {
+                maxError = error;
+            }
+            CHECK(temperature <= previous);
+            previous = temperature;
+        }
+    }
+    
+    printf("thermistor_test: largest error %.2f hundredths of a degree C\n", 
+           maxError);
+    CHECK(maxError <= TEST_MAX_ERROR);
+}
+
+/*******************************************************************************
+* Function Name: int main(void)
+********************************************************************************
+* Summary:
+*  Runs the tests
+*
+* Return:
+*  int : 0 if all checks passed
+*
+*******************************************************************************/
+int main(void)
+{
+    TestEndpoints();
+    TestAccuracy();
+    
+    printf("thermistor_test: %u failed\n", (unsigned int)failures);
+    
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
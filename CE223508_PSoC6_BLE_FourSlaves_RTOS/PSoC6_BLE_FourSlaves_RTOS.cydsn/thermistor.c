@@ -0,0 +1,181 @@
+/******************************************************************************
+* File Name: thermistor.c
+*
+* Version: 1.0
+*
+* Description: This file contains the thermistor temperature conversion
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the conversion from the ADC counts of the thermistor 
+* circuit to temperature. It uses no RTOS or hardware API.
+*******************************************************************************/
+
+/* Header file includes */
+#include "thermistor.h"
+
+/**
+ * The thermistor (NCP18XH103F03RB) is in series with a 10 KOhm reference 
+ * resistor, so the thermistor resistance is 
+ * R = R_REFERENCE * countThermistor / countReference. With a beta constant of 
+ * 3380 Kelvin and 10 KOhm at 25 degrees C (from the data sheet), the 
+ * temperature is T = B / ln(R / R_INFINITY) - 273.15, where 
+ * R_INFINITY = R0 e^(-B / T0) = 0.1192855 Ohm. See the thermistor data sheet 
+ * for more details.
+ *
+ * Instead of evaluating this equation with floating point math, the 
+ * temperature is read from a table indexed by the voltage divider ratio 
+ * x = countThermistor / (countThermistor + countReference), in Q16 format. 
+ * The ratio is split into TEMP_LUT_SEGMENTS segments; entry i holds the 
+ * temperature at x = i / TEMP_LUT_SEGMENTS, in hundredths of a degree C, and 
+ * the temperature between two entries is linearly interpolated. Between
+ * THERMISTOR_TEMP_MIN and THERMISTOR_TEMP_MAX the result is within 0.06 
+ * degree C of the floating point equation for all 12-bit ADC counts, which
+ * test/thermistor_test.c checks.
+ */
+#define TEMP_LUT_SEGMENT_BITS   (8u)
+#define TEMP_LUT_SEGMENTS       (1u << TEMP_LUT_SEGMENT_BITS)
+#define TEMP_RATIO_BITS         (16u)
+#define TEMP_LUT_FRACTION_BITS  (TEMP_RATIO_BITS - TEMP_LUT_SEGMENT_BITS)
+#define TEMP_LUT_FRACTION_MASK  ((1u << TEMP_LUT_FRACTION_BITS) - 1u)
+
+/* Temperature in hundredths of a degree C versus the voltage divider ratio */
+static const int16_t temperatureLut[TEMP_LUT_SEGMENTS + 1u] =
+{
+     32767,  31008,  24746,  21658,  19672,  18234,  17118,  16213,
+     15456,  14806,  14240,  13738,  13289,  12883,  12512,  12172,
+     11857,  11565,  11293,  11038,  10798,  10571,  10357,  10153,
+      9959,   9775,   9598,   9429,   9267,   9112,   8962,   8817,
+      8678,   8544,   8413,   8287,   8165,   8046,   7931,   7819,
+      7710,   7604,   7501,   7400,   7301,   7205,   7111,   7019,
+      6929,   6841,   6755,   6671,   6588,   6506,   6427,   6348,
+      6271,   6196,   6121,   6048,   5976,   5905,   5836,   5767,
+      5699,   5633,   5567,   5502,   5438,   5375,   5313,   5251,
+      5190,   5130,   5071,   5012,   4954,   4897,   4840,   4784,
+      4729,   4674,   4619,   4565,   4512,   4459,   4407,   4355,
+      4303,   4252,   4202,   4152,   4102,   4053,   4004,   3955,
+      3907,   3859,   3811,   3764,   3717,   3671,   3624,   3578,
+      3533,   3487,   3442,   3397,   3352,   3308,   3264,   3220,
+      3176,   3132,   3089,   3046,   3003,   2960,   2918,   2875,
+      2833,   2791,   2749,   2707,   2665,   2624,   2582,   2541,
+      2500,   2459,   2418,   2377,   2336,   2296,   2255,   2215,
+      2174,   2134,   2094,   2054,   2013,   1973,   1933,   1893,
+      1853,   1813,   1774,   1734,   1694,   1654,   1614,   1574,
+      1534,   1494,   1454,   1415,   1375,   1335,   1295,   1255,
+      1214,   1174,   1134,   1094,   1053,   1013,    972,    932,
+       891,    850,    809,    768,    727,    686,    645,    603,
+       561,    519,    477,    435,    393,    350,    307,    264,
+       221,    178,    134,     90,     46,      1,    -44,    -89,
+      -134,   -180,   -226,   -272,   -319,   -366,   -414,   -462,
+      -510,   -559,   -608,   -658,   -708,   -759,   -810,   -862,
+      -915,   -968,  -1022,  -1076,  -1132,  -1188,  -1245,  -1302,
+     -1361,  -1420,  -1481,  -1542,  -1605,  -1669,  -1734,  -1800,
+     -1868,  -1937,  -2008,  -2080,  -2154,  -2231,  -2309,  -2389,
+     -2472,  -2557,  -2645,  -2736,  -2831,  -2929,  -3031,  -3137,
+     -3249,  -3366,  -3489,  -3620,  -3759,  -3908,  -4068,  -4241,
+     -4432,  -4643,  -4881,  -5155,  -5480,  -5884,  -6426,  -7289,
+    -32768
+};
+
+/*******************************************************************************
+* Function Name: int32_t Thermistor_ConvertToTemperature(
+*                           int16_t countThermistor, int16_t countReference)
+********************************************************************************
+* Summary:
+*  This function converts the ADC counts of the thermistor circuit to 
+*  temperature
+*
+* Parameters:
+*  int16_t countThermistor : ADC count of the voltage across the thermistor
+*  int16_t countReference  : ADC count of the voltage across the reference 
+*                            resistor
+*
+* Return:
+*  int32_t : temperature in hundredths of a degree C, between 
+*            THERMISTOR_TEMP_MIN and THERMISTOR_TEMP_MAX
+*
+* Theory:
+*  The conversion takes one division to get the voltage divider ratio, and 
+*  a table lookup with linear interpolation. Negative counts, which can only 
+*  come from noise around zero volts, are treated as zero.
+*
+*******************************************************************************/
+int32_t Thermistor_ConvertToTemperature(int16_t countThermistor, 
+                                        int16_t countReference)
+{
+    uint32_t thermistor = (countThermistor > 0) ? (uint32_t)countThermistor : 0u;
+    uint32_t reference  = (countReference > 0) ? (uint32_t)countReference : 0u;
+    uint32_t ratio;
+    uint32_t index;
+    int32_t  fraction;
+    int32_t  temperature;
+    
+    /* Without any voltage across the circuit, the reading is out of range */
+    if((thermistor + reference) == 0u)
+    {
+        return THERMISTOR_TEMP_MAX;
+    }
+    
+    /* Voltage divider ratio in Q16 format; it is always less than 1.0 unless
+       the reference count is zero */
+    ratio = (thermistor << TEMP_RATIO_BITS) / (thermistor + reference);
+    if(ratio > ((1u << TEMP_RATIO_BITS) - 1u))
+    {
+        ratio = (1u << TEMP_RATIO_BITS) - 1u;
+    }
+    
+    index    = ratio >> TEMP_LUT_FRACTION_BITS;
+    fraction = (int32_t)(ratio & TEMP_LUT_FRACTION_MASK);
+    
+    /* Interpolate between the two table entries around the ratio */
+    temperature = temperatureLut[index] + 
+        (((int32_t)temperatureLut[index + 1u] - temperatureLut[index]) * 
+         fraction) / (int32_t)(1u << TEMP_LUT_FRACTION_BITS);
+    
+    if(temperature < THERMISTOR_TEMP_MIN)
+    {
+        temperature = THERMISTOR_TEMP_MIN;
+    }
+    else if(temperature > THERMISTOR_TEMP_MAX)
+    {
+        temperature = THERMISTOR_TEMP_MAX;
+    }
+    
+    return temperature;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,70 @@
+/******************************************************************************
+* File Name: thermistor.h
+*
+* Version: 1.0
+*
+* Description: This file contains the declaration of the thermistor 
+*              temperature conversion
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the conversion from the ADC counts of
+* the thermistor circuit to temperature
+*******************************************************************************/
+
+/* Include guard */
+#ifndef THERMISTOR_H
+#define THERMISTOR_H
+
+/* Header file includes */
+#include <stdint.h>
+
+/**
+ * Operating range of the thermistor in hundredths of a degree C. Readings 
+ * outside this range, such as from an open or shorted thermistor, are 
+ * limited to it.
+ */
+#define THERMISTOR_TEMP_MIN         (int32_t)(-4000)
+#define THERMISTOR_TEMP_MAX         (int32_t)(12500)
+
+/* Converts the ADC counts of the thermistor circuit to temperature */
+int32_t Thermistor_ConvertToTemperature(int16_t countThermistor, 
+                                        int16_t countReference);
+
+#endif /* THERMISTOR_H */
+
+/* [] END OF FILE */
@@ -61,12 +61,52 @@
 #define TicksToMcwdtCount(x)    (((x*CYDEV_CLK_LFCLK__HZ)/configTICK_RATE_HZ)-1)
 #define McwdtCountToTicks(x)    (((x*configTICK_RATE_HZ)/CYDEV_CLK_LFCLK__HZ)+1)
 
-/* Function for checking the tickless idle entry readiness of the system */
-tickless_readiness_function_t   IsReadyForTicklessIdle;
+/* Registered wake sources */
+static tickless_wake_source_t wakeSources[TICKLESS_IDLE_MAX_SOURCES];
+static uint32_t               wakeSourceCount = 0u;
+
+/* Time spent in Tickless Idle */
+static tickless_idle_stats_t  ticklessIdleStats;
 
 /* Flag used to detect a MCWDT match event */
 bool static mcwdtMatchEvent = false;
 
+/*******************************************************************************
+* Function Name: static tickless_idle_mode_t GetIdleMode(TickType_t *idleTicks)
+********************************************************************************
+* Summary:
+*  Asks every registered wake source for the deepest mode it allows and for 
+*  its next deadline.
+*
+* Parameters:
+*  idleTicks : Expected idle time of the RTOS on entry, time until the earliest
+*              deadline of the RTOS or of a wake source on return
+*
+* Return:
+*  tickless_idle_mode_t : Deepest mode that all wake sources allow
+*
+*******************************************************************************/
+static tickless_idle_mode_t GetIdleMode(TickType_t *idleTicks)
+{
+    tickless_idle_mode_t idleMode = TICKLESS_IDLE_DEEP_SLEEP;
+    tickless_idle_mode_t sourceMode;
+    uint32_t index;
+    
+    /* All sources are asked, even when one of them has already limited the 
+       mode, so that every deadline is taken into account */
+    for(index = 0u; index < wakeSourceCount; index++)
+    {
+        sourceMode = wakeSources[index](idleTicks);
+        
+        if(sourceMode < idleMode)
+        {
+            idleMode = sourceMode;
+        }
+    }
+    
+    return idleMode;
+}
+
 /*******************************************************************************
 * Function Name: void vApplicationSleep(TickType_t xExpectedIdleTime)
 ********************************************************************************
@@ -80,11 +120,21 @@ bool static mcwdtMatchEvent = false;
 * Return:
 *  void
 *
+* Theory:
+*  The system enters the deepest mode that all the registered wake sources 
+*  allow. A source that only allows Sleep, for example while a peripheral is 
+*  still running on the high frequency clocks, does not keep the RTOS tick 
+*  running: the MCWDT wakes up the CPU at the earliest deadline of the RTOS
+*  and of the wake sources, so that the sources are asked again as soon as one
+*  of them may allow Deep Sleep.
+*
 *******************************************************************************/
 void vApplicationSleep(TickType_t xExpectedIdleTime)
 {
     /* Local variables used to store the system status and MCWDT values */
-    bool     deepSleepEntry = false;
+    tickless_idle_mode_t idleMode;
+    TickType_t idleTicks = xExpectedIdleTime;
+    TickType_t elapsedTicks;
     bool     portMaxDelayDetected = false;
     uint16_t counterMatchValue = UINT16_MAX;
     uint16_t counterCurrentValue;
@@ -92,25 +142,21 @@ void vApplicationSleep(TickType_t xExpectedIdleTime)
     /* Stop the SysTick Timer that is generating the RTOS tick interrupt */
     Cy_SysTick_Disable();
     
-    /* Check if the user tasks are ready to enter Tickless Idle  */
-    if (IsReadyForTicklessIdle())
-    {       
-        /* PortMaxDelay detected */
-        if(xExpectedIdleTime > PORT_MAX_DETECT)
-        {
-            portMaxDelayDetected = true;
-        }
-        /* Check if the expected wait time is below the maximum count value
-           possible by MCWDT Counter0 */
-        else if(xExpectedIdleTime < (TickType_t)McwdtCountToTicks(UINT16_MAX))
-        {
-            /* Calculate MCWDT Counter0 value corresponding to the given
-               expected idle time */
-            counterMatchValue = (uint16_t)TicksToMcwdtCount(xExpectedIdleTime); 
-        }
-        
-        /* Indicate Deep Sleep entry readiness */
-        deepSleepEntry = true;
+    /* Find the deepest mode allowed by the wake sources and the time at which
+       the RTOS or one of the wake sources needs the CPU again */
+    idleMode = GetIdleMode(&idleTicks);
+    
+    /* PortMaxDelay detected, and none of the wake sources has a deadline */
+    if(idleTicks > PORT_MAX_DETECT)
+    {
+        portMaxDelayDetected = true;
+    }
+    /* Check if the idle time is below the maximum count value possible by 
+       MCWDT Counter0 */
+    else if(idleTicks < (TickType_t)McwdtCountToTicks(UINT16_MAX))
+    {
+        /* Calculate MCWDT Counter0 value corresponding to the idle time */
+        counterMatchValue = (uint16_t)TicksToMcwdtCount(idleTicks); 
     }
 
     /* Ensure it is still OK to enter the sleep mode. */
@@ -121,63 +167,75 @@ void vApplicationSleep(TickType_t xExpectedIdleTime)
         enter Tickless Idle. Restart the RTOS tick counter instead */ 
         Cy_SysTick_Enable();
     }
+    /* A wake source has a deadline in the current tick */
+    else if(idleTicks == 0u)
+    {
+        /* Restart the RTOS tick counter */
+        Cy_SysTick_Enable();
+        /* Enter Sleep mode and wait for next tick to re-check the wake 
+           sources */
+        Cy_SysPm_Sleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+    }
     else
     {     
-        /* OK to enter Deep Sleep mode */
-        if (deepSleepEntry == true)
+        /* If portMaxDelay is detected, do not use any timed-wake up. 
+           In this case, an external interrupt such as GPIO interrupt 
+           should be used to wake up from Tickless Idle */
+        if(!portMaxDelayDetected)
+        {
+            /* Set up the MCWDT Counter0 for the required wakeup time */
+            mcwdtMatchEvent = false;
+            Cy_MCWDT_ResetCounters(MCWDT_HW, CY_MCWDT_CTR0,
+                                   MCWDT_RESET_API_WAIT);
+            Cy_MCWDT_SetMatch(MCWDT_HW, CY_MCWDT_COUNTER0, 
+                              counterMatchValue, MCWDT_COMMON_API_WAIT);
+            Cy_MCWDT_Enable(MCWDT_HW, CY_MCWDT_CTR0, MCWDT_COMMON_API_WAIT);
+        }
+        
+        /* Enter the deepest mode allowed by the wake sources */
+        if(idleMode == TICKLESS_IDLE_DEEP_SLEEP)
+        {
+            Cy_SysPm_DeepSleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+        }
+        else
+        {
+            Cy_SysPm_Sleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+        }
+        
+        if(!portMaxDelayDetected)
         {
-            /* If portMaxDelay is detected, do not use any timed-wake up. 
-               In this case, an external interrupt such as GPIO interrupt 
-               should be used to wake up from Tickless Idle */
-            if(!portMaxDelayDetected)
+            /* MCWDT match event has occurred */
+            if (mcwdtMatchEvent)
             {
-                /* Set up the MCWDT Counter0 for the required wakeup time */
-                mcwdtMatchEvent = false;
-                Cy_MCWDT_ResetCounters(MCWDT_HW, CY_MCWDT_CTR0,
-                                       MCWDT_RESET_API_WAIT);
-                Cy_MCWDT_SetMatch(MCWDT_HW, CY_MCWDT_COUNTER0, 
-                                  counterMatchValue, MCWDT_COMMON_API_WAIT);
-                Cy_MCWDT_Enable(MCWDT_HW, CY_MCWDT_CTR0, MCWDT_COMMON_API_WAIT);
+                counterCurrentValue = counterMatchValue;
+            }
+            /* Other source of wakeup */
+            else
+            {
+                /* Disable MCWDT and retrieve count value */
+                Cy_MCWDT_Disable(MCWDT_HW, CY_MCWDT_CTR0,
+                                 MCWDT_COMMON_API_WAIT);
+                counterCurrentValue = (Cy_MCWDT_GetCount
+                                       (MCWDT_HW,CY_MCWDT_COUNTER0));
             }
             
-            /* Enter Deep Sleep mode */
-            Cy_SysPm_DeepSleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+            /* Correct the RTOS Kernel's tick count to account for the time
+               spent in the low power mode */
+            elapsedTicks = (TickType_t)McwdtCountToTicks(counterCurrentValue);
+            vTaskStepTick(elapsedTicks);
             
-            if(!portMaxDelayDetected)
+            if(idleMode == TICKLESS_IDLE_DEEP_SLEEP)
             {
-                /* MCWDT match event has occurred */
-                if (mcwdtMatchEvent)
-                {
-                    counterCurrentValue = counterMatchValue;
-                }
-                /* Other source of wakeup */
-                else
-                {
-                    /* Disable MCWDT and retrieve count value */
-                    Cy_MCWDT_Disable(MCWDT_HW, CY_MCWDT_CTR0,
-                                     MCWDT_COMMON_API_WAIT);
-                    counterCurrentValue = (Cy_MCWDT_GetCount
-                                           (MCWDT_HW,CY_MCWDT_COUNTER0));
-                }
-                
-                 /* Correct the RTOS Kernel's tick count to account for the time
-                    spent in the Deep Sleep mode */
-                vTaskStepTick((TickType_t)McwdtCountToTicks
-                                          (counterCurrentValue));
+                ticklessIdleStats.deepSleepTicks += elapsedTicks;
+            }
+            else
+            {
+                ticklessIdleStats.sleepTicks += elapsedTicks;
             }
-            
-            /* Restart the RTOS tick counter */
-            Cy_SysTick_Enable();
         }
-        /* Tasks are not ready for Deep Sleep */
-        else
-        {
-            /* Restart the RTOS tick counter */
-            Cy_SysTick_Enable();
-            /* Enter Sleep mode and wait for next tick to re-check if the 
-               tasks are OK to enter Deep Sleep */
-            Cy_SysPm_Sleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
-        }      
+        
+        /* Restart the RTOS tick counter */
+        Cy_SysTick_Enable();
     }
 }
 
@@ -222,10 +280,8 @@ void IsrMcwdt(void)
 *  None
 *
 *******************************************************************************/
-void TicklessIdleInit(tickless_readiness_function_t TicklessIdleReadiness)
+void TicklessIdleInit(void)
 {
-    IsReadyForTicklessIdle = TicklessIdleReadiness;
-    
     /* Initialize the MCDWT */
     Cy_MCWDT_Init(MCWDT_HW, &MCWDT_config);
     /* Enable the interrupts for MCDWT Counter 0 */
@@ -237,4 +293,58 @@ void TicklessIdleInit(tickless_readiness_function_t TicklessIdleReadiness)
     NVIC_EnableIRQ((IRQn_Type)MCWDT_isr_cfg.intrSrc);
 }
 
+/*******************************************************************************
+* Function Name: bool TicklessIdleAddSource(tickless_wake_source_t wakeSource)
+********************************************************************************
+*
+* Summary:
+*  Registers a wake source that is consulted every time the system is about to
+*  enter Tickless Idle. Call this function before the RTOS scheduler is 
+*  started.
+*    
+* Parameters:
+*  wakeSource : Function that returns the deepest mode allowed by the source 
+*               and its next deadline
+*
+* Return:
+*  bool : true if the source was registered, false if the table is full
+*
+*******************************************************************************/
+bool TicklessIdleAddSource(tickless_wake_source_t wakeSource)
+{
+    bool result = false;
+    
+    if((wakeSource != NULL) && (wakeSourceCount < TICKLESS_IDLE_MAX_SOURCES))
+    {
+        wakeSources[wakeSourceCount] = wakeSource;
+        wakeSourceCount++;
+        result = true;
+    }
+    
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: void TicklessIdleGetStats(tickless_idle_stats_t *stats)
+********************************************************************************
+*
+* Summary:
+*  Returns the time spent in the Sleep and Deep Sleep modes with a timed 
+*  wakeup. Idle periods that end only on an external interrupt are not counted 
+*  since their length is not measured.
+*    
+* Parameters:
+*  stats : Pointer to the structure that receives the time in RTOS ticks
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TicklessIdleGetStats(tickless_idle_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = ticklessIdleStats;
+    taskEXIT_CRITICAL();
+}
+
 /* [] END OF FILE */
@@ -49,13 +49,47 @@
 
 /* Header file includes */    
 #include "project.h"
-    
-/* Callback function prototype for checking the tickless idle entry readiness 
-   of the system */
-typedef bool (*tickless_readiness_function_t) (void);     
+#include "FreeRTOS.h"
+
+/* Maximum number of wake sources that can be registered */
+#define TICKLESS_IDLE_MAX_SOURCES   (6u)
+
+/* Low power modes used by Tickless Idle, from the shallowest to the deepest */
+typedef enum
+{
+    TICKLESS_IDLE_SLEEP,
+    TICKLESS_IDLE_DEEP_SLEEP
+}   tickless_idle_mode_t;
+
+/** 
+ * Callback function prototype of a Tickless Idle wake source. The function 
+ * returns the deepest mode that the source allows at the moment. A source 
+ * that needs the CPU before the next RTOS task unblocks lowers the value
+ * pointed by ticksToDeadline to the number of ticks until its deadline, and 
+ * leaves it unchanged otherwise 
+ */
+typedef tickless_idle_mode_t (*tickless_wake_source_t) 
+                             (TickType_t *ticksToDeadline);
+
+/** 
+ * Time spent in Tickless Idle, in RTOS ticks. The BLE task prints both counts
+ * when it stops; run the same scenario with and without a wake source 
+ * registered to see how the time splits between Sleep and Deep Sleep 
+ */
+typedef struct
+{
+    uint32_t sleepTicks;
+    uint32_t deepSleepTicks;
+}   tickless_idle_stats_t;
 
 /* Function that initializes the components used for enabling Tickless Idle */   
-void TicklessIdleInit(tickless_readiness_function_t);
+void TicklessIdleInit(void);
+
+/* Function that registers a wake source with Tickless Idle */
+bool TicklessIdleAddSource(tickless_wake_source_t wakeSource);
+
+/* Function that returns the time spent in Tickless Idle */
+void TicklessIdleGetStats(tickless_idle_stats_t *stats);
 
 #endif /* TICKLESS_IDLE_H */
 /* [] END OF FILE */
@@ -0,0 +1,337 @@
+/******************************************************************************
+* File Name: tx_scheduler.c
+*
+* Version: 1.0
+*
+* Description: This file contains the BLE transmission scheduler
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the scheduler of the notifications and indications sent to
+* the connected centrals. Every link has a set of pending values; a new value
+* replaces the one still pending, so a slow link only ever receives the latest
+* data. The links are served round-robin, one value per link and turn, and a
+* link whose stack buffers are full is parked until the stack reports free
+* buffers again, so it does not hold back the other links.
+*******************************************************************************/
+
+/* Header file includes */
+#include "tx_scheduler.h"
+#include <stddef.h>
+
+/* Pending values and parked links are kept as bit masks */
+#if ((TX_SCHED_ITEM_COUNT > 8) || (TX_SCHED_MAX_LINKS > 8u))
+    #error "Too many items or links for the 8-bit masks"
+#endif
+
+/* Function that sends the values */
+static tx_sched_send_t txSendFunction = NULL;
+
+/* Pending values of every link, one bit per tx_sched_item_t */
+static uint8_t pendingItems[TX_SCHED_MAX_LINKS];
+
+/* Value of every link that is tried first on its next turn */
+static uint8_t nextItem[TX_SCHED_MAX_LINKS];
+
+/* Links parked because their stack buffers are full, one bit per link */
+static uint8_t parkedLinks = 0u;
+
+/* Link that is served first on the next TxSched_Run() */
+static uint32_t nextLink = 0u;
+
+/* Counters of the scheduler */
+static tx_sched_stats_t txSchedStats;
+
+/*******************************************************************************
+* Function Name: static bool ServeLink(uint32_t link)
+********************************************************************************
+* Summary:
+*  Sends one pending value of a link. The values of the link take turns too, 
+*  so that a value that has to wait does not hold back the others.
+*
+* Parameters:
+*  uint32_t link : Link to serve
+*
+* Return:
+*  bool : true if a pending value was sent or dropped
+*
+*******************************************************************************/
+static bool ServeLink(uint32_t link)
+{
+    bool     served = false;
+    uint32_t count;
+    uint32_t item;
+    uint8_t  itemMask;
+    
+    if((parkedLinks & (1u << link)) != 0u)
+    {
+        return false;
+    }
+    
+    for(count = 0u; (count < (uint32_t)TX_SCHED_ITEM_COUNT) && (!served); 
+        count++)
+    {
+        item = (nextItem[link] + count) % (uint32_t)TX_SCHED_ITEM_COUNT;
+        itemMask = (uint8_t)(1u << item);
+        
+        if((pendingItems[link] & itemMask) == 0u)
+        {
+            continue;
+        }
+        
+        switch(txSendFunction(link, (tx_sched_item_t)item))
+        {
+            case TX_SCHED_SENT:
+            {
+                txSchedStats.sent++;
+                pendingItems[link] &= (uint8_t)~itemMask;
+                nextItem[link] = (uint8_t)((item + 1u) % 
+                                           (uint32_t)TX_SCHED_ITEM_COUNT);
+                served = true;
+                break;
+            }
+            case TX_SCHED_DROPPED:
+            {
+                pendingItems[link] &= (uint8_t)~itemMask;
+                served = true;
+                break;
+            }
+            case TX_SCHED_BUSY:
+            {
+                txSchedStats.parked++;
+                parkedLinks |= (uint8_t)(1u << link);
+                return false;
+            }
+            default:
+            {
+                /* TX_SCHED_WAIT, try the next value of the link */
+                break;
+            }
+        }
+    }
+    
+    return served;
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_Init(tx_sched_send_t sendFunction)
+********************************************************************************
+* Summary:
+*  Initializes the scheduler
+*
+* Parameters:
+*  tx_sched_send_t sendFunction : Function that sends a value to a link
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_Init(tx_sched_send_t sendFunction)
+{
+    uint32_t link;
+    
+    txSendFunction = sendFunction;
+    
+    for(link = 0u; link < TX_SCHED_MAX_LINKS; link++)
+    {
+        pendingItems[link] = 0u;
+        nextItem[link]     = 0u;
+    }
+    parkedLinks = 0u;
+    nextLink    = 0u;
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_Post(uint32_t link, tx_sched_item_t item)
+********************************************************************************
+* Summary:
+*  Marks a new value as pending for a link. A value of the same kind that is 
+*  still pending is replaced, since only the latest value is sent. A parked 
+*  link is resumed, so that it is tried again at least once per new value 
+*  even if the stack does not report free buffers.
+*
+* Parameters:
+*  uint32_t link        : Link that receives the value
+*  tx_sched_item_t item : Kind of the value
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_Post(uint32_t link, tx_sched_item_t item)
+{
+    uint8_t itemMask = (uint8_t)(1u << (uint32_t)item);
+    
+    if(link < TX_SCHED_MAX_LINKS)
+    {
+        if((pendingItems[link] & itemMask) != 0u)
+        {
+            txSchedStats.coalesced++;
+        }
+        pendingItems[link] |= itemMask;
+        parkedLinks &= (uint8_t)~(1u << link);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_PostAll(tx_sched_item_t item)
+********************************************************************************
+* Summary:
+*  Marks a new value as pending for all the links
+*
+* Parameters:
+*  tx_sched_item_t item : Kind of the value
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_PostAll(tx_sched_item_t item)
+{
+    uint32_t link;
+    
+    for(link = 0u; link < TX_SCHED_MAX_LINKS; link++)
+    {
+        TxSched_Post(link, item);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_Run(void)
+********************************************************************************
+* Summary:
+*  Sends the pending values, one value per link and turn, until a full round
+*  over the links makes no progress
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The next call starts with the link that follows the last one served, so 
+*  when the stack runs out of buffers during a round it is not always the 
+*  same link that has to wait.
+*
+*******************************************************************************/
+void TxSched_Run(void)
+{
+    uint32_t link = nextLink;
+    uint32_t idleLinks = 0u;
+    
+    if(txSendFunction == NULL)
+    {
+        return;
+    }
+    
+    while(idleLinks < TX_SCHED_MAX_LINKS)
+    {
+        if(ServeLink(link))
+        {
+            idleLinks = 0u;
+            nextLink  = (link + 1u) % TX_SCHED_MAX_LINKS;
+        }
+        else
+        {
+            idleLinks++;
+        }
+        link = (link + 1u) % TX_SCHED_MAX_LINKS;
+    }
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_Unpark(void)
+********************************************************************************
+* Summary:
+*  Resumes the links that were parked because their stack buffers were full.
+*  Call TxSched_Run() afterwards to send their pending values.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_Unpark(void)
+{
+    parkedLinks = 0u;
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_ResetLink(uint32_t link)
+********************************************************************************
+* Summary:
+*  Drops the pending values of a link and resumes it if it was parked
+*
+* Parameters:
+*  uint32_t link : Link to reset
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_ResetLink(uint32_t link)
+{
+    if(link < TX_SCHED_MAX_LINKS)
+    {
+        pendingItems[link] = 0u;
+        nextItem[link]     = 0u;
+        parkedLinks &= (uint8_t)~(1u << link);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void TxSched_GetStats(tx_sched_stats_t *stats)
+********************************************************************************
+* Summary:
+*  Returns the counters of the scheduler
+*
+* Parameters:
+*  tx_sched_stats_t *stats : Structure that receives the counters
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void TxSched_GetStats(tx_sched_stats_t *stats)
+{
+    *stats = txSchedStats;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name: tx_scheduler.h
+*
+* Version: 1.0
+*
+* Description: This file is the public interface of tx_scheduler.c source file
+*
+* Related Document: CE223508_PSoC6_BLE_FourSlaves_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the scheduler that shares the BLE
+* transmissions fairly between the connected centrals
+*******************************************************************************/
+
+/* Include guard */
+#ifndef TX_SCHEDULER_H
+#define TX_SCHEDULER_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Maximum number of links, must not be less than CY_BLE_CONN_COUNT */
+#define TX_SCHED_MAX_LINKS      (4u)
+
+/* Values sent to the centrals. A link holds at most one pending value of each
+   kind; the value itself is read by the send function when it is sent */
+typedef enum
+{
+    TX_SCHED_CUSTOM_NOTIFICATION,
+    TX_SCHED_TEMP_INDICATION,
+    TX_SCHED_ITEM_COUNT
+}   tx_sched_item_t;
+
+/* Result of sending a value to a link */
+typedef enum
+{
+    TX_SCHED_SENT,      /* Value sent */
+    TX_SCHED_DROPPED,   /* Value not wanted by the link, for example not 
+                           connected or notifications disabled */
+    TX_SCHED_WAIT,      /* Value kept pending, the other values of the link 
+                           can still be sent */
+    TX_SCHED_BUSY       /* Stack buffers of the link are full, the link is
+                           parked until TxSched_Unpark() is called or a new
+                           value is posted to it */
+}   tx_sched_result_t;
+
+/* Function that sends a value to a link */
+typedef tx_sched_result_t (*tx_sched_send_t) (uint32_t link, 
+                                              tx_sched_item_t item);
+
+/* Counters of the scheduler */
+typedef struct
+{
+    /* Values sent to the links */
+    uint32_t sent;
+    /* Values replaced by a newer one before they were sent */
+    uint32_t coalesced;
+    /* Times a link was parked because its stack buffers were full */
+    uint32_t parked;
+}   tx_sched_stats_t;
+
+/* Initializes the scheduler with the function that sends the values. The
+   scheduler is not thread-safe, all the functions are called by one task */
+void TxSched_Init(tx_sched_send_t sendFunction);
+
+/* Marks a new value as pending for one link or for all the links */
+void TxSched_Post(uint32_t link, tx_sched_item_t item);
+void TxSched_PostAll(tx_sched_item_t item);
+
+/* Sends the pending values until all the links are done, waiting or parked */
+void TxSched_Run(void);
+
+/* Resumes the parked links after the stack reported free buffers */
+void TxSched_Unpark(void);
+
+/* Drops the pending values of a link, for example on disconnection */
+void TxSched_ResetLink(uint32_t link);
+
+/* Returns the counters of the scheduler */
+void TxSched_GetStats(tx_sched_stats_t *stats);
+
+#endif /* TX_SCHEDULER_H */
+
+/* [] END OF FILE */
@@ -53,6 +53,36 @@
 /* Queue handle for debug message Queue */       
 QueueHandle_t debugMessageQ;
 
+/* Stack, control block and queue storage of Task_Debug */
+static StackType_t   debugTaskStack[configMINIMAL_STACK_SIZE];
+static StaticTask_t  debugTaskBuffer;
+static uint8_t       debugMessageQStorage[DEBUG_QUEUE_SIZE * 
+                                          sizeof(debug_print_data_t)];
+static StaticQueue_t debugMessageQBuffer;
+
+/*******************************************************************************
+* Function Name: void InitDebugPrintf(void)
+********************************************************************************
+* Summary:
+*  Creates Task_Debug and the Queue of the debug messages
+*
+* Parameters:
+*  None
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void InitDebugPrintf(void)
+{
+    debugMessageQ = xQueueCreateStatic(DEBUG_QUEUE_SIZE,
+                                       sizeof(debug_print_data_t),
+                                       debugMessageQStorage,
+                                       &debugMessageQBuffer);
+    xTaskCreateStatic(Task_Debug, "Debug Task", configMINIMAL_STACK_SIZE, NULL,
+                      (tskIDLE_PRIORITY+1u), debugTaskStack, &debugTaskBuffer);
+}
+
 /*******************************************************************************
 * Function Name: void Task_Debug(void *pvParameters)
 ********************************************************************************
@@ -104,6 +134,50 @@ void Task_Debug(void *pvParameters)
     }
 }
 
+/*******************************************************************************
+* Function Name: tickless_idle_mode_t Task_Debug_Tickless_Idle_Readiness
+*                                     (TickType_t *ticksToDeadline)
+********************************************************************************
+* Summary:
+*  This function returns the Tickless Idle readiness of Task_Debug. The UART
+*  does not run in Deep Sleep, so only Sleep is allowed while the bytes in the
+*  TX FIFO are being sent. The deadline is the time needed to send them, after
+*  which Deep Sleep is allowed again.
+*
+* Parameters:
+*  ticksToDeadline : Ticks until the earliest deadline of the wake sources
+*
+* Return:
+*  tickless_idle_mode_t : Deepest mode allowed by Task_Debug
+*
+*******************************************************************************/
+tickless_idle_mode_t Task_Debug_Tickless_Idle_Readiness
+                     (TickType_t *ticksToDeadline)
+{
+    tickless_idle_mode_t idleMode = TICKLESS_IDLE_DEEP_SLEEP;
+    TickType_t drainTicks;
+    uint32_t   pendingBytes = DEBUG_UART_GetNumInTxFifo() + 
+                              Cy_SCB_GetTxSrValid(DEBUG_UART_SCB__HW);
+    
+    if(pendingBytes != 0u)
+    {
+        /* Time in ticks to send the pending bytes, rounded up */
+        drainTicks = (TickType_t)(((pendingBytes * DEBUG_UART_BITS_PER_BYTE *
+                                    configTICK_RATE_HZ) + 
+                                   (DEBUG_UART_BAUD_RATE - 1u)) / 
+                                  DEBUG_UART_BAUD_RATE);
+        
+        if(drainTicks < *ticksToDeadline)
+        {
+            *ticksToDeadline = drainTicks;
+        }
+        
+        idleMode = TICKLESS_IDLE_SLEEP;
+    }
+    
+    return idleMode;
+}
+
 #endif /* UART_DEBUG_ENABLE */ 
 
 /* [] END OF FILE */
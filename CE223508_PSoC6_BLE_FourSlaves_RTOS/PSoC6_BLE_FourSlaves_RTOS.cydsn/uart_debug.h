@@ -72,6 +72,7 @@
     #include "FreeRTOS.h"
     #include "task.h"
     #include "queue.h"
+    #include "tickless_idle.h"
 #endif
   
 /**
@@ -123,10 +124,9 @@
         /* Maximum number of debug messages that can be queued */
         #define DEBUG_QUEUE_SIZE    16u
         
-		/* Function that checks for Tickless Idle entry readiness of Task_Debug */
-        #define Task_Debug_Tickless_Idle_Readiness()       \
-                     ((DEBUG_UART_GetNumInTxFifo() == 0u)&& \
-                     (Cy_SCB_GetTxSrValid(DEBUG_UART_SCB__HW)== 0u))
+        /* Baud rate of the DEBUG_UART component and bits sent per byte */
+        #define DEBUG_UART_BAUD_RATE        (115200u)
+        #define DEBUG_UART_BITS_PER_BYTE    (10u)
 
         /* Datatype used for debug queue */
         typedef struct
@@ -141,14 +141,12 @@
         /* Task that performs thread safe debug message printing */
         void Task_Debug(void *pvParameters);
         
-        /* Inline function that creates the underlying Task and Queue  */
-        void inline static InitDebugPrintf()
-        {
-            debugMessageQ = xQueueCreate(DEBUG_QUEUE_SIZE,
-                                            sizeof(debug_print_data_t));
-            xTaskCreate(Task_Debug, "Debug Task", configMINIMAL_STACK_SIZE, NULL,
-                        (tskIDLE_PRIORITY+1u), NULL);
-        }        
+        /* Function that creates the underlying Task and Queue  */
+        void InitDebugPrintf(void);
+        
+        /* Function that returns the Tickless Idle readiness of Task_Debug */
+        tickless_idle_mode_t Task_Debug_Tickless_Idle_Readiness
+                             (TickType_t *ticksToDeadline);
         
         /* Inline function that sends messages to the debug Queue */
         void inline static SendToDebugPrintTask(char* stringPtr, uint32_t errCode)
@@ -171,7 +169,6 @@
     #define Task_DebugInit()
     #define Task_DebugPrintf(...)
     #define WAIT_FOR_UART_TX_COMPLETE   
-    #define Task_Debug_Tickless_Idle_Readiness()    (NULL)
 #endif  /* UART_DEBUG_ENABLE */ 
     
 #endif /* UART_DEBUG_H */ 
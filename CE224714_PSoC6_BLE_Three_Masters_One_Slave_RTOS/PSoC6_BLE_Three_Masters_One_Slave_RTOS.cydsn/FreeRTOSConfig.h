@@ -65,22 +65,38 @@
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
-#define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   10240
+#define configSUPPORT_STATIC_ALLOCATION         1 /* Changed to create all
+                                                     kernel objects at compile
+                                                     time */
+#define configSUPPORT_DYNAMIC_ALLOCATION        1 /* Needed by the heap file 
+                                                     selected in Build Settings;
+                                                     nothing is allocated */
+#define configTOTAL_HEAP_SIZE                   256 /* Reduced since all kernel
+                                                       objects are static */
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
-#define configUSE_IDLE_HOOK                     0
+#define configUSE_IDLE_HOOK                     1 /* Changed to put the CPU
+                                                     to sleep when idle */
 #define configUSE_TICK_HOOK                     0
 #define configCHECK_FOR_STACK_OVERFLOW          2
 #define configUSE_MALLOC_FAILED_HOOK            1	/* Changed to use memory 
                                                        allocation failed hook */
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
-/* Run time and task stats gathering related definitions. */
+/* Run time and task stats gathering related definitions. (true) enables the 
+   CPU load and stack use of every task, the heap use and the trace of queues,
+   task switches and BLE events, printed by Task_Trace over the UART. See 
+   rtos_trace.c for details */
+#define RTOS_TRACE_ENABLE                       (false)
+
+#if (RTOS_TRACE_ENABLE)
+#define configGENERATE_RUN_TIME_STATS           1
+#define configUSE_TRACE_FACILITY                1
+#else
 #define configGENERATE_RUN_TIME_STATS           0
 #define configUSE_TRACE_FACILITY                0
+#endif
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
 /* Co-routine related definitions. */
@@ -116,6 +132,28 @@ extern void vApplicationSleep(uint32_t xExpectedIdleTime);
                                                        idle. See the 
                                                        tickless_idle.c file 
                                                        for more details */
+
+#if (RTOS_TRACE_ENABLE)
+/* Run time counter and trace hooks, implemented in rtos_trace.c */
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()    RtosTrace_StartTimer()
+#define portGET_RUN_TIME_COUNTER_VALUE()            RtosTrace_GetRunTimeCounter()
+#define traceTASK_SWITCHED_IN()                     RtosTrace_TaskSwitchedIn( \
+                                                    pxCurrentTCB->uxTCBNumber)
+#define traceQUEUE_SEND(pxQueue)                    RtosTrace_QueueSend( \
+                                                    (pxQueue)->uxQueueNumber, \
+                                                    (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           traceQUEUE_SEND(pxQueue)
+#define traceQUEUE_RECEIVE(pxQueue)                 RtosTrace_QueueReceive( \
+                                                    (pxQueue)->uxQueueNumber, \
+                                                    (pxQueue)->uxMessagesWaiting)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)        traceQUEUE_RECEIVE(pxQueue)
+
+extern void RtosTrace_StartTimer(void);
+extern uint32_t RtosTrace_GetRunTimeCounter(void);
+extern void RtosTrace_TaskSwitchedIn(uint32_t taskNumber);
+extern void RtosTrace_QueueSend(uint32_t queueNumber, uint32_t messagesWaiting);
+extern void RtosTrace_QueueReceive(uint32_t queueNumber, uint32_t messagesWaiting);
+#endif /* RTOS_TRACE_ENABLE */
     
     
 /*
@@ -45,7 +45,7 @@
 
 #include "project.h"    
 
-#define BLE_MAX_SCAN_DEVICES            (16u)
+#define BLE_MAX_SCAN_DEVICES            (16u)    /* Displayed to the user */
 #define BLE_MAX_PERIPHERAL_CONN_COUNT   (1u)    /* Slave  */    
 #define BLE_MAX_CENTRAL_CONN_COUNT      (3u)    /* Master */
 #define BLE_MAX_CONN_COUNT              (BLE_MAX_PERIPHERAL_CONN_COUNT + \
@@ -56,12 +56,35 @@
 #define IS_DISCONNECTED(x)  (Cy_BLE_GetConnectionState(x) == \
                              CY_BLE_CONN_STATE_DISCONNECTED)
 
+/* Steps of the procedure that readies a link to a GATT server. The links go
+   through the steps independently, so several links are set up at once */
+typedef enum
+{
+    LINK_IDLE,                  /* Not connected */
+    LINK_SETUP,                 /* Authentication and MTU exchange running */
+    LINK_DISCOVERY_PENDING,     /* Waiting for a free discovery instance */
+    LINK_DISCOVERY,             /* GATT discovery running */
+    LINK_ENABLE_NOTIFICATION,   /* BAS CCCD write running */
+    LINK_READY                  /* BAS notifications enabled */
+} app_en_link_state_t;
+
+/* Setup steps that run at the same time in the LINK_SETUP state */
+#define LINK_SETUP_AUTH     (0x01u)     /* Authentication */
+#define LINK_SETUP_MTU      (0x02u)     /* MTU exchange */
+#define LINK_SETUP_ALL      (LINK_SETUP_AUTH | LINK_SETUP_MTU)
+
 /* Central connection information */
 typedef struct
 {    
     /* Peer device handle */
     cy_stc_ble_conn_handle_t   connHandle;
     
+    /* Link setup procedure step */
+    app_en_link_state_t        linkState;
+    
+    /* Setup steps that have not completed yet, LINK_SETUP_xxx bits */
+    uint8_t                    setupPending;
+    
     /* Battery level data */
     uint8_t                    battaryLevel;
     
@@ -92,10 +115,10 @@ typedef struct
     
 } app_stc_connection_info_t;
 
-/* Scan device information */
+/* Scan device information, the devices last displayed to the user */
 typedef struct
 {
-    /* Array for store peer device address */
+    /* Array for store peer device address, strongest signal first */
     cy_stc_ble_gap_bd_addr_t  address[BLE_MAX_SCAN_DEVICES];
     
     /* Number of peer device in list */
@@ -48,26 +48,61 @@
 #include "status_led_task.h"
 #include "uart_task.h"
 #include "uart_debug.h"
+#include "rtos_trace.h"
+#include "scan_list.h"
 
 /* Queue Handle for BLE command */
 QueueHandle_t bleCommandQ;
 
+/**
+ * Task notification bits of Task_Ble. The controller interrupt only sets a 
+ * bit, so any number of interrupts that arrive before Task_Ble runs are
+ * handled by one Cy_BLE_ProcessEvents() pass and never fill bleCommandQ.
+ */
+#define BLE_EVENT_PROCESS_EVENTS    (0x01u)   /* Controller has pending events */
+#define BLE_EVENT_COMMAND           (0x02u)   /* Command sent over bleCommandQ */
+#define BLE_EVENT_ALL               (BLE_EVENT_PROCESS_EVENTS | BLE_EVENT_COMMAND)
+
+/* Handle of Task_Ble, the target of the task notifications */
+static TaskHandle_t bleTaskHandle = NULL;
+
+/* Counters of the Task_Ble wake-ups */
+static ble_wakeup_stats_t bleWakeupStats;
+
 #define MAX_BUFFER_LENGTH   (64u)   /* Buffer size for display messages */
 #define BAS_SERVICE_INDEX   (0u)    /* BAS service index */
 
 /* Variable for storing connection information */
 static app_stc_connection_info_t    appConnInfo;
-/* Variable for storing scanned device information */
+/* Variable for storing the scanned devices last displayed to the user */
 static app_stc_scan_device_list_t   appScanDevInfo;
 /* Flag used for tracking device with BAS notification enabled */ 
 static uint8_t basNotificationFlag = 0u;
 
+/* Connection request sent and waiting for the GAP connected event */
+static bool connectInProgress = false;
+/* Devices selected while a connection request was in progress. They are 
+   connected in order, while the links before them are being set up */
+static cy_stc_ble_gap_bd_addr_t connectQueue[BLE_MAX_CENTRAL_CONN_COUNT];
+static uint32_t connectQueueCount = 0u;
+/* Set by the stack event handler when a connection request has completed. 
+   The next device is connected from Task_Ble once Cy_BLE_ProcessEvents() has
+   returned, since that calls the GAP APIs and processes the events again */
+static bool connectNextPending = false;
+
+/* Time the first of a group of links was requested, and the time it took
+   until all of them were ready */
+static TickType_t linkSetupStartTick;
+static TickType_t linkSetupTicks = 0u;
+static bool linkSetupRunning = false;
+
 /** 
  * These static functions are used by the BLE Task. These are not available 
  * outside this file. See the respective function definitions for more 
  * details. 
  */
 static void BleControllerInterruptEventHandler(void);
+static BaseType_t ReceiveBleCommand(ble_command_t *bleCommand);
 static void StackEventHandler(uint32_t eventType, void *eventParam);
 static void BasCallback(uint32_t event, void *eventParam);
 
@@ -76,10 +111,7 @@ static void Ble_ConnectDevice(uint32_t devId);
 static void Ble_DisconnectDevice(uint32_t devId);
 static void Ble_RemoveDevice(uint8_t bdHandle);
 static void Ble_DisplayConnectedDevice(void);
-static void Ble_DisplayScannedDevice(void);
-static bool Ble_AddDeviceInScanList(uint8_t* peerBdAddr,\
-    uint8_t peerAddrType);
-static bool Ble_IsDeviceInScanList(uint8_t* peerBdAddr);
+static uint32_t Ble_DisplayScannedDevice(void);
 static bool Ble_IsServiceUuidPresent(\
     cy_stc_ble_gapc_adv_report_param_t *eventParam, uint16_t uuid);
 
@@ -95,6 +127,13 @@ static void Ble_Peripheral_AddDevice(uint8_t bdHandle);
 static void Ble_Central_StartScan(void);
 static void Ble_Central_StopScan(void);
 static void Ble_Central_AddDevice(uint8_t bdHandle);
+static void Ble_Central_SendConnectRequest(const cy_stc_ble_gap_bd_addr_t *address);
+static void Ble_Central_ConnectNext(void);
+static app_stc_central_info_t* Ble_Central_FindLink(uint8_t bdHandle);
+static void Ble_Central_SetupStepDone(uint8_t bdHandle, uint8_t step);
+static void Ble_Central_StartDiscovery(app_stc_central_info_t *link);
+static void Ble_Central_LinkReady(uint8_t bdHandle);
+static bool Ble_Central_IsSetupBusy(void);
 
 /* Display the menu */ 
 static void PrintMenu(void);
@@ -130,6 +169,10 @@ void Task_Ble(void *pvParameters)
     
     /* Remove warning for unused parameter */
     (void)pvParameters;
+    
+    /* Store the task handle for the task notifications */
+    bleTaskHandle = xTaskGetCurrentTaskHandle();
+    
     /* Display the menu */
     PrintMenu();
     /* Start the BLE component and register the stack event handler */
@@ -158,8 +201,11 @@ void Task_Ble(void *pvParameters)
     /* Repeatedly running part of the task */
     for(;;)
     {
-        /* Block until a BLE command has been received over bleCommandQ */
-        rtosApiResult = xQueueReceive(bleCommandQ, &bleCommand, portMAX_DELAY);
+        /**
+         * Block until a BLE command has been received over bleCommandQ. 
+         * Pending controller events are processed while waiting.
+         */
+        rtosApiResult = ReceiveBleCommand(&bleCommand);
         
         /* Command has been received from bleCommandQ */
         if(rtosApiResult == pdTRUE)
@@ -226,15 +272,10 @@ void Task_Ble(void *pvParameters)
                     }
                     else
                     {
-                        if(appScanDevInfo.count > 0)
+                        /* Wait for the selection if any device is listed */
+                        if(Ble_DisplayScannedDevice() > 0u)
                         {
                             connectPending = true;
-                            Ble_DisplayScannedDevice();
-                        }
-                        else
-                        {
-                            Task_Printf("\rInfo     : BLE - No device present "\
-                                "with Battery Alert Service", 0u);
                         }
                     }
                     break;
@@ -284,6 +325,18 @@ void Task_Ble(void *pvParameters)
                 {
                     Task_DebugPrintf("Info     : Display connected device", 0);
                     Ble_DisplayConnectedDevice();
+                    
+                    /* Show how well the controller interrupts are merged */
+                    Task_Printf("\rInfo     : BLE - Controller interrupts (hex)  :", 
+                        bleWakeupStats.controllerInterrupts);
+                    Task_Printf("\rInfo     : BLE - Merged wake-ups (hex)        :", 
+                        bleWakeupStats.mergedWakeups);
+                    Task_Printf("\rInfo     : BLE - Max command queue depth (hex):", 
+                        bleWakeupStats.maxQueueDepth);
+                    
+                    /* Show how long the last group of links took to set up */
+                    Task_Printf("\rInfo     : BLE - Time to all links ready (ms, hex):",
+                        linkSetupTicks * portTICK_PERIOD_MS);
                     break;
                 }
                 
@@ -337,6 +390,9 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
     /* Variable used to store the return values of RTOS APIs */
     BaseType_t rtosApiResult;
     
+    /* Record the event in the trace. See FreeRTOSConfig.h to enable the trace */
+    RtosTrace_BleEvent(eventType);
+    
     /* Take an action based on the current event */
     switch (eventType)
     {
@@ -376,6 +432,13 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
                 }
             }
             Task_DebugPrintf("Info     : BLE - Timeout", 0u);
+            
+            /* The connection request timed out; a new one may be sent */
+            if(timeoutParam->reasonCode == CY_BLE_GENERIC_APP_TO)
+            {
+                connectInProgress = false;
+                connectNextPending = true;
+            }
             break;
         }
         
@@ -419,6 +482,11 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
                 Task_DebugPrintf("Info     : BLE - Scan complete!", 0u);
             }
             
+            /* The scanned devices only age while the scan is running */
+            ScanList_SetScanning((Cy_BLE_GetScanState() == 
+                                  CY_BLE_SCAN_STATE_SCANNING), 
+                                 xTaskGetTickCount());
+            
             rtosApiResult = xQueueSend(statusLedDataQ, &statusLedData, 0u);
             /* Check if the operation has been successful */
             if(rtosApiResult != pdTRUE)
@@ -465,11 +533,11 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
             
             if((Cy_BLE_IsPeerConnected(advReport.peerBdAddr) == false) && \
                (advReport.eventType == CY_BLE_GAPC_CONN_UNDIRECTED_ADV) && \
-               (Ble_IsServiceUuidPresent(&advReport, CY_BLE_UUID_BAS_SERVICE) == true) &&\
-               (appScanDevInfo.count < BLE_MAX_SCAN_DEVICES))
+               (Ble_IsServiceUuidPresent(&advReport, CY_BLE_UUID_BAS_SERVICE) == true))
             {
-                /* Display device address */
-                if(Ble_AddDeviceInScanList(advReport.peerBdAddr, advReport.peerAddrType))
+                /* Display device address if the device is new in the list */
+                if(ScanList_Update(advReport.peerBdAddr, advReport.peerAddrType,
+                                   advReport.rssi, xTaskGetTickCount()))
                 {
                     sprintf(printBuffer[devCount], "\rInfo     : Device with BAS found" \
                     "- %2.2X%2.2X%2.2X%2.2X%2.2X%2.2X", \
@@ -478,7 +546,7 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
                     advReport.peerBdAddr[1], advReport.peerBdAddr[0]);
                     
                     Task_Printf(printBuffer[devCount], 0u);
-                    devCount = devCount % BLE_MAX_SCAN_DEVICES;
+                    devCount = (devCount + 1u) % BLE_MAX_SCAN_DEVICES;
                 }
             }
             break;
@@ -517,6 +585,10 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
         {
             Task_DebugPrintf("Info     : BLE - GAP authentication failed", 
                 (*(cy_stc_ble_gap_auth_info_t *)eventParam).authErr);
+            
+            /* BAS needs no security; set the link up without it */
+            Ble_Central_SetupStepDone(
+                ((cy_stc_ble_gap_auth_info_t*)eventParam)->bdHandle, LINK_SETUP_AUTH);
             break;
         } 
         
@@ -537,11 +609,7 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
             
             if(Cy_BLE_GetDeviceRole(&connHandle) == CY_BLE_GAP_LL_ROLE_MASTER )
             {
-                bleApiResult = Cy_BLE_GATTC_StartDiscovery(connHandle);
-                if(bleApiResult != CY_BLE_SUCCESS)
-                {
-                    Task_DebugPrintf("Failure!  : BLE - Start Discovery API", 0u);
-                }
+                Ble_Central_SetupStepDone(connHandle.bdHandle, LINK_SETUP_AUTH);
             }
             else
             {
@@ -568,8 +636,15 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
             
             uint16_t cccd_attValue = CY_BLE_CCCD_NOTIFICATION;
             
+            app_stc_central_info_t *link = Ble_Central_FindLink(connHandle.bdHandle);
+            
             Task_DebugPrintf("Info     : BLE - Discovery complete", 0u);
             
+            if(link != NULL)
+            {
+                link->linkState = LINK_ENABLE_NOTIFICATION;
+            }
+            
             /* Enable notification for the connected BAS Client */
             Task_DebugPrintf("Info     : BLE - Enable notifications for BAS service", 0u);
             
@@ -583,9 +658,41 @@ static void StackEventHandler(uint32_t eventType, void *eventParam)
                 
                 Task_DebugPrintf("Failure!  : BLE - BASC set characteristic descriptor API ", \
                     bleApiResult);
+                
+                /* No write response follows; the link is as ready as it gets */
+                Ble_Central_LinkReady(connHandle.bdHandle);
             }
+            break;
+        }
+        
+        /* MTU Exchange Response received from GATT Server device */
+        case CY_BLE_EVT_GATTC_XCHNG_MTU_RSP:
+        {
+            Task_DebugPrintf("Info     : BLE - MTU exchanged, MTU ", 
+                ((cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam)->mtu);
             
-            Task_Printf("Info     : BLE - Connection complete", 0u);
+            Ble_Central_SetupStepDone(
+                ((cy_stc_ble_gatt_xchg_mtu_param_t *)eventParam)->connHandle.bdHandle,
+                LINK_SETUP_MTU);
+            break;
+        }
+        
+        /* Error Response received from GATT Server device */
+        case CY_BLE_EVT_GATTC_ERROR_RSP:
+        {
+            cy_stc_ble_gatt_err_param_t *errParam = 
+                (cy_stc_ble_gatt_err_param_t *)eventParam;
+            
+            Task_DebugPrintf("Info     : BLE - GATT error response, error code ", 
+                errParam->errInfo.errorCode);
+            
+            /* A server that does not support the MTU exchange keeps the
+               default MTU */
+            if(errParam->errInfo.opCode == CY_BLE_GATT_XCHNG_MTU_REQ)
+            {
+                Ble_Central_SetupStepDone(errParam->connHandle.bdHandle, 
+                                          LINK_SETUP_MTU);
+            }
             break;
         }
         
@@ -699,7 +806,7 @@ static void BasCallback(uint32_t event, void *eventParam)
             
             /* Send BLE command for sending notification */
             ble_command_t bleCommand = {.command = SEND_NOTIFICATION};
-            rtosApiResult = xQueueSend(bleCommandQ, &bleCommand, 0);
+            rtosApiResult = Task_Ble_SendCommand(&bleCommand, 0u);
             /* Check if the operation has been successful */
             if(rtosApiResult != pdTRUE)
             {
@@ -727,6 +834,10 @@ static void BasCallback(uint32_t event, void *eventParam)
         case CY_BLE_EVT_BASC_WRITE_DESCR_RESPONSE:
         {
             Task_DebugPrintf("Info     : BLE - BAS descriptor write request response", 0u);
+            
+            /* BAS notifications are enabled, the link is set up */
+            Ble_Central_LinkReady(
+                ((cy_stc_ble_bas_descr_value_t*)eventParam)->connHandle.bdHandle);
             break;
         }
         /* Other BAS events */
@@ -753,36 +864,185 @@ static void BasCallback(uint32_t event, void *eventParam)
 *******************************************************************************/
 static void BleControllerInterruptEventHandler(void)
 {
-    BaseType_t xHigherPriorityTaskWoken;
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    
+    /* Notification value before this interrupt set its bit */
+    uint32_t previousEvents = 0u;
+    
+    bleWakeupStats.controllerInterrupts++;
     
-    /* Send command to process BLE events  */
-    ble_command_t bleCommand = {.command = PROCESS_BLE_EVENTS};
-    xQueueSendToFrontFromISR(bleCommandQ, &bleCommand, &xHigherPriorityTaskWoken);
+    /* Tell Task_Ble to process BLE events */
+    xTaskNotifyAndQueryFromISR(bleTaskHandle, BLE_EVENT_PROCESS_EVENTS, eSetBits,
+                               &previousEvents, &xHigherPriorityTaskWoken);
+    
+    /* A pass was already pending; this interrupt is handled by it */
+    if((previousEvents & BLE_EVENT_PROCESS_EVENTS) != 0u)
+    {
+        bleWakeupStats.mergedWakeups++;
+    }
 
     portYIELD_FROM_ISR(xHigherPriorityTaskWoken );
 }
 
 /*******************************************************************************
-* Function Name: static void Ble_DisplayScannedDevice(void)
+* Function Name: static BaseType_t ReceiveBleCommand(ble_command_t *bleCommand)
 ********************************************************************************
 * Summary:
-*  Display all the scanned devices with BAS service
+*  Waits for the next BLE command. Pending controller events are processed
+*  before every command, so they are never delayed by queued commands. A 
+*  completed connection request is followed up here as well, outside of the
+*  stack event handler.
 *
 * Parameters:
-*  None
+*  ble_command_t *bleCommand : received command
+*
+* Return:
+*  BaseType_t : pdTRUE when a command has been received
+*
+*******************************************************************************/
+static BaseType_t ReceiveBleCommand(ble_command_t *bleCommand)
+{
+    /* Task notification bits; every wait clears the bits it returns */
+    uint32_t pendingEvents = 0u;
+    
+    /* Collect the bits set since the last call without blocking */
+    if(xTaskNotifyWait(0u, BLE_EVENT_ALL, &pendingEvents, 0u) != pdTRUE)
+    {
+        pendingEvents = 0u;
+    }
+    
+    for(;;)
+    {
+        /* One pass handles all the controller interrupts received so far */
+        if((pendingEvents & BLE_EVENT_PROCESS_EVENTS) != 0u)
+        {
+            bleWakeupStats.processEventPasses++;
+            Cy_BLE_ProcessEvents();
+        }
+        
+        /* Connect the next queued device or restart scanning. The events 
+           processed on the way can complete another request */
+        while(connectNextPending)
+        {
+            connectNextPending = false;
+            Ble_Central_ConnectNext();
+        }
+        
+        if(xQueueReceive(bleCommandQ, bleCommand, 0u) == pdTRUE)
+        {
+            return pdTRUE;
+        }
+        
+        /**
+         * Nothing to do; block until the next notification. A notification
+         * that arrived during the pass above makes this call return 
+         * immediately.
+         */
+        if(xTaskNotifyWait(0u, BLE_EVENT_ALL, &pendingEvents, portMAX_DELAY) != pdTRUE)
+        {
+            pendingEvents = 0u;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: BaseType_t Task_Ble_SendCommand(const ble_command_t *bleCommand,
+*                                                TickType_t ticksToWait)
+********************************************************************************
+* Summary:
+*  Sends a command to Task_Ble over bleCommandQ and wakes up the task. Must 
+*  not be called from an interrupt.
+*
+* Parameters:
+*  const ble_command_t *bleCommand : command to be sent
+*  TickType_t ticksToWait          : time to wait for space in the queue
+*
+* Return:
+*  BaseType_t : pdTRUE if the command has been queued
+*
+*******************************************************************************/
+BaseType_t Task_Ble_SendCommand(const ble_command_t *bleCommand, 
+                                TickType_t ticksToWait)
+{
+    BaseType_t rtosApiResult;
+    uint32_t queueDepth;
+    
+    rtosApiResult = xQueueSend(bleCommandQ, bleCommand, ticksToWait);
+    if(rtosApiResult == pdTRUE)
+    {
+        queueDepth = (uint32_t)uxQueueMessagesWaiting(bleCommandQ);
+        if(queueDepth > bleWakeupStats.maxQueueDepth)
+        {
+            bleWakeupStats.maxQueueDepth = queueDepth;
+        }
+        
+        /* Task_Ble drains the queue on start-up, so commands sent before it
+           runs need no notification */
+        if(bleTaskHandle != NULL)
+        {
+            (void)xTaskNotify(bleTaskHandle, BLE_EVENT_COMMAND, eSetBits);
+        }
+    }
+    
+    return rtosApiResult;
+}
+
+/*******************************************************************************
+* Function Name: void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats)
+********************************************************************************
+* Summary:
+*  Returns the counters of the Task_Ble wake-ups
+*
+* Parameters:
+*  ble_wakeup_stats_t *stats : counters
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-static void Ble_DisplayScannedDevice(void)
+void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats)
+{
+    taskENTER_CRITICAL();
+    *stats = bleWakeupStats;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: static uint32_t Ble_DisplayScannedDevice(void)
+********************************************************************************
+* Summary:
+*  Display the scanned devices with BAS service, strongest signal first. The 
+*  displayed list is kept in appScanDevInfo for the device selection.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : Number of devices displayed
+*
+*******************************************************************************/
+static uint32_t Ble_DisplayScannedDevice(void)
 {    
     /* Local variables */
     uint8_t i;
     uint8_t devCount = 0;
     
-    /* String buffer used for storing display messages */
-    char8 printBuffer[BLE_MAX_SCAN_DEVICES][MAX_BUFFER_LENGTH];
+    /* String buffer used for storing display messages. The messages are 
+       printed by Task_Debug after this function returns */
+    static char8 printBuffer[BLE_MAX_SCAN_DEVICES][MAX_BUFFER_LENGTH];
+    
+    /* Scanned devices sorted by signal strength */
+    static scan_list_device_t scanDevices[BLE_MAX_SCAN_DEVICES];
+    
+    /* Drop the devices that are out of range and take a snapshot of the 
+       others, which stays valid until the user has made a selection */
+    ScanList_RemoveAged(xTaskGetTickCount());
+    appScanDevInfo.count = ScanList_GetSorted(scanDevices, 
+                                              BLE_MAX_SCAN_DEVICES);
+    for(i = 0; i < appScanDevInfo.count; i++)
+    {
+        appScanDevInfo.address[i] = scanDevices[i].address;
+    }
     
     if(appScanDevInfo.count > 0)
     {
@@ -802,6 +1062,8 @@ static void Ble_DisplayScannedDevice(void)
     {
         Task_Printf("\rInfo     : No device found with Battery Alert Service",0u);
     }
+    
+    return appScanDevInfo.count;
 }
 
 /*******************************************************************************
@@ -875,7 +1137,8 @@ static void Ble_DisplayConnectedDevice(void)
 * Function Name: static void Ble_ConnectDevice(uint32_t deviceId)
 ********************************************************************************
 * Summary:
-*  Send a connection request to the remote device
+*  Send a connection request to the remote device, or queue the device if a 
+*  connection request is in progress
 *
 * Parameters: 
 *  uint8_t deviceId: Device id 
@@ -885,6 +1148,74 @@ static void Ble_DisplayConnectedDevice(void)
 *
 *******************************************************************************/
 static void Ble_ConnectDevice(uint32_t deviceId)
+{
+    uint32_t i;
+    
+    /* Check if the device is already connected */
+    if(Cy_BLE_IsPeerConnected(appScanDevInfo.address[deviceId - 1].bdAddr))
+    {
+        Task_Printf("\rInfo     : You are already connected to device :", 
+            deviceId);
+        return;
+    }
+    
+    /* Check if the device is already queued */
+    for(i = 0; i < connectQueueCount; i++)
+    {
+        if(memcmp(connectQueue[i].bdAddr, 
+                  appScanDevInfo.address[deviceId - 1].bdAddr, 
+                  CY_BLE_BD_ADDR_SIZE) == 0)
+        {
+            Task_Printf("\rInfo     : Device is already queued :", deviceId);
+            return;
+        }
+    }
+    
+    /* Check if there is a free link for the device */
+    if((appConnInfo.centralCnt + connectQueueCount + (connectInProgress ? 1u : 0u))
+        >= BLE_MAX_CENTRAL_CONN_COUNT)
+    {
+        Task_Printf("\rInfo     : Maximum number of devices connected", 0u);
+        return;
+    }
+    
+    /* Start timing when the first of a group of links is requested */
+    if(!linkSetupRunning)
+    {
+        linkSetupRunning = true;
+        linkSetupStartTick = xTaskGetTickCount();
+    }
+    
+    if(connectInProgress)
+    {
+        /* Connected as soon as the GAP connected event of the request in 
+           progress has been received */
+        connectQueue[connectQueueCount++] = appScanDevInfo.address[deviceId - 1];
+        Task_Printf("\rInfo     : Device queued for connection :", deviceId);
+    }
+    else
+    {
+        Ble_Central_SendConnectRequest(&appScanDevInfo.address[deviceId - 1]);
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Ble_Central_SendConnectRequest(
+*                               const cy_stc_ble_gap_bd_addr_t *address)
+********************************************************************************
+* Summary:
+*  Stops scanning and sends a connection request to the remote device. If the
+*  request fails the device is dropped and the next queued device is connected
+*  from Task_Ble, or scanning is restarted.
+*
+* Parameters: 
+*  const cy_stc_ble_gap_bd_addr_t *address : address of the device
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void Ble_Central_SendConnectRequest(const cy_stc_ble_gap_bd_addr_t *address)
 {
     /* Variable used to store the return values of BLE APIs */
     cy_en_ble_api_result_t bleApiResult;
@@ -892,38 +1223,237 @@ static void Ble_ConnectDevice(uint32_t deviceId)
     /* Variable used for buffer */
     static char8 printBuffer[32];
     
-    /* Check if the device is already connected */
-    if(Cy_BLE_IsPeerConnected(appScanDevInfo.address[deviceId - 1].bdAddr))
+    /* Connection request is sent with the address from the caller; the stack
+       API takes it as non-const */
+    cy_stc_ble_gap_bd_addr_t peerAddress = *address;
+    
+    /* Stop scanning before connection */
+    Ble_Central_StopScan();
+    
+    /* Send connect request */
+    bleApiResult = Cy_BLE_GAPC_ConnectDevice(&peerAddress,\
+        CY_BLE_CENTRAL_CONFIGURATION_0_INDEX);
+    if(bleApiResult != CY_BLE_SUCCESS)
     {
-        Task_Printf("\rInfo     : You are already connected to device :", 
-            deviceId);
+        Task_DebugPrintf("Failure!  : BLE - Connection request ", bleApiResult);
+        
+        /* Keep the queue draining */
+        connectNextPending = true;
     }
     else
     {
-        /* Stop scanning before connection */
-        Ble_Central_StopScan();
+        connectInProgress = true;
         
-        /* Send connect request */
-        bleApiResult = Cy_BLE_GAPC_ConnectDevice(&appScanDevInfo.address[--deviceId],\
-            CY_BLE_CENTRAL_CONFIGURATION_0_INDEX);
-        if(bleApiResult != CY_BLE_SUCCESS)
+        sprintf(printBuffer, "\rConnecting with - %2.2X%2.2X%2.2X%2.2X%2.2X%2.2X", \
+            peerAddress.bdAddr[5u], peerAddress.bdAddr[4u],\
+            peerAddress.bdAddr[3u], peerAddress.bdAddr[2u],\
+            peerAddress.bdAddr[1u], peerAddress.bdAddr[0u]);
+        
+        Task_Printf(printBuffer, 0u);
+    }
+    Cy_BLE_ProcessEvents();
+}
+
+/*******************************************************************************
+* Function Name: static void Ble_Central_ConnectNext(void)
+********************************************************************************
+* Summary:
+*  Called from Task_Ble when a connection request has completed. Connects the
+*  next queued device, or restarts scanning if a link is still free, so the 
+*  next device is found while the earlier links are being set up. It must not
+*  be called from the stack event handler.
+*
+* Parameters: 
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void Ble_Central_ConnectNext(void)
+{
+    cy_stc_ble_gap_bd_addr_t nextAddress;
+    uint32_t i;
+    
+    if(connectQueueCount > 0u)
+    {
+        nextAddress = connectQueue[0u];
+        connectQueueCount--;
+        for(i = 0u; i < connectQueueCount; i++)
         {
-            Task_DebugPrintf("Failure!  : BLE - Connection request ", bleApiResult);
+            connectQueue[i] = connectQueue[i + 1u];
         }
-        else
+        Ble_Central_SendConnectRequest(&nextAddress);
+    }
+    else if(appConnInfo.centralCnt < BLE_MAX_CENTRAL_CONN_COUNT)
+    {
+        Ble_Central_StartScan();
+    }
+}
+
+/*******************************************************************************
+* Function Name: static app_stc_central_info_t* Ble_Central_FindLink(
+*                                                       uint8_t bdHandle)
+********************************************************************************
+* Summary:
+*  Finds the central link of a peer device
+*
+* Parameters: 
+*  uint8_t bdHandle : BD Handle of the peer device
+*
+* Return:
+*  app_stc_central_info_t* : link of the device, NULL if it is not a GATT 
+*                            server connected to this device
+*
+*******************************************************************************/
+static app_stc_central_info_t* Ble_Central_FindLink(uint8_t bdHandle)
+{
+    uint32_t i;
+    for(i = 0; i < BLE_MAX_CENTRAL_CONN_COUNT; i++)
+    {
+        if((appConnInfo.central[i].linkState != LINK_IDLE) &&
+           (appConnInfo.central[i].connHandle.bdHandle == bdHandle))
         {
-            sprintf(printBuffer, "\rConnecting with - %2.2X%2.2X%2.2X%2.2X%2.2X%2.2X", \
-                appScanDevInfo.address[deviceId].bdAddr[5u],\
-                appScanDevInfo.address[deviceId].bdAddr[4u],\
-                appScanDevInfo.address[deviceId].bdAddr[3u],\
-                appScanDevInfo.address[deviceId].bdAddr[2u],\
-                appScanDevInfo.address[deviceId].bdAddr[1u],\
-                appScanDevInfo.address[deviceId].bdAddr[0u]);
-            
-            Task_Printf(printBuffer, 0u);
+            return &appConnInfo.central[i];
         }
-        Cy_BLE_ProcessEvents();
     }
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: static void Ble_Central_SetupStepDone(uint8_t bdHandle, 
+*                                                      uint8_t step)
+********************************************************************************
+* Summary:
+*  Marks a setup step of a link as completed, and starts the GATT discovery 
+*  of the link when both authentication and MTU exchange have completed
+*
+* Parameters: 
+*  uint8_t bdHandle : BD Handle of the peer device
+*  uint8_t step     : LINK_SETUP_AUTH or LINK_SETUP_MTU
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void Ble_Central_SetupStepDone(uint8_t bdHandle, uint8_t step)
+{
+    app_stc_central_info_t *link = Ble_Central_FindLink(bdHandle);
+    
+    if((link != NULL) && (link->linkState == LINK_SETUP))
+    {
+        link->setupPending &= (uint8_t)~step;
+        if(link->setupPending == 0u)
+        {
+            Ble_Central_StartDiscovery(link);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Ble_Central_StartDiscovery(
+*                                       app_stc_central_info_t *link)
+********************************************************************************
+* Summary:
+*  Starts the GATT discovery of a link. The discovery of several links runs
+*  at the same time, up to the number of GATT client instances of the BLE 
+*  component. An instance keeps the discovered handles of its link until the
+*  link is disconnected, so a link that finds none free waits for that.
+*
+* Parameters: 
+*  app_stc_central_info_t *link : link to discover
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void Ble_Central_StartDiscovery(app_stc_central_info_t *link)
+{
+    /* Variable used to store the return values of BLE APIs */
+    cy_en_ble_api_result_t bleApiResult;
+    
+    bleApiResult = Cy_BLE_GATTC_StartDiscovery(link->connHandle);
+    if(bleApiResult == CY_BLE_SUCCESS)
+    {
+        link->linkState = LINK_DISCOVERY;
+    }
+    else if(bleApiResult == CY_BLE_ERROR_INSUFFICIENT_RESOURCES)
+    {
+        link->linkState = LINK_DISCOVERY_PENDING;
+    }
+    else
+    {
+        Task_DebugPrintf("Failure!  : BLE - Start Discovery API", bleApiResult);
+        
+        /* The link will not become ready; do not time the group */
+        linkSetupRunning = false;
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void Ble_Central_LinkReady(uint8_t bdHandle)
+********************************************************************************
+* Summary:
+*  Marks a link as set up, and reports the time the group of links took when
+*  it was the last one
+*
+* Parameters: 
+*  uint8_t bdHandle : BD Handle of the peer device
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void Ble_Central_LinkReady(uint8_t bdHandle)
+{
+    app_stc_central_info_t *link = Ble_Central_FindLink(bdHandle);
+    
+    if((link != NULL) && (link->linkState == LINK_ENABLE_NOTIFICATION))
+    {
+        link->linkState = LINK_READY;
+        Task_Printf("Info     : BLE - Connection complete", 0u);
+        
+        if(linkSetupRunning && !Ble_Central_IsSetupBusy())
+        {
+            linkSetupRunning = false;
+            linkSetupTicks = xTaskGetTickCount() - linkSetupStartTick;
+            Task_Printf("\rInfo     : BLE - All links ready in (ms, hex):", 
+                        linkSetupTicks * portTICK_PERIOD_MS);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static bool Ble_Central_IsSetupBusy(void)
+********************************************************************************
+* Summary:
+*  Checks if a link is being connected or set up
+*
+* Parameters: 
+*  None
+*
+* Return:
+*  bool : true if a connection request is in progress or queued, or a link 
+*         is not ready yet
+*
+*******************************************************************************/
+static bool Ble_Central_IsSetupBusy(void)
+{
+    uint32_t i;
+    
+    if(connectInProgress || (connectQueueCount > 0u))
+    {
+        return true;
+    }
+    for(i = 0; i < BLE_MAX_CENTRAL_CONN_COUNT; i++)
+    {
+        if((appConnInfo.central[i].linkState != LINK_IDLE) &&
+           (appConnInfo.central[i].linkState != LINK_READY))
+        {
+            return true;
+        }
+    }
+    return false;
 }
 
 /*******************************************************************************
@@ -1137,36 +1667,6 @@ static bool Ble_IsServiceUuidPresent(
     return(servicePresent);
 }
 
-/****************************************************************************** 
-* Function Name: static bool Ble_AddDeviceInScanList(
-*                   uint8_t* peerBdAddr, uint8_t peerAddrType)
-*******************************************************************************
-*
-* Summary:
-*   This function add new device in scanned device list
-*
-* Parameters:
-*   uint8_t* peerBdAddr : Public device address
-*   uint8_t peerAddrType: BD address type of the device advertising
-*
-* Return:
-*   true: if device is added successfully in list
-*
-******************************************************************************/
-static bool Ble_AddDeviceInScanList(uint8_t* peerBdAddr, uint8_t peerAddrType)
-{
-    bool newDeviceAdded = false;
-    if(!Ble_IsDeviceInScanList(peerBdAddr))
-    {
-        newDeviceAdded = true;
-        memcpy(&appScanDevInfo.address[appScanDevInfo.count].bdAddr,\
-                        peerBdAddr, CY_BLE_GAP_BD_ADDR_SIZE); 
-        appScanDevInfo.address[appScanDevInfo.count].type = peerAddrType;
-        appScanDevInfo.count++;
-    }
-    return newDeviceAdded;
-}
-
 /****************************************************************************** 
 * Function Name: static void Ble_Peripheral_SendNotification(void)
 *******************************************************************************
@@ -1235,7 +1735,8 @@ static void Ble_Peripheral_AddDevice(uint8_t bdHandle)
 *******************************************************************************
 *
 * Summary:
-*   This function add new device in connected central list
+*   This function add new device in connected central list, and starts the
+*   authentication and the MTU exchange of the link at the same time
 *
 * Parameters:
 *   uint8_t bdHandle : Public device BD Handle
@@ -1251,13 +1752,23 @@ static void Ble_Central_AddDevice(uint8_t bdHandle)
     {
         if(IS_DISCONNECTED(appConnInfo.central[i].connHandle))
         {
+            cy_stc_ble_gatt_xchg_mtu_param_t mtuParam = {.mtu = CY_BLE_GATT_MTU};
+            
+            appConnInfo.central[i].connHandle = Cy_BLE_GetConnHandleByBdHandle(bdHandle);
+            appConnInfo.central[i].linkState = LINK_SETUP;
+            appConnInfo.central[i].setupPending = LINK_SETUP_ALL;
+            appConnInfo.centralCnt++;
+            
             /* Send an authorization request */
             cy_ble_authInfo[CY_BLE_SECURITY_CONFIGURATION_0_INDEX].bdHandle = bdHandle;
             Cy_BLE_GAP_AuthReq(&cy_ble_authInfo[CY_BLE_SECURITY_CONFIGURATION_0_INDEX]);
             
-            appConnInfo.central[i].connHandle = Cy_BLE_GetConnHandleByBdHandle(bdHandle);
-            
-            appConnInfo.centralCnt++;
+            /* The MTU exchange runs on the ATT bearer, next to the pairing */
+            mtuParam.connHandle = appConnInfo.central[i].connHandle;
+            if(Cy_BLE_GATTC_ExchangeMtuReq(&mtuParam) != CY_BLE_SUCCESS)
+            {
+                appConnInfo.central[i].setupPending &= (uint8_t)~LINK_SETUP_MTU;
+            }
             break;
         }
     }
@@ -1283,8 +1794,19 @@ static void Ble_AddDevice(cy_stc_ble_gap_connected_param_t *connParam)
     /* Variable used to store the return values of RTOS APIs */
     BaseType_t rtosApiResult;
     
+    /* Check if the connection has been established */
+    if(connParam->status != 0u)
+    {
+        Task_DebugPrintf("Failure! : BLE - Connection failed, status ", 
+                         connParam->status);
+        if(connParam->role != CY_BLE_GAP_LL_ROLE_SLAVE)
+        {
+            connectInProgress = false;
+            connectNextPending = true;
+        }
+    }
     /* Check if connected as Central or Peripheral */
-    if(connParam->role == CY_BLE_GAP_LL_ROLE_SLAVE)
+    else if(connParam->role == CY_BLE_GAP_LL_ROLE_SLAVE)
     {
         /* Connected as Peripheral (Slave role) */
         Task_DebugPrintf("Info     : BLE - GAP device connected as peripheral", 0u);
@@ -1313,6 +1835,11 @@ static void Ble_AddDevice(cy_stc_ble_gap_connected_param_t *connParam)
             Ble_Central_AddDevice(connParam->bdHandle);
         }
         
+        /* Connect or look for the next device while this link is set up; 
+           Task_Ble does this once the events have been processed */
+        connectInProgress = false;
+        connectNextPending = true;
+        
         if(appConnInfo.centralCnt == BLE_MAX_CENTRAL_CONN_COUNT)
         {
             /* Turn on the Red LED to indicate maximum number allowed 
@@ -1359,7 +1886,22 @@ static void Ble_RemoveDevice(uint8_t bdHandle)
                 CY_BLE_INVALID_CONN_HANDLE_VALUE;
             appConnInfo.central[i].connHandle.attId = \
                 CY_BLE_INVALID_CONN_HANDLE_VALUE;
+            appConnInfo.central[i].linkState = LINK_IDLE;
+            appConnInfo.central[i].setupPending = 0u;
             appConnInfo.centralCnt--;
+            
+            /* A group of links that lost a link is not timed */
+            linkSetupRunning = linkSetupRunning && Ble_Central_IsSetupBusy();
+            break;
+        }
+    }
+    
+    /* The GATT client instance of the link is free for a waiting link */
+    for(i = 0; i < BLE_MAX_CENTRAL_CONN_COUNT; i++)
+    {
+        if(appConnInfo.central[i].linkState == LINK_DISCOVERY_PENDING)
+        {
+            Ble_Central_StartDiscovery(&appConnInfo.central[i]);
             break;
         }
     }
@@ -1427,35 +1969,6 @@ static void UpdateBatteryLevel(uint8_t bdHandle, uint8_t* value)
     }
 }
 
-/****************************************************************************** 
-* Function Name: static bool IsDeviceInScanList(uint8_t* peerBdAddr)
-*******************************************************************************
-*
-* Summary:
-*   This function returns if the device is present in scanned device list 
-*
-* Parameters:
-*   uint8_t* peerBdAddr : Device address
-*
-* Return:
-*   true : if device is in scanned device list
-*
-******************************************************************************/
-static bool Ble_IsDeviceInScanList(uint8_t* peerBdAddr)
-{
-    bool isDevicePresent = false;
-    uint32_t i;
-    for(i = 0u; i < BLE_MAX_SCAN_DEVICES; i++)
-    {
-        if(!(memcmp(&appScanDevInfo.address[i].bdAddr, peerBdAddr, 
-            CY_BLE_GAP_BD_ADDR_SIZE)))
-        {
-            isDevicePresent = true;
-        }
-    } 
-    return(isDevicePresent);
-}
-
 /*******************************************************************************
 * Function Name: static void PrintMenu(void)
 ********************************************************************************
@@ -53,6 +53,7 @@
 #include "project.h"
 #include "FreeRTOS.h"
 #include "queue.h"    
+#include "task.h"
 
 /* List of BLE commands */
 typedef enum
@@ -75,12 +76,32 @@ typedef struct
     uint32_t data;
 }   ble_command_t;
 
+/* Counters of the Task_Ble wake-ups */
+typedef struct
+{
+    /* Interrupts received from the BLE controller */
+    uint32_t controllerInterrupts;
+    /* Cy_BLE_ProcessEvents() passes run for the controller interrupts */
+    uint32_t processEventPasses;
+    /* Controller interrupts merged into a pass that was already pending */
+    uint32_t mergedWakeups;
+    /* Largest number of commands seen waiting in bleCommandQ */
+    uint32_t maxQueueDepth;
+}   ble_wakeup_stats_t;
+
 /* Handle for the Queue that contains BLE commands and data */
 extern QueueHandle_t bleCommandQ;
 
 /* Task_Ble takes care of the BLE module in this code example */    
 void Task_Ble(void *pvParameters);
 
+/* Sends a command to Task_Ble over bleCommandQ and wakes up the task */
+BaseType_t Task_Ble_SendCommand(const ble_command_t *bleCommand, 
+                                TickType_t ticksToWait);
+
+/* Returns the counters of the Task_Ble wake-ups */
+void Task_Ble_GetWakeupStats(ble_wakeup_stats_t *stats);
+
 #endif /* BLE_TASK_H */
 
 /* [] END OF FILE */
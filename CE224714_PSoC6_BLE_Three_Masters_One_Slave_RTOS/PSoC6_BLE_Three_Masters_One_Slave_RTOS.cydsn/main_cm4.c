@@ -52,6 +52,7 @@
 #include "ble_task.h"
 #include "uart_task.h"
 #include "status_led_task.h"
+#include "rtos_trace.h"
 
 /** 
  * Priorities of user tasks in this project - spaced at intervals of 5 for 
@@ -72,25 +73,66 @@
 #define STATUS_LED_COMMAND_QUEUE_LEN    (1u)
 #define DEBUG_QUEUE_LEN                 (32u)
 
+/** 
+ * Stacks and control blocks of the user tasks and storage of the queues. All 
+ * kernel objects are allocated at compile time, so the RAM they take shows up
+ * in the map file and nothing is allocated from the FreeRTOS heap. 
+ */
+static StackType_t   bleTaskStack[TASK_BLE_STACK_SIZE];
+static StaticTask_t  bleTaskBuffer;
+static StackType_t   uartTaskStack[TASK_UART_STACK_SIZE];
+static StaticTask_t  uartTaskBuffer;
+static StackType_t   statusLedTaskStack[TASK_STATUS_LED_STACK_SIZE];
+static StaticTask_t  statusLedTaskBuffer;
+
+static uint8_t       bleCommandQStorage[BLE_COMMAND_QUEUE_LEN * 
+                                        sizeof(ble_command_t)];
+static StaticQueue_t bleCommandQBuffer;
+static uint8_t       debugMessageQStorage[DEBUG_QUEUE_LEN * 
+                                          sizeof(debug_print_data_t)];
+static StaticQueue_t debugMessageQBuffer;
+static uint8_t       statusLedDataQStorage[STATUS_LED_COMMAND_QUEUE_LEN * 
+                                           sizeof(status_led_data_t)];
+static StaticQueue_t statusLedDataQBuffer;
+
 int main(void)
 {
     __enable_irq(); /* Enable global interrupts. */
     
     /* Create queues */
-    bleCommandQ     = xQueueCreate(BLE_COMMAND_QUEUE_LEN, sizeof(ble_command_t));
-    debugMessageQ   = xQueueCreate(DEBUG_QUEUE_LEN, sizeof(debug_print_data_t));
-    statusLedDataQ  = xQueueCreate(STATUS_LED_COMMAND_QUEUE_LEN, sizeof(status_led_data_t));
+    bleCommandQ     = xQueueCreateStatic(BLE_COMMAND_QUEUE_LEN, 
+                                         sizeof(ble_command_t),
+                                         bleCommandQStorage, 
+                                         &bleCommandQBuffer);
+    debugMessageQ   = xQueueCreateStatic(DEBUG_QUEUE_LEN, 
+                                         sizeof(debug_print_data_t),
+                                         debugMessageQStorage, 
+                                         &debugMessageQBuffer);
+    statusLedDataQ  = xQueueCreateStatic(STATUS_LED_COMMAND_QUEUE_LEN, 
+                                         sizeof(status_led_data_t),
+                                         statusLedDataQStorage, 
+                                         &statusLedDataQBuffer);
+    
+    /* Name the queues in the trace. See FreeRTOSConfig.h to enable the trace */
+    RtosTrace_RegisterQueue(bleCommandQ, "BLE command");
+    RtosTrace_RegisterQueue(debugMessageQ, "Debug message");
+    RtosTrace_RegisterQueue(statusLedDataQ, "Status LED");
     
     /** 
      * Create the user Tasks. 
      * See the respective Task definition for more details of these tasks 
      */ 
-    xTaskCreate(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
-                NULL, TASK_BLE_PRIORITY, NULL);
-    xTaskCreate(Task_Debug, "UART Task", TASK_UART_STACK_SIZE, NULL,
-                TASK_UART_PRIORITY, NULL);
-    xTaskCreate(Task_StatusLed, "Status LED Task", TASK_STATUS_LED_STACK_SIZE,
-                NULL, TASK_STATUS_LED_PRIORITY, NULL);
+    xTaskCreateStatic(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
+                      NULL, TASK_BLE_PRIORITY, bleTaskStack, &bleTaskBuffer);
+    xTaskCreateStatic(Task_Debug, "UART Task", TASK_UART_STACK_SIZE, NULL,
+                      TASK_UART_PRIORITY, uartTaskStack, &uartTaskBuffer);
+    xTaskCreateStatic(Task_StatusLed, "Status LED Task", 
+                      TASK_STATUS_LED_STACK_SIZE, NULL, 
+                      TASK_STATUS_LED_PRIORITY, statusLedTaskStack,
+                      &statusLedTaskBuffer);
+    
+    /* Initialize the run time statistics and trace reporting */
+    RtosTrace_Init();
     
     /* Start the RTOS scheduler. This function should never return */
     vTaskStartScheduler();
@@ -107,6 +149,26 @@ int main(void)
     }
 }
 
+/*******************************************************************************
+* Function Name: void vApplicationIdleHook(void)
+********************************************************************************
+*
+* Summary:
+*  This function is called when the RTOS in idle mode
+*    
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationIdleHook(void)
+{
+    /* Enter sleep-mode */
+    Cy_SysPm_Sleep(CY_SYSPM_WAIT_FOR_INTERRUPT);
+}
+
 /*******************************************************************************
 * Function Name: void vApplicationStackOverflowHook(TaskHandle_t *pxTask, 
 *                                                   signed char *pcTaskName)
@@ -163,4 +225,66 @@ void vApplicationMallocFailedHook(void)
     CY_ASSERT(0);
 }
 
+/*******************************************************************************
+* Function Name: void vApplicationGetIdleTaskMemory(
+*                               StaticTask_t **ppxIdleTaskTCBBuffer,
+*                               StackType_t **ppxIdleTaskStackBuffer,
+*                               uint32_t *pulIdleTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the idle task
+*    
+* Parameters:
+*  StaticTask_t **ppxIdleTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxIdleTaskStackBuffer : returns the stack
+*  uint32_t *pulIdleTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t idleTaskBuffer;
+    static StackType_t  idleTaskStack[configMINIMAL_STACK_SIZE];
+    
+    *ppxIdleTaskTCBBuffer   = &idleTaskBuffer;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: void vApplicationGetTimerTaskMemory(
+*                               StaticTask_t **ppxTimerTaskTCBBuffer,
+*                               StackType_t **ppxTimerTaskStackBuffer,
+*                               uint32_t *pulTimerTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the timer service task
+*    
+* Parameters:
+*  StaticTask_t **ppxTimerTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxTimerTaskStackBuffer : returns the stack
+*  uint32_t *pulTimerTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t timerTaskBuffer;
+    static StackType_t  timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+    
+    *ppxTimerTaskTCBBuffer   = &timerTaskBuffer;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
 /* [] END OF FILE */
@@ -0,0 +1,699 @@
+/******************************************************************************
+* File Name: rtos_trace.c
+*
+* Version: 1.0
+*
+* Description: This file contains the run time statistics and the binary trace
+*              ring of the RTOS tasks
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the run time counter used for the FreeRTOS run time
+* statistics, the ring of trace records that is filled by the trace hooks in
+* FreeRTOSConfig.h, and Task_Trace, which drains the ring, matches queue sends
+* with receives and prints the CPU load of every task and the latency of every
+* registered queue. The run time counter is derived from the CM4 cycle counter,
+* which stops in Deep Sleep, so the time spent in Deep Sleep is not counted for
+* any task.
+*******************************************************************************/
+
+/* Header file includes */
+#include <string.h>
+#include "rtos_trace.h"
+#include "task.h"
+#include "uart_task.h"
+
+#if (RTOS_TRACE_ENABLE)
+
+/* Maximum number of tasks shown in the report */
+#define MAX_TASKS               (12u)
+
+/* Number of send timestamps kept per queue for the latency measurement */
+#define LATENCY_DEPTH           (16u)
+
+/* Number of records copied out of the ring at a time */
+#define DRAIN_CHUNK             (16u)
+
+/* Stack size of Task_Trace in words */
+#define TRACE_TASK_STACK_SIZE   (2u * configMINIMAL_STACK_SIZE)
+
+/* Sync bytes of a streamed record frame */
+#define FRAME_SYNC_0            (0xA5u)
+#define FRAME_SYNC_1            (0x5Au)
+
+/* The ring indexes wrap around with a mask */
+#if ((RTOS_TRACE_RING_SIZE & (RTOS_TRACE_RING_SIZE - 1u)) != 0u)
+    #error "RTOS_TRACE_RING_SIZE must be a power of two"
+#endif
+
+/* Latency bookkeeping of a registered queue */
+typedef struct
+{
+    const char *name;
+    /* Timestamps of the sends whose messages are still in the queue */
+    uint32_t sendTime[LATENCY_DEPTH];
+    uint32_t head;
+    uint32_t count;
+    /* Statistics of the current report period */
+    uint32_t sends;
+    uint32_t receives;
+    uint32_t latencySum;
+    uint32_t latencyMax;
+}   trace_queue_t;
+
+/* Run time counter */
+static uint32_t cyclesPerUs;
+static uint32_t lastCycles;
+static uint32_t cycleRemainder;
+static uint32_t runTimeUs;
+
+/* Trace ring, filled by the hooks and drained by Task_Trace */
+static rtos_trace_record_t traceRing[RTOS_TRACE_RING_SIZE];
+static uint32_t ringWrite;
+static uint32_t ringRead;
+static uint32_t droppedRecords;
+
+/* Registered queues; the queue number is the index plus one */
+static trace_queue_t traceQueues[RTOS_TRACE_MAX_QUEUES];
+static uint32_t queueCount;
+
+/* Stack and control block of Task_Trace */
+static StackType_t  traceTaskStack[TRACE_TASK_STACK_SIZE];
+static StaticTask_t traceTaskBuffer;
+
+/* Data used by Task_Trace only */
+static uint32_t bleEvents;
+static TaskStatus_t taskStatus[MAX_TASKS];
+static uint32_t lastTaskRunTime[MAX_TASKS + 1u];
+static uint32_t lastTotalRunTime;
+static TickType_t lastReportTick;
+
+/**
+ * These static functions are used by Task_Trace. These are not available 
+ * outside this file. See the respective function definitions for more 
+ * details.
+ */
+static void Record(uint8_t type, uint32_t id, uint32_t value);
+static void DrainRing(void);
+static void ProcessRecord(const rtos_trace_record_t *record);
+#if (RTOS_TRACE_STREAM_ENABLE)
+static void StreamRecord(const rtos_trace_record_t *record);
+#endif
+static void PrintReport(void);
+
+/*******************************************************************************
+* Function Name: void RtosTrace_Init(void)
+********************************************************************************
+* Summary:
+*  Creates Task_Trace. 
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_Init(void)
+{
+    xTaskCreateStatic(Task_Trace, "Trace Task", TRACE_TASK_STACK_SIZE, NULL,
+                      (tskIDLE_PRIORITY + 1u), traceTaskStack, &traceTaskBuffer);
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_RegisterQueue(QueueHandle_t queue, 
+*                                             const char *name)
+********************************************************************************
+* Summary:
+*  Gives a queue a number and a name. Operations on queues that are not 
+*  registered are not recorded.
+*
+* Parameters:
+*  QueueHandle_t queue : queue to be registered
+*  const char *name    : name of the queue in the report
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_RegisterQueue(QueueHandle_t queue, const char *name)
+{
+    if((queue != NULL) && (queueCount < RTOS_TRACE_MAX_QUEUES))
+    {
+        traceQueues[queueCount].name = name;
+        queueCount++;
+        vQueueSetQueueNumber(queue, (UBaseType_t)queueCount);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_StartTimer(void)
+********************************************************************************
+* Summary:
+*  Starts the run time counter. Called by the scheduler through 
+*  portCONFIGURE_TIMER_FOR_RUN_TIME_STATS().
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_StartTimer(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    
+    lastCycles     = 0u;
+    cycleRemainder = 0u;
+    runTimeUs      = 0u;
+    cyclesPerUs    = SystemCoreClock / 1000000u;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t RtosTrace_GetRunTimeCounter(void)
+********************************************************************************
+* Summary:
+*  Returns the run time counter. Called by the scheduler through 
+*  portGET_RUN_TIME_COUNTER_VALUE() and by the trace hooks.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : microseconds counted since the scheduler was started
+*
+* Theory:
+*  The cycle counter wraps around in less than a minute, so the elapsed cycles
+*  are accumulated into a microsecond count on every call. Task_Trace runs
+*  periodically, so the counter is always read often enough while the CPU is
+*  awake. The cycle counter stops in Deep Sleep, so Deep Sleep is not counted.
+*  A dedicated TCPWM counter would keep running in Sleep but not in Deep Sleep
+*  either, and would need a change in the TopDesign schematic.
+*
+*******************************************************************************/
+uint32_t RtosTrace_GetRunTimeCounter(void)
+{
+    uint32_t interruptState;
+    uint32_t now;
+    uint32_t result = 0u;
+    
+    interruptState = Cy_SysLib_EnterCriticalSection();
+    
+    /* The counter runs once RtosTrace_StartTimer() has been called */
+    if(cyclesPerUs != 0u)
+    {
+        now = DWT->CYCCNT;
+        cycleRemainder += now - lastCycles;
+        lastCycles = now;
+        
+        runTimeUs      += cycleRemainder / cyclesPerUs;
+        cycleRemainder %= cyclesPerUs;
+        result = runTimeUs;
+    }
+    
+    Cy_SysLib_ExitCriticalSection(interruptState);
+    
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_TaskSwitchedIn(uint32_t taskNumber)
+********************************************************************************
+* Summary:
+*  Trace hook that records a task switch. Called through traceTASK_SWITCHED_IN().
+*
+* Parameters:
+*  uint32_t taskNumber : task number of the task that starts running
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_TaskSwitchedIn(uint32_t taskNumber)
+{
+    Record(RTOS_TRACE_TASK_SWITCHED_IN, taskNumber, 0u);
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_QueueSend(uint32_t queueNumber, 
+*                                         uint32_t messagesWaiting)
+********************************************************************************
+* Summary:
+*  Trace hook that records a queue send. Called through traceQUEUE_SEND() and
+*  traceQUEUE_SEND_FROM_ISR().
+*
+* Parameters:
+*  uint32_t queueNumber     : number of the queue, 0 if it is not registered
+*  uint32_t messagesWaiting : messages in the queue before the send
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_QueueSend(uint32_t queueNumber, uint32_t messagesWaiting)
+{
+    if(queueNumber != 0u)
+    {
+        Record(RTOS_TRACE_QUEUE_SEND, queueNumber, messagesWaiting);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_QueueReceive(uint32_t queueNumber, 
+*                                            uint32_t messagesWaiting)
+********************************************************************************
+* Summary:
+*  Trace hook that records a queue receive. Called through traceQUEUE_RECEIVE()
+*  and traceQUEUE_RECEIVE_FROM_ISR().
+*
+* Parameters:
+*  uint32_t queueNumber     : number of the queue, 0 if it is not registered
+*  uint32_t messagesWaiting : messages in the queue before the receive
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_QueueReceive(uint32_t queueNumber, uint32_t messagesWaiting)
+{
+    if(queueNumber != 0u)
+    {
+        Record(RTOS_TRACE_QUEUE_RECEIVE, queueNumber, messagesWaiting);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void RtosTrace_BleEvent(uint32_t eventType)
+********************************************************************************
+* Summary:
+*  Records the dispatch of a BLE stack event.
+*
+* Parameters:
+*  uint32_t eventType : BLE stack event
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void RtosTrace_BleEvent(uint32_t eventType)
+{
+    Record(RTOS_TRACE_BLE_EVENT, 0u, eventType);
+}
+
+/*******************************************************************************
+* Function Name: static void Record(uint8_t type, uint32_t id, uint32_t value)
+********************************************************************************
+* Summary:
+*  Writes a record into the trace ring. If the ring is full, the record is 
+*  dropped and counted.
+*
+* Parameters:
+*  uint8_t type   : one of rtos_trace_type_t
+*  uint32_t id    : task or queue number
+*  uint32_t value : type dependent value
+*
+* Return:
+*  None
+*
+* Theory:
+*  The hooks run in tasks, in interrupts and inside the scheduler, so the ring 
+*  is written with interrupts disabled. Writing a record takes a few dozen 
+*  cycles.
+*
+*******************************************************************************/
+static void Record(uint8_t type, uint32_t id, uint32_t value)
+{
+    uint32_t interruptState;
+    rtos_trace_record_t *record;
+    
+    interruptState = Cy_SysLib_EnterCriticalSection();
+    
+    /* Records are only written once the run time counter is running */
+    if(cyclesPerUs != 0u)
+    {
+        if((ringWrite - ringRead) < RTOS_TRACE_RING_SIZE)
+        {
+            record = &traceRing[ringWrite & (RTOS_TRACE_RING_SIZE - 1u)];
+            record->timestamp = RtosTrace_GetRunTimeCounter();
+            record->type      = type;
+            record->id        = (uint8_t)id;
+            record->value     = (uint16_t)value;
+            ringWrite++;
+        }
+        else
+        {
+            droppedRecords++;
+        }
+    }
+    
+    Cy_SysLib_ExitCriticalSection(interruptState);
+}
+
+/*******************************************************************************
+* Function Name: void Task_Trace(void *pvParameters)
+********************************************************************************
+* Summary:
+*  Task that drains the trace ring and periodically prints the report.
+*
+* Parameters:
+*  void *pvParameters : Task parameter defined during task creation (unused)                            
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void Task_Trace(void *pvParameters)
+{
+    /* Variable used to run the task periodically */
+    TickType_t lastWakeTime;
+    
+    /* Remove warning for unused parameter */
+    (void)pvParameters;
+    
+    lastWakeTime   = xTaskGetTickCount();
+    lastReportTick = lastWakeTime;
+    
+    /* Repeatedly running part of the task */
+    for(;;)
+    {
+        vTaskDelayUntil(&lastWakeTime, pdMS_TO_TICKS(RTOS_TRACE_DRAIN_PERIOD_MS));
+        
+        DrainRing();
+        
+        if((xTaskGetTickCount() - lastReportTick) >= 
+            pdMS_TO_TICKS(RTOS_TRACE_REPORT_PERIOD_MS))
+        {
+            PrintReport();
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void DrainRing(void)
+********************************************************************************
+* Summary:
+*  Copies the records out of the trace ring in chunks and processes them.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void DrainRing(void)
+{
+    rtos_trace_record_t chunk[DRAIN_CHUNK];
+    uint32_t interruptState;
+    uint32_t count;
+    uint32_t index;
+    
+    do
+    {
+        /* Copy a chunk with interrupts disabled */
+        interruptState = Cy_SysLib_EnterCriticalSection();
+        
+        count = ringWrite - ringRead;
+        if(count > DRAIN_CHUNK)
+        {
+            count = DRAIN_CHUNK;
+        }
+        for(index = 0u; index < count; index++)
+        {
+            chunk[index] = traceRing[ringRead & (RTOS_TRACE_RING_SIZE - 1u)];
+            ringRead++;
+        }
+        
+        Cy_SysLib_ExitCriticalSection(interruptState);
+        
+        /* Process the chunk with interrupts enabled */
+        for(index = 0u; index < count; index++)
+        {
+            ProcessRecord(&chunk[index]);
+            
+        #if (RTOS_TRACE_STREAM_ENABLE)
+            StreamRecord(&chunk[index]);
+        #endif
+        }
+    }
+    while(count == DRAIN_CHUNK);
+}
+
+/*******************************************************************************
+* Function Name: static void ProcessRecord(const rtos_trace_record_t *record)
+********************************************************************************
+* Summary:
+*  Updates the statistics of the report with a trace record.
+*
+* Parameters:
+*  const rtos_trace_record_t *record : record to be processed
+*
+* Return:
+*  None
+*
+* Theory:
+*  The send timestamps of a queue are kept in the order of the messages, so a
+*  receive takes the oldest one. Both records carry the number of messages in
+*  the queue, and when fewer messages are left than timestamps are kept, the
+*  oldest timestamps are discarded. This keeps the matching right after 
+*  xQueueOverwrite() and after records were dropped.
+*
+*******************************************************************************/
+static void ProcessRecord(const rtos_trace_record_t *record)
+{
+    trace_queue_t *queue;
+    uint32_t latency;
+    
+    if(record->type == RTOS_TRACE_BLE_EVENT)
+    {
+        bleEvents++;
+    }
+    else if(((record->type == RTOS_TRACE_QUEUE_SEND) ||
+             (record->type == RTOS_TRACE_QUEUE_RECEIVE)) &&
+            (record->id != 0u) && (record->id <= queueCount))
+    {
+        queue = &traceQueues[record->id - 1u];
+        
+        /* Discard the timestamps of messages that are no longer queued */
+        while(queue->count > record->value)
+        {
+            queue->head = (queue->head + 1u) % LATENCY_DEPTH;
+            queue->count--;
+        }
+        
+        if(record->type == RTOS_TRACE_QUEUE_SEND)
+        {
+            queue->sends++;
+            
+            if(queue->count == LATENCY_DEPTH)
+            {
+                queue->head = (queue->head + 1u) % LATENCY_DEPTH;
+                queue->count--;
+            }
+            queue->sendTime[(queue->head + queue->count) % LATENCY_DEPTH] = 
+                record->timestamp;
+            queue->count++;
+        }
+        else if(queue->count != 0u)
+        {
+            latency = record->timestamp - queue->sendTime[queue->head];
+            queue->head = (queue->head + 1u) % LATENCY_DEPTH;
+            queue->count--;
+            
+            queue->receives++;
+            queue->latencySum += latency;
+            if(latency > queue->latencyMax)
+            {
+                queue->latencyMax = latency;
+            }
+        }
+        else
+        {
+            /* The matching send was dropped */
+        }
+    }
+    else
+    {
+        /* Task switches are only streamed; the CPU load comes from the
+           run time statistics of the scheduler */
+    }
+}
+
+#if (RTOS_TRACE_STREAM_ENABLE)
+/*******************************************************************************
+* Function Name: static void StreamRecord(const rtos_trace_record_t *record)
+********************************************************************************
+* Summary:
+*  Sends a trace record over the UART as a binary frame. See 
+*  RTOS_TRACE_STREAM_ENABLE in rtos_trace.h for the frame format.
+*
+* Parameters:
+*  const rtos_trace_record_t *record : record to be sent
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void StreamRecord(const rtos_trace_record_t *record)
+{
+    uint8_t frame[2u + sizeof(rtos_trace_record_t) + 1u];
+    uint8_t checksum = 0u;
+    uint32_t index;
+    
+    frame[0u] = FRAME_SYNC_0;
+    frame[1u] = FRAME_SYNC_1;
+    memcpy(&frame[2u], record, sizeof(rtos_trace_record_t));
+    for(index = 0u; index < sizeof(rtos_trace_record_t); index++)
+    {
+        checksum ^= frame[2u + index];
+    }
+    frame[sizeof(frame) - 1u] = checksum;
+    
+    /* The scheduler is not suspended while the frame is sent: a line printed
+       by a higher priority task in between is skipped by the sync pattern
+       and the checksum */
+    Cy_SCB_UART_PutArrayBlocking(UART_HW, frame, sizeof(frame));
+}
+#endif /* RTOS_TRACE_STREAM_ENABLE */
+
+/*******************************************************************************
+* Function Name: static void PrintReport(void)
+********************************************************************************
+* Summary:
+*  Prints the CPU load of every task and the latency of every registered queue
+*  since the last report, then starts a new report period. The stack and heap
+*  figures are the worst case since reset.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The loads are relative to the counted run time. The difference between the
+*  counted run time and the elapsed time is the time spent in Deep Sleep.
+*  uxTaskGetSystemState() takes the snapshot of the tasks with the scheduler
+*  suspended only briefly; the other figures are only changed by Task_Trace.
+*  The report is then printed with the scheduler running, so printing it does
+*  not hold up the other tasks.
+*
+*******************************************************************************/
+static void PrintReport(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t totalRunTime;
+    uint32_t elapsedRunTime;
+    uint32_t taskRunTime;
+    uint32_t permille;
+    uint32_t taskCount;
+    uint32_t index;
+    uint32_t number;
+    uint32_t dropped;
+    uint32_t heapFree;
+    uint32_t interruptState;
+    trace_queue_t *queue;
+    
+    taskCount = uxTaskGetSystemState(taskStatus, MAX_TASKS, &totalRunTime);
+    elapsedRunTime = totalRunTime - lastTotalRunTime;
+    lastTotalRunTime = totalRunTime;
+    
+    interruptState = Cy_SysLib_EnterCriticalSection();
+    dropped = droppedRecords;
+    droppedRecords = 0u;
+    Cy_SysLib_ExitCriticalSection(interruptState);
+    
+    /* The heap reports no free bytes until the first allocation sets it up */
+    heapFree = (uint32_t)xPortGetMinimumEverFreeHeapSize();
+    if(heapFree == 0u)
+    {
+        heapFree = (uint32_t)configTOTAL_HEAP_SIZE;
+    }
+    
+    printf("\r\nTrace    : counted %"PRIu32" ms of %"PRIu32" ms, "
+           "%"PRIu32" BLE events, %"PRIu32" records dropped\r\n",
+           elapsedRunTime / 1000u, 
+           (uint32_t)((now - lastReportTick) * 1000u / configTICK_RATE_HZ),
+           bleEvents, dropped);
+    printf("Trace    : heap never used %"PRIu32" of %"PRIu32" bytes\r\n",
+           heapFree, (uint32_t)configTOTAL_HEAP_SIZE);
+    
+    for(index = 0u; index < taskCount; index++)
+    {
+        number = taskStatus[index].xTaskNumber;
+        taskRunTime = taskStatus[index].ulRunTimeCounter;
+        
+        if(number <= MAX_TASKS)
+        {
+            permille = (elapsedRunTime == 0u) ? 0u : 
+                (uint32_t)(((uint64_t)(taskRunTime - lastTaskRunTime[number]) *
+                            1000u) / elapsedRunTime);
+            lastTaskRunTime[number] = taskRunTime;
+            
+            printf("Trace    : task %-16s %3"PRIu32".%"PRIu32" %%, "
+                   "stack never used %4"PRIu32" words\r\n",
+                   taskStatus[index].pcTaskName, permille / 10u,
+                   permille % 10u, 
+                   (uint32_t)taskStatus[index].usStackHighWaterMark);
+        }
+    }
+    
+    for(index = 0u; index < queueCount; index++)
+    {
+        queue = &traceQueues[index];
+        
+        printf("Trace    : queue %-15s %4"PRIu32" sent, latency avg "
+               "%"PRIu32" us max %"PRIu32" us\r\n", queue->name,
+               queue->sends, (queue->receives == 0u) ? 0u :
+               (queue->latencySum / queue->receives), queue->latencyMax);
+        
+        queue->sends      = 0u;
+        queue->receives   = 0u;
+        queue->latencySum = 0u;
+        queue->latencyMax = 0u;
+    }
+    
+    bleEvents      = 0u;
+    lastReportTick = now;
+}
+
+#endif /* RTOS_TRACE_ENABLE */
+
+/* [] END OF FILE */
@@ -0,0 +1,128 @@
+/******************************************************************************
+* File Name: rtos_trace.h
+*
+* Version: 1.0
+*
+* Description: This file is the public interface of rtos_trace.c source file
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the run time statistics and the binary
+* trace ring that show where the CM4 time goes
+*******************************************************************************/
+
+/* Include guard */
+#ifndef RTOS_TRACE_H
+#define RTOS_TRACE_H
+
+/* Header file includes */
+#include "FreeRTOS.h"
+#include "queue.h"
+
+/* If the run time statistics and the trace are enabled in FreeRTOSConfig.h */
+#if (RTOS_TRACE_ENABLE)
+    
+/* Number of records that the trace ring can hold */
+#define RTOS_TRACE_RING_SIZE            (256u)
+    
+/* Maximum number of queues that can be registered for the trace */
+#define RTOS_TRACE_MAX_QUEUES           (8u)
+    
+/* Period of Task_Trace draining the ring, and of the printed report */
+#define RTOS_TRACE_DRAIN_PERIOD_MS      (50u)
+#define RTOS_TRACE_REPORT_PERIOD_MS     (5000u)
+
+/**
+ * (true) streams every trace record over the UART as a binary frame
+ * for offline analysis, (false) only prints the report. A frame is 11 bytes:
+ * the sync bytes 0xA5 0x5A, the 8-byte rtos_trace_record_t in little-endian
+ * byte order, and the XOR of the 8 record bytes. The frames are mixed with
+ * the text output, which is why they start with a sync pattern.
+ */
+#define RTOS_TRACE_STREAM_ENABLE        (false)
+
+/* Types of the trace records */
+typedef enum
+{
+    /* id: task number of the task that starts running */
+    RTOS_TRACE_TASK_SWITCHED_IN = 1u,
+    /* id: queue number; value: messages in the queue before the send */
+    RTOS_TRACE_QUEUE_SEND,
+    /* id: queue number; value: messages in the queue before the receive */
+    RTOS_TRACE_QUEUE_RECEIVE,
+    /* value: BLE stack event that is dispatched to StackEventHandler */
+    RTOS_TRACE_BLE_EVENT
+}   rtos_trace_type_t;
+
+/* Trace record as stored in the ring and streamed over UART */
+typedef struct
+{
+    /* Run time counter value in microseconds */
+    uint32_t timestamp;
+    /* One of rtos_trace_type_t */
+    uint8_t  type;
+    /* Task or queue number, depending on the type */
+    uint8_t  id;
+    /* Type dependent value */
+    uint16_t value;
+}   rtos_trace_record_t;
+
+/* Creates Task_Trace; must be called before the scheduler is started */
+void RtosTrace_Init(void);
+
+/* Gives a queue a number and a name in the trace and the report */
+void RtosTrace_RegisterQueue(QueueHandle_t queue, const char *name);
+
+/* Records the dispatch of a BLE stack event */
+void RtosTrace_BleEvent(uint32_t eventType);
+
+/* Task that drains the trace ring and prints the report */
+void Task_Trace(void *pvParameters);
+
+/**
+ * Declaration of empty macros if the trace is not enabled for efficient code 
+ * generation
+ */
+#else
+#define RtosTrace_Init()
+#define RtosTrace_RegisterQueue(queue, name)
+#define RtosTrace_BleEvent(eventType)
+#endif /* RTOS_TRACE_ENABLE */
+
+#endif /* RTOS_TRACE_H */
+
+/* [] END OF FILE */
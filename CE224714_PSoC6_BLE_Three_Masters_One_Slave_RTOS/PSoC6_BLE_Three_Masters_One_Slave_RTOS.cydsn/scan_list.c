@@ -0,0 +1,449 @@
+/******************************************************************************
+* File Name: scan_list.c
+*
+* Version: 1.0
+*
+* Description: This file contains the table of scanned devices
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains an open-addressed hash table of the scanned devices keyed
+* by the BD address. Entries age out when a device is no longer seen while 
+* scanning, the least recently seen device is evicted when the table is full, 
+* and the RSSI of each device is smoothed over the advertising reports. 
+* Connected devices do not advertise, so they are never aged out or evicted
+*******************************************************************************/
+
+/* Header file includes */
+#include "scan_list.h"
+#include <string.h>
+
+/* Mask used to wrap the slot index around the table */
+#define SCAN_LIST_SLOT_MASK     (SCAN_LIST_SLOTS - 1u)
+
+#if ((SCAN_LIST_SLOTS & SCAN_LIST_SLOT_MASK) != 0u)
+    #error "SCAN_LIST_SLOTS must be a power of two"
+#endif
+
+/* Scale of the smoothed RSSI: 16 steps per dBm */
+#define SCAN_LIST_RSSI_SCALE    (16)
+
+/* Hash table of the scanned devices */
+static scan_list_device_t scanTable[SCAN_LIST_SLOTS];
+
+/* Number of devices in scanTable */
+static uint32_t scanDeviceCount = 0u;
+
+/* Scanning time in ticks up to the last stop of the scan, the tick count when
+   the scan was last started, and whether a scan is in progress */
+static uint32_t scanTimeAtStop  = 0u;
+static uint32_t scanStartTick   = 0u;
+static bool     scanInProgress  = false;
+
+/*******************************************************************************
+* Function Name: static uint32_t GetScanTime(uint32_t now)
+********************************************************************************
+* Summary:
+*  Returns the time spent scanning so far
+*
+* Parameters:
+*  uint32_t now : Current time in ticks
+*
+* Return:
+*  uint32_t : Scanning time in ticks
+*
+* Theory:
+*  The devices are aged against this time instead of the tick count, so that 
+*  the list is not emptied while the scan is stopped, for example while the 
+*  user selects a device or while a connection is set up.
+*
+*******************************************************************************/
+static uint32_t GetScanTime(uint32_t now)
+{
+    uint32_t scanTime = scanTimeAtStop;
+    
+    if(scanInProgress)
+    {
+        scanTime += now - scanStartTick;
+    }
+    
+    return scanTime;
+}
+
+/*******************************************************************************
+* Function Name: static uint32_t HomeSlot(const uint8_t *bdAddr)
+********************************************************************************
+* Summary:
+*  Returns the slot where the search for a device starts
+*
+* Parameters:
+*  const uint8_t *bdAddr : Device address
+*
+* Return:
+*  uint32_t : Home slot of the device
+*
+* Theory:
+*  The four lower bytes of the address are the ones that differ between 
+*  devices, both for the public addresses (the upper bytes are the company 
+*  identifier) and for the random ones. A multiplicative hash spreads them
+*  over the table.
+*
+*******************************************************************************/
+static uint32_t HomeSlot(const uint8_t *bdAddr)
+{
+    uint32_t key = ((uint32_t)bdAddr[0u])         | 
+                   ((uint32_t)bdAddr[1u] << 8u)   |
+                   ((uint32_t)bdAddr[2u] << 16u)  | 
+                   ((uint32_t)bdAddr[3u] << 24u);
+    
+    return ((key * 2654435761u) >> 16u) & SCAN_LIST_SLOT_MASK;
+}
+
+/*******************************************************************************
+* Function Name: static bool FindSlot(const uint8_t *bdAddr, uint8_t type, 
+*                                     uint32_t *slot)
+********************************************************************************
+* Summary:
+*  Looks up a device in the table
+*
+* Parameters:
+*  const uint8_t *bdAddr : Device address
+*  uint8_t type          : Device address type
+*  uint32_t *slot        : Slot of the device if found, otherwise the free slot
+*                          where it can be added
+*
+* Return:
+*  bool : true if the device is in the table
+*
+*******************************************************************************/
+static bool FindSlot(const uint8_t *bdAddr, uint8_t type, uint32_t *slot)
+{
+    bool     found = false;
+    uint32_t index = HomeSlot(bdAddr);
+    
+    /* The table always has free slots, so the search ends */
+    while(scanTable[index].used)
+    {
+        if((scanTable[index].address.type == type) &&
+           (memcmp(scanTable[index].address.bdAddr, bdAddr, 
+                   CY_BLE_GAP_BD_ADDR_SIZE) == 0))
+        {
+            found = true;
+            break;
+        }
+        index = (index + 1u) & SCAN_LIST_SLOT_MASK;
+    }
+    
+    *slot = index;
+    return found;
+}
+
+/*******************************************************************************
+* Function Name: static void RemoveSlot(uint32_t slot)
+********************************************************************************
+* Summary:
+*  Removes the device in a slot of the table
+*
+* Parameters:
+*  uint32_t slot : Slot of the device
+*
+* Return:
+*  None
+*
+* Theory:
+*  The devices that follow in the same probe sequence are shifted back into 
+*  the freed slot when their home slot allows it, so that every device stays 
+*  reachable without marking removed slots.
+*
+*******************************************************************************/
+static void RemoveSlot(uint32_t slot)
+{
+    uint32_t next = slot;
+    uint32_t home;
+    
+    scanTable[slot].used = false;
+    scanDeviceCount--;
+    
+    for(;;)
+    {
+        next = (next + 1u) & SCAN_LIST_SLOT_MASK;
+        
+        if(!scanTable[next].used)
+        {
+            break;
+        }
+        
+        /* Move the device if the free slot lies between its home slot and 
+           the slot it is in */
+        home = HomeSlot(scanTable[next].address.bdAddr);
+        if(((next - home) & SCAN_LIST_SLOT_MASK) >= 
+           ((next - slot) & SCAN_LIST_SLOT_MASK))
+        {
+            scanTable[slot] = scanTable[next];
+            scanTable[next].used = false;
+            slot = next;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static bool RemoveLeastRecentlySeen(void)
+********************************************************************************
+* Summary:
+*  Removes the device that has not been seen for the longest time, skipping 
+*  the connected devices
+*
+* Parameters:
+*  None
+*
+* Return:
+*  bool : true if a device was removed
+*
+*******************************************************************************/
+static bool RemoveLeastRecentlySeen(void)
+{
+    uint32_t index;
+    uint32_t oldestSlot = 0u;
+    bool     oldestFound = false;
+    
+    for(index = 0u; index < SCAN_LIST_SLOTS; index++)
+    {
+        if(scanTable[index].used && 
+           (!Cy_BLE_IsPeerConnected(scanTable[index].address.bdAddr)) &&
+           ((!oldestFound) || 
+            ((int32_t)(scanTable[index].lastSeen - 
+                       scanTable[oldestSlot].lastSeen) < 0)))
+        {
+            oldestSlot  = index;
+            oldestFound = true;
+        }
+    }
+    
+    if(oldestFound)
+    {
+        RemoveSlot(oldestSlot);
+    }
+    
+    return oldestFound;
+}
+
+/*******************************************************************************
+* Function Name: void ScanList_SetScanning(bool scanning, uint32_t now)
+********************************************************************************
+* Summary:
+*  Starts or pauses the scanning time. Called when the scan starts or stops.
+*
+* Parameters:
+*  bool scanning : true if the scan has started, false if it has stopped
+*  uint32_t now  : Current time in ticks
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void ScanList_SetScanning(bool scanning, uint32_t now)
+{
+    if(scanning && (!scanInProgress))
+    {
+        scanStartTick = now;
+    }
+    else if((!scanning) && scanInProgress)
+    {
+        scanTimeAtStop += now - scanStartTick;
+    }
+    else
+    {
+        /* No change */
+    }
+    
+    scanInProgress = scanning;
+}
+
+/*******************************************************************************
+* Function Name: bool ScanList_Update(const uint8_t *peerBdAddr, 
+*                       uint8_t peerAddrType, int8_t rssi, uint32_t now)
+********************************************************************************
+* Summary:
+*  Adds a device to the table, or refreshes its last seen time and its 
+*  smoothed RSSI if it is already there
+*
+* Parameters:
+*  const uint8_t *peerBdAddr : Device address
+*  uint8_t peerAddrType      : BD address type of the device
+*  int8_t rssi               : RSSI of the advertising report in dBm
+*  uint32_t now              : Current time in ticks
+*
+* Return:
+*  bool : true if the device is new in the table, false if it was already there
+*         or if there was no room for it
+*
+*******************************************************************************/
+bool ScanList_Update(const uint8_t *peerBdAddr, uint8_t peerAddrType,
+                     int8_t rssi, uint32_t now)
+{
+    uint32_t slot;
+    int16_t  sample = (int16_t)(rssi * SCAN_LIST_RSSI_SCALE);
+    bool     newDevice = false;
+    bool     stored = true;
+    
+    if(FindSlot(peerBdAddr, peerAddrType, &slot))
+    {
+        /* Exponential moving average of the RSSI */
+        scanTable[slot].rssi += (int16_t)((sample - scanTable[slot].rssi) / 
+                                          (1 << SCAN_LIST_RSSI_SHIFT));
+    }
+    else
+    {
+        /* Make room by evicting the least recently seen device. The free slot
+           has to be looked up again since the removal moves devices */
+        if(scanDeviceCount >= SCAN_LIST_MAX_DEVICES)
+        {
+            stored = RemoveLeastRecentlySeen();
+            (void)FindSlot(peerBdAddr, peerAddrType, &slot);
+        }
+        
+        if(stored)
+        {
+            memcpy(scanTable[slot].address.bdAddr, peerBdAddr, 
+                   CY_BLE_GAP_BD_ADDR_SIZE);
+            scanTable[slot].address.type = peerAddrType;
+            scanTable[slot].rssi = sample;
+            scanTable[slot].used = true;
+            scanDeviceCount++;
+            newDevice = true;
+        }
+    }
+    
+    if(stored)
+    {
+        scanTable[slot].lastSeen = GetScanTime(now);
+    }
+    
+    return newDevice;
+}
+
+/*******************************************************************************
+* Function Name: void ScanList_RemoveAged(uint32_t now)
+********************************************************************************
+* Summary:
+*  Removes the devices that have not been seen for SCAN_LIST_AGE_OUT_TICKS 
+*  of scanning. The connected devices are kept.
+*
+* Parameters:
+*  uint32_t now : Current time in ticks
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void ScanList_RemoveAged(uint32_t now)
+{
+    uint32_t index = 0u;
+    uint32_t scanTime = GetScanTime(now);
+    
+    while(index < SCAN_LIST_SLOTS)
+    {
+        /* A removal can shift another device into this slot, so the slot is
+           checked again before moving on */
+        if(scanTable[index].used && 
+           ((scanTime - scanTable[index].lastSeen) > SCAN_LIST_AGE_OUT_TICKS) &&
+           (!Cy_BLE_IsPeerConnected(scanTable[index].address.bdAddr)))
+        {
+            RemoveSlot(index);
+        }
+        else
+        {
+            index++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: uint32_t ScanList_GetSorted(scan_list_device_t *devices,
+*                                            uint32_t maxDevices)
+********************************************************************************
+* Summary:
+*  Copies the devices in the table sorted by decreasing smoothed RSSI, so that
+*  the closest devices are listed first
+*
+* Parameters:
+*  scan_list_device_t *devices : Array that receives the devices
+*  uint32_t maxDevices         : Size of the array
+*
+* Return:
+*  uint32_t : Number of devices copied
+*
+*******************************************************************************/
+uint32_t ScanList_GetSorted(scan_list_device_t *devices, uint32_t maxDevices)
+{
+    uint32_t index;
+    uint32_t position;
+    uint32_t count = 0u;
+    
+    for(index = 0u; index < SCAN_LIST_SLOTS; index++)
+    {
+        if(!scanTable[index].used)
+        {
+            continue;
+        }
+        
+        /* Insertion sort, the array holds the strongest devices seen so far */
+        position = count;
+        while((position > 0u) && 
+              (devices[position - 1u].rssi < scanTable[index].rssi))
+        {
+            if(position < maxDevices)
+            {
+                devices[position] = devices[position - 1u];
+            }
+            position--;
+        }
+        
+        if(position < maxDevices)
+        {
+            devices[position] = scanTable[index];
+            if(count < maxDevices)
+            {
+                count++;
+            }
+        }
+    }
+    
+    return count;
+}
+
+/* [] END OF FILE */
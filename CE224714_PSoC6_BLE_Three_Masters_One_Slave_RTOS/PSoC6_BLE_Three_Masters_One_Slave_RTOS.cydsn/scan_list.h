@@ -0,0 +1,105 @@
+/******************************************************************************
+* File Name: scan_list.h
+*
+* Version: 1.0
+*
+* Description: This file is the public interface of scan_list.c source file
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declaration of the table of scanned devices, which is
+* used to track a large number of advertisers with a fixed amount of memory
+*******************************************************************************/
+
+/* Include guard */
+#ifndef SCAN_LIST_H
+#define SCAN_LIST_H
+
+/* Header file includes */
+#include "project.h"
+#include "FreeRTOS.h"
+
+/* Number of slots of the hash table, must be a power of two */
+#define SCAN_LIST_SLOTS             (32u)
+
+/**
+ * Maximum number of devices in the table. Keeping a quarter of the slots free
+ * keeps the probe sequences short. The least recently seen device is evicted
+ * to make room for a new one.
+ */
+#define SCAN_LIST_MAX_DEVICES       ((SCAN_LIST_SLOTS * 3u) / 4u)
+
+/* Scanning time in ticks after which a device that is no longer seen is 
+   removed */
+#define SCAN_LIST_AGE_OUT_TICKS     pdMS_TO_TICKS(10000u)
+
+/* Weight of a new RSSI sample in the smoothed RSSI, as a power of two */
+#define SCAN_LIST_RSSI_SHIFT        (2u)
+
+/* Scanned device information */
+typedef struct
+{
+    /* Scanning time in ticks when the device was last seen */
+    uint32_t                  lastSeen;
+    
+    /* Peer device address */
+    cy_stc_ble_gap_bd_addr_t  address;
+    
+    /* Slot of the hash table is in use */
+    bool                      used;
+    
+    /* Smoothed RSSI in 1/16 dBm */
+    int16_t                   rssi;
+} scan_list_device_t;
+
+/* Starts or pauses the scanning time that the devices are aged against */
+void ScanList_SetScanning(bool scanning, uint32_t now);
+
+/* Adds a device to the table or refreshes it, returns true for a new device */
+bool ScanList_Update(const uint8_t *peerBdAddr, uint8_t peerAddrType,
+                     int8_t rssi, uint32_t now);
+
+/* Removes the devices that have not been seen for SCAN_LIST_AGE_OUT_TICKS of
+   scanning, except the connected ones */
+void ScanList_RemoveAged(uint32_t now);
+
+/* Copies the devices sorted by decreasing RSSI, returns the number copied */
+uint32_t ScanList_GetSorted(scan_list_device_t *devices, uint32_t maxDevices);
+
+#endif /* SCAN_LIST_H */
+
+/* [] END OF FILE */
@@ -68,6 +68,10 @@ QueueHandle_t statusLedDataQ;
 TimerHandle_t xTimer_StatusLedRed;
 TimerHandle_t xTimer_StatusLedOrange;
 
+/* Control blocks of the LED timers */
+static StaticTimer_t statusLedRedTimerBuffer;
+static StaticTimer_t statusLedOrangeTimerBuffer;
+
 /**
  * Functions that start and control the timers used for LED blink / toggle
  * intervals. 
@@ -313,9 +317,10 @@ static void StatusLedOrangeTimerStart(void)
     BaseType_t rtosApiResult;
     
     /* Create an RTOS timer */
-    xTimer_StatusLedOrange =  xTimerCreate ("Orange Status LED Timer",
+    xTimer_StatusLedOrange =  xTimerCreateStatic ("Orange Status LED Timer",
                                             STATUS_LED_IDLE_INTERVAL, pdTRUE, 
-                                            NULL, StatusLedOrangeTimerCallback); 
+                                            NULL, StatusLedOrangeTimerCallback,
+                                            &statusLedOrangeTimerBuffer); 
     
     /* Make sure that timer handle is valid */
     if (xTimer_StatusLedOrange != NULL)
@@ -421,9 +426,10 @@ static void StatusLedRedTimerStart(void)
     BaseType_t rtosApiResult;
     
     /* Create an RTOS timer */
-    xTimer_StatusLedRed    =  xTimerCreate ("Red Status LED Timer",
+    xTimer_StatusLedRed    =  xTimerCreateStatic ("Red Status LED Timer",
                                             STATUS_LED_IDLE_INTERVAL, pdTRUE,
-                                            NULL, StatusLedRedTimerCallback);
+                                            NULL, StatusLedRedTimerCallback,
+                                            &statusLedRedTimerBuffer);
     
     /* Make sure that timer handle is valid */
     if (xTimer_StatusLedRed != NULL)
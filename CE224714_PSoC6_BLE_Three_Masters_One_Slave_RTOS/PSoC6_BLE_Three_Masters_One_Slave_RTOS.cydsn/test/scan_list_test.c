@@ -0,0 +1,378 @@
+/******************************************************************************
+* File Name: scan_list_test.c
+*
+* Version: 1.0
+*
+* Description: This file contains the host test of the table of scanned
+*              devices in scan_list.c
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* The test includes scan_list.c to check the table itself: the probe
+* sequence of devices that share a home slot, the backward-shift delete, 
+* aging and eviction. The stubs directory stands in for the generated 
+* project.h and for FreeRTOS.h. This file is not part of the PSoC Creator 
+* project. From this directory:
+*     gcc -std=c99 -Wall -Istubs scan_list_test.c
+*     ./a.out
+* The program prints every failed check and returns non-zero if any failed.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stdio.h>
+#include "../scan_list.c"
+
+/* Number of devices that share a home slot in the probe tests */
+#define TEST_COLLISIONS         (3u)
+
+/* Address type used for all test devices */
+#define TEST_ADDR_TYPE          (0u)
+
+/* Prints a failed check and counts it */
+#define CHECK(condition)        do                                          \
+                                {                                           \
+                                    if(!(condition))                        \
+                                    {                                       \
+                                        printf("%s:%d: %s\n", __FILE__,     \
+                                               __LINE__, #condition);       \
+                                        failures++;                         \
+                                    }                                       \
+                                } while(0)
+
+static uint32_t failures;
+
+/* Address of the device reported as connected, if any */
+static uint8_t connectedAddr[CY_BLE_GAP_BD_ADDR_SIZE];
+static bool    connectedValid;
+
+/*******************************************************************************
+* Function Name: bool Cy_BLE_IsPeerConnected(uint8_t *bdAddr)
+********************************************************************************
+* Summary:
+*  Stub of the BLE middleware function, reports connectedAddr as connected
+*
+*******************************************************************************/
+bool Cy_BLE_IsPeerConnected(uint8_t *bdAddr)
+{
+    return connectedValid && 
+           (memcmp(bdAddr, connectedAddr, CY_BLE_GAP_BD_ADDR_SIZE) == 0);
+}
+
+/*******************************************************************************
+* Function Name: static void ResetTable(void)
+********************************************************************************
+* Summary:
+*  Empties the table and starts the scanning time at tick 0
+*
+*******************************************************************************/
+static void ResetTable(void)
+{
+    memset(scanTable, 0, sizeof(scanTable));
+    scanDeviceCount = 0u;
+    scanTimeAtStop  = 0u;
+    scanInProgress  = false;
+    connectedValid  = false;
+    ScanList_SetScanning(true, 0u);
+}
+
+/*******************************************************************************
+* Function Name: static void MakeAddress(uint32_t key, uint8_t *bdAddr)
+********************************************************************************
+* Summary:
+*  Builds a test address from a key
+*
+*******************************************************************************/
+static void MakeAddress(uint32_t key, uint8_t *bdAddr)
+{
+    bdAddr[0u] = (uint8_t)key;
+    bdAddr[1u] = (uint8_t)(key >> 8u);
+    bdAddr[2u] = (uint8_t)(key >> 16u);
+    bdAddr[3u] = (uint8_t)(key >> 24u);
+    bdAddr[4u] = 0x50u;
+    bdAddr[5u] = 0x00u;
+}
+
+/*******************************************************************************
+* Function Name: static void FindCollisions(uint32_t home, 
+*                                           uint8_t bdAddr[][])
+********************************************************************************
+* Summary:
+*  Finds TEST_COLLISIONS addresses whose home slot is home
+*
+*******************************************************************************/
+static void FindCollisions(uint32_t home, 
+                           uint8_t bdAddr[][CY_BLE_GAP_BD_ADDR_SIZE])
+{
+    uint32_t key = 1u;
+    uint32_t found = 0u;
+    
+    while(found < TEST_COLLISIONS)
+    {
+        MakeAddress(key, bdAddr[found]);
+        if(HomeSlot(bdAddr[found]) == home)
+        {
+            found++;
+        }
+        key++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: static bool SlotHolds(uint32_t slot, const uint8_t *bdAddr)
+********************************************************************************
+* Summary:
+*  Returns true if a slot holds the device
+*
+*******************************************************************************/
+static bool SlotHolds(uint32_t slot, const uint8_t *bdAddr)
+{
+    slot &= SCAN_LIST_SLOT_MASK;
+    
+    return scanTable[slot].used && 
+           (memcmp(scanTable[slot].address.bdAddr, bdAddr, 
+                   CY_BLE_GAP_BD_ADDR_SIZE) == 0);
+}
+
+/*******************************************************************************
+* Function Name: static void CheckTable(void)
+********************************************************************************
+* Summary:
+*  Checks that the device count matches the used slots, and that no free slot
+*  lies between a device and its home slot, so every device can be found
+*
+*******************************************************************************/
+static void CheckTable(void)
+{
+    uint32_t slot;
+    uint32_t probe;
+    uint32_t used = 0u;
+    
+    for(slot = 0u; slot < SCAN_LIST_SLOTS; slot++)
+    {
+        if(scanTable[slot].used)
+        {
+            used++;
+            for(probe = HomeSlot(scanTable[slot].address.bdAddr); 
+                probe != slot; probe = (probe + 1u) & SCAN_LIST_SLOT_MASK)
+            {
+                CHECK(scanTable[probe].used);
+            }
+        }
+    }
+    CHECK(used == scanDeviceCount);
+}
+
+/*******************************************************************************
+* Function Name: static void TestProbeAndShift(uint32_t home)
+********************************************************************************
+* Summary:
+*  Adds devices that share a home slot, then ages out the first one and checks
+*  that the others are shifted back
+*
+* Parameters:
+*  uint32_t home : Home slot shared by the devices
+*
+*******************************************************************************/
+static void TestProbeAndShift(uint32_t home)
+{
+    uint8_t  bdAddr[TEST_COLLISIONS][CY_BLE_GAP_BD_ADDR_SIZE];
+    uint32_t index;
+    
+    ResetTable();
+    FindCollisions(home, bdAddr);
+    
+    /* The devices take the slots after their home slot in turn */
+    CHECK(ScanList_Update(bdAddr[0u], TEST_ADDR_TYPE, -60, 0u));
+    for(index = 1u; index < TEST_COLLISIONS; index++)
+    {
+        CHECK(ScanList_Update(bdAddr[index], TEST_ADDR_TYPE, -60, 5000u));
+    }
+    for(index = 0u; index < TEST_COLLISIONS; index++)
+    {
+        CHECK(SlotHolds(home + index, bdAddr[index]));
+    }
+    CHECK(!ScanList_Update(bdAddr[TEST_COLLISIONS - 1u], TEST_ADDR_TYPE, 
+                           -60, 5000u));
+    CheckTable();
+    
+    /* The first device ages out and the others move back one slot */
+    ScanList_RemoveAged(SCAN_LIST_AGE_OUT_TICKS + 1u);
+    CHECK(scanDeviceCount == (TEST_COLLISIONS - 1u));
+    for(index = 1u; index < TEST_COLLISIONS; index++)
+    {
+        CHECK(SlotHolds(home + index - 1u, bdAddr[index]));
+    }
+    CHECK(!scanTable[(home + TEST_COLLISIONS - 1u) & SCAN_LIST_SLOT_MASK].used);
+    CheckTable();
+    
+    /* The remaining devices are still found */
+    for(index = 1u; index < TEST_COLLISIONS; index++)
+    {
+        CHECK(!ScanList_Update(bdAddr[index], TEST_ADDR_TYPE, -60, 5000u));
+    }
+    CHECK(scanDeviceCount == (TEST_COLLISIONS - 1u));
+}
+
+/*******************************************************************************
+* Function Name: static void TestShiftKeepsHome(void)
+********************************************************************************
+* Summary:
+*  Checks that the delete does not move a device to before its home slot
+*
+*******************************************************************************/
+static void TestShiftKeepsHome(void)
+{
+    uint8_t bdAddr[TEST_COLLISIONS][CY_BLE_GAP_BD_ADDR_SIZE];
+    uint8_t other[TEST_COLLISIONS][CY_BLE_GAP_BD_ADDR_SIZE];
+    
+    ResetTable();
+    FindCollisions(4u, bdAddr);
+    FindCollisions(5u, other);
+    
+    /* Slots 4 and 5 hold devices of home 4, slot 6 a device of home 5 */
+    (void)ScanList_Update(bdAddr[0u], TEST_ADDR_TYPE, -60, 0u);
+    (void)ScanList_Update(bdAddr[1u], TEST_ADDR_TYPE, -60, 0u);
+    (void)ScanList_Update(other[0u], TEST_ADDR_TYPE, -60, 5000u);
+    CHECK(SlotHolds(6u, other[0u]));
+    
+    /* Removing both home 4 devices leaves the home 5 device in slot 5 */
+    ScanList_RemoveAged(SCAN_LIST_AGE_OUT_TICKS + 1u);
+    CHECK(scanDeviceCount == 1u);
+    CHECK(SlotHolds(5u, other[0u]));
+    CHECK(!scanTable[4u].used);
+    CheckTable();
+}
+
+/*******************************************************************************
+* Function Name: static void TestAgingAndEviction(void)
+********************************************************************************
+* Summary:
+*  Checks that the aging pauses while the scan is stopped, that a connected 
+*  device is kept, and that a full table evicts the least recently seen device
+*
+*******************************************************************************/
+static void TestAgingAndEviction(void)
+{
+    uint8_t  bdAddr[CY_BLE_GAP_BD_ADDR_SIZE];
+    uint8_t  first[CY_BLE_GAP_BD_ADDR_SIZE];
+    uint32_t key;
+    
+    ResetTable();
+    MakeAddress(1u, first);
+    (void)ScanList_Update(first, TEST_ADDR_TYPE, -60, 0u);
+    
+    /* Time with the scan stopped does not count */
+    ScanList_SetScanning(false, 1000u);
+    ScanList_RemoveAged(100000u);
+    CHECK(scanDeviceCount == 1u);
+    ScanList_SetScanning(true, 100000u);
+    
+    /* A connected device is not aged out */
+    memcpy(connectedAddr, first, CY_BLE_GAP_BD_ADDR_SIZE);
+    connectedValid = true;
+    ScanList_RemoveAged(100000u + SCAN_LIST_AGE_OUT_TICKS);
+    CHECK(scanDeviceCount == 1u);
+    connectedValid = false;
+    
+    /* Fill the table, then a new device evicts the oldest one */
+    ResetTable();
+    for(key = 1u; key <= SCAN_LIST_MAX_DEVICES; key++)
+    {
+        MakeAddress(key, bdAddr);
+        CHECK(ScanList_Update(bdAddr, TEST_ADDR_TYPE, -60, key));
+    }
+    CHECK(scanDeviceCount == SCAN_LIST_MAX_DEVICES);
+    MakeAddress(key, bdAddr);
+    CHECK(ScanList_Update(bdAddr, TEST_ADDR_TYPE, -60, key));
+    CHECK(scanDeviceCount == SCAN_LIST_MAX_DEVICES);
+    CHECK(ScanList_Update(first, TEST_ADDR_TYPE, -60, key));
+    CheckTable();
+}
+
+/*******************************************************************************
+* Function Name: static void TestSorted(void)
+********************************************************************************
+* Summary:
+*  Checks that the devices are listed by decreasing RSSI
+*
+*******************************************************************************/
+static void TestSorted(void)
+{
+    const int8_t rssi[4u] = {-80, -40, -90, -60};
+    scan_list_device_t devices[3u];
+    uint8_t  bdAddr[CY_BLE_GAP_BD_ADDR_SIZE];
+    uint32_t index;
+    
+    ResetTable();
+    for(index = 0u; index < 4u; index++)
+    {
+        MakeAddress(index + 1u, bdAddr);
+        (void)ScanList_Update(bdAddr, TEST_ADDR_TYPE, rssi[index], 0u);
+    }
+    
+    CHECK(ScanList_GetSorted(devices, 3u) == 3u);
+    CHECK(devices[0u].rssi == (-40 * SCAN_LIST_RSSI_SCALE));
+    CHECK(devices[1u].rssi == (-60 * SCAN_LIST_RSSI_SCALE));
+    CHECK(devices[2u].rssi == (-80 * SCAN_LIST_RSSI_SCALE));
+}
+
+/*******************************************************************************
+* Function Name: int main(void)
+********************************************************************************
+* Summary:
+*  Runs the tests
+*
+* Return:
+*  int : 0 if all checks passed
+*
+*******************************************************************************/
+int main(void)
+{
+    TestProbeAndShift(4u);
+    
+    /* The probe sequence wraps around the end of the table */
+    TestProbeAndShift(SCAN_LIST_SLOTS - 1u);
+    TestShiftKeepsHome();
+    TestAgingAndEviction();
+    TestSorted();
+    
+    printf("scan_list_test: %u failed\n", (unsigned int)failures);
+    
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name: project.h
+*
+* Version: 1.0
+*
+* Description: This file contains the parts of the generated project.h
+*              that scan_list.c uses, for the host test
+*
+* Related Document: CE224714_PSoC6_BLE_Three_Masters_One_Slave_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* Only used by the host test in the parent directory. The types and the
+* function follow the PSoC 6 BLE middleware.
+*******************************************************************************/
+
+#ifndef PROJECT_H
+#define PROJECT_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Size of a BD address in bytes */
+#define CY_BLE_GAP_BD_ADDR_SIZE     (0x06u)
+
+/* BD address */
+typedef struct
+{
+    /* Device address */
+    uint8_t bdAddr[CY_BLE_GAP_BD_ADDR_SIZE];
+    
+    /* Public or random address */
+    uint8_t type;
+} cy_stc_ble_gap_bd_addr_t;
+
+/* Returns true if a device is connected, implemented by the test */
+bool Cy_BLE_IsPeerConnected(uint8_t *bdAddr);
+
+#endif /* PROJECT_H */
+
+/* [] END OF FILE */
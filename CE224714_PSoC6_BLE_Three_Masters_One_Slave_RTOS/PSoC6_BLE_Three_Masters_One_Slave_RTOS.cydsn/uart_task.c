@@ -48,7 +48,17 @@
 #include "ble_task.h"
 #include "uart_debug.h"
 
-#define UART_NO_DATA    (char8) CY_SCB_UART_RX_NO_DATA
+/* Task notification bits that wake up Task_Debug */
+#define UART_EVENT_RX_DATA      (0x01u)
+#define UART_EVENT_PRINT        (0x02u)
+#define UART_EVENT_ALL          (UART_EVENT_RX_DATA | UART_EVENT_PRINT)
+
+/* Size of the receive ring buffer; must be a power of two */
+#define UART_RX_RING_SIZE       (16u)
+
+#if ((UART_RX_RING_SIZE & (UART_RX_RING_SIZE - 1u)) != 0u)
+    #error "UART_RX_RING_SIZE must be a power of two"
+#endif
 
 /* Queue handle for debug message Queue */
 QueueHandle_t debugMessageQ;
@@ -58,11 +68,22 @@ QueueHandle_t debugMessageQ;
  * outside this file. See the respective function definition for more details. 
  */
 static void ProcessUartCommands(char8 command);
+static void UartRxInit(void);
+static void UartInterruptHandler(void);
+static bool UartRxGet(char8 *data);
 
 /* Global variables */
 static bool connectPending = false;
 static bool disconnectPending = false;
 
+/* Handle of Task_Debug, used to wake it up */
+static TaskHandle_t uartTaskHandle = NULL;
+
+/* Receive ring buffer, filled by UartInterruptHandler */
+static volatile char8    rxRing[UART_RX_RING_SIZE];
+static volatile uint32_t rxWrite = 0u;
+static volatile uint32_t rxRead  = 0u;
+
 /*******************************************************************************
 * Function Name: void Task_Debug(void *pvParameters)
 ********************************************************************************
@@ -75,29 +96,33 @@ static bool disconnectPending = false;
 * Return:
 *  void
 *
+* Theory:
+*  The task blocks until it is notified, either by SendToDebugPrintTask() 
+*  when a message has been queued or by the UART interrupt when a character 
+*  has been received, so it uses no CPU time while the terminal is quiet and 
+*  the idle task can put the CPU to sleep.
+*
 *******************************************************************************/    
 void Task_Debug(void *pvParameters)
 {
     /* Variable that stores the data to be printed */
     debug_print_data_t dataToPrint;
     
-   /* Variable used to store the return values of RTOS APIs */
-    BaseType_t rtosApiResult;
-    
     /* Remove warning for unused parameter */
     (void) pvParameters;
     
     /* Variable used to store user command*/
     char8 command;
+    
+    /* Enable the notifications and the UART receive interrupt */
+    uartTaskHandle = xTaskGetCurrentTaskHandle();
+    UartRxInit();
         
     /* Repeatedly running part of the task */    
     for(;;)
     {
-        /* Block until a message to printed has been received over debugMessageQ */
-        rtosApiResult = xQueueReceive(debugMessageQ, &dataToPrint, 0u);
-        
-        /* Message has been received from debugMessageQ */
-        if(rtosApiResult == pdTRUE)
+        /* Print all the messages that have been received over debugMessageQ */
+        while(xQueueReceive(debugMessageQ, &dataToPrint, 0u) == pdTRUE)
         {
             /* If the error code is not 0, print message string along with the
                error code (as 32-bit hexadecimal data) */
@@ -112,15 +137,140 @@ void Task_Debug(void *pvParameters)
                 printf("%s \r\n", dataToPrint.stringPointer);
             }
         }
-        else
+        
+        /* Process all the received user commands */
+        while(UartRxGet(&command))
         {
-            command = UART_Get();
-            if(command != UART_NO_DATA)
-            {
-                 ProcessUartCommands(command);
-            }
+             ProcessUartCommands(command);
+        }
+        
+        /* Block until there is a new message or a new user command. A 
+           notification that arrived while printing makes this return at 
+           once, so no message or command is left waiting */
+        (void)xTaskNotifyWait(0u, UART_EVENT_ALL, NULL, portMAX_DELAY);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void SendToDebugPrintTask(char* stringPtr, uint32_t errCode)
+********************************************************************************
+* Summary:
+*  Sends a message to the debug Queue and wakes up Task_Debug to print it.
+*
+* Parameters:
+*  char* stringPtr  : constant string to be printed
+*  uint32_t errCode : error code printed after the string, 0 for none
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void SendToDebugPrintTask(char* stringPtr, uint32_t errCode)
+{
+    debug_print_data_t printData = {.stringPointer = stringPtr, 
+                                    .errorCode     = errCode};
+    
+    if((xQueueSend(debugMessageQ, &printData, 0u) == pdTRUE) && 
+       (uartTaskHandle != NULL))
+    {
+        (void)xTaskNotify(uartTaskHandle, UART_EVENT_PRINT, eSetBits);
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void UartRxInit(void)
+********************************************************************************
+* Summary:
+*  Routes the UART interrupt to this core and enables it for received data.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The UART is started by the CM0+ core; only the interrupt is set up here. 
+*  UART_SCB_IRQ is assigned to the CM4 core in the Interrupts tab of the 
+*  design-wide resources.
+*
+*******************************************************************************/
+static void UartRxInit(void)
+{
+    Cy_SysInt_Init(&UART_SCB_IRQ_cfg, &UartInterruptHandler);
+    NVIC_ClearPendingIRQ(UART_SCB_IRQ_cfg.intrSrc);
+    NVIC_EnableIRQ(UART_SCB_IRQ_cfg.intrSrc);
+    
+    /* Interrupt whenever the RX FIFO holds data */
+    Cy_SCB_UART_ClearRxFifoStatus(UART_HW, CY_SCB_UART_RX_NOT_EMPTY);
+    Cy_SCB_SetRxInterruptMask(UART_HW, CY_SCB_UART_RX_NOT_EMPTY);
+}
+
+/*******************************************************************************
+* Function Name: static void UartInterruptHandler(void)
+********************************************************************************
+* Summary:
+*  Moves the received characters from the RX FIFO into the receive ring buffer
+*  and wakes up Task_Debug.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void UartInterruptHandler(void)
+{
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+    char8 data;
+    
+    while(Cy_SCB_UART_GetNumInRxFifo(UART_HW) != 0u)
+    {
+        data = (char8)Cy_SCB_UART_Get(UART_HW);
+        
+        /* Characters that do not fit are dropped */
+        if((rxWrite - rxRead) < UART_RX_RING_SIZE)
+        {
+            rxRing[rxWrite & (UART_RX_RING_SIZE - 1u)] = data;
+            rxWrite++;
         }
     }
+    Cy_SCB_UART_ClearRxFifoStatus(UART_HW, CY_SCB_UART_RX_NOT_EMPTY);
+    
+    if(uartTaskHandle != NULL)
+    {
+        (void)xTaskNotifyFromISR(uartTaskHandle, UART_EVENT_RX_DATA, eSetBits,
+                                 &xHigherPriorityTaskWoken);
+    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
+}
+
+/*******************************************************************************
+* Function Name: static bool UartRxGet(char8 *data)
+********************************************************************************
+* Summary:
+*  Takes a received character out of the receive ring buffer.
+*
+* Parameters:
+*  char8 *data : the received character is stored here
+*
+* Return:
+*  bool : true if a character was taken, false if the buffer is empty
+*
+*******************************************************************************/
+static bool UartRxGet(char8 *data)
+{
+    bool result = false;
+    
+    if(rxRead != rxWrite)
+    {
+        *data = rxRing[rxRead & (UART_RX_RING_SIZE - 1u)];
+        rxRead++;
+        result = true;
+    }
+    
+    return result;
 }
 
 
@@ -227,7 +377,7 @@ void ProcessUartCommands(char8 command)
     if(validBleCommand)
     {
         /* Send BLE command */
-        rtosApiResult = xQueueSend(bleCommandQ, &bleCommand, 0);
+        rtosApiResult = Task_Ble_SendCommand(&bleCommand, 0u);
         if(rtosApiResult != pdTRUE)
         {
             DebugPrintf("Failure!  : UART - Send command to BLE\r\n");
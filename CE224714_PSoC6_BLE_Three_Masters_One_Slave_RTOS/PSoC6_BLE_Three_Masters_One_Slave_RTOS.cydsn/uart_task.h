@@ -83,12 +83,7 @@ extern QueueHandle_t debugMessageQ;
 /* Task that performs thread safe debug message printing */
 void Task_Debug(void *pvParameters);
    
-/* Inline function that sends messages to the debug Queue */
-void inline static SendToDebugPrintTask(char* stringPtr, uint32_t errCode)
-{
-    debug_print_data_t printData = {.stringPointer = stringPtr, 
-                                    .errorCode     = errCode};
-    xQueueSend(debugMessageQ, &printData, 0u);
-}
+/* Sends a message to the debug Queue and wakes up Task_Debug */
+void SendToDebugPrintTask(char* stringPtr, uint32_t errCode);
 
 /* [] END OF FILE */
@@ -64,9 +64,14 @@
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
 
 /* Memory allocation related definitions. */
-#define configSUPPORT_STATIC_ALLOCATION         0
-#define configSUPPORT_DYNAMIC_ALLOCATION        1
-#define configTOTAL_HEAP_SIZE                   10240
+#define configSUPPORT_STATIC_ALLOCATION         1 /* Changed to create all
+                                                     kernel objects at compile
+                                                     time */
+#define configSUPPORT_DYNAMIC_ALLOCATION        1 /* Needed by the heap file 
+                                                     selected in Build Settings;
+                                                     nothing is allocated */
+#define configTOTAL_HEAP_SIZE                   256 /* Reduced since all kernel
+                                                       objects are static */
 #define configAPPLICATION_ALLOCATED_HEAP        0
 
 /* Hook function related definitions. */
@@ -98,4 +98,18 @@ void RTCtimer_Init()
     Cy_RTC_SetAlarmDateAndTime(&alarm, CY_RTC_ALARM_1);
 }
 
+/* Returns the seconds since RTCtimer_Init() set the default date and time,
+   which is the time spent in hibernate when called after a wakeup */
+uint32_t RTCtimer_GetElapsedSeconds(void)
+{
+    cy_stc_rtc_config_t dateTime;
+    
+    Cy_RTC_GetDateAndTime(&dateTime);
+    
+    /* TIME_AT_RESET starts on the first day of January, so the days elapsed
+       are the date minus one for up to a month */
+    return dateTime.sec + (dateTime.min * 60u) + (dateTime.hour * 3600u) +
+           ((dateTime.date - 1u) * 86400u);
+}
+
 /* [] END OF FILE */
@@ -47,6 +47,7 @@
     *       Function Prototypes
     ***************************************/
     void RTCtimer_Init(void);
+    uint32_t RTCtimer_GetElapsedSeconds(void);
 
 #endif
 
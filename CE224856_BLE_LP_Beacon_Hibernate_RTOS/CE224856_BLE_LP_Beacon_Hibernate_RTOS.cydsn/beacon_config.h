@@ -0,0 +1,118 @@
+/******************************************************************************
+* File Name: beacon_config.h
+*
+* Version: 1.00
+*
+* Description: This file contains macros used for iBeacon and AltBeacon packet
+*              configuration.
+*
+* Related Document: CE224856_BLE_Low_Power_Beacon_with_Hibernate_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains macros used for the iBeacon and AltBeacon packets, which 
+* are broadcast in turn with the Eddystone packets. For details, see:
+*
+* https://developer.apple.com/ibeacon/
+* https://github.com/AltBeacon/spec
+*
+********************************************************************************/
+
+/* Include Guard */
+#ifndef BEACON_CONFIG_H
+#define BEACON_CONFIG_H
+    
+/*~~~~~~~~~~~~~~~~~~~~~~ ROTATION SETTINGS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* Longest time between two broadcasts of each frame in milliseconds, and the
+   TX power it is broadcast with. An interval of 0 leaves the frame out of 
+   the rotation. See eddystone_config.h for the Eddystone frames */
+#define IBEACON_INTERVAL_MS             (1000u)
+#define IBEACON_TX_POWER                (CY_BLE_LL_PWR_LVL_0_DBM)
+#define ALTBEACON_INTERVAL_MS           (2000u)
+#define ALTBEACON_TX_POWER              (CY_BLE_LL_PWR_LVL_0_DBM)
+
+/*~~~~~~~~~~~~~~~~~~~~~~ IBEACON PACKET SETTINGS ~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* Manufacturer specific data of the iBeacon frame. Replace the proximity UUID
+   with your own */
+#define IBEACON_DATA                    {0x1Au, /* Length */\
+                                         0xFFu, /* Manufacturer Specific Data */\
+                                         0x4Cu, /* LSB - Apple company ID */\
+                                         0x00u, /* MSB - Apple company ID */\
+                                         0x02u, /* Signifies iBeacon */\
+                                         0x15u, /* Length of the iBeacon data */\
+                                         0x00u, 0x05u, 0x00u, 0x01u, /* UUID */\
+                                         0x00u, 0x00u, 0x10u, 0x00u, /* UUID */\
+                                         0x80u, 0x00u, 0x00u, 0x80u, /* UUID */\
+                                         0x5Fu, 0x9Bu, 0x01u, 0x31u, /* UUID */\
+                                         0x00u, /* MSB - Major */\
+                                         0x01u, /* LSB - Major */\
+                                         0x00u, /* MSB - Minor */\
+                                         0x01u, /* LSB - Minor */\
+                                         0xC3u} /* Measured power at 1 m: -61dBm */
+
+/* Packet index of the iBeacon data */
+#define IBEACON_INDEX                   (0x03u)
+
+/* Total size of an iBeacon frame */
+#define IBEACON_PACKET_SIZE             (0x1Eu)
+
+/*~~~~~~~~~~~~~~~~~~~~~~ ALTBEACON PACKET SETTINGS ~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* Manufacturer specific data of the AltBeacon frame. The beacon ID is the 
+   16-byte organization ID followed by a 4-byte sub-ID */
+#define ALTBEACON_DATA                  {0x1Bu, /* Length */\
+                                         0xFFu, /* Manufacturer Specific Data */\
+                                         0x31u, /* LSB - Cypress company ID */\
+                                         0x01u, /* MSB - Cypress company ID */\
+                                         0xBEu, /* MSB - AltBeacon code */\
+                                         0xACu, /* LSB - AltBeacon code */\
+                                         0x00u, 0x05u, 0x00u, 0x01u, /* ID */\
+                                         0x00u, 0x00u, 0x10u, 0x00u, /* ID */\
+                                         0x80u, 0x00u, 0x00u, 0x80u, /* ID */\
+                                         0x5Fu, 0x9Bu, 0x01u, 0x31u, /* ID */\
+                                         0x00u, 0x01u, 0x00u, 0x01u, /* ID */\
+                                         0xC3u, /* Reference RSSI at 1 m: -61dBm */\
+                                         0x00u} /* Manufacturer reserved */
+
+/* Packet index of the AltBeacon data */
+#define ALTBEACON_INDEX                 (0x03u)
+
+/* Total size of an AltBeacon frame */
+#define ALTBEACON_PACKET_SIZE           (0x1Fu)
+
+#endif    
+/* [] END OF FILE */
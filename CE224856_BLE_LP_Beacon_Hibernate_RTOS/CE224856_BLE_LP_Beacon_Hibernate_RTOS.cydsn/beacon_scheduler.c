@@ -0,0 +1,429 @@
+/******************************************************************************
+* File Name: beacon_scheduler.c
+*
+* Version: 1.00
+*
+* Description: This file contains the scheduler that shares the advertising
+*              events between the beacon frames
+*
+* Related Document: CE224856_BLE_Low_Power_Beacon_with_Hibernate_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the scheduler that decides which beacon frame is broadcast
+* in each advertising event. It only depends on the C library
+*******************************************************************************/
+
+/* Header file includes */
+#include <string.h>
+#include "beacon_scheduler.h"
+
+/* Longest advertising interval allowed by the link layer */
+#define MAX_INTERVAL_MS             (10240u)
+
+/* Fixed point scales used to add up the event rates and the share of slots
+   that the frames need */
+#define RATE_ONE                    (1ull << 24u)
+#define SHARE_ONE                   (1ul << 16u)
+
+/**
+ * Schedule of the frames. The frame to broadcast is set once per slot, which 
+ * is the advertising interval plus the largest random advertising delay, so 
+ * every frame is on air for at least one advertising event. Each frame has 
+ * the slots whose number modulo periodSlots equals offsetSlot; a period of 0
+ * means the frame is not broadcast. intervalMs is the interval the frame is 
+ * scheduled for, which is longer than asked for if the frames do not fit. 
+ * Slots that no frame has keep the frame of the previous slot on air.
+ */
+typedef struct
+{
+    uint32_t eventIntervalMs;
+    uint32_t slotMs;
+    uint32_t slot;
+    uint32_t lastFrame;
+    uint32_t enabledCount;
+    uint32_t frameCount;
+    uint32_t intervalMs[BEACON_SCHED_MAX_FRAMES];
+    uint32_t periodSlots[BEACON_SCHED_MAX_FRAMES];
+    uint32_t offsetSlot[BEACON_SCHED_MAX_FRAMES];
+}   schedule_t;
+
+static schedule_t schedule;
+
+/**
+ * These static functions are used by the beacon scheduler. These are not 
+ * available outside this file. See the respective function definitions for 
+ * more details 
+ */
+static uint32_t FindEventInterval(schedule_t *sched);
+static bool     SetPeriods(schedule_t *sched, uint32_t slotMs);
+static void     SetOffsets(schedule_t *sched);
+static uint32_t PickFrame(schedule_t *sched);
+
+/*******************************************************************************
+* Function Name: bool BeaconSched_Init(const beacon_sched_frame_t *frames, 
+*                                      uint32_t frameCount)
+********************************************************************************
+* Summary:
+*  Sets up a schedule for the frames
+*
+* Parameters:
+*  const beacon_sched_frame_t *frames : settings of the frames; the index of a
+*                                       frame in this array is the value 
+*                                       returned by BeaconSched_NextFrame()
+*  uint32_t frameCount                : number of frames, up to 
+*                                       BEACON_SCHED_MAX_FRAMES
+*
+* Return:
+*  bool : true if the schedule was set up; false if there are too many 
+*         frames, or none of them is ever broadcast
+*
+*******************************************************************************/
+bool BeaconSched_Init(const beacon_sched_frame_t *frames, uint32_t frameCount)
+{
+    uint32_t index;
+    
+    if((frameCount == 0u) || (frameCount > BEACON_SCHED_MAX_FRAMES))
+    {
+        return false;
+    }
+    
+    memset(&schedule, 0, sizeof(schedule));
+    schedule.frameCount = frameCount;
+    schedule.lastFrame  = frameCount;
+    
+    for(index = 0u; index < frameCount; index++)
+    {
+        schedule.intervalMs[index] = frames[index].intervalMs;
+        
+        if(frames[index].intervalMs != 0u)
+        {
+            schedule.enabledCount++;
+            
+            /* Until a slot is assigned, keep the first frame on air */
+            if(schedule.lastFrame == frameCount)
+            {
+                schedule.lastFrame = index;
+            }
+        }
+    }
+    
+    if(schedule.enabledCount == 0u)
+    {
+        return false;
+    }
+    
+    schedule.eventIntervalMs = FindEventInterval(&schedule);
+    schedule.slotMs = schedule.eventIntervalMs + BEACON_SCHED_ADV_DELAY_MAX_MS;
+    SetOffsets(&schedule);
+    
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t BeaconSched_GetEventInterval(void)
+********************************************************************************
+* Summary:
+*  Returns the advertising interval of the schedule. The frame to broadcast 
+*  must be changed every BEACON_SCHED_ADV_DELAY_MAX_MS more than that, by 
+*  calling BeaconSched_NextFrame().
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : advertising interval in milliseconds
+*
+*******************************************************************************/
+uint32_t BeaconSched_GetEventInterval(void)
+{
+    return schedule.eventIntervalMs;
+}
+
+/*******************************************************************************
+* Function Name: uint32_t BeaconSched_NextFrame(void)
+********************************************************************************
+* Summary:
+*  Returns the frame to broadcast until the next call
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : index of the frame in the array passed to BeaconSched_Init()
+*
+*******************************************************************************/
+uint32_t BeaconSched_NextFrame(void)
+{
+    return PickFrame(&schedule);
+}
+
+/*******************************************************************************
+* Function Name: static uint32_t FindEventInterval(schedule_t *sched)
+********************************************************************************
+* Summary:
+*  Finds the longest advertising interval that still broadcasts every frame 
+*  within its interval, and sets the periods of the frames for it
+*
+* Parameters:
+*  schedule_t *sched : schedule with the frames set
+*
+* Return:
+*  uint32_t : advertising interval in milliseconds, at least 
+*             BEACON_SCHED_MIN_INTERVAL_MS
+*
+* Theory:
+*  Each advertising event carries one frame, so the frames together need at
+*  least as many events as the sum of their rates. That gives the longest 
+*  interval to start from, which is shortened until the periods of the frames
+*  fit, see SetPeriods(). If they do not fit even at the shortest interval, 
+*  the frames that take most slots are broadcast less often than asked for 
+*  until they do.
+*
+*******************************************************************************/
+static uint32_t FindEventInterval(schedule_t *sched)
+{
+    uint64_t eventsPerMs = 0u;
+    uint32_t intervalMs;
+    uint32_t index;
+    uint32_t shortest;
+    
+    for(index = 0u; index < sched->frameCount; index++)
+    {
+        if(sched->intervalMs[index] != 0u)
+        {
+            /* Rate of the frame in events per ms, rounded up */
+            eventsPerMs += (RATE_ONE + sched->intervalMs[index] - 1u) /
+                           sched->intervalMs[index];
+        }
+    }
+    
+    intervalMs = (uint32_t)(RATE_ONE / eventsPerMs);
+    intervalMs = (intervalMs > MAX_INTERVAL_MS) ? MAX_INTERVAL_MS : intervalMs;
+    intervalMs = (intervalMs < BEACON_SCHED_MIN_INTERVAL_MS) ? 
+                 BEACON_SCHED_MIN_INTERVAL_MS : intervalMs;
+    
+    while(!SetPeriods(sched, intervalMs + BEACON_SCHED_ADV_DELAY_MAX_MS))
+    {
+        if(intervalMs > BEACON_SCHED_MIN_INTERVAL_MS)
+        {
+            intervalMs--;
+        }
+        else
+        {
+            /* Halve the share of the frame with the shortest period */
+            shortest = sched->frameCount;
+            for(index = 0u; index < sched->frameCount; index++)
+            {
+                if((sched->intervalMs[index] != 0u) &&
+                   ((shortest == sched->frameCount) || 
+                    (sched->intervalMs[index] < 
+                     sched->intervalMs[shortest])))
+                {
+                    shortest = index;
+                }
+            }
+            sched->intervalMs[shortest] *= 2u;
+        }
+    }
+    
+    return intervalMs;
+}
+
+/*******************************************************************************
+* Function Name: static bool SetPeriods(schedule_t *sched, uint32_t slotMs)
+********************************************************************************
+* Summary:
+*  Sets the period of each frame in slots, and checks if the slots needed by
+*  all frames add up to no more than all slots
+*
+* Parameters:
+*  schedule_t *sched : schedule with the frames set
+*  uint32_t slotMs   : length of a slot in milliseconds
+*
+* Return:
+*  bool : true if the frames fit
+*
+* Theory:
+*  The frame is not changed in step with the advertising events, so a frame
+*  may be on air only at the start of one of its slots and only at the end of
+*  the next one. A frame with an interval of N slots therefore needs one slot 
+*  out of every N - 1. A frame that has all slots to itself is on air in 
+*  every advertising event, and only needs slots that are no longer than its
+*  interval. The periods are rounded down to powers of two, which lets 
+*  SetOffsets() give every frame its own slots whenever their shares add up 
+*  to no more than one.
+*
+*******************************************************************************/
+static bool SetPeriods(schedule_t *sched, uint32_t slotMs)
+{
+    uint32_t share = 0u;
+    uint32_t slots;
+    uint32_t period;
+    uint32_t index;
+    
+    for(index = 0u; index < sched->frameCount; index++)
+    {
+        sched->periodSlots[index] = 0u;
+        
+        if(sched->intervalMs[index] != 0u)
+        {
+            slots = sched->intervalMs[index] / slotMs;
+            if(sched->enabledCount > 1u)
+            {
+                slots = (slots > 0u) ? (slots - 1u) : 0u;
+            }
+            if(slots == 0u)
+            {
+                return false;
+            }
+            
+            for(period = 1u; (period * 2u) <= slots; period *= 2u)
+            {
+            }
+            
+            sched->periodSlots[index] = period;
+            share += SHARE_ONE / period;
+        }
+    }
+    
+    return share <= SHARE_ONE;
+}
+
+/*******************************************************************************
+* Function Name: static void SetOffsets(schedule_t *sched)
+********************************************************************************
+* Summary:
+*  Gives every frame its own slots
+*
+* Parameters:
+*  schedule_t *sched : schedule with the periods set
+*
+* Return:
+*  None
+*
+* Theory:
+*  The frames are placed from the shortest period to the longest. A frame gets
+*  the first offset that is not taken by a frame placed before it. As all 
+*  periods are powers of two, the slots taken so far repeat with the period 
+*  of the frame being placed, so a free offset exists as long as the shares 
+*  add up to no more than one.
+*
+*******************************************************************************/
+static void SetOffsets(schedule_t *sched)
+{
+    bool     placed[BEACON_SCHED_MAX_FRAMES] = {false};
+    uint32_t next;
+    uint32_t offset;
+    uint32_t other;
+    uint32_t index;
+    bool     taken;
+    
+    for(;;)
+    {
+        /* Pick the frame with the shortest period not placed yet */
+        next = sched->frameCount;
+        for(index = 0u; index < sched->frameCount; index++)
+        {
+            if((sched->periodSlots[index] != 0u) && !placed[index] &&
+               ((next == sched->frameCount) || 
+                (sched->periodSlots[index] < sched->periodSlots[next])))
+            {
+                next = index;
+            }
+        }
+        
+        if(next == sched->frameCount)
+        {
+            break;
+        }
+        
+        for(offset = 0u; offset < sched->periodSlots[next]; offset++)
+        {
+            taken = false;
+            for(other = 0u; other < sched->frameCount; other++)
+            {
+                if(placed[other] && ((offset & (sched->periodSlots[other] - 1u))
+                                     == sched->offsetSlot[other]))
+                {
+                    taken = true;
+                }
+            }
+            
+            if(!taken)
+            {
+                break;
+            }
+        }
+        
+        sched->offsetSlot[next] = offset;
+        placed[next] = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: static uint32_t PickFrame(schedule_t *sched)
+********************************************************************************
+* Summary:
+*  Picks the frame for the next slot and moves the schedule on by one slot
+*
+* Parameters:
+*  schedule_t *sched : schedule to run
+*
+* Return:
+*  uint32_t : index of the frame
+*
+*******************************************************************************/
+static uint32_t PickFrame(schedule_t *sched)
+{
+    uint32_t index;
+    
+    for(index = 0u; index < sched->frameCount; index++)
+    {
+        if((sched->periodSlots[index] != 0u) &&
+           ((sched->slot & (sched->periodSlots[index] - 1u)) == 
+            sched->offsetSlot[index]))
+        {
+            sched->lastFrame = index;
+            break;
+        }
+    }
+    
+    sched->slot++;
+    
+    return sched->lastFrame;
+}
+
+/* [] END OF FILE */
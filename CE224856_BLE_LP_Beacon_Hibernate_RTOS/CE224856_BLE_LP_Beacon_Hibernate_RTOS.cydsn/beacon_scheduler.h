@@ -0,0 +1,86 @@
+/******************************************************************************
+* File Name: beacon_scheduler.h
+*
+* Version: 1.00
+*
+* Description: This file is the public interface of beacon_scheduler.c source
+*              file
+*
+* Related Document: CE224856_BLE_Low_Power_Beacon_with_Hibernate_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* This file contains the declarations of the scheduler that shares the
+* advertising events between the beacon frames
+*******************************************************************************/
+
+/* Include guard */
+#ifndef BEACON_SCHEDULER_H
+#define BEACON_SCHEDULER_H
+
+/* Header file includes */
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Maximum number of frames in a schedule */
+#define BEACON_SCHED_MAX_FRAMES         (8u)
+
+/* Shortest advertising interval allowed for non-connectable advertising */
+#define BEACON_SCHED_MIN_INTERVAL_MS    (100u)
+
+/* The link layer adds a random delay of up to 10 ms to every advertising 
+   event, which the scheduler takes off the advertising interval */
+#define BEACON_SCHED_ADV_DELAY_MAX_MS   (10u)
+
+/* Settings of a frame in the schedule */
+typedef struct
+{
+    /* Longest time allowed between two broadcasts of the frame. A frame with
+       an interval of 0 is never broadcast */
+    uint32_t intervalMs;
+}   beacon_sched_frame_t;
+
+/* Sets up a schedule for the frames, returns false if the frames are invalid */
+bool BeaconSched_Init(const beacon_sched_frame_t *frames, uint32_t frameCount);
+
+/* Returns the interval of the advertising events of the schedule */
+uint32_t BeaconSched_GetEventInterval(void);
+
+/* Returns the frame to broadcast in the next advertising event */
+uint32_t BeaconSched_NextFrame(void);
+
+#endif /* BEACON_SCHEDULER_H */
+
+/* [] END OF FILE */
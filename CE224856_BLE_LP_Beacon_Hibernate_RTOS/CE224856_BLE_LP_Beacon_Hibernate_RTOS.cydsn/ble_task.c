@@ -51,6 +51,8 @@
 #include "ble_task.h"
 #include "status_led_task.h"
 #include "eddystone_config.h"
+#include "beacon_config.h"
+#include "beacon_scheduler.h"
 #include "task.h"
 #include "queue.h"
 #include "timers.h"    
@@ -62,39 +64,45 @@
                                 [CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX]\
                                 .advData
                                 
-#define AdvertisementSize       cy_ble_discoveryData\
+#define AdvertisementFrame      cy_ble_discoveryModeInfo\
                                 [CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX]\
-                                .advDataLen
+                                .advData
                                 
 #define AdvertisementTimeOut    cy_ble_discoveryModeInfo\
                                 [CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX]\
                                 .advTo
                                 
-/* Number of packets broadcasted during a UID/URL + TLM advertisement.
-   This is equal to the total time out in seconds / 100 milliseconds or
-   total time out *10 */                      
-#define PACKETS_PER_BROADCAST   ((APP_UID_URL_TIMEOUT \
-                                 +APP_TLM_TIMEOUT)*10)
-
-/* Variables that store constant URL, UID and TLM packet data. To change 
-   the Eddystone packet settings, see the header file eddystone_config.h */
+#define AdvertisementParameters cy_ble_discoveryModeInfo\
+                                [CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX]\
+                                .advParam
+                                
+/* Advertising interval unit of the BLE stack is 0.625 ms */
+#define ADV_INTERVAL_UNITS(ms)  (uint16_t)(((ms) * 8u) / 5u)
+
+/* Variables that store constant URL, UID, TLM, EID, iBeacon and AltBeacon 
+   packet data. To change the packet settings, see the header files 
+   eddystone_config.h and beacon_config.h */
 uint8_t const solicitationData[] = SERVICE_SOLICITATION;
 uint8_t const serviceDataUID[]   = UID_SERVICE_DATA;
 uint8_t const nameSpaceID[]      = NAME_SPACE_ID;
 uint8_t const instanceID[]       = INSTANCE_ID;
 uint8_t const packetDataURL[]    = URL_PACKET_DATA;
 uint8_t const serviceDataTLM[]   = TLM_SERVICE_DATA;
+uint8_t const serviceDataEID[]   = EID_SERVICE_DATA;
+uint8_t const ephemeralID[]      = EPHEMERAL_ID;
+uint8_t const iBeaconData[]      = IBEACON_DATA;
+uint8_t const altBeaconData[]    = ALTBEACON_DATA;
                                 
-/* Data type that stores advertisement packet count since power-up 
+/* Data type that stores the count of rotation slots since power-up 
    or reset  */
 typedef union
 {
-    /* 32-bit packet count for mathematical operations */
+    /* 32-bit slot count for mathematical operations */
     uint32_t    count;
-    /* Same packet count segmented into four 8-bit fields for copying 
+    /* Same slot count segmented into four 8-bit fields for copying 
        to the Eddystone frame */
     uint8_t     countByte[4u]; 
-}   packet_count_t;
+}   slot_count_t;
 
 /* Data type that stores the time elapsed since power-up or reset */
 typedef union
@@ -117,21 +125,85 @@ typedef enum
     EDDYSTONE_TLM
 }   eddystone_role_t;
 
-/* Variable that stores the current role  (UID/URL or TLM). To change 
-   the Eddystone packet settings, see the header file eddystone_config.h */
-eddystone_role_t beaconCurrentRole = EDDYSTONE_IMPLEMENTATION;
-
-/* variable that stores advertisement packet count since power-up or reset */
-packet_count_t   packetCount;
+/* Frames in the beacon rotation, in the order of beaconFrames[] */
+typedef enum
+{
+    BEACON_FRAME_UID_URL,
+    BEACON_FRAME_TLM,
+    BEACON_FRAME_EID,
+    BEACON_FRAME_IBEACON,
+    BEACON_FRAME_ALTBEACON,
+    BEACON_FRAME_COUNT
+}   beacon_frame_id_t;
+
+/* Data type that stores the settings of a frame in the beacon rotation */
+typedef struct
+{
+    /* Advertisement data of the frame */
+    cy_stc_ble_gapp_disc_data_t *data;
+    /* Longest time between two broadcasts of the frame, 0 if it is not 
+       broadcast */
+    uint32_t                     intervalMs;
+    /* TX power of the frame */
+    cy_en_ble_bless_pwr_lvl_t    txPower;
+}   beacon_frame_t;
+
+/* Variable that stores the number of slots of the beacon rotation since 
+   power-up or reset. The TLM frame reports it in its advertising PDU count 
+   field; each slot has one advertising event and now and then two, so it 
+   counts events, not the PDUs sent on every advertising channel */
+slot_count_t     slotCount;
 
 /* Variable  that stores the time elapsed in seconds since power-up or reset */
 second_count_t seconds;
 
+/* Frames that are broadcast. They are built once when the stack starts, and
+   the stack is pointed at the one to broadcast, so switching frames copies 
+   nothing. Only the changing fields of the TLM frame are updated before it 
+   is broadcast */
+static cy_stc_ble_gapp_disc_data_t uidFrame;
+static cy_stc_ble_gapp_disc_data_t urlFrame;
+static cy_stc_ble_gapp_disc_data_t tlmFrame;
+static cy_stc_ble_gapp_disc_data_t eidFrame;
+static cy_stc_ble_gapp_disc_data_t iBeaconFrame;
+static cy_stc_ble_gapp_disc_data_t altBeaconFrame;
+
+/* Beacon rotation. To change the intervals and TX power of the frames, see 
+   the header files eddystone_config.h and beacon_config.h */
+static beacon_frame_t const beaconFrames[BEACON_FRAME_COUNT] =
+{
+    [BEACON_FRAME_UID_URL]   = {(EDDYSTONE_IMPLEMENTATION == EDDYSTONE_UID) ?
+                                &uidFrame : &urlFrame, 
+                                EDDYSTONE_UID_URL_INTERVAL_MS, 
+                                EDDYSTONE_UID_URL_TX_POWER},
+    [BEACON_FRAME_TLM]       = {&tlmFrame, EDDYSTONE_TLM_INTERVAL_MS, 
+                                EDDYSTONE_TLM_TX_POWER},
+    [BEACON_FRAME_EID]       = {&eidFrame, EDDYSTONE_EID_INTERVAL_MS, 
+                                EDDYSTONE_EID_TX_POWER},
+    [BEACON_FRAME_IBEACON]   = {&iBeaconFrame, IBEACON_INTERVAL_MS, 
+                                IBEACON_TX_POWER},
+    [BEACON_FRAME_ALTBEACON] = {&altBeaconFrame, ALTBEACON_INTERVAL_MS, 
+                                ALTBEACON_TX_POWER}
+};
+
+/* Frame that is on air, BEACON_FRAME_COUNT before the first one */
+static beacon_frame_id_t beaconCurrentFrame = BEACON_FRAME_COUNT;
+
+/* Set by the beacon timer when the next frame of the rotation is due */
+static volatile bool beaconSlotPending = false;
+
 /*  These static functions are not available outside this file. 
     See the respective function definitions for more details */
 void static BleControllerInterruptEventHandler(void);
 void static StackEventHandler(uint32_t eventType, void *eventParam);
-void static ConfigureAdvPacket(void);
+void static ConfigureAdvPacket(beacon_frame_id_t frame);
+void static StartBeacon(void);
+void static BeaconTimerCallback(TimerHandle_t xTimer);
+void static BuildFrames(void);
+void static BuildFrameHeader(cy_stc_ble_gapp_disc_data_t *frame);
+void static UpdateTlmFrame(void);
+void static RestoreBeaconState(void);
+void static SaveBeaconState(void);
 void static SecondsTimerStart(void);
 void static HibernateTimerCallback(TimerHandle_t xTimer);
 void static HibernateStartTimer(void);
@@ -144,6 +216,14 @@ TimerHandle_t xTimer_Seconds;
 
 /*Handle for timer*/
 TimerHandle_t xTimer_hibernate;
+
+/* Handle of the timer that moves the beacon rotation on */
+TimerHandle_t xTimer_Beacon;
+
+/* Control blocks of the timers */
+static StaticTimer_t secondsTimerBuffer;
+static StaticTimer_t hibernateTimerBuffer;
+static StaticTimer_t beaconTimerBuffer;
                     
 /*******************************************************************************
 * Function Name: void Task_Ble(void *pvParameters)
@@ -200,6 +280,15 @@ void Task_Ble(void *pvParameters)
         /* Semaphore has been received */
         if(rtosApiResult == pdTRUE)
         {
+            /* Put the next frame of the rotation on air */
+            if(beaconSlotPending)
+            {
+                beaconSlotPending = false;
+                
+                slotCount.count++;
+                ConfigureAdvPacket((beacon_frame_id_t)BeaconSched_NextFrame());
+            }
+            
             /* Process event callback to handle BLE events. The events generated 
             and used for this application are inside the 'StackEventHandler' 
             routine */
@@ -250,27 +339,14 @@ void static StackEventHandler(uint32_t eventType, void *eventParam)
             }
             else
             {
-                /* Start with the selected implementation */
-                beaconCurrentRole = EDDYSTONE_IMPLEMENTATION;
+                /* Continue the TLM counts from before hibernate */
+                RestoreBeaconState();
             }
             
-            /* Reset advertisement packet count and start tracking time */
-            packetCount.count = 0x00000000u;
-            seconds.count     = 0x00000000u; 
-            
+            /* Build the frames, start tracking time and start the rotation */
+            BuildFrames();
             SecondsTimerStart();
-            
-            /* Configure Eddystone packets for the selected implementation */
-            ConfigureAdvPacket();
-
-            /* Start advertisement */
-            bleApiResult = Cy_BLE_GAPP_StartAdvertisement(CY_BLE_ADVERTISING_CUSTOM,
-                            CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX);
-
-            if(bleApiResult == CY_BLE_SUCCESS )
-            {
-                Cy_BLE_ProcessEvents();
-            }
+            StartBeacon();
             break;
             
         /* This event is received when there is a timeout */
@@ -286,25 +362,10 @@ void static StackEventHandler(uint32_t eventType, void *eventParam)
         /* This event indicates peripheral device has started/stopped
            advertising */
         case CY_BLE_EVT_GAPP_ADVERTISEMENT_START_STOP:
-                            /* Advertisement timeout */
+            /* The rotation advertises without a timeout; restart 
+               advertisement if it has stopped anyway */
             if (Cy_BLE_GetAdvertisementState() != CY_BLE_ADV_STATE_ADVERTISING)
             {
-                /* On advertisement timeout, switch between URI/URL and
-                *  TLM packets. */
-                if( (beaconCurrentRole == EDDYSTONE_UID) ||
-                    (beaconCurrentRole == EDDYSTONE_URL) )
-                {
-                    beaconCurrentRole = EDDYSTONE_TLM;
-                }
-                else if(beaconCurrentRole == EDDYSTONE_TLM)
-                {
-                    beaconCurrentRole = EDDYSTONE_IMPLEMENTATION;
-                }
-                
-                /* Configure Eddystone packets for the selected implementation */
-                ConfigureAdvPacket();
-                
-                /* Restart advertisement */
                 bleApiResult = Cy_BLE_GAPP_StartAdvertisement(CY_BLE_ADVERTISING_CUSTOM,
                                 CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX);
                 
@@ -313,18 +374,6 @@ void static StackEventHandler(uint32_t eventType, void *eventParam)
                     Cy_BLE_ProcessEvents();
                 }
             }
-            /* Advertisement started */
-            else
-            {
-                /* If the beacon role switched to UID/URL, a complete URL/UID + TLM 
-                   frames have been broadcasted */
-                if( (beaconCurrentRole == EDDYSTONE_UID) ||
-                    (beaconCurrentRole == EDDYSTONE_URL) )
-                {
-                    /* Increment advertisement packet count */
-                    packetCount.count+=PACKETS_PER_BROADCAST;
-                }    
-            }
             break;                
         
         /*~~~~~~~~~~~~~~~~~~~~~~~~~~ OTHER EVENTS ~~~~~~~~~~~~~~~~~~~~~~~~~~~~*/ 
@@ -337,134 +386,368 @@ void static StackEventHandler(uint32_t eventType, void *eventParam)
 } 
 
 /*******************************************************************************
-* Function Name: void ConfigureAdvPacket(void)
+* Function Name: void static ConfigureAdvPacket(beacon_frame_id_t frame)
 ********************************************************************************
 * Summary:
-*  Function that configures Eddystone packets at run-time
+*  Function that puts a frame of the beacon rotation on air at run-time
 *
 * Parameters:
-*  None
+*  beacon_frame_id_t frame : frame to broadcast
 *
 * Return:
 *  None
 *
 *******************************************************************************/
-void ConfigureAdvPacket(void)
+void static ConfigureAdvPacket(beacon_frame_id_t frame)
 {
-   /* Note: To change the Eddystone packet settings, see the header file 
-      eddystone_config.h */
+   /* Note: To change the packet settings, see the header files 
+      eddystone_config.h and beacon_config.h */
     status_led_data_t   statusLedData;
     
     /* Variable used to store the return values of RTOS APIs */
     BaseType_t rtosApiResult;
-
-    /* Load the service Solicitation data onto the Eddystone advertisement 
-       packet */
-    memcpy (&AdvertisementData[SOLICITATION_INDEX],
-            &solicitationData, 
-            (sizeof solicitationData));
     
-    /* Check if the current Eddystone role is either UID or URL */
-    if( (beaconCurrentRole == EDDYSTONE_UID) ||
-        (beaconCurrentRole == EDDYSTONE_URL))
+    /* Variable used to set the TX power of the advertisement channels */
+    cy_stc_ble_tx_pwr_lvl_info_t txPowerInfo;
+    
+    beacon_frame_id_t previousFrame = beaconCurrentFrame;
+    
+    /* A frame that stays on air needs no update, unless it is the TLM frame,
+       whose telemetry changes */
+    if(frame == BEACON_FRAME_TLM)
     {
-        /* Turn the Red LED on and the Orange LED off */
-            statusLedData.orangeLed = LED_TURN_OFF;
-            statusLedData.redLed    = LED_TURN_ON;
-            rtosApiResult = xQueueSend(statusLedDataQ, &statusLedData,0u);
-            
-            /* Check if the operation has been successful */
-            if(rtosApiResult != pdTRUE)
-            {
-            }
+        UpdateTlmFrame();
+    }
+    else if(frame == previousFrame)
+    {
+        return;
+    }
+    
+    /* Set the TX power of the frame, if it differs from the previous one */
+    if((previousFrame == BEACON_FRAME_COUNT) ||
+       (beaconFrames[frame].txPower != beaconFrames[previousFrame].txPower))
+    {
+        txPowerInfo.blePwrLevel = beaconFrames[frame].txPower;
+        txPowerInfo.pwrConfigParam.bleSsnId = CY_BLE_LL_ADV_CH_TYPE;
+        (void)Cy_BLE_SetTxPowerLevel(&txPowerInfo);
+    }
+    
+    /* Point the stack at the frame, and hand it to the controller if 
+       advertisement is running already */
+    AdvertisementFrame = beaconFrames[frame].data;
+    if(previousFrame != BEACON_FRAME_COUNT)
+    {
+        (void)Cy_BLE_GAPP_UpdateAdvScanData(&cy_ble_discoveryModeInfo
+                                   [CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX]);
+    }
+    beaconCurrentFrame = frame;
+    
+    /* The Orange LED is on while the TLM frame is broadcast, and the Red LED
+       while any other frame is */
+    if((previousFrame == BEACON_FRAME_COUNT) ||
+       ((previousFrame == BEACON_FRAME_TLM) != (frame == BEACON_FRAME_TLM)))
+    {
+        statusLedData.orangeLed = (frame == BEACON_FRAME_TLM) ? 
+                                  LED_TURN_ON : LED_TURN_OFF;
+        statusLedData.redLed    = (frame == BEACON_FRAME_TLM) ? 
+                                  LED_TURN_OFF : LED_TURN_ON;
+        rtosApiResult = xQueueSend(statusLedDataQ, &statusLedData,0u);
         
-        /* Configure the advertisement timeout */
-        AdvertisementTimeOut = APP_UID_URL_TIMEOUT;
-
-        /* If the current role is UID, load the UID specific data onto the
-           Eddystone advertisement packet */
-        if(beaconCurrentRole == EDDYSTONE_UID)
+        /* Check if the operation has been successful */
+        if(rtosApiResult != pdTRUE)
         {
-            /* Load Service Data */
-            memcpy (&AdvertisementData[UID_SERVICE_INDEX], 
-                    &serviceDataUID, 
-                    (sizeof serviceDataUID));
-           
-            /* Load Name-space ID */
-            memcpy (&AdvertisementData[NAME_SPACE_INDEX],
-                    &nameSpaceID,
-                    (sizeof nameSpaceID));
-
-            /* Load Instance ID  */
-             memcpy (&AdvertisementData[INSTANCE_INDEX],
-                     &instanceID, 
-                     (sizeof instanceID));
-            
-            /* Load the reserved fields with default values */
-            AdvertisementData[RESERVED_INDEX_0] = RESERVED_FIELD_VALUE;              
-            AdvertisementData[RESERVED_INDEX_1] = RESERVED_FIELD_VALUE;              
-            
-            /* Configure advertisement packet length */
-            AdvertisementSize = UID_PACKET_SIZE;
-        }
-        /* If the current role is URL, load the URL specific data onto the
-           Eddystone advertisement packet */
-        else if(beaconCurrentRole == EDDYSTONE_URL)
-        {    
-            /* Load URL data */
-            memcpy (&AdvertisementData[URL_INDEX],
-                     &packetDataURL, 
-                     (sizeof packetDataURL));
-            
-            /* Configure advertisement packet length */
-            AdvertisementSize = URL_PACKET_SIZE;
         }
     }
-    /* If the current role is TLM, load the TLM specific data onto the
-       Eddystone advertisement packet */
-    else if(beaconCurrentRole == EDDYSTONE_TLM)
+}
+
+/*******************************************************************************
+* Function Name: void static StartBeacon(void)
+********************************************************************************
+* Summary:
+*  Function that sets up the beacon rotation and starts advertisement
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The beacon scheduler picks the advertising interval that the frames need
+*  together, and a frame for each slot of the rotation. Advertisement runs 
+*  without a timeout at that interval, and the beacon timer puts the next 
+*  frame on air at the end of each slot.
+*
+*******************************************************************************/
+void static StartBeacon(void)
+{
+    /* Variable used to store the return values of BLE APIs */
+    cy_en_ble_api_result_t bleApiResult;
+    
+    beacon_sched_frame_t schedFrames[BEACON_FRAME_COUNT];
+    uint32_t intervalMs;
+    uint32_t frame;
+    
+    for(frame = 0u; frame < BEACON_FRAME_COUNT; frame++)
+    {
+        schedFrames[frame].intervalMs = beaconFrames[frame].intervalMs;
+    }
+    
+    /* Halt the CPU if no frame is enabled */
+    if(!BeaconSched_Init(schedFrames, BEACON_FRAME_COUNT))
     {
-        /* Turn the Orange LED on and the Red LED off */
-        statusLedData.orangeLed = LED_TURN_ON;
-        statusLedData.redLed    = LED_TURN_OFF;
-        rtosApiResult = xQueueSend(statusLedDataQ, &statusLedData,0u);
-        
-        
-        /* Configure the advertisement timeout */
-        AdvertisementTimeOut = APP_TLM_TIMEOUT;
+        CY_ASSERT(0u);
+    }
+    
+    /* Advertise at the interval of the rotation, without a timeout */
+    intervalMs = BeaconSched_GetEventInterval();
+    AdvertisementParameters->advIntvMin = ADV_INTERVAL_UNITS(intervalMs);
+    AdvertisementParameters->advIntvMax = ADV_INTERVAL_UNITS(intervalMs);
+    AdvertisementTimeOut = 0u;
+    
+    ConfigureAdvPacket((beacon_frame_id_t)BeaconSched_NextFrame());
+    
+    bleApiResult = Cy_BLE_GAPP_StartAdvertisement(CY_BLE_ADVERTISING_CUSTOM,
+                    CY_BLE_BROADCASTER_CONFIGURATION_0_INDEX);
 
-        /* Load Service Data */
-        memcpy (&AdvertisementData[TLM_SERVICE_INDEX],
-                &serviceDataTLM,    
-                (sizeof serviceDataTLM));
-        
-        /* Load battery voltage in mV (1 mV per bit) */
-        AdvertisementData[BATTERY_MSB_INDEX] = BATTERY_VOLTAGE_MSB;     
-        AdvertisementData[BATTERY_LSB_INDEX] = BATTERY_VOLTAGE_LSB;     
-
-        /* Load beacon temperature in Celsius (8.8 fixed point notation) */
-        AdvertisementData[TEMPERATURE_MSB_INDEX] = BEACON_TEMPERATURE_MSB;     
-        AdvertisementData[TEMPERATURE_LSB_INDEX] = BEACON_TEMPERATURE_LSB;     
-
-        /* Load advertising packet count since power-up or reset */
-        AdvertisementData[PACKET_COUNT_INDEX_0] = packetCount.countByte[TLM_4B_ENDIAN_SWAP_0];     
-        AdvertisementData[PACKET_COUNT_INDEX_1] = packetCount.countByte[TLM_4B_ENDIAN_SWAP_1];
-        AdvertisementData[PACKET_COUNT_INDEX_2] = packetCount.countByte[TLM_4B_ENDIAN_SWAP_2];                                                      
-        AdvertisementData[PACKET_COUNT_INDEX_3] = packetCount.countByte[TLM_4B_ENDIAN_SWAP_3]; 
-                                                      
-        /* Load time elapsed since power-on or reboot (100 ms per bit) */
-        AdvertisementData[SECONDS_INDEX_0] = seconds.countByte
-                                             [TLM_4B_ENDIAN_SWAP_0];     
-        AdvertisementData[SECONDS_INDEX_1] = seconds.countByte
-                                             [TLM_4B_ENDIAN_SWAP_1];     
-        AdvertisementData[SECONDS_INDEX_2] = seconds.countByte
-                                             [TLM_4B_ENDIAN_SWAP_2];     
-        AdvertisementData[SECONDS_INDEX_3] = seconds.countByte
-                                             [TLM_4B_ENDIAN_SWAP_3];     
-                
-        /* Configure advertisement packet length */
-        AdvertisementSize = TLM_PACKET_SIZE;
-    } 
+    if(bleApiResult == CY_BLE_SUCCESS )
+    {
+        Cy_BLE_ProcessEvents();
+    }
+    
+    /* Create an RTOS timer that ends each slot of the rotation */
+    xTimer_Beacon = xTimerCreateStatic("Beacon Timer", 
+                        pdMS_TO_TICKS(intervalMs + BEACON_SCHED_ADV_DELAY_MAX_MS),
+                        pdTRUE, NULL, BeaconTimerCallback, &beaconTimerBuffer);
+    
+    /* Make sure that timer handle is valid */
+    if (xTimer_Beacon != NULL)
+    {
+        /* Start the timer */
+        xTimerStart(xTimer_Beacon, 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: void static BeaconTimerCallback(TimerHandle_t xTimer)
+********************************************************************************
+* Summary:
+*  This function is called at the end of each slot of the beacon rotation, 
+*  and lets Task_Ble put the next frame on air
+*
+* Parameters:
+*  TimerHandle_t xTimer :  Current timer value (unused)
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void static BeaconTimerCallback(TimerHandle_t xTimer)
+{
+    /* Remove warning for unused parameter */
+    (void)xTimer;
+    
+    beaconSlotPending = true;
+    xSemaphoreGive(bleSemaphore);
+}
+
+/*******************************************************************************
+* Function Name: void static BuildFrames(void)
+********************************************************************************
+* Summary:
+*  Function that builds the Eddystone frames once at start-up
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void static BuildFrames(void)
+{
+    /* Note: To change the packet settings, see the header files 
+       eddystone_config.h and beacon_config.h */
+    
+    /* UID frame: service data, name-space ID, instance ID and the reserved
+       fields */
+    BuildFrameHeader(&uidFrame);
+    memcpy (&uidFrame.advData[UID_SERVICE_INDEX], 
+            &serviceDataUID, 
+            (sizeof serviceDataUID));
+    memcpy (&uidFrame.advData[NAME_SPACE_INDEX],
+            &nameSpaceID,
+            (sizeof nameSpaceID));
+    memcpy (&uidFrame.advData[INSTANCE_INDEX],
+            &instanceID, 
+            (sizeof instanceID));
+    uidFrame.advData[RESERVED_INDEX_0] = RESERVED_FIELD_VALUE;              
+    uidFrame.advData[RESERVED_INDEX_1] = RESERVED_FIELD_VALUE;              
+    uidFrame.advDataLen = UID_PACKET_SIZE;
+    
+    /* URL frame */
+    BuildFrameHeader(&urlFrame);
+    memcpy (&urlFrame.advData[URL_INDEX],
+            &packetDataURL, 
+            (sizeof packetDataURL));
+    urlFrame.advDataLen = URL_PACKET_SIZE;
+    
+    /* TLM frame: service data here, the telemetry in UpdateTlmFrame() */
+    BuildFrameHeader(&tlmFrame);
+    memcpy (&tlmFrame.advData[TLM_SERVICE_INDEX],
+            &serviceDataTLM,    
+            (sizeof serviceDataTLM));
+    tlmFrame.advDataLen = TLM_PACKET_SIZE;
+    
+    /* EID frame: service data and the ephemeral ID */
+    BuildFrameHeader(&eidFrame);
+    memcpy (&eidFrame.advData[EID_SERVICE_INDEX],
+            &serviceDataEID,
+            (sizeof serviceDataEID));
+    memcpy (&eidFrame.advData[EPHEMERAL_ID_INDEX],
+            &ephemeralID,
+            (sizeof ephemeralID));
+    eidFrame.advDataLen = EID_PACKET_SIZE;
+    
+    /* iBeacon and AltBeacon frames: flags and the manufacturer specific data,
+       without the Eddystone service solicitation */
+    memcpy (iBeaconFrame.advData, AdvertisementData, IBEACON_INDEX);
+    memcpy (&iBeaconFrame.advData[IBEACON_INDEX],
+            &iBeaconData,
+            (sizeof iBeaconData));
+    iBeaconFrame.advDataLen = IBEACON_PACKET_SIZE;
+    
+    memcpy (altBeaconFrame.advData, AdvertisementData, ALTBEACON_INDEX);
+    memcpy (&altBeaconFrame.advData[ALTBEACON_INDEX],
+            &altBeaconData,
+            (sizeof altBeaconData));
+    altBeaconFrame.advDataLen = ALTBEACON_PACKET_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: void static BuildFrameHeader(cy_stc_ble_gapp_disc_data_t *frame)
+********************************************************************************
+* Summary:
+*  Function that loads the part that is common to all Eddystone frames
+*
+* Parameters:
+*  cy_stc_ble_gapp_disc_data_t *frame : frame to load 
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void static BuildFrameHeader(cy_stc_ble_gapp_disc_data_t *frame)
+{
+    /* Keep the flags configured in the BLE component */
+    memcpy (frame->advData, AdvertisementData, SOLICITATION_INDEX);
+    
+    /* Load the service Solicitation data */
+    memcpy (&frame->advData[SOLICITATION_INDEX],
+            &solicitationData, 
+            (sizeof solicitationData));
+}
+
+/*******************************************************************************
+* Function Name: void static UpdateTlmFrame(void)
+********************************************************************************
+* Summary:
+*  Function that writes the current telemetry into the TLM frame
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void static UpdateTlmFrame(void)
+{
+    uint8_t *tlmData = tlmFrame.advData;
+    
+    /* Load battery voltage in mV (1 mV per bit) */
+    tlmData[BATTERY_MSB_INDEX] = BATTERY_VOLTAGE_MSB;     
+    tlmData[BATTERY_LSB_INDEX] = BATTERY_VOLTAGE_LSB;     
+
+    /* Load beacon temperature in Celsius (8.8 fixed point notation) */
+    tlmData[TEMPERATURE_MSB_INDEX] = BEACON_TEMPERATURE_MSB;     
+    tlmData[TEMPERATURE_LSB_INDEX] = BEACON_TEMPERATURE_LSB;     
+
+    /* Load the rotation slot count since power-up or reset */
+    tlmData[PACKET_COUNT_INDEX_0] = slotCount.countByte[TLM_4B_ENDIAN_SWAP_0];     
+    tlmData[PACKET_COUNT_INDEX_1] = slotCount.countByte[TLM_4B_ENDIAN_SWAP_1];
+    tlmData[PACKET_COUNT_INDEX_2] = slotCount.countByte[TLM_4B_ENDIAN_SWAP_2];                                                      
+    tlmData[PACKET_COUNT_INDEX_3] = slotCount.countByte[TLM_4B_ENDIAN_SWAP_3]; 
+                                                  
+    /* Load time elapsed since power-on or reboot (100 ms per bit) */
+    tlmData[SECONDS_INDEX_0] = seconds.countByte[TLM_4B_ENDIAN_SWAP_0];     
+    tlmData[SECONDS_INDEX_1] = seconds.countByte[TLM_4B_ENDIAN_SWAP_1];     
+    tlmData[SECONDS_INDEX_2] = seconds.countByte[TLM_4B_ENDIAN_SWAP_2];     
+    tlmData[SECONDS_INDEX_3] = seconds.countByte[TLM_4B_ENDIAN_SWAP_3];     
+}
+
+/*******************************************************************************
+* Function Name: void static RestoreBeaconState(void)
+********************************************************************************
+* Summary:
+*  Function that restores the TLM counters from the backup registers after a 
+*  wakeup from hibernate, or resets them otherwise
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+* Theory:
+*  The backup registers keep their value in hibernate. The check word, which 
+*  SaveBeaconState() writes last, tells if they hold a complete state. The 
+*  time spent in hibernate is read from the RTC and added to the uptime, so
+*  the TLM frame keeps counting from power-up across hibernate cycles.
+*
+*******************************************************************************/
+void static RestoreBeaconState(void)
+{
+    uint32_t savedCount   = BACKUP->BREG[BACKUP_REG_SLOT_COUNT];
+    uint32_t savedSeconds = BACKUP->BREG[BACKUP_REG_SECONDS];
+    uint32_t check        = BACKUP_CHECK_KEY ^ savedCount ^ savedSeconds;
+    
+    if(((Cy_SysLib_GetResetReason() & CY_SYSLIB_RESET_HIB_WAKEUP) != 0u) &&
+       (BACKUP->BREG[BACKUP_REG_CHECK] == check))
+    {
+        slotCount.count = savedCount;
+        seconds.count     = savedSeconds + (RTCtimer_GetElapsedSeconds() * 10u);
+    }
+    else
+    {
+        slotCount.count = 0x00000000u;
+        seconds.count     = 0x00000000u;
+    }
+    
+    /* The state is used once; any other reset starts from zero again */
+    BACKUP->BREG[BACKUP_REG_CHECK] = ~check;
+}
+
+/*******************************************************************************
+* Function Name: void static SaveBeaconState(void)
+********************************************************************************
+* Summary:
+*  Function that saves the TLM counters to the backup registers before 
+*  entering hibernate
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void static SaveBeaconState(void)
+{
+    BACKUP->BREG[BACKUP_REG_SLOT_COUNT] = slotCount.count;
+    BACKUP->BREG[BACKUP_REG_SECONDS]      = seconds.count;
+    BACKUP->BREG[BACKUP_REG_CHECK]        = BACKUP_CHECK_KEY ^ 
+        slotCount.count ^ seconds.count;
 }
 
 
@@ -530,8 +813,9 @@ void static SecondsTimerCallback(TimerHandle_t xTimer)
 void static SecondsTimerStart(void)
 {
     /* Create an RTOS timer with 100ms interval */
-    xTimer_Seconds =  xTimerCreate ("Seconds Timer", (pdMS_TO_TICKS(100u)), 
-                                    pdTRUE, NULL, SecondsTimerCallback);
+    xTimer_Seconds =  xTimerCreateStatic ("Seconds Timer", (pdMS_TO_TICKS(100u)), 
+                                    pdTRUE, NULL, SecondsTimerCallback,
+                                    &secondsTimerBuffer);
     
     /* Make sure that timer handle is valid */
     if (xTimer_Seconds != NULL)
@@ -564,6 +848,7 @@ void static HibernateTimerCallback(TimerHandle_t xTimer)
     /*Write your code here for pre hibenrate process
                     .   .   .   .   .   
     Write your code here for pre hibenrate process*/
+    SaveBeaconState();
     RTCtimer_Init();
     statusLedData.orangeLed = LED_TURN_OFF;
     statusLedData.redLed    = LED_TURN_OFF;
@@ -590,9 +875,10 @@ void static HibernateTimerCallback(TimerHandle_t xTimer)
 void static HibernateStartTimer(void)
 {     
     /* Create an RTOS timer */
-    xTimer_hibernate =  xTimerCreate ("Hibernate Timer",
+    xTimer_hibernate =  xTimerCreateStatic ("Hibernate Timer",
                                             ACTIVE_TIME_TICKS, pdFALSE, 
-                                            NULL, HibernateTimerCallback); 
+                                            NULL, HibernateTimerCallback,
+                                            &hibernateTimerBuffer); 
     
     /* Make sure that timer handle is valid */
     if (xTimer_hibernate != NULL)
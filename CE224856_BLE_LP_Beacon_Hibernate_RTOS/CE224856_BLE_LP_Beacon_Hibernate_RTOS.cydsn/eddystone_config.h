@@ -53,6 +53,7 @@
 * https://github.com/google/eddystone/tree/master/eddystone-url
 * https://github.com/google/eddystone/tree/master/eddystone-uid
 * https://github.com/google/eddystone/tree/master/eddystone-tlm
+* https://github.com/google/eddystone/tree/master/eddystone-eid
 *
 ********************************************************************************/
 
@@ -66,11 +67,19 @@
    Valid options are  EDDYSTONE_URL and EDDYSTONE_UID */
 #define EDDYSTONE_IMPLEMENTATION        EDDYSTONE_URL
 
-/* UID/URL frame timeout in seconds */
-#define APP_UID_URL_TIMEOUT             (0x0Au)
-    
-/* TLM frame timeout in seconds */
-#define APP_TLM_TIMEOUT                 (0x01u)
+/* Longest time between two broadcasts of each Eddystone frame in 
+   milliseconds, and the TX power it is broadcast with. An interval of 0 
+   leaves the frame out of the rotation. See beacon_config.h for the other
+   beacon frames */
+#define EDDYSTONE_UID_URL_INTERVAL_MS   (1000u)
+#define EDDYSTONE_UID_URL_TX_POWER      (CY_BLE_LL_PWR_LVL_0_DBM)
+#define EDDYSTONE_TLM_INTERVAL_MS       (10000u)
+#define EDDYSTONE_TLM_TX_POWER          (CY_BLE_LL_PWR_LVL_0_DBM)
+/* The EID frame is off: it carries the fixed EPHEMERAL_ID below, which a 
+   resolver cannot use. To broadcast it, set an interval here and provide the
+   current ephemeral ID, see EPHEMERAL_ID */
+#define EDDYSTONE_EID_INTERVAL_MS       (0u)
+#define EDDYSTONE_EID_TX_POWER          (CY_BLE_LL_PWR_LVL_0_DBM)
  
 /*~~~~~~~~~~~~~~~~~~~~~~ GENERIC PACKET SETTINGS ~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
     
@@ -213,5 +222,50 @@
 /* Total size of a TLM frame */     
 #define TLM_PACKET_SIZE                 (0x19u)  
 
+/* The TLM fields follow the 6 bytes of service data back to back, as in the 
+   Eddystone TLM layout, and the service data length byte covers them all */
+#if ((BATTERY_MSB_INDEX     != (TLM_SERVICE_INDEX + 6u))     || \
+     (TEMPERATURE_MSB_INDEX != (BATTERY_MSB_INDEX + 2u))     || \
+     (PACKET_COUNT_INDEX_0  != (TEMPERATURE_MSB_INDEX + 2u)) || \
+     (SECONDS_INDEX_0       != (PACKET_COUNT_INDEX_0 + 4u))  || \
+     (TLM_PACKET_SIZE       != (SECONDS_INDEX_0 + 4u))       || \
+     ((TLM_PACKET_SIZE - TLM_SERVICE_INDEX - 1u) != 0x11u))
+    #error "TLM field indexes do not match the Eddystone TLM frame layout"
+#endif
+
+/*~~~~~~~~~~~~~~~~~~~~~~ EID PACKET SETTINGS ~~~~~~~~~~~~~~~~~~~~~~~~~~~*/
+
+/* Service data for the EID frame */    
+#define EID_SERVICE_DATA                {0x0Du, /* Length */\
+                                         0x16u, /* Service Data */\
+                                         0xAAu, /* LSB - Eddystone Service */\
+                                         0xFEu, /* MSB - Eddystone Service */\
+                                         0x30u, /* Signifies Eddystone EID */\
+                                         0xF2u} /* Ranging data: -18dB*/
+
+/* Eddystone packet index of the EID service data */       
+#define EID_SERVICE_INDEX               (0x07u)
+
+/* Ephemeral ID. Per Eddystone specification, this is computed with AES-128 
+   from an identity key shared with a resolver service, and rotates every 
+   2^K seconds. This example only has a placeholder, and the EID frame is 
+   left out of the rotation (EDDYSTONE_EID_INTERVAL_MS is 0). To enable it, 
+   compute the ID with the Crypto block, write it to the EID frame at 
+   EPHEMERAL_ID_INDEX every 2^K seconds, and set the interval */
+#define EPHEMERAL_ID                    {0x00u, /* EID[0] */\
+                                         0x11u, /* EID[1] */\
+                                         0x22u, /* EID[2] */\
+                                         0x33u, /* EID[3] */\
+                                         0x44u, /* EID[4] */\
+                                         0x55u, /* EID[5] */\
+                                         0x66u, /* EID[6] */\
+                                         0x77u} /* EID[7] */
+
+/* Eddystone packet index of the ephemeral ID */ 
+#define EPHEMERAL_ID_INDEX              (0x0Du)
+
+/* Total size of an EID frame */    
+#define EID_PACKET_SIZE                 (0x15u)      
+
 #endif    
 /* [] END OF FILE */
@@ -50,5 +50,11 @@
 #define HIBERNATE_TIME_MIN              (00)        // Enable minutes comparison in "RTCtimer.c" before using
 #define HIBERNATE_TIME_HR               (00)        // Enable hours comparison in "RTCtimer.c" before using
 
+/*Backup registers that keep the beacon state while the device is in hibernate*/
+#define BACKUP_REG_CHECK                (0u)        // Check word of the two registers below
+#define BACKUP_REG_SLOT_COUNT           (1u)        // TLM rotation slot count
+#define BACKUP_REG_SECONDS              (2u)        // TLM time since power-up (100 ms per bit)
+#define BACKUP_CHECK_KEY                (0xEDD57011u) // Mixed into the check word
+
 #endif /* HIBERNATE_H */
 /* [] END OF FILE */
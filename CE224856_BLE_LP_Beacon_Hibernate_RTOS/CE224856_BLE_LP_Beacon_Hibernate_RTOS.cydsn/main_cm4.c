@@ -81,6 +81,21 @@
 /* Queue lengths of message queues used in this project */
 #define STATUS_LED_QUEUE_LEN       (5u)
 
+/** 
+ * Stacks and control blocks of the user tasks and storage of the queues. All 
+ * kernel objects are allocated at compile time, so the RAM they take shows up
+ * in the map file and nothing is allocated from the FreeRTOS heap. 
+ */
+static StackType_t   bleTaskStack[TASK_BLE_STACK_SIZE];
+static StaticTask_t  bleTaskBuffer;
+static StackType_t   statusLedTaskStack[TASK_STATUS_LED_STACK_SIZE];
+static StaticTask_t  statusLedTaskBuffer;
+
+static StaticQueue_t bleSemaphoreBuffer;
+static uint8_t       statusLedDataQStorage[STATUS_LED_QUEUE_LEN * 
+                                           sizeof(status_led_data_t)];
+static StaticQueue_t statusLedDataQBuffer;
+
 /*******************************************************************************
 * Function Name: main
 ********************************************************************************
@@ -99,15 +114,21 @@ int main()
 {   
      /* Create the queues and semaphores. See the respective data-types for 
        details of queue contents */
-    bleSemaphore    = xQueueCreateCountingSemaphore(ULONG_MAX,0u);
-    statusLedDataQ  = xQueueCreate(STATUS_LED_QUEUE_LEN, sizeof(status_led_data_t));
+    bleSemaphore    = xQueueCreateCountingSemaphoreStatic(ULONG_MAX, 0u,
+                                                          &bleSemaphoreBuffer);
+    statusLedDataQ  = xQueueCreateStatic(STATUS_LED_QUEUE_LEN, 
+                                         sizeof(status_led_data_t),
+                                         statusLedDataQStorage, 
+                                         &statusLedDataQBuffer);
  
     /* Create the user Tasks. See the respective Task definition for more
        details of these tasks */       
-    xTaskCreate(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
-                NULL, TASK_BLE_PRIORITY, NULL);
-    xTaskCreate(Task_StatusLed, "Status LED Task", TASK_STATUS_LED_STACK_SIZE,
-                NULL, TASK_STATUS_LED_PRIORITY, NULL);
+    xTaskCreateStatic(Task_Ble, "BLE Task", TASK_BLE_STACK_SIZE,
+                      NULL, TASK_BLE_PRIORITY, bleTaskStack, &bleTaskBuffer);
+    xTaskCreateStatic(Task_StatusLed, "Status LED Task", 
+                      TASK_STATUS_LED_STACK_SIZE, NULL, 
+                      TASK_STATUS_LED_PRIORITY, statusLedTaskStack,
+                      &statusLedTaskBuffer);
 
     
     /* Start the RTOS scheduler. This function should never return */
@@ -194,5 +215,67 @@ void vApplicationMallocFailedHook(void)
     CY_ASSERT(0);
 }
 
+/*******************************************************************************
+* Function Name: void vApplicationGetIdleTaskMemory(
+*                               StaticTask_t **ppxIdleTaskTCBBuffer,
+*                               StackType_t **ppxIdleTaskStackBuffer,
+*                               uint32_t *pulIdleTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the idle task
+*    
+* Parameters:
+*  StaticTask_t **ppxIdleTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxIdleTaskStackBuffer : returns the stack
+*  uint32_t *pulIdleTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                   StackType_t **ppxIdleTaskStackBuffer,
+                                   uint32_t *pulIdleTaskStackSize)
+{
+    static StaticTask_t idleTaskBuffer;
+    static StackType_t  idleTaskStack[configMINIMAL_STACK_SIZE];
+    
+    *ppxIdleTaskTCBBuffer   = &idleTaskBuffer;
+    *ppxIdleTaskStackBuffer = idleTaskStack;
+    *pulIdleTaskStackSize   = configMINIMAL_STACK_SIZE;
+}
+
+/*******************************************************************************
+* Function Name: void vApplicationGetTimerTaskMemory(
+*                               StaticTask_t **ppxTimerTaskTCBBuffer,
+*                               StackType_t **ppxTimerTaskStackBuffer,
+*                               uint32_t *pulTimerTaskStackSize)
+********************************************************************************
+*
+* Summary:
+*  This function provides the RTOS with the memory of the timer service task
+*    
+* Parameters:
+*  StaticTask_t **ppxTimerTaskTCBBuffer : returns the task control block
+*  StackType_t **ppxTimerTaskStackBuffer : returns the stack
+*  uint32_t *pulTimerTaskStackSize : returns the stack size in words
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                    StackType_t **ppxTimerTaskStackBuffer,
+                                    uint32_t *pulTimerTaskStackSize)
+{
+    static StaticTask_t timerTaskBuffer;
+    static StackType_t  timerTaskStack[configTIMER_TASK_STACK_DEPTH];
+    
+    *ppxTimerTaskTCBBuffer   = &timerTaskBuffer;
+    *ppxTimerTaskStackBuffer = timerTaskStack;
+    *pulTimerTaskStackSize   = configTIMER_TASK_STACK_DEPTH;
+}
+
 
 /* [] END OF FILE */
@@ -0,0 +1,265 @@
+/******************************************************************************
+* File Name: beacon_scheduler_test.c
+*
+* Version: 1.00
+*
+* Description: This file contains the host test of the beacon scheduler
+*              in beacon_scheduler.c
+*
+* Related Document: CE224856_BLE_Low_Power_Beacon_with_Hibernate_RTOS.pdf
+*
+* Hardware Dependency: CY8CKIT-062-BLE PSoC 6 BLE Pioneer Kit
+*
+*******************************************************************************
+* Copyright (2018), Cypress Semiconductor Corporation. All rights reserved.
+*******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND, 
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED 
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress 
+* reserves the right to make changes to the Software without notice. Cypress 
+* does not assume any liability arising out of the application or use of the 
+* Software or any product or circuit described in the Software. Cypress does 
+* not authorize its products for use in any products where a malfunction or 
+* failure of the Cypress product may reasonably be expected to result in 
+* significant property damage, injury or death (“High Risk Product”). By 
+* including Cypress’s product in a High Risk Product, the manufacturer of such 
+* system or application assumes all risk of such use and in doing so agrees to 
+* indemnify Cypress against all liability.
+*******************************************************************************/
+/******************************************************************************
+* The beacon scheduler only depends on the C library, so it is tested on the
+* build host. This file is not part of the PSoC Creator project. From this
+* directory:
+*     gcc -std=c99 -Wall -I.. beacon_scheduler_test.c ../beacon_scheduler.c
+*     ./a.out
+* The program prints every failed check and returns non-zero if any failed.
+*******************************************************************************/
+
+/* Header file includes */
+#include <stdio.h>
+#include "beacon_scheduler.h"
+
+/* Number of slots run for every schedule */
+#define TEST_SLOTS              (1024u)
+
+/* Marks a frame that has not been broadcast yet */
+#define NOT_SEEN                (0xFFFFFFFFu)
+
+/* Prints a failed check and counts it */
+#define CHECK(condition)        do                                          \
+                                {                                           \
+                                    if(!(condition))                        \
+                                    {                                       \
+                                        printf("%s:%d: %s\n", __FILE__,     \
+                                               __LINE__, #condition);       \
+                                        failures++;                         \
+                                    }                                       \
+                                } while(0)
+
+/* Result of running a schedule for TEST_SLOTS slots */
+typedef struct
+{
+    uint32_t slotMs;
+    uint32_t count[BEACON_SCHED_MAX_FRAMES];
+    uint32_t maxGapSlots[BEACON_SCHED_MAX_FRAMES];
+}   run_result_t;
+
+static uint32_t failures;
+
+/*******************************************************************************
+* Function Name: static void RunSchedule(run_result_t *result)
+********************************************************************************
+* Summary:
+*  Runs the schedule set up by BeaconSched_Init() and records how often each
+*  frame is on air and the longest time between two slots that broadcast it
+*
+* Parameters:
+*  run_result_t *result : result of the run
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void RunSchedule(run_result_t *result)
+{
+    uint32_t lastSlot[BEACON_SCHED_MAX_FRAMES];
+    uint32_t slot;
+    uint32_t frame;
+    
+    result->slotMs = BeaconSched_GetEventInterval() + 
+                     BEACON_SCHED_ADV_DELAY_MAX_MS;
+    for(frame = 0u; frame < BEACON_SCHED_MAX_FRAMES; frame++)
+    {
+        lastSlot[frame] = NOT_SEEN;
+        result->count[frame] = 0u;
+        result->maxGapSlots[frame] = 0u;
+    }
+    
+    for(slot = 0u; slot < TEST_SLOTS; slot++)
+    {
+        frame = BeaconSched_NextFrame();
+        CHECK(frame < BEACON_SCHED_MAX_FRAMES);
+        if(frame < BEACON_SCHED_MAX_FRAMES)
+        {
+            if((lastSlot[frame] != NOT_SEEN) && 
+               ((slot - lastSlot[frame]) > result->maxGapSlots[frame]))
+            {
+                result->maxGapSlots[frame] = slot - lastSlot[frame];
+            }
+            lastSlot[frame] = slot;
+            result->count[frame]++;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: static void TestInvalidFrames(void)
+********************************************************************************
+* Summary:
+*  Checks that schedules without a frame to broadcast are refused
+*
+*******************************************************************************/
+static void TestInvalidFrames(void)
+{
+    const beacon_sched_frame_t frames[BEACON_SCHED_MAX_FRAMES + 1u] = {{0u}};
+    const beacon_sched_frame_t one[1u] = {{1000u}};
+    
+    CHECK(!BeaconSched_Init(one, 0u));
+    CHECK(!BeaconSched_Init(frames, 3u));
+    CHECK(!BeaconSched_Init(frames, BEACON_SCHED_MAX_FRAMES + 1u));
+}
+
+/*******************************************************************************
+* Function Name: static void TestSingleFrame(void)
+********************************************************************************
+* Summary:
+*  Checks that a frame on its own is broadcast in every advertising event, at
+*  an interval that still meets its own with the random advertising delay
+*
+*******************************************************************************/
+static void TestSingleFrame(void)
+{
+    const beacon_sched_frame_t frames[1u] = {{1000u}};
+    run_result_t result;
+    
+    CHECK(BeaconSched_Init(frames, 1u));
+    RunSchedule(&result);
+    
+    CHECK(result.count[0u] == TEST_SLOTS);
+    CHECK(result.slotMs <= frames[0u].intervalMs);
+    CHECK(BeaconSched_GetEventInterval() >= BEACON_SCHED_MIN_INTERVAL_MS);
+}
+
+/*******************************************************************************
+* Function Name: static void TestSlotAssignment(void)
+********************************************************************************
+* Summary:
+*  Checks that frames that fit are all broadcast within their interval, and
+*  that a frame with an interval of 0 is never broadcast
+*
+* Theory:
+*  A frame may only be on air at the start of one of its slots and at the end
+*  of the next one, so a gap of G slots between its slots is within the 
+*  interval if G + 1 slots are. Two frames given the same offset would make
+*  one of them miss its slots, which breaks this bound.
+*
+*******************************************************************************/
+static void TestSlotAssignment(void)
+{
+    const beacon_sched_frame_t frames[4u] = 
+    {
+        {1000u}, {1000u}, {2000u}, {0u}
+    };
+    run_result_t result;
+    uint32_t frame;
+    
+    CHECK(BeaconSched_Init(frames, 4u));
+    RunSchedule(&result);
+    
+    for(frame = 0u; frame < 3u; frame++)
+    {
+        CHECK(result.count[frame] != 0u);
+        CHECK(((result.maxGapSlots[frame] + 1u) * result.slotMs) <= 
+              frames[frame].intervalMs);
+    }
+    CHECK(result.count[3u] == 0u);
+}
+
+/*******************************************************************************
+* Function Name: static void TestIntervalStretching(void)
+********************************************************************************
+* Summary:
+*  Checks frames that do not fit even at the shortest advertising interval.
+*  The frame with the shortest interval is broadcast less often than asked, 
+*  but no less than half as often, and the other frame keeps its interval.
+*
+*******************************************************************************/
+static void TestIntervalStretching(void)
+{
+    const beacon_sched_frame_t frames[2u] = {{300u}, {10000u}};
+    const beacon_sched_frame_t crowded[5u] = 
+    {
+        {100u}, {100u}, {100u}, {100u}, {100u}
+    };
+    run_result_t result;
+    uint32_t frame;
+    
+    CHECK(BeaconSched_Init(frames, 2u));
+    CHECK(BeaconSched_GetEventInterval() == BEACON_SCHED_MIN_INTERVAL_MS);
+    RunSchedule(&result);
+    
+    CHECK(((result.maxGapSlots[0u] + 1u) * result.slotMs) > 
+          frames[0u].intervalMs);
+    CHECK(((result.maxGapSlots[0u] + 1u) * result.slotMs) <= 
+          (2u * frames[0u].intervalMs));
+    CHECK(((result.maxGapSlots[1u] + 1u) * result.slotMs) <= 
+          frames[1u].intervalMs);
+    
+    /* Every frame is still broadcast when none of them fits */
+    CHECK(BeaconSched_Init(crowded, 5u));
+    CHECK(BeaconSched_GetEventInterval() == BEACON_SCHED_MIN_INTERVAL_MS);
+    RunSchedule(&result);
+    for(frame = 0u; frame < 5u; frame++)
+    {
+        CHECK(result.count[frame] != 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: int main(void)
+********************************************************************************
+* Summary:
+*  Runs the tests
+*
+* Return:
+*  int : 0 if all checks passed
+*
+*******************************************************************************/
+int main(void)
+{
+    TestInvalidFrames();
+    TestSingleFrame();
+    TestSlotAssignment();
+    TestIntervalStretching();
+    
+    printf("beacon_scheduler_test: %u failed\n", (unsigned int)failures);
+    
+    return (failures == 0u) ? 0 : 1;
+}
+
+/* [] END OF FILE */